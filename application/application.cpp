@@ -49,7 +49,7 @@
 #include "../util/stringUtil.h"
 
 #define TICKS_PER_SECOND 120.0
-#define TICK_SKIP_TIME std::chrono::milliseconds(1000)
+#define MAX_CATCH_UP_TICKS 10
 
 namespace P3D::Application {
 
@@ -233,7 +233,7 @@ void setupWorld(const Util::ParsedArgs& cmdArgs) {
 }
 
 void setupPhysics() {
-	physicsThread = TickerThread(TICKS_PER_SECOND, TICK_SKIP_TIME, [] () {
+	physicsThread = TickerThread(TICKS_PER_SECOND, MAX_CATCH_UP_TICKS, [] () {
 		physicsMeasure.mark(PhysicsProcess::OTHER);
 
 		Graphics::AppDebug::logTickStart();
@@ -345,6 +345,10 @@ double getSpeed() {
 	return physicsThread.getSpeed();
 }
 
+double getTickInterpolationAlpha() {
+	return physicsThread.getInterpolationAlpha();
+}
+
 void runTick() {
 	physicsThread.runTick();
 }
@@ -19,6 +19,7 @@ void togglePause();
 void runTick();
 void setSpeed(double newSpeed);
 double getSpeed();
+double getTickInterpolationAlpha();
 void stop(int returnCode);
 void toggleFlying();
 void onEvent(Engine::Event& event);
@@ -12,7 +12,12 @@ namespace P3D::Application {
 
 namespace Comp {
 
-struct Hitbox : RefCountable {
+/*
+	Hitbox, Transform and Collider are read by systems every frame, so they aren't RefCountable and the registry stores them inline in its pools.
+	The registry hands them out as plain pointers, which stay valid until a component of the same type is removed
+*/
+
+struct Hitbox {
 	std::variant<Shape, ExtendedPart*> hitbox;
 
 	Hitbox() : hitbox(Shape(&CubeClass::instance)) {}
@@ -49,7 +54,7 @@ struct Hitbox : RefCountable {
 	}
 };
 
-struct Transform : RefCountable {
+struct Transform {
 	struct ScaledCFrame {
 		GlobalCFrame cframe;
 		DiagonalMat3 scale;
@@ -202,6 +207,7 @@ struct Transform : RefCountable {
 	void setWidth(double width) {
 		if (std::holds_alternative<ExtendedPart*>(this->cframe)) {
 			std::get<ExtendedPart*>(this->cframe)->hitbox.setWidth(width);
+			std::get<ExtendedPart*>(this->cframe)->updateBounds();
 		} else {
 			std::get<ScaledCFrame>(this->cframe).scale[0] = width;
 		}
@@ -218,6 +224,7 @@ struct Transform : RefCountable {
 	void setHeight(double height) {
 		if (std::holds_alternative<ExtendedPart*>(this->cframe)) {
 			std::get<ExtendedPart*>(this->cframe)->hitbox.setHeight(height);
+			std::get<ExtendedPart*>(this->cframe)->updateBounds();
 		} else {
 			std::get<ScaledCFrame>(this->cframe).scale[1] = height;
 		}
@@ -234,6 +241,7 @@ struct Transform : RefCountable {
 	void setDepth(double depth) {
 		if (std::holds_alternative<ExtendedPart*>(this->cframe)) {
 			std::get<ExtendedPart*>(this->cframe)->hitbox.setDepth(depth);
+			std::get<ExtendedPart*>(this->cframe)->updateBounds();
 		} else {
 			std::get<ScaledCFrame>(this->cframe).scale[2] = depth;
 		}
@@ -268,7 +276,7 @@ struct Name : RefCountable {
 };
 
 // The collider of the entity, as it is being physicsed in the engine 
-struct Collider : RefCountable {
+struct Collider {
 	ExtendedPart* part;
 
 	Collider(ExtendedPart* part) : part(part) {}
@@ -4,6 +4,7 @@
 #include "../graphics/visualData.h"
 #include "../graphics/visualShape.h"
 #include "../physics/part.h"
+#include "../physics/threading/renderSnapshot.h"
 #include "../engine/ecs/registry.h"
 
 namespace P3D::Application {
@@ -28,4 +29,12 @@ public:
 	Graphics::Color getColor() const;
 };
 
-};
\ No newline at end of file
+};
+
+// render snapshots refer to parts by their entity, which can still be looked up safely after the part has been removed
+template<>
+struct RenderSnapshotID<P3D::Application::ExtendedPart> {
+	using type = P3D::Application::ExtendedPart::Entity;
+
+	static type of(const P3D::Application::ExtendedPart& part) { return part.entity; }
+};
@@ -3,6 +3,7 @@
 #include "serialization.h"
 
 #include "../util/fileUtils.h"
+#include "../util/mappedFile.h"
 
 #include "extendedPart.h"
 #include "application.h"
@@ -156,18 +157,18 @@ void WorldImportExport::saveWorld(const char* fileName, const World<ExtendedPart
 	file.close();
 }
 void WorldImportExport::loadWorld(const char* fileName, World<ExtendedPart>& world) {
-	std::ifstream file;
-	openReadFile(file, fileName);
+	std::string fullPath = Util::getFullPath(fileName);
+	Log::info("Reading file %s", fullPath.c_str());
 
-	if(!file.is_open()) {
+	// the world file is read in place, the part columns are not copied out of the mapping
+	Util::MappedFile file(fullPath);
+	if(!file.isOpen()) {
 		throw std::runtime_error("Could not open file!");
 	}
 
 	Deserializer deserializer;
-	deserializer.deserializeWorld(world, file);
+	deserializer.deserializeWorld(world, file.getData(), file.getSize());
 
 	assert(world.isValid());
-
-	file.close();
 }
 };
@@ -62,67 +62,25 @@ static void renderBoundsForDepth(const Bounds& bounds, int depth) {
 	renderBounds(bounds.expanded((10 - depth) * 0.002), getCyclingColor(depth));
 }
 
-static void recursiveRenderColTree(const P3D::OldBoundsTree::TreeNode& node, int depth) {
-	if (node.isLeafNode()) {
-		//renderBounds(node.bounds, GUI::COLOR::AQUA);
-	} else {
-		for (const P3D::OldBoundsTree::TreeNode& node : node) {
-			recursiveRenderColTree(node, depth + 1);
-		}
-	}
-
-	renderBoundsForDepth(node.bounds, depth);
-}
-
-static bool recursiveColTreeForOneObject(const P3D::OldBoundsTree::TreeNode& node, const Part* part, const Bounds& bounds, int depth) {
-	if (node.isLeafNode()) {
-		if (node.object == part)
-			return true;
-		/*for (const BoundedPhysical& p : *node.physicals) {
-			if (p.object == physical) {
-				return true;
-			}
-		}*/
-	} else {
-		//if (!intersects(node.bounds, bounds)) return false;
-		for (const P3D::OldBoundsTree::TreeNode& subNode : node) {
-			if (recursiveColTreeForOneObject(subNode, part, bounds, depth+1)) {
-				renderBoundsForDepth(node.bounds, depth);
-				return true;
-			}
-		}
-	}
-	return false;
-}
-
-static void renderTree(const P3D::OldBoundsTree::BoundsTree<Part>& tree) {
-	recursiveRenderColTree(tree.rootNode, 0);
-}
-static void renderTreeForOneObject(const P3D::OldBoundsTree::BoundsTree<Part>& tree, const Part& part) {
-	recursiveColTreeForOneObject(tree.rootNode, &part, part.getBounds(), 0);
-}
-
-
-
-static void recursiveRenderColTree(const P3D::NewBoundsTree::TreeTrunk& curTrunk, int curTrunkSize, int depth) {
+static void recursiveRenderColTree(const P3D::NewBoundsTree::TreeTrunk& curTrunk, int curTrunkSize, const Position& treeOrigin, int depth) {
 	for(int i = 0; i < curTrunkSize; i++) {
 		const P3D::NewBoundsTree::TreeNodeRef& subNode = curTrunk.subNodes[i];
 
 		if(subNode.isTrunkNode()) {
-			recursiveRenderColTree(subNode.asTrunk(), subNode.getTrunkSize(), depth + 1);
+			recursiveRenderColTree(subNode.asTrunk(), subNode.getTrunkSize(), treeOrigin, depth + 1);
 		}
 
-		renderBoundsForDepth(curTrunk.getBoundsOfSubNode(i), depth);
+		renderBoundsForDepth(P3D::NewBoundsTree::fromTreeBounds(curTrunk.getBoundsOfSubNode(i), treeOrigin), depth);
 	}
 }
 
-static bool recursiveColTreeForOneObject(const P3D::NewBoundsTree::TreeTrunk& curTrunk, int curTrunkSize, const Part* part, const Bounds& bounds, int depth) {
+static bool recursiveColTreeForOneObject(const P3D::NewBoundsTree::TreeTrunk& curTrunk, int curTrunkSize, const Part* part, const Position& treeOrigin, int depth) {
 	for(int i = 0; i < curTrunkSize; i++) {
 		const P3D::NewBoundsTree::TreeNodeRef& subNode = curTrunk.subNodes[i];
 
 		if(subNode.isTrunkNode()) {
-			if(recursiveColTreeForOneObject(subNode.asTrunk(), subNode.getTrunkSize(), part, bounds, depth + 1)) {
-				renderBoundsForDepth(curTrunk.getBoundsOfSubNode(i), depth);
+			if(recursiveColTreeForOneObject(subNode.asTrunk(), subNode.getTrunkSize(), part, treeOrigin, depth + 1)) {
+				renderBoundsForDepth(P3D::NewBoundsTree::fromTreeBounds(curTrunk.getBoundsOfSubNode(i), treeOrigin), depth);
 				return true;
 			}
 		} else {
@@ -136,11 +94,11 @@ static bool recursiveColTreeForOneObject(const P3D::NewBoundsTree::TreeTrunk& cu
 
 static void renderTree(const P3D::NewBoundsTree::BoundsTree<Part>& tree) {
 	auto baseTrunk = tree.getPrototype().getBaseTrunk();
-	recursiveRenderColTree(baseTrunk.first, baseTrunk.second, 0);
+	recursiveRenderColTree(baseTrunk.first, baseTrunk.second, tree.getOrigin(), 0);
 }
 static void renderTreeForOneObject(const P3D::NewBoundsTree::BoundsTree<Part>& tree, const Part& part) {
 	auto baseTrunk = tree.getPrototype().getBaseTrunk();
-	recursiveColTreeForOneObject(baseTrunk.first, baseTrunk.second, &part, part.getBounds(), 0);
+	recursiveColTreeForOneObject(baseTrunk.first, baseTrunk.second, &part, tree.getOrigin(), 0);
 }
 
 
@@ -73,7 +73,11 @@ void DebugOverlay::onRender(Engine::Registry64& registry) {
 	//addDebugField(screen->dimension, GUI::font, "Intersections", getTheoreticalNumberOfIntersections(objectCount), "");
 	addDebugField(screen->dimension, GUI::font, "AVG Collide GJK Iterations", gjkCollideIterStats.avg(), "");
 	addDebugField(screen->dimension, GUI::font, "AVG No Collide GJK Iterations", gjkNoCollideIterStats.avg(), "");
+	addDebugField(screen->dimension, GUI::font, "AVG Queued Operations", commandQueueDepth.avg(), "");
+	addDebugField(screen->dimension, GUI::font, "AVG Queue Latency", commandQueueLatency.avg().count() / 1000000.0, "ms");
 	addDebugField(screen->dimension, GUI::font, "TPS", physicsMeasure.getAvgTPS(), "");
+	addDebugField(screen->dimension, GUI::font, "AVG Tick Jitter", tickJitter.avg().count() / 1000000.0, "ms");
+	addDebugField(screen->dimension, GUI::font, "Max Tick Jitter", tickJitter.max().count() / 1000000.0, "ms");
 	addDebugField(screen->dimension, GUI::font, "FPS", Graphics::graphicsMeasure.getAvgTPS(), "");
 	/*addDebugField(screen->dimension, GUI::font, "World Kinetic Energy", screen->world->getTotalKineticEnergy(), "");
 	addDebugField(screen->dimension, GUI::font, "World Potential Energy", screen->world->getTotalPotentialEnergy(), "");
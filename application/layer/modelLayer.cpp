@@ -19,7 +19,6 @@
 #include "../graphics/gui/color.h"
 
 #include "../physics/math/linalg/vec.h"
-#include "../physics/misc/filters/visibilityFilter.h"
 
 #include "../util/resource/resourceManager.h"
 #include "../layer/shadowLayer.h"
@@ -38,21 +37,22 @@ enum class RelationToSelectedPart {
 	MAINPHYSICAL_ATTACH
 };
 
-static RelationToSelectedPart getRelationToSelectedPart(const Part* selectedPart, const Part* testPart) {
+// parts are compared through the render snapshot, so this doesn't have to look at the parts while the physics thread changes them
+static RelationToSelectedPart getRelationToSelectedPart(const RenderSnapshotPart<ExtendedPart>* selectedPart, const RenderSnapshotPart<ExtendedPart>& testPart) {
 	if (selectedPart == nullptr)
 		return RelationToSelectedPart::NONE;
 
-	if (testPart == selectedPart)
+	if (testPart.id == selectedPart->id)
 		return RelationToSelectedPart::SELF;
 
-	if (selectedPart->parent != nullptr && testPart->parent != nullptr) {
-		if (testPart->parent == selectedPart->parent) {
-			if (testPart->isMainPart())
+	if (selectedPart->physical != nullptr && testPart.physical != nullptr) {
+		if (testPart.physical == selectedPart->physical) {
+			if (testPart.isMainPart)
 				return RelationToSelectedPart::MAINPART;
 			else
 				return RelationToSelectedPart::DIRECT_ATTACH;
-		} else if (testPart->parent->mainPhysical == selectedPart->parent->mainPhysical) {
-			if (testPart->parent->isMainPhysical())
+		} else if (testPart.mainPhysical == selectedPart->mainPhysical) {
+			if (testPart.isMainPhysical)
 				return RelationToSelectedPart::MAINPHYSICAL_ATTACH;
 			else
 				return RelationToSelectedPart::PHYSICAL_ATTACH;
@@ -62,8 +62,8 @@ static RelationToSelectedPart getRelationToSelectedPart(const Part* selectedPart
 	return RelationToSelectedPart::NONE;
 }
 
-static Color getAmbientForPartForSelected(Screen* screen, Part* part) {
-	switch (getRelationToSelectedPart(screen->selectedPart, part)) {
+static Color getAmbientForPartForSelected(const RenderSnapshotPart<ExtendedPart>* selectedPart, const RenderSnapshotPart<ExtendedPart>& part) {
+	switch (getRelationToSelectedPart(selectedPart, part)) {
 		case RelationToSelectedPart::NONE:
 			return Color(0.0f, 0, 0, 0);
 		case RelationToSelectedPart::SELF:
@@ -81,10 +81,10 @@ static Color getAmbientForPartForSelected(Screen* screen, Part* part) {
 	return Color(0, 0, 0, 0);
 }
 
-static Color getAlbedoForPart(Screen* screen, ExtendedPart* part) {
-	Color computedAmbient = getAmbientForPartForSelected(screen, part);
+static Color getAlbedoForPart(Screen* screen, const RenderSnapshotPart<ExtendedPart>* selectedPart, const RenderSnapshotPart<ExtendedPart>& part) {
+	Color computedAmbient = getAmbientForPartForSelected(selectedPart, part);
 
-	if (part->entity == screen->intersectedEntity)
+	if (part.id == screen->intersectedEntity)
 		computedAmbient = Vec4f(computedAmbient) + Vec4f(-0.1f, -0.1f, -0.1f, 0);
 
 	return computedAmbient;
@@ -110,8 +110,8 @@ void ModelLayer::onUpdate(Engine::Registry64& registry) {
 		Ref<Comp::Light> light = view.get<Comp::Light>(entity);
 
 		Position position;
-		Ref<Comp::Transform> transform = registry.get<Comp::Transform>(entity);
-		if (transform.valid()) 
+		Comp::Transform* transform = registry.get<Comp::Transform>(entity);
+		if (transform != nullptr) 
 			position = transform->getCFrame().getPosition();
 		
 		Shaders::basicShader.updateLight(index, position, *light);
@@ -154,130 +154,142 @@ void ModelLayer::onRender(Engine::Registry64& registry) {
 	Shaders::instanceShader.updateSunDirection(sunDirection);
 
 	graphicsMeasure.mark(PHYSICALS);
-	
+
+	// parts are drawn from the render snapshot, so the render thread doesn't take the world's lock for them
+	const RenderSnapshot<ExtendedPart>& snapshot = screen->world->getRenderSnapshot();
+	const RenderSnapshotPart<ExtendedPart>* selectedPart = nullptr;
+	if (screen->selectedPart != nullptr) {
+		for (const RenderSnapshotPart<ExtendedPart>& part : snapshot.parts) {
+			if (part.id == screen->selectedPart->entity) {
+				selectedPart = &part;
+				break;
+			}
+		}
+	}
+
 	// Filter on mesh ID and transparency
 	struct EntityInfo {
 		Engine::Registry64::entity_type entity = 0;
-		Comp::Transform transform;
+		Mat4f modelMatrix;
 		Comp::Material material;
 		Ref<Comp::Mesh> mesh;
-		Ref<Comp::Collider> collider;
 	};
 	
 	std::map<double, EntityInfo> transparentEntities;
-	screen->world->syncReadOnlyOperation([this, &transparentEntities, screen, &registry] () {
-		VisibilityFilter filter = VisibilityFilter::forWindow(screen->camera.cframe.position, screen->camera.getForwardDirection(), screen->camera.getUpDirection(), screen->camera.fov, screen->camera.aspect, screen->camera.zfar);
-
-		auto view = registry.view<Comp::Mesh>();
-		for (auto entity : view) {
-			EntityInfo info;
-			info.entity = entity;
+	auto addEntity = [this, &transparentEntities, screen, &registry] (Engine::Registry64::entity_type entity, Ref<Comp::Mesh> mesh, const GlobalCFrame& cframe, const DiagonalMat3& scale, const Color& ambient) {
+		EntityInfo info;
+		info.entity = entity;
+		info.mesh = std::move(mesh);
+		info.modelMatrix = cframe.asMat4WithPreScale(scale);
+		info.material = registry.getOr<Comp::Material>(entity);
+
+		bool transparent = info.material.albedo.a < 1.0f;
+		info.material.albedo += ambient;
+
+		if (transparent) {
+			double distance = lengthSquared(Vec3(screen->camera.cframe.position - cframe.getPosition()));
+			transparentEntities.insert(std::make_pair(distance, info));
+		} else {
+			Uniform uniform {
+				info.modelMatrix,
+				info.material.albedo,
+				info.material.metalness,
+				info.material.roughness,
+				info.material.ao
+			};
 			
-			info.mesh = view.get<Comp::Mesh>(entity);
-			if (!info.mesh.valid())
-				continue;
-
-			if (info.mesh->id == -1)
-				continue;
-			
-			info.collider = registry.get<Comp::Collider>(entity);
-			if (info.collider.valid())
-				if (!filter(*info.collider->part))
-					continue;
-
-			info.transform = registry.getOr<Comp::Transform>(entity);
-			info.material = registry.getOr<Comp::Material>(entity);
-			
-			if (info.material.albedo.a < 1.0f) {
-				double distance = lengthSquared(Vec3(screen->camera.cframe.position - info.transform.getPosition()));
-				transparentEntities.insert(std::make_pair(distance, info));
-			} else {
-				Mat4f modelMatrix = info.transform.getModelMatrix();
-
-				if (info.collider.valid())
-					info.material.albedo += getAlbedoForPart(screen, info.collider->part);
-
-				Uniform uniform {
-					modelMatrix,
-					info.material.albedo,
-					info.material.metalness,
-					info.material.roughness,
-					info.material.ao
-				};
-				
-				manager->add(info.mesh->id, uniform);
-			}
+			manager->add(info.mesh->id, uniform);
 		}
-		
-		Shaders::instanceShader.bind();
-		manager->submit();
-		
-
-		// Render transparent meshes
-		Shaders::basicShader.bind();
-		enableBlending();
-		for (auto iterator = transparentEntities.rbegin(); iterator != transparentEntities.rend(); ++iterator) {
-			EntityInfo info = iterator->second;
+	};
 
-			if (info.mesh->id == -1)
-				continue;
+	for (const RenderSnapshotPart<ExtendedPart>& part : snapshot.parts) {
+		Ref<Comp::Mesh> mesh = registry.get<Comp::Mesh>(part.id);
+		if (!mesh.valid() || mesh->id == -1)
+			continue;
 
-			if (info.collider.valid())
-				info.material.albedo += getAlbedoForPart(screen, info.collider->part);
+		addEntity(part.id, mesh, part.cframe, part.scale, getAlbedoForPart(screen, selectedPart, part));
+	}
 
-			Shaders::basicShader.updateMaterial(info.material);
-			Shaders::basicShader.updateModel(info.transform.getModelMatrix());
-			MeshRegistry::meshes[info.mesh->id]->render(info.mesh->mode);
-		}
+	// meshes without a part aren't in the snapshot, physics never moves them
+	auto view = registry.view<Comp::Mesh>();
+	for (auto entity : view) {
+		if (registry.has<Comp::Collider>(entity))
+			continue;
 
-		// Hitbox drawing
-		if (screen->selectedEntity) {
-			Ref<Comp::Transform> transform = registry.get<Comp::Transform>(screen->selectedEntity);
-			if (transform.valid()) {
-				Ref<Comp::Hitbox> hitbox = registry.get<Comp::Hitbox>(screen->selectedEntity);
+		Ref<Comp::Mesh> mesh = view.get<Comp::Mesh>(entity);
+		if (!mesh.valid() || mesh->id == -1)
+			continue;
 
-				if (hitbox.valid()) {
-					Shape shape = hitbox->getShape();
-					DiagonalMat3 scale = transform->getScale();
+		Comp::Transform transform = registry.getOr<Comp::Transform>(entity);
+		addEntity(entity, mesh, transform.getCFrame(), transform.getScale(), Color(0, 0, 0, 0));
+	}
+	
+	Shaders::instanceShader.bind();
+	manager->submit();
+
+	// Render transparent meshes
+	Shaders::basicShader.bind();
+	enableBlending();
+	for (auto iterator = transparentEntities.rbegin(); iterator != transparentEntities.rend(); ++iterator) {
+		const EntityInfo& info = iterator->second;
+
+		Shaders::basicShader.updateMaterial(info.material);
+		Shaders::basicShader.updateModel(info.modelMatrix);
+		MeshRegistry::meshes[info.mesh->id]->render(info.mesh->mode);
+	}
 
-					if (!hitbox->isPartAttached())
-						scale = scale * hitbox->getScale();		
+	// the hitboxes of the selection are read from the parts themselves, so the world is only locked while something is selected
+	if (screen->selectedEntity || !SelectionTool::selection.empty()) {
+		screen->world->syncReadOnlyOperation([screen, &registry] () {
+			// Hitbox drawing
+			if (screen->selectedEntity) {
+				Comp::Transform* transform = registry.get<Comp::Transform>(screen->selectedEntity);
+				if (transform != nullptr) {
+					Comp::Hitbox* hitbox = registry.get<Comp::Hitbox>(screen->selectedEntity);
+
+					if (hitbox != nullptr) {
+						Shape shape = hitbox->getShape();
+						DiagonalMat3 scale = transform->getScale();
+
+						if (!hitbox->isPartAttached())
+							scale = scale * hitbox->getScale();		
 					
-					VisualData data = MeshRegistry::getOrCreateMeshFor(shape.baseShape);
+						VisualData data = MeshRegistry::getOrCreateMeshFor(shape.baseShape);
 
-					Shaders::debugShader.updateModel(transform->getCFrame().asMat4WithPreScale(scale));
-					MeshRegistry::meshes[data.id]->render();
+						Shaders::debugShader.updateModel(transform->getCFrame().asMat4WithPreScale(scale));
+						MeshRegistry::meshes[data.id]->render();
+					}
 				}
 			}
-		}
-		auto scf = SelectionTool::selection.getCFrame();
-		auto shb = SelectionTool::selection.getHitbox();
-		if (scf.has_value() && shb.has_value()) {
-			VisualData data = MeshRegistry::getOrCreateMeshFor(shb->baseShape);
-			Shaders::debugShader.updateModel(scf.value().asMat4WithPreScale(shb->scale));
-			MeshRegistry::meshes[data.id]->render();
-		}
+			auto scf = SelectionTool::selection.getCFrame();
+			auto shb = SelectionTool::selection.getHitbox();
+			if (scf.has_value() && shb.has_value()) {
+				VisualData data = MeshRegistry::getOrCreateMeshFor(shb->baseShape);
+				Shaders::debugShader.updateModel(scf.value().asMat4WithPreScale(shb->scale));
+				MeshRegistry::meshes[data.id]->render();
+			}
 		
-		// Hitbox drawing
-		for (auto entity : SelectionTool::selection) {
-			Ref<Comp::Transform> transform = registry.get<Comp::Transform>(entity);
-			if (transform.valid()) {
-				Ref<Comp::Hitbox> hitbox = registry.get<Comp::Hitbox>(entity);
+			// Hitbox drawing
+			for (auto entity : SelectionTool::selection) {
+				Comp::Transform* transform = registry.get<Comp::Transform>(entity);
+				if (transform != nullptr) {
+					Comp::Hitbox* hitbox = registry.get<Comp::Hitbox>(entity);
 
-				if (hitbox.valid()) {
-					Shape shape = hitbox->getShape();
+					if (hitbox != nullptr) {
+						Shape shape = hitbox->getShape();
 
-					if (!hitbox->isPartAttached())
-						shape = shape.scaled(transform->getScale());
+						if (!hitbox->isPartAttached())
+							shape = shape.scaled(transform->getScale());
 
-					VisualData data = MeshRegistry::getOrCreateMeshFor(shape.baseShape);
+						VisualData data = MeshRegistry::getOrCreateMeshFor(shape.baseShape);
 
-					Shaders::debugShader.updateModel(transform->getCFrame().asMat4WithPreScale(shape.scale));
-					MeshRegistry::meshes[data.id]->render();
+						Shaders::debugShader.updateModel(transform->getCFrame().asMat4WithPreScale(shape.scale));
+						MeshRegistry::meshes[data.id]->render();
+					}
 				}
 			}
-		}
-	});
+		});
+	}
 
 	endScene();
 }
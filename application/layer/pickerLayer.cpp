@@ -92,8 +92,8 @@ Position planeIntersection = screen.camera.cframe.position + SelectionTool::ray.
 if (isPaused()) {
 	Vec3 translation = planeIntersection - screen.selectedPoint;
 	screen.selectedPoint += translation;
-	Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(screen.selectedEntity);
-	if (transform.valid())
+	Comp::Transform* transform = screen.registry.get<Comp::Transform>(screen.selectedEntity);
+	if (transform != nullptr)
 		transform->translate(translation);
 } else {
 	screen.world->selectedPart = screen.selectedPart;
@@ -116,8 +116,8 @@ void moveGrabbedEntityTransversal(Screen& screen, double dz) {
 	Vec3 translation = -cameraYDirection * dz;
 	if (isPaused()) {
 		screen.selectedPoint += translation;
-		Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(screen.selectedEntity);
-		if (transform.valid())
+		Comp::Transform* transform = screen.registry.get<Comp::Transform>(screen.selectedEntity);
+		if (transform != nullptr)
 			transform->translate(translation);
 	} else {
 		screen.world->selectedPart = screen.selectedPart;
@@ -64,14 +64,11 @@ void ShadowLayer::onEvent(Engine::Registry64& registry, Engine::Event& event) {
 }
 
 void ShadowLayer::renderScene(Engine::Registry64& registry) {
-	std::vector<ExtendedPart*> visibleParts;
-	screen.world->syncReadOnlyOperation([&visibleParts, &registry] () {
-		for (ExtendedPart& part : screen.world->iterParts())
-			visibleParts.push_back(&part);
-		});
+	// the render snapshot is read without locking the world, so the physics thread doesn't have to wait on rendering
+	const RenderSnapshot<ExtendedPart>& snapshot = screen.world->getRenderSnapshot();
 
-	for (ExtendedPart* part : visibleParts) {
-		Ref<Comp::Mesh> mesh = registry.get<Comp::Mesh>(part->entity);
+	for (const RenderSnapshotPart<ExtendedPart>& part : snapshot.parts) {
+		Ref<Comp::Mesh> mesh = registry.get<Comp::Mesh>(part.id);
 
 		if (!mesh.valid())
 			continue;
@@ -79,7 +76,7 @@ void ShadowLayer::renderScene(Engine::Registry64& registry) {
 		if (mesh->id == -1)
 			continue;
 
-		Shaders::depthShader.updateModel(part->getCFrame().asMat4WithPreScale(part->hitbox.scale));
+		Shaders::depthShader.updateModel(part.cframe.asMat4WithPreScale(part.scale));
 		Graphics::MeshRegistry::meshes[mesh->id]->render(mesh->mode);
 	}
 }
@@ -14,23 +14,23 @@ namespace P3D::Application {
 	}
 
 	void Selection::expandSelection(const Engine::Registry64::entity_type& entity) {
-		Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(entity);
-		if (transform.invalid())
+		Comp::Transform* transform = screen.registry.get<Comp::Transform>(entity);
+		if (transform == nullptr)
 			return;
 
-		Ref<Comp::Hitbox> hitbox = screen.registry.get<Comp::Hitbox>(entity);
+		Comp::Hitbox* hitbox = screen.registry.get<Comp::Hitbox>(entity);
 		
 		if (selection.empty() || !this->boundingBox.has_value()) {
-			if (hitbox.valid())
+			if (hitbox != nullptr)
 				this->boundingBox = hitbox->getShape().getBounds();
 			else
 				this->boundingBox = BoundingBox(0.2, 0.2, .2);
 		} else {
-			Ref<Comp::Transform> referenceTransform = screen.registry.get<Comp::Transform>(selection[0]);
+			Comp::Transform* referenceTransform = screen.registry.get<Comp::Transform>(selection[0]);
 			GlobalCFrame referenceFrame = referenceTransform->getCFrame();
 			CFrame relativeFrame = referenceFrame.globalToLocal(transform->getCFrame());
 
-			if (hitbox.valid()) {
+			if (hitbox != nullptr) {
 				BoundingBox rotatedBounds = hitbox->getShape().getBounds(relativeFrame.getRotation());
 				this->boundingBox = this->boundingBox->expanded(relativeFrame.getPosition() + rotatedBounds.min).expanded(relativeFrame.getPosition() + rotatedBounds.max);
 			} else {
@@ -114,8 +114,8 @@ namespace P3D::Application {
 
 	void Selection::translate(const Vec3& translation) {
 		for (auto entity : this->selection) {
-			Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(entity);
-			if (transform.valid())
+			Comp::Transform* transform = screen.registry.get<Comp::Transform>(entity);
+			if (transform != nullptr)
 				transform->translate(translation);
 		}
 	}
@@ -127,9 +127,9 @@ namespace P3D::Application {
 		
 		Rotation rotation = Rotation::fromRotationVec(angle * normal);
 		for (auto entity : this->selection) {
-			Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(entity);
+			Comp::Transform* transform = screen.registry.get<Comp::Transform>(entity);
 			
-			if (transform.valid()) {
+			if (transform != nullptr) {
 				transform->rotate(rotation);
 				Vec3 delta = transform->getPosition() - reference->getPosition();
 				Vec3 translation = rotation * delta - delta;
@@ -144,7 +144,7 @@ namespace P3D::Application {
 			return;
 
 		for (auto entity : this->selection) {
-			Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(entity);
+			Comp::Transform* transform = screen.registry.get<Comp::Transform>(entity);
 			Vec3 delta = transform->getPosition() - reference->getPosition();
 			Vec3 translation = elementWiseMul(delta, scale - Vec3(1.0, 1.0, 1.0));
 			transform->translate(translation);
@@ -159,8 +159,8 @@ namespace P3D::Application {
 			return std::nullopt;
 
 		if (this->size() == 1) {
-			Ref<Comp::Hitbox> hitbox = screen.registry.get<Comp::Hitbox>(this->selection[0]);
-			if (hitbox.valid())
+			Comp::Hitbox* hitbox = screen.registry.get<Comp::Hitbox>(this->selection[0]);
+			if (hitbox != nullptr)
 				return hitbox->getShape();
 		}
 
@@ -171,7 +171,7 @@ namespace P3D::Application {
 		if (this->selection.empty())
 			return std::nullopt;
 
-		Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(this->selection[0]);
+		Comp::Transform* transform = screen.registry.get<Comp::Transform>(this->selection[0]);
 		return GlobalCFrame(transform->getCFrame().localToGlobal(this->boundingBox->getCenter()), transform->getRotation());
 	}
 	
@@ -100,8 +100,8 @@ namespace P3D::Application {
 
 			auto view = screen.registry.view<Comp::Hitbox, Comp::Transform>();
 			for (auto entity : view) {
-				Ref<Comp::Hitbox> hitbox = view.get<Comp::Hitbox>(entity);
-				Ref<Comp::Transform> transform = view.get<Comp::Transform>(entity);
+				Comp::Hitbox* hitbox = view.get<Comp::Hitbox>(entity);
+				Comp::Transform* transform = view.get<Comp::Transform>(entity);
 				screen.world->syncReadOnlyOperation([&] () {
 					Shape shape = hitbox->getShape();
 					if (!transform->isPartAttached())
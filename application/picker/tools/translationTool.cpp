@@ -331,8 +331,8 @@ namespace P3D::Application {
 			if (SelectionTool::selection.size() > 1)
 				return;
 
-			Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(SelectionTool::selection[0]);
-			if (transform.invalid())
+			Comp::Transform* transform = screen.registry.get<Comp::Transform>(SelectionTool::selection[0]);
+			if (transform == nullptr)
 				return;
 			if (!transform->isPartAttached())
 				return;
@@ -2,12 +2,17 @@
 
 #include "tickerThread.h"
 
+#include "../physics/misc/physicsProfiler.h"
+
 namespace P3D::Application {
 
+// how long before the next tick a precisely paced thread stops sleeping and starts yielding
+#define PRECISE_PACING_MARGIN milliseconds(2)
+
 using namespace std::chrono;
-TickerThread::TickerThread(double targetTPS, milliseconds tickSkipTimeout, void(*tickAction)()) {
+TickerThread::TickerThread(double targetTPS, int maxCatchUpTicks, void(*tickAction)()) {
 	this->TPS = targetTPS;
-	this->tickSkipTimeout = tickSkipTimeout;
+	this->maxCatchUpTicks = maxCatchUpTicks;
 	this->tickAction = tickAction;
 }
 
@@ -15,32 +20,71 @@ TickerThread::~TickerThread() {
 	this->stop();
 }
 
+void TickerThread::waitUntil(time_point<steady_clock> target) const {
+	if (this->precisePacing) {
+		std::this_thread::sleep_until(target - PRECISE_PACING_MARGIN);
+		while (steady_clock::now() < target) {
+			std::this_thread::yield();
+		}
+	} else {
+		std::this_thread::sleep_until(target);
+	}
+}
+
 void TickerThread::start() {
 	this->stopped = false;
+	this->isRunning = true;
 
 	this->thread = std::thread([this] () {
-		time_point<system_clock> nextTarget = system_clock::now();
+		duration<double> tickTime(1.0 / (this->TPS * this->speed));
+		// the first tick runs right away
+		duration<double> accumulator = tickTime;
+		time_point<steady_clock> previousTime = steady_clock::now();
 
 		while (!(this->stopped)) {
+			tickTime = duration<double>(1.0 / (this->TPS * this->speed));
 
-			microseconds tickTime = microseconds((long long) (1000000 / (this->TPS * this->speed)));
+			time_point<steady_clock> curTime = steady_clock::now();
+			accumulator += curTime - previousTime;
+			previousTime = curTime;
 
-			this->tickAction();
+			int ticksRun = 0;
+			while (accumulator >= tickTime && ticksRun < this->maxCatchUpTicks && !(this->stopped)) {
+				this->tickAction();
+				accumulator -= tickTime;
+				ticksRun++;
+			}
 
-			nextTarget += tickTime;
-			time_point<system_clock>  curTime = system_clock::now();
-			if (curTime < nextTarget) {
-				std::this_thread::sleep_until(nextTarget);
-			} else {
+			if (accumulator >= tickTime) {
 				// We're behind schedule
-				if (nextTarget < curTime - this->tickSkipTimeout) {
-					Log::warn("Can't keep up! Skipping %d ticks!", (int) ((curTime - nextTarget).count() / (1E3 * this->tickSkipTimeout.count())));
-
-					nextTarget = curTime;
-				}
+				int skippedTicks = (int) (accumulator / tickTime);
+				Log::warn("Can't keep up! Skipping %d ticks!", skippedTicks);
+				accumulator -= skippedTicks * tickTime;
 			}
+
+			time_point<steady_clock> latestTick = curTime - duration_cast<steady_clock::duration>(accumulator);
+			this->latestTickTime.store(duration_cast<nanoseconds>(latestTick.time_since_epoch()).count(), std::memory_order_relaxed);
+			this->tickLength.store(tickTime.count(), std::memory_order_relaxed);
+
+			time_point<steady_clock> nextTarget = latestTick + duration_cast<steady_clock::duration>(tickTime);
+			this->waitUntil(nextTarget);
+			tickJitter.add(duration_cast<nanoseconds>(steady_clock::now() - nextTarget));
 		}
-		});
+	});
+}
+
+double TickerThread::getInterpolationAlpha() const {
+	if (!this->isRunning.load(std::memory_order_relaxed)) return 1.0;
+
+	double length = this->tickLength.load(std::memory_order_relaxed);
+	if (length <= 0.0) return 1.0;
+
+	nanoseconds latestTick(this->latestTickTime.load(std::memory_order_relaxed));
+	duration<double> sinceLatestTick = steady_clock::now().time_since_epoch() - latestTick;
+	double alpha = sinceLatestTick.count() / length;
+	if (alpha < 0.0) return 0.0;
+	if (alpha > 1.0) return 1.0;
+	return alpha;
 }
 
 void TickerThread::runTick() {
@@ -50,6 +94,7 @@ void TickerThread::runTick() {
 void TickerThread::stop() {
 	this->stopped = true;
 	if (this->thread.joinable()) this->thread.join();
+	this->isRunning = false;
 }
 
-};
\ No newline at end of file
+};
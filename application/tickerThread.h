@@ -2,29 +2,47 @@
 
 #include <chrono>
 #include <thread>
+#include <atomic>
 
 namespace P3D::Application {
 
 using namespace std::chrono;
 
+/*
+	Runs tickAction at a fixed rate of TPS * speed ticks per second on its own thread
+
+	Elapsed time is collected in an accumulator, and every time the thread wakes up it runs as many ticks as fit in it, up to maxCatchUpTicks
+	When more time has accumulated than that, the thread can't keep up and the remaining ticks are dropped
+*/
 class TickerThread {
 private:
 	std::thread thread;
 	bool stopped = false;
 	double TPS;
 	double speed = 1.0;
-	milliseconds tickSkipTimeout;
+	int maxCatchUpTicks;
+	// sleeps until shortly before the next tick and yields for the rest, for pacing below the resolution of the OS scheduler
+	bool precisePacing = false;
 	void(*tickAction)();
+
+	// the time the latest tick was scheduled at, in steady_clock nanoseconds, and the length of a tick in seconds, read by getInterpolationAlpha
+	std::atomic<long long> latestTickTime{0};
+	std::atomic<double> tickLength{0.0};
+	std::atomic<bool> isRunning{false};
+
+	void waitUntil(time_point<steady_clock> target) const;
 public:
-	TickerThread() : thread(), TPS(0.0), tickSkipTimeout(0), tickAction(nullptr) {};
-	TickerThread(double targetTPS, milliseconds tickSkipTimeout, void(*tickAction)());
+	TickerThread() : thread(), TPS(0.0), maxCatchUpTicks(0), tickAction(nullptr) {};
+	TickerThread(double targetTPS, int maxCatchUpTicks, void(*tickAction)());
 	~TickerThread();
 
 	TickerThread& operator=(TickerThread&& rhs) noexcept {
 		this->thread = std::thread();
 		this->stopped = rhs.stopped;
 		this->TPS = rhs.TPS;
-		this->tickSkipTimeout = rhs.tickSkipTimeout;
+		this->speed = rhs.speed;
+		this->maxCatchUpTicks = rhs.maxCatchUpTicks;
+		this->precisePacing = rhs.precisePacing;
 		this->tickAction = rhs.tickAction;
 
 		return *this;
@@ -41,7 +59,19 @@ public:
 	void setSpeed(double newSpeed) { this->speed = newSpeed; }
 	double getSpeed() { return this->speed; }
 
+	void setMaxCatchUpTicks(int newMaxCatchUpTicks) { this->maxCatchUpTicks = newMaxCatchUpTicks; }
+	int getMaxCatchUpTicks() const { return this->maxCatchUpTicks; }
+
+	void setPrecisePacing(bool newPrecisePacing) { this->precisePacing = newPrecisePacing; }
+	bool isPrecisePacing() const { return this->precisePacing; }
+
+	/*
+		How far the current time is between the latest tick and the next one, from 0 right at the latest tick to 1 when the next one is due
+		Renderers can use this to interpolate between the last two ticks. Always 1 while the thread is stopped
+	*/
+	double getInterpolationAlpha() const;
+
 	void runTick();
 };
 
-};
\ No newline at end of file
+};
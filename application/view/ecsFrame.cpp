@@ -30,8 +30,8 @@ bool IconTreeNode(Engine::Registry64& registry, Engine::Registry64::entity_type
 	if (ImGui::ButtonBehavior(button, id, &hovered, &held, true)) {
 		screen.selectedEntity = entity;
 		
-		Ref<Comp::Collider> model = registry.get<Comp::Collider>(entity);
-		if (model.valid())
+		Comp::Collider* model = registry.get<Comp::Collider>(entity);
+		if (model != nullptr)
 			screen.selectedPart = model->part;
 		
 		if (!leaf)
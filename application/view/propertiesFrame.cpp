@@ -43,9 +43,9 @@ bool _ecs_property_frame_start(Engine::Registry64& registry, Engine::Registry64:
 	if ((index) == -1) \
 		continue
 
-#define ENTITY_DISPATCH(index, type, registry, component) \
+#define ENTITY_DISPATCH(index, type, registry, entity) \
 	else if ((index) == (registry).getComponentIndex<type>()) \
-		renderEntity(registry, index, intrusive_cast<type>(component))
+		renderEntity(registry, index, (registry).get<type>(entity))
 
 #define ENTITY_DISPATCH_END(index, registry, component) \
 	else \
@@ -133,7 +133,7 @@ void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_ty
 	ImGui::CollapsingHeader(label.c_str(), ImGuiTreeNodeFlags_Leaf);
 }
 
-void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_type index, const Ref<Comp::Collider>& component) {
+void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_type index, Comp::Collider* component) {
 	ECS_PROPERTY_FRAME_START(registry, index);
 	
 	ExtendedPart* selectedPart = component->part;
@@ -283,7 +283,7 @@ void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_ty
 	ECS_PROPERTY_FRAME_END;
 }
 
-void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_type index, const Ref<Comp::Transform>& component) {
+void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_type index, Comp::Transform* component) {
 
 	ECS_PROPERTY_FRAME_START(registry, index);
 
@@ -310,7 +310,7 @@ void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_ty
 
 }
 
-void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_type index, const Ref<Comp::Hitbox>& component) {
+void renderEntity(Engine::Registry64& registry, Engine::Registry64::component_type index, Comp::Hitbox* component) {
 	ECS_PROPERTY_FRAME_START(registry, index);
 
 	bool standalone = component->isPartAttached();
@@ -359,13 +359,13 @@ void PropertiesFrame::onRender(Engine::Registry64& registry) {
 	auto components = registry.getComponents(screen.selectedEntity);
 	for (auto [index, component] : components) {
 		ENTITY_DISPATCH_START(index);
-		ENTITY_DISPATCH(index, Comp::Name, registry, component);
-		ENTITY_DISPATCH(index, Comp::Transform, registry, component);
-		ENTITY_DISPATCH(index, Comp::Collider, registry, component);
-		ENTITY_DISPATCH(index, Comp::Mesh, registry, component);
-		ENTITY_DISPATCH(index, Comp::Material, registry, component);
-		ENTITY_DISPATCH(index, Comp::Light, registry, component);
-		ENTITY_DISPATCH(index, Comp::Hitbox, registry, component);
+		ENTITY_DISPATCH(index, Comp::Name, registry, screen.selectedEntity);
+		ENTITY_DISPATCH(index, Comp::Transform, registry, screen.selectedEntity);
+		ENTITY_DISPATCH(index, Comp::Collider, registry, screen.selectedEntity);
+		ENTITY_DISPATCH(index, Comp::Mesh, registry, screen.selectedEntity);
+		ENTITY_DISPATCH(index, Comp::Material, registry, screen.selectedEntity);
+		ENTITY_DISPATCH(index, Comp::Light, registry, screen.selectedEntity);
+		ENTITY_DISPATCH(index, Comp::Hitbox, registry, screen.selectedEntity);
 		ENTITY_DISPATCH_END(index, registry, component);
 	}
 
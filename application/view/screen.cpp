@@ -198,6 +198,9 @@ void Screen::onInit(bool quickBoot) {
 }
 
 void Screen::onUpdate() {
+	// Finish resources which have been loaded in the background
+	ResourceManager::update();
+
 	// Update layers
 	layerStack.onUpdate(registry);
 }
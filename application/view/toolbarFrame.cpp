@@ -13,10 +13,10 @@ namespace P3D::Application {
 
 void ToolbarFrame::onInit(Engine::Registry64& registry) {
 	std::string path = "../res/textures/icons/";
-	ResourceManager::add<Graphics::TextureResource>("play", path + "play.png");
-	ResourceManager::add<Graphics::TextureResource>("pause", path + "pause.png");
-	ResourceManager::add<Graphics::TextureResource>("tick", path + "tick.png");
-	ResourceManager::add<Graphics::TextureResource>("reset", path + "reset.png");
+	ResourceManager::addAsync<Graphics::TextureResource>("play", path + "play.png");
+	ResourceManager::addAsync<Graphics::TextureResource>("pause", path + "pause.png");
+	ResourceManager::addAsync<Graphics::TextureResource>("tick", path + "tick.png");
+	ResourceManager::addAsync<Graphics::TextureResource>("reset", path + "reset.png");
 }
 
 void ToolbarFrame::onRender(Engine::Registry64& registry) {
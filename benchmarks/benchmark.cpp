@@ -8,6 +8,8 @@
 
 #include "../util/terminalColor.h"
 #include "../util/parseCPUIDArgs.h"
+#include "../physics/misc/physicsProfiler.h"
+#include "../physics/misc/traceRecorder.h"
 
 std::vector<Benchmark*>* knownBenchmarks = nullptr;
 
@@ -84,10 +86,46 @@ static void runBenchmarks(const std::vector<std::string>& benchmarks) {
 	}
 }
 
+/*
+	--trace <file> writes the physics tick phases of all benchmarks run to file as a Chrome trace
+	Together with --slowTick <ms>, only the latest spans are kept, and they are written to file whenever a tick takes longer than ms
+*/
+static void setupTrace(const Util::ParsedArgs& pa, TraceRecorder& recorder) {
+	std::string traceFile = pa.getOptional("trace");
+	if(traceFile.empty()) return;
+
+	std::string slowTick = pa.getOptional("slowTick");
+	if(!slowTick.empty()) {
+		std::chrono::nanoseconds threshold(static_cast<long long>(std::stod(slowTick) * 1000000.0));
+		recorder.setSlowTickCapture(threshold, traceFile);
+	}
+	setPhysicsTraceRecorder(&recorder);
+}
+
+static void finishTrace(const Util::ParsedArgs& pa, TraceRecorder& recorder) {
+	std::string traceFile = pa.getOptional("trace");
+	if(traceFile.empty()) return;
+
+	setPhysicsTraceRecorder(nullptr);
+	if(pa.getOptional("slowTick").empty()) {
+		if(recorder.saveChromeTrace(traceFile.c_str())) {
+			std::cout << "Trace of " << recorder.getSpanCount() << " spans written to " << traceFile << "\n";
+		} else {
+			std::cout << "Could not write trace to " << traceFile << "\n";
+		}
+	} else {
+		std::cout << recorder.getCaptureCount() << " slow ticks captured, the last one is in " << traceFile << "\n";
+	}
+}
+
 int main(int argc, const char** args) {
 	Util::ParsedArgs pa(argc, args);
 	std::cout << Util::printAndParseCPUIDArgs(pa).c_str() << "\n";
 
+	// a ring buffer when waiting for slow ticks, otherwise the first spans of the run
+	TraceRecorder traceRecorder(1000000, !pa.getOptional("slowTick").empty());
+	setupTrace(pa, traceRecorder);
+
 	if(pa.argCount() >= 1) {
 		runBenchmarks(pa.args());
 	} else {
@@ -114,6 +152,8 @@ int main(int argc, const char** args) {
 
 		runBenchmarks(commands);
 	}
+
+	finishTrace(pa, traceRecorder);
 	
 	return 0;
 }
@@ -1,16 +1,18 @@
 #include "benchmark.h"
 
-#include "../physics/datastructures/boundsTree.h"
+#include "../physics/datastructures/boundsTree2.h"
 #include "../physics/datastructures/boundsTreeOld.h"
 
-using namespace P3D::OldBoundsTree;
+/*
+	The old and new bounds trees are benchmarked side by side on the same data, until the old tree is retired
+*/
 
 #define BENCH_TREE_BRANCH_FACTOR 4
-static void fillTreeNodeRecursive(TreeNode& node, BasicBounded* curItemList, size_t numberOfItems) {
+static void fillTreeNodeRecursive(P3D::OldBoundsTree::TreeNode& node, P3D::OldBoundsTree::BasicBounded* curItemList, size_t numberOfItems) {
 	if(numberOfItems == 1) {
-		node = TreeNode(curItemList, curItemList->getBounds());
+		node = P3D::OldBoundsTree::TreeNode(curItemList, curItemList->getBounds());
 	} else {
-		node = TreeNode::withEmptySubNodes();
+		node = P3D::OldBoundsTree::TreeNode::withEmptySubNodes();
 		node.nodeCount = BENCH_TREE_BRANCH_FACTOR;
 		size_t numberOfItemsForSubNode = numberOfItems / BENCH_TREE_BRANCH_FACTOR;
 		for(int i = 0; i < BENCH_TREE_BRANCH_FACTOR; i++) {
@@ -19,32 +21,141 @@ static void fillTreeNodeRecursive(TreeNode& node, BasicBounded* curItemList, siz
 	}
 }
 
+template<typename BasicBounded>
+static void fillBoundsDiagonal(BasicBounded* objects, size_t count) {
+	Position curPos(0, 0, 0);
+	Vec3Fix delta(0.1, 0.1, 0.1);
+	Vec3Fix diag(0.13, 0.13, 0.13);
+	for(size_t i = 0; i < count; i++) {
+		objects[i].bounds = Bounds(curPos, curPos + diag);
+		curPos += delta;
+	}
+}
+
+// the new tree has no structure improvement yet, so objects are added in a scrambled order to avoid degenerate trees
+static void addAllScrambled(P3D::NewBoundsTree::BoundsTree<P3D::NewBoundsTree::BasicBounded>& tree, P3D::NewBoundsTree::BasicBounded* objects, size_t count) {
+	// count is a power of 2, multiplying by an odd number gives a permutation
+	for(size_t i = 0; i < count; i++) {
+		tree.add(&objects[(i * 2654435761ULL) % count]);
+	}
+}
+
 #define BENCH_TREE_NODECOUNT 1 << 18
+#define BENCH_FILTER_QUERIES 1000
 struct FindInBoundsTreeBenchmark : public Benchmark {
 	FindInBoundsTreeBenchmark() : Benchmark("findInBoundsTree") {}
 
-	BoundsTree<BasicBounded> tree;
-	BasicBounded objects[BENCH_TREE_NODECOUNT];
+	P3D::OldBoundsTree::BoundsTree<P3D::OldBoundsTree::BasicBounded> tree;
+	P3D::OldBoundsTree::BasicBounded objects[BENCH_TREE_NODECOUNT];
 
 	int total = 0;
-	
+
 	virtual void init() override {
-		Position curPos(0, 0, 0);
-		Vec3Fix delta(0.1, 0.1, 0.1);
-		Vec3Fix diag(0.13, 0.13, 0.13);
-		for(BasicBounded& b : objects) {
-			b.bounds = Bounds(curPos, curPos + diag);
-			curPos += delta;
-		}
+		fillBoundsDiagonal(objects, BENCH_TREE_NODECOUNT);
 		fillTreeNodeRecursive(tree.rootNode, objects, BENCH_TREE_NODECOUNT);
 		tree.recalculateBounds();
 	}
 	virtual void run() override {
 		for(int i = 0; i < 100; i++) {
-			for(const BasicBounded& obj : objects) {
-				auto stack = tree.find(&obj, obj.bounds);
-				total += stack.getSize();
+			for(const P3D::OldBoundsTree::BasicBounded& obj : objects) {
+				total += tree.contains(&obj, obj.bounds);
 			}
 		}
 	}
 } boundsTreeBenchmark;
+
+struct FindInBoundsTree2Benchmark : public Benchmark {
+	FindInBoundsTree2Benchmark() : Benchmark("findInBoundsTree2") {}
+
+	P3D::NewBoundsTree::BoundsTree<P3D::NewBoundsTree::BasicBounded> tree;
+	P3D::NewBoundsTree::BasicBounded objects[BENCH_TREE_NODECOUNT];
+
+	int total = 0;
+
+	virtual void init() override {
+		fillBoundsDiagonal(objects, BENCH_TREE_NODECOUNT);
+		addAllScrambled(tree, objects, BENCH_TREE_NODECOUNT);
+	}
+	virtual void run() override {
+		for(int i = 0; i < 100; i++) {
+			for(const P3D::NewBoundsTree::BasicBounded& obj : objects) {
+				total += tree.contains(&obj);
+			}
+		}
+	}
+} boundsTree2Benchmark;
+
+// returns the region queried by the given query index, spread along the diagonal of the filled trees
+static Bounds getFilterQueryRegion(int queryIndex) {
+	double start = (queryIndex * 7919 % BENCH_FILTER_QUERIES) * (0.1 * (BENCH_TREE_NODECOUNT) / BENCH_FILTER_QUERIES);
+	return Bounds(Position(start, start, start), Position(start + 3.0, start + 3.0, start + 3.0));
+}
+
+struct OldTreeRegionFilter {
+	Bounds region;
+
+	bool operator()(const P3D::OldBoundsTree::TreeNode& node) const {
+		return intersects(node.bounds, region);
+	}
+};
+
+struct NewTreeRegionFilter {
+	BoundsTemplate<float> region;
+
+	NewTreeRegionFilter relativeTo(const Position& treeOrigin) const {
+		return NewTreeRegionFilter{P3D::NewBoundsTree::toTreeBounds(region, treeOrigin)};
+	}
+
+	std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> operator()(const P3D::NewBoundsTree::TreeTrunk& trunk, int trunkSize) const {
+		return P3D::NewBoundsTree::filterEachSubNode(trunk, [this](const BoundsTemplate<float>& subNodeBounds) {
+			return intersects(subNodeBounds, region);
+		});
+	}
+};
+
+struct FilterBoundsTreeBenchmark : public Benchmark {
+	FilterBoundsTreeBenchmark() : Benchmark("filterBoundsTree") {}
+
+	P3D::OldBoundsTree::BoundsTree<P3D::OldBoundsTree::BasicBounded> tree;
+	P3D::OldBoundsTree::BasicBounded objects[BENCH_TREE_NODECOUNT];
+
+	size_t total = 0;
+
+	virtual void init() override {
+		fillBoundsDiagonal(objects, BENCH_TREE_NODECOUNT);
+		fillTreeNodeRecursive(tree.rootNode, objects, BENCH_TREE_NODECOUNT);
+		tree.recalculateBounds();
+	}
+	virtual void run() override {
+		for(int i = 0; i < 100; i++) {
+			for(int q = 0; q < BENCH_FILTER_QUERIES; q++) {
+				for(const P3D::OldBoundsTree::BasicBounded& obj : tree.iterFiltered(OldTreeRegionFilter{getFilterQueryRegion(q)})) {
+					total++;
+				}
+			}
+		}
+	}
+} filterBoundsTreeBenchmark;
+
+struct FilterBoundsTree2Benchmark : public Benchmark {
+	FilterBoundsTree2Benchmark() : Benchmark("filterBoundsTree2") {}
+
+	P3D::NewBoundsTree::BoundsTree<P3D::NewBoundsTree::BasicBounded> tree;
+	P3D::NewBoundsTree::BasicBounded objects[BENCH_TREE_NODECOUNT];
+
+	size_t total = 0;
+
+	virtual void init() override {
+		fillBoundsDiagonal(objects, BENCH_TREE_NODECOUNT);
+		addAllScrambled(tree, objects, BENCH_TREE_NODECOUNT);
+	}
+	virtual void run() override {
+		for(int i = 0; i < 100; i++) {
+			for(int q = 0; q < BENCH_FILTER_QUERIES; q++) {
+				tree.forEachFiltered(NewTreeRegionFilter{BoundsTemplate<float>(getFilterQueryRegion(q))}, [this](const P3D::NewBoundsTree::BasicBounded& obj) {
+					total++;
+				});
+			}
+		}
+	}
+} filterBoundsTree2Benchmark;
@@ -0,0 +1,34 @@
+#include "benchmark.h"
+
+#include "../physics/geometry/convexDecomposition.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../physics/threading/threadPool.h"
+#include "../util/log.h"
+
+/*
+	Decomposing a torus into convex pieces at the default resolution, serially and on a thread pool
+*/
+class ConvexDecompositionBenchmark : public Benchmark {
+	bool parallel;
+	Polyhedron torus;
+	std::vector<Polyhedron> hulls;
+	ThreadPool* pool = nullptr;
+public:
+	ConvexDecompositionBenchmark(const char* name, bool parallel) : Benchmark(name), parallel(parallel) {}
+	~ConvexDecompositionBenchmark() { delete pool; }
+
+	virtual void init() override {
+		torus = Library::createTorus(1.0f, 0.3f, 64, 16);
+		if(parallel) pool = new ThreadPool();
+	}
+	virtual void run() override {
+		hulls = parallel ? decomposeConvex(torus, *pool) : decomposeConvex(torus);
+	}
+	virtual void printResults(double timeTaken) override {
+		double volume = 0.0;
+		for(const Polyhedron& hull : hulls) volume += hull.getVolume();
+		Log::print("Decomposed a torus of volume %f into %d pieces of total volume %f\n", torus.getVolume(), int(hulls.size()), volume);
+	}
+};
+ConvexDecompositionBenchmark convexDecompositionBench("convexDecomposition", false);
+ConvexDecompositionBenchmark convexDecompositionParallelBench("convexDecompositionParallel", true);
@@ -0,0 +1,47 @@
+#include "benchmark.h"
+
+#include <random>
+#include <vector>
+
+#include "../physics/geometry/convexHull.h"
+#include "../physics/threading/threadPool.h"
+#include "../util/log.h"
+
+/*
+	The hull of a cloud of 200000 points in a ball, such as the vertices of a large imported mesh.
+	Serially, on a thread pool, and simplified to at most 64 vertices
+*/
+class ConvexHullBenchmark : public Benchmark {
+	bool parallel;
+	int maxVertices;
+	std::vector<Vec3f> points;
+	ConvexHullBuilder builder;
+	ThreadPool* pool = nullptr;
+public:
+	ConvexHullBenchmark(const char* name, bool parallel, int maxVertices) : Benchmark(name), parallel(parallel), maxVertices(maxVertices) {}
+	~ConvexHullBenchmark() { delete pool; }
+
+	virtual void init() override {
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+		while(points.size() < 200000) {
+			Vec3f point(coordinate(random), coordinate(random), coordinate(random));
+			if(lengthSquared(point) <= 1.0f) points.push_back(point);
+		}
+		if(parallel) pool = new ThreadPool();
+	}
+	virtual void run() override {
+		if(parallel) {
+			builder.build(points.data(), points.size(), *pool, maxVertices);
+		} else {
+			builder.build(points.data(), points.size(), maxVertices);
+		}
+	}
+	virtual void printResults(double timeTaken) override {
+		Polyhedron hull = builder.toPolyhedron();
+		Log::print("Hull of %d points has %d vertices and %d triangles, volume %f\n", int(points.size()), hull.vertexCount, hull.triangleCount, hull.getVolume());
+	}
+};
+ConvexHullBenchmark convexHullBench("convexHull", false, 0);
+ConvexHullBenchmark convexHullParallelBench("convexHullParallel", true, 0);
+ConvexHullBenchmark convexHullSimplifiedBench("convexHullSimplified", false, 64);
@@ -0,0 +1,43 @@
+#include "worldBenchmark.h"
+
+#include <limits>
+
+#include "../physics/world.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../physics/geometry/shapeCreation.h"
+
+/*
+	Stacks of detailed discs, colliding with their full shapes, with coarser hulls away from the middle of the stacks,
+	with shallow contacts of the hulls refined, and with a budget of colissions using the full shapes
+*/
+class DetailLevelBenchmark : public WorldBenchmark {
+	double detailDistance;
+	bool refineShallowContacts;
+	size_t fullDetailBudget;
+public:
+	DetailLevelBenchmark(const char* name, double detailDistance, bool refineShallowContacts, size_t fullDetailBudget) :
+		WorldBenchmark(name, 1000), detailDistance(detailDistance), refineShallowContacts(refineShallowContacts), fullDetailBudget(fullDetailBudget) {}
+
+	void init() {
+		createFloor(20, 20, 10);
+
+		world.colissionDetail.focus = Position(0.0, 0.0, 0.0);
+		world.colissionDetail.detailDistance = detailDistance;
+		world.colissionDetail.refineShallowContacts = refineShallowContacts;
+		world.colissionDetail.fullDetailBudget = fullDetailBudget;
+
+		const int detailVertexCounts[]{32, 12};
+		Shape disc = polyhedronShape(Library::createPrism(64, 0.5, 0.5), detailVertexCounts, 2);
+		for(int x = -3; x < 3; x++) {
+			for(int y = 0; y < 6; y++) {
+				for(int z = -3; z < 3; z++) {
+					world.addPart(new Part(disc, GlobalCFrame(x * 1.1, y * 0.55 + 0.75, z * 1.1, Rotation::Predefined::X_90), basicProperties));
+				}
+			}
+		}
+	}
+};
+DetailLevelBenchmark detailLevelFullBench("detailLevelFull", std::numeric_limits<double>::infinity(), false, std::numeric_limits<size_t>::max());
+DetailLevelBenchmark detailLevelDistanceBench("detailLevelDistance", 2.0, false, std::numeric_limits<size_t>::max());
+DetailLevelBenchmark detailLevelRefinedBench("detailLevelRefined", 2.0, true, std::numeric_limits<size_t>::max());
+DetailLevelBenchmark detailLevelBudgetBench("detailLevelBudget", std::numeric_limits<double>::infinity(), false, 50);
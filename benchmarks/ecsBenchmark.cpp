@@ -1,5 +1,8 @@
 #include "benchmark.h"
 #include "../engine/ecs/registry.h"
+#include "../engine/ecs/systemScheduler.h"
+#include "../application/ecs/components.h"
+#include "../physics/threading/threadPool.h"
 #include "../util/log.h"
 
 using namespace P3D::Engine;
@@ -77,6 +80,67 @@ public:
 
 } ecsGetFromViewConjunctionBenchmark;
 
+class ECSEachBenchmark : public Benchmark {
+public:
+	ECSEachBenchmark() : Benchmark("ecsEachBenchmark") {}
+
+	Registry64 registry;
+	int errors = 0;
+
+	struct A { int i; A(int i) : i(i) {} };
+
+	void init() override {
+		int amount = 1000000;
+		for (int i = 0; i < amount; i++) {
+			auto id = registry.create();
+			registry.add<A>(id, i);
+		}
+	}
+
+	void run() override {
+		int i = 0;
+		registry.each<A>([&] (Registry64::entity_type entity, A& comp) {
+			if (comp.i != i)
+				errors++;
+			i++;
+		});
+	}
+
+	void printResults(double timeTaken) override {
+		Log::error("Amount of errors: %d\n", errors);
+	}
+
+} ecsEachBenchmark;
+
+class ECSTransformViewBenchmark : public Benchmark {
+public:
+	ECSTransformViewBenchmark() : Benchmark("ecsTransformViewBenchmark") {}
+
+	Registry64 registry;
+	double checksum = 0.0;
+
+	void init() override {
+		int amount = 1000000;
+		for (int i = 0; i < amount; i++) {
+			auto id = registry.create();
+			registry.add<P3D::Application::Comp::Transform>(id, GlobalCFrame(Position(i, 0.0, 0.0)), 2.0);
+		}
+	}
+
+	void run() override {
+		auto view = registry.view<P3D::Application::Comp::Transform>();
+		for (auto entity : view) {
+			auto transform = view.get<P3D::Application::Comp::Transform>(entity);
+			checksum += transform->getModelMatrix()(0, 3);
+		}
+	}
+
+	void printResults(double timeTaken) override {
+		Log::print("Checksum: %f\n", checksum);
+	}
+
+} ecsTransformViewBenchmark;
+
 /*class ECSGetFromViewDisjunctionBenchmark : public Benchmark {
 public:
 	ECSGetFromViewDisjunctionBenchmark() : Benchmark("ecsGetFromViewDisjunctionBenchmark") {}
@@ -109,4 +173,49 @@ public:
 		Log::error("Amount of errors: %d\n", errors);
 	}
 	
-} ecsGetFromViewDisjunctionBenchmark;*/
\ No newline at end of file
+} ecsGetFromViewDisjunctionBenchmark;*/
+class ECSSchedulerBenchmark : public Benchmark {
+public:
+	ECSSchedulerBenchmark() : Benchmark("ecsSchedulerBenchmark") {}
+
+	struct Transform { float position[3]; float velocity[3]; };
+	struct Material { float color[4]; };
+
+	Registry32 registry;
+	ThreadPool pool;
+	SystemScheduler32 scheduler{registry, pool};
+	int errors = 0;
+
+	void init() override {
+		int amount = 200000;
+		for (int i = 0; i < amount; i++) {
+			auto id = registry.create();
+			registry.add<Transform>(id, Transform { { 0.0f, 0.0f, 0.0f }, { 1.0f, 2.0f, 3.0f } });
+			registry.add<Material>(id, Material { { 0.5f, 0.5f, 0.5f, 1.0f } });
+		}
+
+		// the transform and material systems don't conflict and run together, every page of the pools as its own chunk
+		scheduler.addEachSystem<Transform>("transform", Reads<>{}, Writes<Transform>{}, [] (Registry32::entity_type, Transform& transform) {
+			for (int i = 0; i < 3; i++)
+				transform.position[i] += transform.velocity[i] * 0.01f;
+		});
+		scheduler.addEachSystem<Material>("material", Reads<>{}, Writes<Material>{}, [] (Registry32::entity_type, Material& material) {
+			for (int i = 0; i < 3; i++)
+				material.color[i] = material.color[i] * 0.99f + 0.005f;
+		});
+	}
+
+	void run() override {
+		for (int i = 0; i < 10; i++)
+			scheduler.update();
+	}
+
+	void printResults(double timeTaken) override {
+		registry.each<Transform>([this] (Registry32::entity_type, Transform& transform) {
+			if (transform.position[0] <= 0.0f)
+				errors++;
+		});
+		Log::error("Amount of errors: %d\n", errors);
+	}
+
+} ecsSchedulerBenchmark;
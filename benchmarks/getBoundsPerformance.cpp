@@ -1,8 +1,12 @@
 #include "benchmark.h"
 
 #include "../physics/geometry/polyhedron.h"
+#include "../physics/geometry/shapeCreation.h"
 #include "../physics/misc/shapeLibrary.h"
 #include "../physics/math/linalg/trigonometry.h"
+#include "../physics/part.h"
+
+#include <vector>
 
 class GetBounds : public Benchmark {
 	Polyhedron poly;
@@ -22,5 +26,47 @@ public:
 	}
 } getBounds;
 
+/*
+	The rotated local box bound that Part uses for polyhedra, on the same polyhedron as getBounds
+*/
+class GetConservativeBounds : public Benchmark {
+	Shape shape;
+	double result = 0;
+public:
+	GetConservativeBounds() : Benchmark("getConservativeBounds") {}
 
+	void init() override { this->shape = polyhedronShape(Library::createSphere(1.0, 2)); }
+	void run() override {
+		Rotation r = Rotation::fromEulerAngles(0.1, 0.05, 0.7);
+		for(size_t i = 0; i < 10000000; i++) {
+			BoundingBox b = this->shape.getConservativeBounds(r);
+			result += b.min.x + b.min.y + b.min.z + b.max.x + b.max.y + b.max.z;
+		}
+	}
+} getConservativeBounds;
 
+/*
+	Repeated Part::getBounds calls on parts that don't move, as done by tree refits, filters and layer updates
+*/
+class GetPartBounds : public Benchmark {
+	std::vector<Part> parts;
+	double result = 0;
+public:
+	GetPartBounds() : Benchmark("getPartBounds") {}
+
+	void init() override {
+		Shape shape = polyhedronShape(Library::createSphere(1.0, 2));
+		this->parts.reserve(1000);
+		for(int i = 0; i < 1000; i++) {
+			this->parts.emplace_back(shape, GlobalCFrame(i * 3.0, 0.0, 0.0, Rotation::fromEulerAngles(0.1 * i, 0.05, 0.7)), PartProperties{1.0, 0.7, 0.3});
+		}
+	}
+	void run() override {
+		for(size_t i = 0; i < 10000; i++) {
+			for(const Part& p : this->parts) {
+				Bounds b = p.getBounds();
+				result += static_cast<double>(b.min.x) + static_cast<double>(b.max.z);
+			}
+		}
+	}
+} getPartBounds;
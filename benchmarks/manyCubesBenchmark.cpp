@@ -2,9 +2,13 @@
 #include "../physics/misc/shapeLibrary.h"
 #include "../physics/geometry/shape.h"
 #include "../physics/geometry/shapeCreation.h"
+#include "../physics/geometry/shapeClassRegistry.h"
 #include "worldBenchmark.h"
 #include "../physics/math/linalg/commonMatrices.h"
 #include "../physics/math/linalg/trigonometry.h"
+#include "../util/log.h"
+
+#include <vector>
 
 class ManyCubesBenchmark : public WorldBenchmark {
 public:
@@ -35,3 +39,54 @@ public:
 		}
 	}
 } manyCubesBench;
+
+/*
+	The manyCubes scenario scaled up to MANY_CUBES_LARGE_SIDE^3 cubes, spaced so that their bounds don't overlap at the start
+	Run once with the cubes in a layer using the bounds tree broadphase, and once using the spatial hash broadphase
+*/
+#define MANY_CUBES_LARGE_SIDE 47
+class ManyCubesLargeBenchmark : public WorldBenchmark {
+	BroadphaseType broadphase;
+public:
+	ManyCubesLargeBenchmark(const char* name, BroadphaseType broadphase) : WorldBenchmark(name, 16), broadphase(broadphase) {}
+
+	void init() {
+		createFloor(50, 50, 10);
+
+		int cubeLayer = world.createLayer(true, true, broadphase);
+
+		GlobalCFrame ref(0, 15, 0, Rotation::fromEulerAngles(3.1415 / 4, 3.1415 / 4, 0.0));
+
+		for(int x = 0; x < MANY_CUBES_LARGE_SIDE; x++) {
+			for(int y = 0; y < MANY_CUBES_LARGE_SIDE; y++) {
+				for(int z = 0; z < MANY_CUBES_LARGE_SIDE; z++) {
+					Part* newCube = new Part(polyhedronShape(Library::createBox(1.0, 1.0, 1.0)), ref.localToGlobal(CFrame((x - MANY_CUBES_LARGE_SIDE / 2) * 1.8, y * 1.8, (z - MANY_CUBES_LARGE_SIDE / 2) * 1.8)), {1.0, 0.2, 0.5});
+					world.addPart(newCube, cubeLayer);
+				}
+			}
+		}
+	}
+};
+ManyCubesLargeBenchmark manyCubesLargeTreeBench("manyCubesLarge", BroadphaseType::BOUNDS_TREE);
+ManyCubesLargeBenchmark manyCubesLargeHashBench("manyCubesLargeHash", BroadphaseType::SPATIAL_HASH);
+
+/*
+	Creating the shapes of a million crates of a few sizes, as a large crate world would
+	Crates of all sizes share one shape class
+*/
+class CrateShapesBenchmark : public Benchmark {
+	std::vector<Shape> shapes;
+public:
+	CrateShapesBenchmark() : Benchmark("crateShapes") {}
+
+	virtual void run() override {
+		shapes.clear();
+		shapes.reserve(1000000);
+		for(int i = 0; i < 1000000; i++) {
+			shapes.push_back(polyhedronShape(Library::createBox(1.0f + (i % 4) * 0.5f, 1.0f, 1.0f + (i % 3) * 0.25f)));
+		}
+	}
+	virtual void printResults(double timeTaken) override {
+		Log::print("%d crate shapes, %d registered shape classes\n", int(shapes.size()), int(getShapeClassRegistry().getClassCount()));
+	}
+} crateShapesBench;
@@ -0,0 +1,107 @@
+#include "benchmark.h"
+
+#include "../engine/io/import.h"
+#include "../engine/io/meshCache.h"
+#include "../graphics/visualShape.h"
+#include "../physics/threading/threadPool.h"
+#include "../util/log.h"
+
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+/*
+	Importing a terrain-like grid of quads with uvs and normals, about 20MB of obj text,
+	with the original line by line parser and with the streaming parser, serially and on a thread pool,
+	and loading it from a mesh cache file, including hashing the source text to find the entry
+*/
+#define OBJ_IMPORT_BENCH_SIDE 500
+
+static std::string generateGridObj(int size) {
+	std::ostringstream obj;
+	obj << "# generated grid\no grid\n";
+	for(int y = 0; y <= size; y++) {
+		for(int x = 0; x <= size; x++) {
+			obj << "v " << x * 0.25 << ' ' << (x * y % 13) * 0.0625 << ' ' << -y * 0.25 << '\n';
+			obj << "vt " << x / double(size) << ' ' << y / double(size) << '\n';
+			obj << "vn 0 1 0\n";
+		}
+	}
+
+	for(int y = 0; y < size; y++) {
+		for(int x = 0; x < size; x++) {
+			int a = y * (size + 1) + x + 1;
+			int corners[4] { a, a + 1, a + size + 2, a + size + 1 };
+			obj << 'f';
+			for(int corner : corners) obj << ' ' << corner << '/' << corner << '/' << corner;
+			obj << '\n';
+		}
+	}
+
+	return obj.str();
+}
+
+enum class ObjImportMethod {
+	LINE_BY_LINE,
+	STREAMING,
+	STREAMING_PARALLEL
+};
+
+class ObjImportBenchmark : public Benchmark {
+	ObjImportMethod method;
+	std::string text;
+	int triangleCount = 0;
+	ThreadPool* pool = nullptr;
+public:
+	ObjImportBenchmark(const char* name, ObjImportMethod method) : Benchmark(name), method(method) {}
+	~ObjImportBenchmark() { delete pool; }
+
+	virtual void init() override {
+		text = generateGridObj(OBJ_IMPORT_BENCH_SIDE);
+		if(method == ObjImportMethod::STREAMING_PARALLEL) pool = new ThreadPool();
+	}
+	virtual void run() override {
+		switch(method) {
+		case ObjImportMethod::LINE_BY_LINE: {
+			std::istringstream stream(text);
+			triangleCount = P3D::OBJImport::loadLineByLine(stream).triangleCount;
+			break;
+		}
+		case ObjImportMethod::STREAMING:
+			triangleCount = P3D::OBJImport::parse(text.data(), text.size()).triangleCount;
+			break;
+		case ObjImportMethod::STREAMING_PARALLEL:
+			triangleCount = P3D::OBJImport::parse(text.data(), text.size(), *pool).triangleCount;
+			break;
+		}
+	}
+	virtual void printResults(double timeTaken) override {
+		Log::print("Imported %d triangles from %d bytes, %f MB/s\n", triangleCount, int(text.size()), text.size() / 1000000.0 / (timeTaken / 1000.0));
+	}
+};
+ObjImportBenchmark objImportLineByLineBench("objImportLineByLine", ObjImportMethod::LINE_BY_LINE);
+ObjImportBenchmark objImportStreamingBench("objImportStreaming", ObjImportMethod::STREAMING);
+ObjImportBenchmark objImportParallelBench("objImportParallel", ObjImportMethod::STREAMING_PARALLEL);
+
+class ObjImportCachedBenchmark : public Benchmark {
+	std::string text;
+	std::string cacheFile = "objImportCachedBench.p3dmesh";
+	int triangleCount = 0;
+public:
+	ObjImportCachedBenchmark() : Benchmark("objImportCached") {}
+	~ObjImportCachedBenchmark() { std::remove(cacheFile.c_str()); }
+
+	virtual void init() override {
+		text = generateGridObj(OBJ_IMPORT_BENCH_SIDE);
+		std::uint64_t key = P3D::MeshCache::getKey(text.data(), text.size());
+		P3D::MeshCache::write(cacheFile, key, P3D::MeshCache::create(P3D::OBJImport::parse(text.data(), text.size())));
+	}
+	virtual void run() override {
+		std::uint64_t key = P3D::MeshCache::getKey(text.data(), text.size());
+		P3D::CachedMesh mesh;
+		if(P3D::MeshCache::read(cacheFile, key, mesh)) triangleCount = mesh.shape.triangleCount;
+	}
+	virtual void printResults(double timeTaken) override {
+		Log::print("Loaded %d triangles from the cache of %d bytes of obj text\n", triangleCount, int(text.size()));
+	}
+} objImportCachedBench;
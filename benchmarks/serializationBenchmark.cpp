@@ -0,0 +1,144 @@
+#include "benchmark.h"
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../physics/misc/serialization.h"
+#include "../physics/misc/worldSnapshots.h"
+#include "../physics/physical.h"
+#include "../physics/math/linalg/trigonometry.h"
+#include "../util/log.h"
+
+#include <sstream>
+#include <chrono>
+
+/*
+	Saving and loading a world the size of the manyCubes benchmark, 1000 cubes on a floor, with and without section compression
+*/
+#define SERIALIZATION_BENCH_ITERATIONS 100
+#define SERIALIZATION_BENCH_SIDE 10
+
+static void createManyCubesWorld(WorldPrototype& world) {
+	world.addTerrainPart(new Part(boxShape(100.0, 1.0, 100.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 0.7, 0.5}));
+
+	GlobalCFrame ref(0, 15, 0, Rotation::fromEulerAngles(3.1415 / 4, 3.1415 / 4, 0.0));
+	Shape cube = polyhedronShape(Library::createBox(1.0, 1.0, 1.0));
+	for(int x = 0; x < SERIALIZATION_BENCH_SIDE; x++) {
+		for(int y = 0; y < SERIALIZATION_BENCH_SIDE; y++) {
+			for(int z = 0; z < SERIALIZATION_BENCH_SIDE; z++) {
+				world.addPart(new Part(cube, ref.localToGlobal(CFrame(x * 1.01, y * 1.01, z * 1.01)), {1.0, 0.2, 0.5}));
+			}
+		}
+	}
+}
+
+static void printThroughput(const char* action, size_t fileSize, double timeTakenMillis) {
+	double millisPerIteration = timeTakenMillis / SERIALIZATION_BENCH_ITERATIONS;
+	double megabytesPerSecond = fileSize / 1000000.0 / (millisPerIteration / 1000.0);
+	Log::print("%s %d bytes in %fms, %f MB/s\n", action, int(fileSize), millisPerIteration, megabytesPerSecond);
+}
+
+class SaveWorldBenchmark : public Benchmark {
+	WorldPrototype world;
+	bool compress;
+	size_t fileSize = 0;
+public:
+	SaveWorldBenchmark(const char* name, bool compress) : Benchmark(name), world(0.005), compress(compress) {}
+
+	virtual void init() override {
+		createManyCubesWorld(world);
+	}
+	virtual void run() override {
+		for(int i = 0; i < SERIALIZATION_BENCH_ITERATIONS; i++) {
+			std::stringstream file;
+			SerializationSessionPrototype serializer;
+			serializer.setWorldFileCompression(compress);
+			serializer.serializeWorld(world, file);
+			fileSize = static_cast<size_t>(file.tellp());
+		}
+	}
+	virtual void printResults(double timeTaken) override {
+		printThroughput("Saved", fileSize, timeTaken);
+	}
+};
+SaveWorldBenchmark saveWorldBench("saveWorld", false);
+SaveWorldBenchmark saveWorldCompressedBench("saveWorldCompressed", true);
+
+class LoadWorldBenchmark : public Benchmark {
+	bool compress;
+	std::string fileData;
+	double loadTimeMillis = 0.0;
+public:
+	LoadWorldBenchmark(const char* name, bool compress) : Benchmark(name), compress(compress) {}
+
+	virtual void init() override {
+		WorldPrototype world(0.005);
+		createManyCubesWorld(world);
+		std::stringstream file;
+		SerializationSessionPrototype serializer;
+		serializer.setWorldFileCompression(compress);
+		serializer.serializeWorld(world, file);
+		fileData = file.str();
+		world.clear();
+	}
+	virtual void run() override {
+		for(int i = 0; i < SERIALIZATION_BENCH_ITERATIONS; i++) {
+			WorldPrototype loadedWorld(0.005);
+			auto start = std::chrono::high_resolution_clock::now();
+			DeSerializationSessionPrototype deserializer;
+			deserializer.deserializeWorld(loadedWorld, fileData.data(), fileData.size());
+			auto finish = std::chrono::high_resolution_clock::now();
+			loadTimeMillis += (finish - start).count() / 1000000.0;
+			// deleting the loaded parts is not part of loading
+			loadedWorld.clear();
+		}
+	}
+	virtual void printResults(double timeTaken) override {
+		printThroughput("Loaded", fileData.size(), loadTimeMillis);
+	}
+};
+LoadWorldBenchmark loadWorldBench("loadWorld", false);
+LoadWorldBenchmark loadWorldCompressedBench("loadWorldCompressed", true);
+
+/*
+	Recording a snapshot every tick of SNAPSHOT_BENCH_SIDE^3 free cubes that all change their motion every tick
+	The world isn't ticked, only the snapshots are measured, the cubes' motion is changed by hand in between
+*/
+#define SNAPSHOT_BENCH_SIDE 20
+#define SNAPSHOT_BENCH_TICKS 200
+class SnapshotWorldBenchmark : public Benchmark {
+	WorldPrototype world;
+	WorldSnapshotBuffer snapshots;
+	double recordTimeMillis = 0.0;
+	size_t totalSnapshotSize = 0;
+public:
+	SnapshotWorldBenchmark() : Benchmark("snapshotWorld"), world(0.005), snapshots(64, 16) {}
+
+	virtual void init() override {
+		Shape cube = boxShape(1.0, 1.0, 1.0);
+		for(int x = 0; x < SNAPSHOT_BENCH_SIDE; x++) {
+			for(int y = 0; y < SNAPSHOT_BENCH_SIDE; y++) {
+				for(int z = 0; z < SNAPSHOT_BENCH_SIDE; z++) {
+					world.addPart(new Part(cube, GlobalCFrame(x * 2.0, y * 2.0, z * 2.0), {1.0, 0.2, 0.5}));
+				}
+			}
+		}
+	}
+	virtual void run() override {
+		for(int tick = 0; tick < SNAPSHOT_BENCH_TICKS; tick++) {
+			for(MotorizedPhysical* phys : world.iterPhysicals()) {
+				phys->motionOfCenterOfMass.translation.translation[0] += Vec3(0.0, -0.005, 0.0);
+			}
+			world.age++;
+			auto start = std::chrono::high_resolution_clock::now();
+			snapshots.record(world);
+			auto finish = std::chrono::high_resolution_clock::now();
+			recordTimeMillis += (finish - start).count() / 1000000.0;
+			totalSnapshotSize += snapshots.getSnapshotSize(world.age);
+		}
+	}
+	virtual void printResults(double timeTaken) override {
+		Log::print("Recorded %d physicals in %fms per tick, %d bytes per snapshot\n", int(world.physicals.size()), recordTimeMillis / SNAPSHOT_BENCH_TICKS, int(totalSnapshotSize / SNAPSHOT_BENCH_TICKS));
+	}
+} snapshotWorldBench;
@@ -0,0 +1,62 @@
+#include "worldBenchmark.h"
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "../physics/geometry/shape.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/misc/shapeLibrary.h"
+
+#define TERRAIN_SIZE 129
+#define TERRAIN_CELL_SIZE 0.5
+
+static float getTerrainHeight(int x, int z) {
+	return float(0.8 * std::sin(x * 0.15) * std::cos(z * 0.15));
+}
+
+/*
+	Cubes dropped onto a rolling landscape, once as a single terrain mesh part and once as one terrain part per cell of the landscape
+*/
+class TerrainBenchmark : public WorldBenchmark {
+	bool useMesh;
+public:
+	TerrainBenchmark(const char* name, bool useMesh) : WorldBenchmark(name, 500), useMesh(useMesh) {}
+
+	void init() {
+		double offset = (TERRAIN_SIZE - 1) * TERRAIN_CELL_SIZE / 2;
+
+		if(useMesh) {
+			std::vector<float> heights(TERRAIN_SIZE * TERRAIN_SIZE);
+			for(int z = 0; z < TERRAIN_SIZE; z++) {
+				for(int x = 0; x < TERRAIN_SIZE; x++) {
+					heights[z * TERRAIN_SIZE + x] = getTerrainHeight(x, z);
+				}
+			}
+			Shape terrain = heightfieldShape(heights.data(), TERRAIN_SIZE, TERRAIN_SIZE, TERRAIN_CELL_SIZE);
+			// the shape is centered on its bounds, placing it at the middle of its heights keeps the heights as they are
+			double lowest = heights[0];
+			double highest = heights[0];
+			for(float height : heights) {
+				lowest = std::min(lowest, double(height));
+				highest = std::max(highest, double(height));
+			}
+			world.addTerrainPart(new Part(terrain, GlobalCFrame(0.0, (lowest + highest) / 2, 0.0), basicProperties));
+		} else {
+			for(int z = 0; z < TERRAIN_SIZE - 1; z++) {
+				for(int x = 0; x < TERRAIN_SIZE - 1; x++) {
+					double height = getTerrainHeight(x, z) + 2.0;
+					world.addTerrainPart(new Part(boxShape(TERRAIN_CELL_SIZE, height, TERRAIN_CELL_SIZE), GlobalCFrame((x + 0.5) * TERRAIN_CELL_SIZE - offset, height / 2 - 2.0, (z + 0.5) * TERRAIN_CELL_SIZE - offset), basicProperties));
+				}
+			}
+		}
+
+		for(int x = -5; x < 5; x++) {
+			for(int z = -5; z < 5; z++) {
+				world.addPart(new Part(polyhedronShape(Library::createBox(1.0, 1.0, 1.0)), GlobalCFrame(x * 3.0, 3.0, z * 3.0), basicProperties));
+			}
+		}
+	}
+};
+TerrainBenchmark terrainMeshBench("terrainMesh", true);
+TerrainBenchmark terrainBoxesBench("terrainBoxes", false);
@@ -3,6 +3,9 @@
 #include <set>
 #include <queue>
 #include <vector>
+#include <memory>
+#include <limits>
+#include <new>
 #include <cstdint>
 #include <type_traits>
 #include <unordered_map>
@@ -96,24 +99,241 @@ private:
 public:
 	using entity_set = std::set<representation_type, entity_compare>;
 	using entity_queue = std::queue<entity_type>;
-	using entity_map = std::unordered_map<entity_type, Ref<RefCountable>>;
 	using type_map = std::unordered_map<component_type, std::string>;
-	using component_vector = std::vector<entity_map*>;
+	using entity_vector = std::vector<entity_type>;
 
-	using component_vector_iterator = decltype(std::declval<component_vector>().begin());
-	using component_map_iterator = decltype(std::declval<entity_map>().begin());
 	using entity_set_iterator = decltype(std::declval<entity_set>().begin());
+	using entity_vector_iterator = typename entity_vector::const_iterator;
 
 	// Null entity
 	inline static entity_type null_entity = static_cast<entity_type>(0u);
 
 
+	//-------------------------------------------------------------------------------------//
+	// Component pools                                                                     //
+	//-------------------------------------------------------------------------------------//
+
+public:
+	/**
+	 * A sparse set of entities, maps every entity in it to an index in a dense array, adding, removing and finding entities is O(1)
+	 */
+	class basic_pool {
+	protected:
+		static constexpr std::size_t null_index = std::numeric_limits<std::size_t>::max();
+
+		// indexed by entity, the index of the entity in dense or null_index
+		std::vector<std::size_t> sparse;
+		// the entities in the pool, in the same order as their components
+		entity_vector dense;
+
+		std::size_t index_of(const entity_type& entity) const noexcept {
+			return entity < sparse.size() ? sparse[entity] : null_index;
+		}
+
+	public:
+		virtual ~basic_pool() = default;
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return dense.size();
+		}
+
+		[[nodiscard]] bool contains(const entity_type& entity) const noexcept {
+			return index_of(entity) != null_index;
+		}
+
+		/**
+		 * Returns the entities in the pool, the component of entities()[i] is at index i
+		 */
+		[[nodiscard]] const entity_vector& entities() const noexcept {
+			return dense;
+		}
+
+		/**
+		 * Removes the component of the given entity, returns whether the entity had one
+		 */
+		virtual bool remove(const entity_type& entity) noexcept = 0;
+
+		/**
+		 * Returns the component of the given entity as a RefCountable, nullptr if it has none or if the component type isn't RefCountable
+		 */
+		[[nodiscard]] virtual RefCountable* get_base(const entity_type& entity) noexcept = 0;
+	};
+
+	/**
+	 * Stores the components of one type in a dense array, in pages of page_size components which are contiguous in memory
+	 * Components never move when other components are added, removing a component moves the last component into its place
+	 *
+	 * RefCountable components are allocated on their own and the pages store a Ref to each of them, so only the Refs move.
+	 * A removed or replaced RefCountable component stays alive for as long as Refs returned by the registry still point to it
+	 */
+	template<typename Component>
+	class component_pool : public basic_pool {
+	public:
+		static constexpr std::size_t page_size = 1024;
+
+		static constexpr bool stored_by_ref = std::is_base_of_v<RefCountable, Component>;
+
+	private:
+		using stored_type = std::conditional_t<stored_by_ref, Ref<Component>, Component>;
+
+		struct page {
+			alignas(stored_type) unsigned char data[sizeof(stored_type) * page_size];
+		};
+
+		std::vector<std::unique_ptr<page>> pages;
+
+		stored_type* slot(std::size_t index) const noexcept {
+			return std::launder(reinterpret_cast<stored_type*>(pages[index / page_size]->data)) + index % page_size;
+		}
+
+		static Component* component_of(stored_type* stored) noexcept {
+			if constexpr (stored_by_ref)
+				return stored->get();
+			else
+				return stored;
+		}
+
+		template<typename... Args>
+		Component* construct(std::size_t index, Args&&... args) {
+			if constexpr (stored_by_ref)
+				return (new(slot(index)) stored_type(new Component(std::forward<Args>(args)...)))->get();
+			else
+				return new(slot(index)) stored_type(std::forward<Args>(args)...);
+		}
+
+	public:
+		component_pool() = default;
+		component_pool(const component_pool&) = delete;
+		component_pool& operator=(const component_pool&) = delete;
+
+		~component_pool() {
+			for (std::size_t index = 0; index < this->dense.size(); index++)
+				slot(index)->~stored_type();
+		}
+
+		/**
+		 * Constructs a component for the given entity, replacing its current component if it has one
+		 */
+		template<typename... Args>
+		Component* emplace(const entity_type& entity, Args&&... args) {
+			std::size_t index = this->index_of(entity);
+			if (index != basic_pool::null_index) {
+				slot(index)->~stored_type();
+
+				return construct(index, std::forward<Args>(args)...);
+			}
+
+			index = this->dense.size();
+			if (index == pages.size() * page_size)
+				pages.push_back(std::make_unique<page>());
+			if (entity >= this->sparse.size())
+				this->sparse.resize(static_cast<std::size_t>(entity) + 1, basic_pool::null_index);
+
+			Component* component = construct(index, std::forward<Args>(args)...);
+			this->sparse[entity] = index;
+			this->dense.push_back(entity);
+
+			return component;
+		}
+
+		bool remove(const entity_type& entity) noexcept override {
+			std::size_t index = this->index_of(entity);
+			if (index == basic_pool::null_index)
+				return false;
+
+			std::size_t last = this->dense.size() - 1;
+			slot(index)->~stored_type();
+			if (index != last) {
+				new(slot(index)) stored_type(std::move(*slot(last)));
+				slot(last)->~stored_type();
+
+				entity_type moved = this->dense[last];
+				this->dense[index] = moved;
+				this->sparse[moved] = index;
+			}
+
+			this->dense.pop_back();
+			this->sparse[entity] = basic_pool::null_index;
+
+			return true;
+		}
+
+		/**
+		 * Returns the component of the given entity, nullptr if it has none
+		 */
+		[[nodiscard]] Component* get(const entity_type& entity) const noexcept {
+			std::size_t index = this->index_of(entity);
+			if (index == basic_pool::null_index)
+				return nullptr;
+
+			return component_of(slot(index));
+		}
+
+		[[nodiscard]] RefCountable* get_base(const entity_type& entity) noexcept override {
+			if constexpr (std::is_base_of_v<RefCountable, Component>)
+				return get(entity);
+			else
+				return nullptr;
+		}
+
+		/**
+		 * Returns the component at the given index in the dense array, which belongs to entities()[index]
+		 */
+		[[nodiscard]] Component& at(std::size_t index) const noexcept {
+			return *component_of(slot(index));
+		}
+
+		/**
+		 * The components are contiguous within each page, systems can process a page at a time
+		 */
+		[[nodiscard]] std::size_t page_count() const noexcept {
+			return (this->dense.size() + page_size - 1) / page_size;
+		}
+
+		/**
+		 * Only for components that aren't RefCountable, the pages of RefCountable components hold Refs
+		 */
+		[[nodiscard]] Component* page_data(std::size_t page_index) const noexcept {
+			static_assert(!stored_by_ref, "RefCountable components aren't contiguous, use each_in_page");
+			return slot(page_index * page_size);
+		}
+
+		[[nodiscard]] std::size_t page_length(std::size_t page_index) const noexcept {
+			std::size_t remaining = this->dense.size() - page_index * page_size;
+			return remaining < page_size ? remaining : page_size;
+		}
+
+		/**
+		 * Calls func(entity, component) for every component in the given page
+		 */
+		template<typename Func>
+		void each_in_page(std::size_t page_index, Func&& func) const {
+			const entity_type* entities = this->dense.data() + page_index * page_size;
+			stored_type* stored = slot(page_index * page_size);
+			std::size_t length = page_length(page_index);
+			for (std::size_t i = 0; i < length; i++)
+				func(entities[i], *component_of(stored + i));
+		}
+	};
+
+	/**
+	 * What the registry returns for a component, a Ref for RefCountable components and a plain pointer for other components
+	 */
+	template<typename Component>
+	using component_handle = std::conditional_t<std::is_base_of_v<RefCountable, Component>, Ref<Component>, Component*>;
+
+	using component_vector = std::vector<std::unique_ptr<basic_pool>>;
+	using component_vector_iterator = decltype(std::declval<component_vector>().begin());
+
+
 	//-------------------------------------------------------------------------------------//
 	// Members                                                                             //
 	//-------------------------------------------------------------------------------------//
 
 private:
 	entity_set entities;
+	// indexed by the self id of an entity, the full representation of the entity or 0 if it doesn't exist
+	std::vector<representation_type> entity_lookup;
 	component_vector components;
 	type_map type_mapping;
 
@@ -163,24 +383,27 @@ private:
 		return (static_cast<representation_type>(parent) << traits_type::parent_shift) | static_cast<representation_type>(entity);
 	}
 
+	void set_lookup(const representation_type& entity) {
+		entity_type id = self(entity);
+		if (id >= entity_lookup.size())
+			entity_lookup.resize(static_cast<std::size_t>(id) + 1, static_cast<representation_type>(0u));
 
-	//-------------------------------------------------------------------------------------//
-	// View iterators                                                                      //
-	//-------------------------------------------------------------------------------------//
+		entity_lookup[id] = entity;
+	}
 
-public:
-	struct component_iterator : component_map_iterator {
-	public:
-		component_iterator() = default;
+	/**
+	 * Returns the pool of the given component, nullptr if no component of this type has been added yet
+	 */
+	template<typename Component>
+	component_pool<Component>* find_pool() noexcept {
+		component_type index = getComponentIndex<Component>();
+		if (index >= components.size())
+			return nullptr;
 
-		explicit component_iterator(component_map_iterator&& iterator) : component_map_iterator(std::move(iterator)) {}
+		return static_cast<component_pool<Component>*>(components[index].get());
+	}
 
-		auto& operator*() const {
-			return component_map_iterator::operator*().first;
-		}
-	};
 
-	
 	//-------------------------------------------------------------------------------------//
 	// View types                                                                          //
 	//-------------------------------------------------------------------------------------//
@@ -193,13 +416,8 @@ public:
 	template<typename... Components>
 	struct conjunction {
 		template<typename Component>
-		static Ref<Component> get(Registry<Entity>* registry, const entity_type& entity) {
-			component_type index = registry->getComponentIndex<Component>();
-			entity_map* map = registry->components[index];
-
-			auto component_iterator = map->find(entity);
-
-			return intrusive_cast<Component>(component_iterator->second);
+		static component_handle<Component> get(Registry<Entity>* registry, const entity_type& entity) {
+			return component_handle<Component>(registry->pool<Component>().get(entity));
 		}
 	};
 
@@ -213,11 +431,20 @@ public:
 
 	struct no_type {
 		template<typename Component>
-		static Ref<Component> get(Registry<Entity>* registry, const entity_type& entity) {
+		static component_handle<Component> get(Registry<Entity>* registry, const entity_type& entity) {
 			return registry->get<Component>(entity);
 		}
 	};
 
+private:
+	template<typename Type>
+	struct is_view_type : std::false_type {};
+
+	template<typename... Components>
+	struct is_view_type<conjunction<Components...>> : std::true_type {};
+
+public:
+
 
 	//-------------------------------------------------------------------------------------//
 	// Basic view                                                                          //
@@ -244,7 +471,7 @@ public:
 		}
 
 		template<typename Component>
-		Ref<Component> get(const entity_type& entity) {
+		component_handle<Component> get(const entity_type& entity) {
 			return ViewType::template get<Component>(this->registry, entity);
 		}
 	};
@@ -267,38 +494,21 @@ private:
 	std::enable_if_t<sizeof...(Components) == 0> init() {}
 	
 	template<typename... Components>
-	std::enable_if_t<sizeof...(Components) == 0> extract_smallest_component(component_type& smallest_component, std::size_t& smallest_size, std::vector<component_type>& other_components) {}
+	std::enable_if_t<sizeof...(Components) == 0> extract_smallest_component(basic_pool*& smallest_pool, std::vector<const basic_pool*>& other_pools) {}
 
 	template<typename Component, typename... Components>
-	void extract_smallest_component(component_type& smallest_component, std::size_t& smallest_size, std::vector<component_type>& other_components) noexcept {
-		component_type current_component = getComponentIndex<Component>();
-		const std::size_t current_size = this->components[current_component]->size();
-
-		if (current_size < smallest_size) {
-			other_components.push_back(smallest_component);
-			smallest_component = current_component;
-			smallest_size = current_size;
+	void extract_smallest_component(basic_pool*& smallest_pool, std::vector<const basic_pool*>& other_pools) noexcept {
+		basic_pool* current_pool = &pool<Component>();
+
+		if (current_pool->size() < smallest_pool->size()) {
+			other_pools.push_back(smallest_pool);
+			smallest_pool = current_pool;
 		} else
-			other_components.push_back(current_component);
+			other_pools.push_back(current_pool);
 
-		extract_smallest_component<Components...>(smallest_component, smallest_size, other_components);
+		extract_smallest_component<Components...>(smallest_pool, other_pools);
 	}
 
-	template<typename... Components>
-	std::enable_if_t<sizeof...(Components) == 0> insert_entities(entity_set& entities) {}
-
-	template<typename Component, typename... Components>
-	void insert_entities(entity_set& entities) noexcept {
-		std::size_t component = getComponentIndex<Component>();
-
-		component_iterator first(this->components[component]->begin());
-		component_iterator last(this->components[component]->end());
-
-		entities.insert(first, last);
-
-		insert_entities<Components...>(entities);
-	}
-	
 	template<typename ViewType, typename Iterator, typename Filter>
 	auto filter_view(const Iterator& first, const Iterator& last, const Filter& filter) noexcept {
 		using iterator_type = filter_iterator<Iterator, iterator_end, Filter>;
@@ -369,14 +579,28 @@ public:
 	[[nodiscard]] std::string_view getComponentName() {
 		return type_mapping.at(getComponentIndex<Component>());
 	}
+
+	/**
+	 * Returns the pool which stores all components of the given type, and creates it if needed
+	 */
+	template<typename Component>
+	[[nodiscard]] component_pool<Component>& pool() {
+		component_type index = getComponentIndex<Component>();
+		if (index >= components.size())
+			components.resize(static_cast<std::size_t>(index) + 1);
+
+		if (components[index] == nullptr)
+			components[index] = std::make_unique<component_pool<Component>>();
+
+		return *static_cast<component_pool<Component>*>(components[index].get());
+	}
 	
 	/**
 	 * Initializes the component vector to create an order in the components
 	 */
 	template<typename Component, typename... Components>
 	void init() {
-		component_type index = getComponentIndex<Component>();
-		components.push_back(new entity_map());
+		(void) pool<Component>();
 		init<Components...>();
 	}
 	
@@ -396,6 +620,7 @@ public:
 		}
 
 		entities.insert(id);
+		set_lookup(id);
 
 		return static_cast<entity_type>(id);
 	}
@@ -410,14 +635,12 @@ public:
 		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
 		if (entities_iterator != entities.end()) {
 			entities.erase(entities_iterator);
+			entity_lookup[entity] = static_cast<representation_type>(0u);
 			id_queue.push(entity);
 
-			for (auto map : components) {
-				auto component_iterator = map->find(entity);
-				if (component_iterator != map->end()) {
-					delete component_iterator->second.get(); // TODO fix
-					map->erase(component_iterator);
-				}
+			for (const std::unique_ptr<basic_pool>& pool : components) {
+				if (pool != nullptr)
+					pool->remove(entity);
 			}
 		}
 	}
@@ -426,46 +649,24 @@ public:
 	 * Instantiates a component using the given type and arguments and adds it to the given entity
 	 */
 	template<typename Component, typename... Args>
-	Ref<Component> add(const entity_type& entity, Args&&... args) noexcept {
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
-			return Ref<Component>();
-
-		Ref<Component> component = make_intrusive(new Component(std::forward<Args>(args)...));
-		component_type index = getComponentIndex<Component>();
-
-		while (index >= components.size())
-			components.push_back(new entity_map());
-
-		entity_map* map = components[index];
-		auto result = map->insert(std::make_pair(entity, intrusive_cast<RefCountable>(component)));
-
-		if (!result.second)
-			result.first->second = intrusive_cast<RefCountable>(component);
+	component_handle<Component> add(const entity_type& entity, Args&&... args) noexcept {
+		if (!contains(entity))
+			return component_handle<Component>();
 
-		return component;
+		return component_handle<Component>(pool<Component>().emplace(entity, std::forward<Args>(args)...));
 	}
 
 	/**
 	 * Removes the component with the given component id from the given entity, returns whether the erasure was successful
 	 */
 	bool remove(const entity_type& entity, const component_type& index) noexcept {
-		if (index >= components.size())
+		if (index >= components.size() || components[index] == nullptr)
 			return false;
 		
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
-			return false;
-
-		entity_map* map = components[index];
-		auto component_iterator = map->find(entity);
-		if (component_iterator == map->end())
+		if (!contains(entity))
 			return false;
 
-		map->erase(component_iterator);
-		// Todo check if really destroyed
-		
-		return true;
+		return components[index]->remove(entity);
 	}
 
 
@@ -487,47 +688,31 @@ public:
 	 * Returns the component of the given type from the given entity, nullptr if no such component exists
 	 */
 	template<typename Component>
-	[[nodiscard]] Ref<Component> get(const entity_type& entity) noexcept {
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
-			return Ref<Component>();
-
-		component_type index = getComponentIndex<Component>();
-		if (index >= components.size())
-			return Ref<Component>();
+	[[nodiscard]] component_handle<Component> get(const entity_type& entity) noexcept {
+		if (!contains(entity))
+			return component_handle<Component>();
 
-		entity_map* map = components[index];
-		auto component_iterator = map->find(entity);
-		if (component_iterator == map->end())
-			return Ref<Component>();
+		component_pool<Component>* pool = find_pool<Component>();
+		if (pool == nullptr)
+			return component_handle<Component>();
 
-		return intrusive_cast<Component>(component_iterator->second);
+		return component_handle<Component>(pool->get(entity));
 	}
 
 	/**
 	 * Returns the component of the given type from the given entity, or creates one using the provides arguments and returns it.
 	 */
 	template<typename Component, typename... Args>
-	[[nodiscard]] Ref<Component> getOrAdd(const entity_type& entity, Args&&... args) {
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
-			return Ref<Component>();
-
-		component_type index = getComponentIndex<Component>();
-		while (index >= components.size())
-			components.push_back(new entity_map());
-
-		entity_map* map = components[index];
-		auto component_iterator = map->find(entity);
-		if (component_iterator == map->end()) {
-			Ref<Component> component = make_intrusive(new Component(std::forward<Args>(args)...));
-
-			map->insert(std::make_pair(entity, intrusive_cast<RefCountable>(component)));
+	[[nodiscard]] component_handle<Component> getOrAdd(const entity_type& entity, Args&&... args) {
+		if (!contains(entity))
+			return component_handle<Component>();
 
-			return component;
-		}
+		component_pool<Component>& pool = this->pool<Component>();
+		Component* component = pool.get(entity);
+		if (component == nullptr)
+			component = pool.emplace(entity, std::forward<Args>(args)...);
 
-		return intrusive_cast<Component>(component_iterator->second);
+		return component_handle<Component>(component);
 	}
 
 	/**
@@ -535,7 +720,7 @@ public:
 	 */
 	template<typename Component, typename... Args>
 	[[nodiscard]] Component getOr(const entity_type& entity, Args&&... args) {
-		Ref<Component> result = get<Component>(entity);
+		component_handle<Component> result = get<Component>(entity);
 		if (result == nullptr)
 			return Component(std::forward<Args>(args)...);
 		else
@@ -547,27 +732,18 @@ public:
 	 */
 	template<typename Component>
 	[[nodiscard]] bool has(const entity_type& entity) noexcept {
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
-			return false;
-
-		component_type index = getComponentIndex<Component>();
-		if (index >= components.size())
-			return false;
-
-		entity_map* map = components[index];
-		auto component_iterator = map->find(entity);
-		if (component_iterator == map->end())
+		if (!contains(entity))
 			return false;
 
-		return true;
+		component_pool<Component>* pool = find_pool<Component>();
+		return pool != nullptr && pool->contains(entity);
 	}
 
 	/**
 	 * Returns whether the registry contains the given entity
 	 */
 	[[nodiscard]] bool contains(const entity_type& entity) noexcept {
-		return entities.find(static_cast<representation_type>(entity)) != entities.end();
+		return entity < entity_lookup.size() && entity_lookup[entity] != static_cast<representation_type>(0u);
 	}
 
 
@@ -586,9 +762,8 @@ public:
 	 * Returns the parent of the given entity
 	 */
 	[[nodiscard]] constexpr entity_type getParent(const entity_type& entity) {
-		entity_set_iterator iterator = entities.find(static_cast<representation_type>(entity));
-		if (iterator != entities.end())
-			return parent(*iterator);
+		if (contains(entity))
+			return parent(entity_lookup[entity]);
 
 		return null_entity;
 	}
@@ -616,8 +791,7 @@ public:
 			return false;
 
 		if (parent != null_entity) {
-			auto parent_iterator = entities.find(parent);
-			if (parent_iterator == entities.end())
+			if (!contains(parent))
 				return false;
 		}
 
@@ -626,6 +800,7 @@ public:
 		++hint_iterator;
 		entities.erase(entity_iterator);
 		entities.insert(hint_iterator, newEntity);
+		set_lookup(newEntity);
 
 		return true;
 	}
@@ -665,36 +840,33 @@ public:
 	
 	/**
 	 * Returns an iterator which iterates over all entities having all the given components
+	 * The entities of the smallest pool are iterated, and only checked against the other pools
 	 */
 private:
 	template<typename Component, typename... Components>
 	[[nodiscard]] auto view(type<conjunction<Component, Components...>>) noexcept {
 		static_assert(unique_types<Component, Components...>);
 
-		std::vector<component_type> other_components;
-		other_components.reserve(sizeof...(Components));
-
-		component_type smallest_component = getComponentIndex<Component>();
-		std::size_t smallest_size = this->components[smallest_component]->size();
+		std::vector<const basic_pool*> other_pools;
+		other_pools.reserve(sizeof...(Components));
 
-		extract_smallest_component<Components...>(smallest_component, smallest_size, other_components);
+		basic_pool* smallest_pool = &pool<Component>();
+		extract_smallest_component<Components...>(smallest_pool, other_pools);
 
-		entity_map* map = this->components[smallest_component];
-		component_map_iterator first(map->begin());
-		component_map_iterator last(map->end());
+		entity_vector_iterator first = smallest_pool->entities().begin();
+		entity_vector_iterator last = smallest_pool->entities().end();
 
-		auto filter = [this, other_components] (const component_map_iterator& iterator) {
-			for (component_type component : other_components) {
-				auto component_iterator = this->components[component]->find(iterator->first);
-				if (component_iterator == this->components[component]->end())
+		auto filter = [other_pools] (const entity_vector_iterator& iterator) {
+			for (const basic_pool* pool : other_pools) {
+				if (!pool->contains(*iterator))
 					return false;
 			}
 
 			return true;
 		};
 
-		auto transform = [] (const component_map_iterator& iterator) {
-			return iterator->first;
+		auto transform = [] (const entity_vector_iterator& iterator) {
+			return *iterator;
 		};
 
 		return filter_transform_view<conjunction<Component, Components...>>(first, last, filter, transform);
@@ -725,20 +897,30 @@ public:
 		component_vector_iterator last = components.end();
 
 		auto filter = [entity] (const component_vector_iterator& iterator) {
-			entity_map* map = *iterator;
+			const std::unique_ptr<basic_pool>& pool = *iterator;
 
-			return map->find(entity) != map->end();
+			return pool != nullptr && pool->contains(entity);
 		};
 
 		auto transform = [first, entity] (const component_vector_iterator& iterator) {
-			entity_map* map = *iterator;
-			auto p =  std::make_pair(std::distance(first, iterator), map->at(entity));
+			const std::unique_ptr<basic_pool>& pool = *iterator;
+			auto p = std::make_pair(std::distance(first, iterator), Ref<RefCountable>(pool->get_base(entity)));
 			return p;
 		};
 
 		return filter_transform_view<no_type>(first, last, filter, transform);
 	}
 
+	/**
+	 * Calls func(entity, component) for every component of the given type, in the order of the pool's dense array
+	 */
+	template<typename Component, typename Func>
+	void each(Func&& func) {
+		component_pool<Component>& pool = this->pool<Component>();
+		for (std::size_t page = 0; page < pool.page_count(); page++)
+			pool.each_in_page(page, func);
+	}
+
 	/**
 	 * Returns a view that iterates over all entities which satisfy the given filter 
 	 */
@@ -778,10 +960,10 @@ public:
 	template<typename... Type>
 	[[nodiscard]] auto view() noexcept {
 		if constexpr (sizeof...(Type) == 1)
-			if constexpr (std::is_base_of<RefCountable, Type...>::value)
-				return view(type<conjunction<Type...>>{});
-			else 
+			if constexpr (is_view_type<Type...>::value)
 				return view(type<Type...>{});
+			else 
+				return view(type<conjunction<Type...>>{});
 		else 
 			return view(type<conjunction<Type...>>{});
 		
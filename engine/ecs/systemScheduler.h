@@ -0,0 +1,294 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <exception>
+#include <functional>
+#include <type_traits>
+
+#include "registry.h"
+#include "../../physics/threading/threadPool.h"
+
+namespace P3D::Engine {
+
+/**
+ * The components a system reads
+ */
+template<typename... Components>
+struct Reads {};
+
+/**
+ * The components a system writes, writing a component includes reading it
+ */
+template<typename... Components>
+struct Writes {};
+
+/**
+ * Runs systems over the components of a registry, using a thread pool
+ *
+ * Every system declares the components it reads and writes. Two systems conflict if one of them writes a component the other one reads or writes,
+ * a system runs after all earlier added systems it conflicts with, and together with all other systems whose dependencies are done.
+ * Systems added with addEachSystem are also split into chunks of one pool page, which run in parallel as well
+ *
+ * Systems may only access the components they declared, and may not create or destroy entities or add or remove components,
+ * structural changes have to happen outside of update(). Components should be accessed through their pools rather than through Refs,
+ * the reference counts of RefCountable components aren't thread safe
+ */
+template<typename Entity>
+class SystemScheduler {
+
+	//-------------------------------------------------------------------------------------//
+	// Types                                                                               //
+	//-------------------------------------------------------------------------------------//
+
+public:
+	using registry_type = Registry<Entity>;
+	using entity_type = typename registry_type::entity_type;
+	using component_type = typename registry_type::component_type;
+
+private:
+	struct System {
+		std::string name;
+		std::vector<component_type> reads;
+		std::vector<component_type> writes;
+
+		// the number of chunks the system is split into for this update
+		std::function<std::size_t()> chunkCount;
+		std::function<void(std::size_t)> run;
+	};
+
+	struct Task {
+		const System* system;
+		std::size_t chunk;
+	};
+
+
+	//-------------------------------------------------------------------------------------//
+	// Members                                                                             //
+	//-------------------------------------------------------------------------------------//
+
+private:
+	registry_type& registry;
+	ThreadPool& pool;
+
+	std::vector<System> systems;
+	// the indices of the systems in every stage, the systems of a stage don't conflict with each other
+	std::vector<std::vector<std::size_t>> stages;
+	std::vector<std::size_t> systemStages;
+	bool stagesValid = true;
+
+
+	//-------------------------------------------------------------------------------------//
+	// Helper functions                                                                    //
+	//-------------------------------------------------------------------------------------//
+
+private:
+	template<typename... Components>
+	std::vector<component_type> getIndices() {
+		// pools are created up front, creating them from within a system isn't thread safe
+		((void) registry.template pool<Components>(), ...);
+
+		return std::vector<component_type> { registry.template getComponentIndex<Components>()... };
+	}
+
+	static bool contains(const std::vector<component_type>& components, component_type component) noexcept {
+		for (component_type c : components) {
+			if (c == component)
+				return true;
+		}
+
+		return false;
+	}
+
+	static bool conflicts(const System& first, const System& second) noexcept {
+		for (component_type component : first.writes) {
+			if (contains(second.reads, component) || contains(second.writes, component))
+				return true;
+		}
+
+		for (component_type component : second.writes) {
+			if (contains(first.reads, component))
+				return true;
+		}
+
+		return false;
+	}
+
+	void buildStages() {
+		stages.clear();
+		systemStages.assign(systems.size(), 0);
+
+		for (std::size_t current = 0; current < systems.size(); current++) {
+			std::size_t stage = 0;
+			for (std::size_t earlier = 0; earlier < current; earlier++) {
+				if (systemStages[earlier] >= stage && conflicts(systems[earlier], systems[current]))
+					stage = systemStages[earlier] + 1;
+			}
+
+			systemStages[current] = stage;
+			if (stage >= stages.size())
+				stages.resize(stage + 1);
+			stages[stage].push_back(current);
+		}
+
+		stagesValid = true;
+	}
+
+	std::size_t addSystem(System&& system) {
+		systems.push_back(std::move(system));
+		stagesValid = false;
+
+		return systems.size() - 1;
+	}
+
+	void runStage(const std::vector<std::size_t>& stage) {
+		std::vector<Task> tasks;
+		for (std::size_t systemIndex : stage) {
+			const System& system = systems[systemIndex];
+			std::size_t chunkCount = system.chunkCount();
+			for (std::size_t chunk = 0; chunk < chunkCount; chunk++)
+				tasks.push_back(Task { &system, chunk });
+		}
+
+		if (tasks.size() <= 1) {
+			for (const Task& task : tasks)
+				task.system->run(task.chunk);
+
+			return;
+		}
+
+		std::atomic<std::size_t> nextTask(0);
+		std::exception_ptr firstException;
+		std::mutex exceptionMutex;
+		pool.doInParallel([&] () {
+			while (true) {
+				std::size_t taskIndex = nextTask++;
+				if (taskIndex >= tasks.size())
+					break;
+
+				try {
+					tasks[taskIndex].system->run(tasks[taskIndex].chunk);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(exceptionMutex);
+					if (!firstException)
+						firstException = std::current_exception();
+				}
+			}
+		});
+
+		if (firstException)
+			std::rethrow_exception(firstException);
+	}
+
+
+	//-------------------------------------------------------------------------------------//
+	// Constructor                                                                         //
+	//-------------------------------------------------------------------------------------//
+
+public:
+	SystemScheduler(registry_type& registry, ThreadPool& pool) : registry(registry), pool(pool) {}
+	SystemScheduler(const SystemScheduler&) = delete;
+	SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+
+	//-------------------------------------------------------------------------------------//
+	// Systems                                                                             //
+	//-------------------------------------------------------------------------------------//
+
+public:
+	/**
+	 * Adds a system which is called once per update as func(registry), returns the index of the system
+	 */
+	template<typename... ReadComponents, typename... WriteComponents, typename Func>
+	std::size_t addSystem(std::string name, Reads<ReadComponents...>, Writes<WriteComponents...>, Func&& func) {
+		System system;
+		system.name = std::move(name);
+		system.reads = getIndices<ReadComponents...>();
+		system.writes = getIndices<WriteComponents...>();
+		system.chunkCount = [] () -> std::size_t { return 1; };
+		system.run = [this, func = std::forward<Func>(func)] (std::size_t) { func(registry); };
+
+		return addSystem(std::move(system));
+	}
+
+	/**
+	 * Adds a system which is called as func(entity, component) for every component of the given type, returns the index of the system
+	 * The components are processed in chunks of one page of the pool, which may run on different threads
+	 */
+	template<typename Component, typename... ReadComponents, typename... WriteComponents, typename Func>
+	std::size_t addEachSystem(std::string name, Reads<ReadComponents...>, Writes<WriteComponents...>, Func&& func) {
+		static_assert((std::is_same_v<Component, ReadComponents> || ...) || (std::is_same_v<Component, WriteComponents> || ...),
+			"The iterated component has to be declared as read or written");
+
+		using pool_type = typename registry_type::template component_pool<Component>;
+
+		System system;
+		system.name = std::move(name);
+		system.reads = getIndices<ReadComponents...>();
+		system.writes = getIndices<WriteComponents...>();
+
+		pool_type* componentPool = &registry.template pool<Component>();
+		system.chunkCount = [componentPool] () {
+			return componentPool->page_count();
+		};
+		system.run = [componentPool, func = std::forward<Func>(func)] (std::size_t chunk) {
+			componentPool->each_in_page(chunk, func);
+		};
+
+		return addSystem(std::move(system));
+	}
+
+	/**
+	 * Runs all systems once
+	 */
+	void update() {
+		if (!stagesValid)
+			buildStages();
+
+		for (const std::vector<std::size_t>& stage : stages)
+			runStage(stage);
+	}
+
+
+	//-------------------------------------------------------------------------------------//
+	// Getters                                                                             //
+	//-------------------------------------------------------------------------------------//
+
+public:
+	[[nodiscard]] std::size_t getSystemCount() const noexcept {
+		return systems.size();
+	}
+
+	[[nodiscard]] const std::string& getSystemName(std::size_t system) const noexcept {
+		return systems[system].name;
+	}
+
+	/**
+	 * Returns the number of stages the systems run in, one after another
+	 */
+	[[nodiscard]] std::size_t getStageCount() {
+		if (!stagesValid)
+			buildStages();
+
+		return stages.size();
+	}
+
+	/**
+	 * Returns the stage the given system runs in
+	 */
+	[[nodiscard]] std::size_t getStage(std::size_t system) {
+		if (!stagesValid)
+			buildStages();
+
+		return systemStages[system];
+	}
+};
+
+typedef SystemScheduler<std::uint16_t> SystemScheduler16;
+typedef SystemScheduler<std::uint32_t> SystemScheduler32;
+typedef SystemScheduler<std::uint64_t> SystemScheduler64;
+
+};
@@ -0,0 +1,243 @@
+#include "core.h"
+
+#include "decompositionCache.h"
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+
+#if defined(_MSC_VER) || __GNUC__ >= 8
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+#include "../util/contentHash.h"
+#include "../util/mappedFile.h"
+
+namespace P3D {
+
+/*
+	A cache file is a header, followed by a table with the vertex and triangle count of every hull,
+	the vertices of all hulls and the triangles of all hulls, each starting at a multiple of DECOMPOSITION_CACHE_ALIGNMENT
+	The triangles of a hull index its own vertices
+*/
+static const char DECOMPOSITION_CACHE_MAGIC[8]{'P', '3', 'D', 'H', 'U', 'L', 'L', 'S'};
+static constexpr std::uint32_t DECOMPOSITION_CACHE_VERSION = 1;
+static constexpr std::size_t DECOMPOSITION_CACHE_ALIGNMENT = 64;
+
+// changes whenever decomposeConvex makes different hulls from the same mesh and settings, so entries made by older versions are not used
+static constexpr std::uint64_t DECOMPOSITION_VERSION = 1;
+
+static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec3f must be tightly packed to be stored in a decomposition cache");
+static_assert(sizeof(Triangle) == 3 * sizeof(int), "Triangle must be tightly packed to be stored in a decomposition cache");
+
+struct DecompositionCacheHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t hullCount;
+	std::uint64_t key;
+	std::uint64_t fileSize;
+	std::uint64_t vertexCount;
+	std::uint64_t triangleCount;
+};
+
+struct HullCounts {
+	std::uint32_t vertexCount;
+	std::uint32_t triangleCount;
+};
+
+struct DecompositionCacheLayout {
+	std::size_t countsOffset;
+	std::size_t verticesOffset;
+	std::size_t trianglesOffset;
+	std::size_t fileSize;
+};
+
+static std::size_t alignDecompositionCacheOffset(std::size_t offset) {
+	return (offset + DECOMPOSITION_CACHE_ALIGNMENT - 1) / DECOMPOSITION_CACHE_ALIGNMENT * DECOMPOSITION_CACHE_ALIGNMENT;
+}
+
+static DecompositionCacheLayout getLayout(const DecompositionCacheHeader& header) {
+	DecompositionCacheLayout layout;
+	layout.countsOffset = alignDecompositionCacheOffset(sizeof(DecompositionCacheHeader));
+	layout.verticesOffset = alignDecompositionCacheOffset(layout.countsOffset + header.hullCount * sizeof(HullCounts));
+	layout.trianglesOffset = alignDecompositionCacheOffset(layout.verticesOffset + header.vertexCount * sizeof(Vec3f));
+	layout.fileSize = alignDecompositionCacheOffset(layout.trianglesOffset + header.triangleCount * sizeof(Triangle));
+
+	return layout;
+}
+
+std::uint64_t DecompositionCache::getKey(const TriangleMesh& mesh, const ConvexDecompositionSettings& settings) {
+	// the settings are hashed field by field, the padding of the struct is undefined
+	double settingValues[4]{static_cast<double>(settings.resolution), static_cast<double>(settings.maxPieces), settings.maxConcavity, static_cast<double>(settings.planesPerAxis)};
+
+	std::vector<Vec3f> vertices(mesh.vertexCount);
+	std::vector<Triangle> triangles(mesh.triangleCount);
+	mesh.getVertices(vertices.data());
+	mesh.getTriangles(triangles.data());
+
+	std::uint64_t key = Util::contentHash(settingValues, sizeof(settingValues), DECOMPOSITION_VERSION);
+	key = Util::contentHash(vertices.data(), vertices.size() * sizeof(Vec3f), key);
+	key = Util::contentHash(triangles.data(), triangles.size() * sizeof(Triangle), key);
+
+	return key;
+}
+
+std::string DecompositionCache::getFileName(const std::string& cacheDirectory, std::uint64_t key) {
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.p3dhulls", static_cast<unsigned long long>(key));
+
+	return (fs::path(cacheDirectory) / name).string();
+}
+
+static void writeDecompositionCacheArray(std::ostream& output, std::size_t& position, std::size_t offset, const void* data, std::size_t size) {
+	static const char padding[DECOMPOSITION_CACHE_ALIGNMENT] {};
+	output.write(padding, offset - position);
+	output.write(static_cast<const char*>(data), size);
+	position = offset + size;
+}
+
+bool DecompositionCache::write(const std::string& file, std::uint64_t key, const std::vector<Polyhedron>& hulls) {
+	std::vector<HullCounts> counts;
+	std::vector<Vec3f> vertices;
+	std::vector<Triangle> triangles;
+	for (const Polyhedron& hull : hulls) {
+		counts.push_back(HullCounts { static_cast<std::uint32_t>(hull.vertexCount), static_cast<std::uint32_t>(hull.triangleCount) });
+
+		std::size_t firstVertex = vertices.size();
+		std::size_t firstTriangle = triangles.size();
+		vertices.resize(firstVertex + hull.vertexCount);
+		triangles.resize(firstTriangle + hull.triangleCount);
+		hull.getVertices(vertices.data() + firstVertex);
+		hull.getTriangles(triangles.data() + firstTriangle);
+	}
+
+	DecompositionCacheHeader header;
+	std::memcpy(header.magic, DECOMPOSITION_CACHE_MAGIC, sizeof(header.magic));
+	header.version = DECOMPOSITION_CACHE_VERSION;
+	header.hullCount = static_cast<std::uint32_t>(hulls.size());
+	header.key = key;
+	header.vertexCount = vertices.size();
+	header.triangleCount = triangles.size();
+
+	DecompositionCacheLayout layout = getLayout(header);
+	header.fileSize = layout.fileSize;
+
+	fs::path path(file);
+	std::error_code error;
+	if (path.has_parent_path())
+		fs::create_directories(path.parent_path(), error);
+
+	std::string temporaryFile = file + ".tmp";
+	{
+		std::ofstream output(temporaryFile, std::ios::binary | std::ios::trunc);
+		if (!output)
+			return false;
+
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		std::size_t position = sizeof(header);
+		writeDecompositionCacheArray(output, position, layout.countsOffset, counts.data(), counts.size() * sizeof(HullCounts));
+		writeDecompositionCacheArray(output, position, layout.verticesOffset, vertices.data(), vertices.size() * sizeof(Vec3f));
+		writeDecompositionCacheArray(output, position, layout.trianglesOffset, triangles.data(), triangles.size() * sizeof(Triangle));
+		writeDecompositionCacheArray(output, position, layout.fileSize, nullptr, 0);
+
+		if (!output) {
+			output.close();
+			fs::remove(temporaryFile, error);
+			return false;
+		}
+	}
+
+	fs::rename(temporaryFile, file, error);
+	if (error) {
+		fs::remove(temporaryFile, error);
+		return false;
+	}
+
+	return true;
+}
+
+bool DecompositionCache::read(const char* data, std::size_t size, std::uint64_t key, std::vector<Polyhedron>& result) {
+	if (size < sizeof(DecompositionCacheHeader))
+		return false;
+
+	DecompositionCacheHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, DECOMPOSITION_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != DECOMPOSITION_CACHE_VERSION || header.key != key)
+		return false;
+
+	// checked before computing the layout, so huge counts in a damaged header can't overflow it
+	if (header.fileSize != size || header.vertexCount > size / sizeof(Vec3f) || header.triangleCount > size / sizeof(Triangle) || header.hullCount > size / sizeof(HullCounts))
+		return false;
+
+	DecompositionCacheLayout layout = getLayout(header);
+	if (layout.fileSize != size)
+		return false;
+
+	const HullCounts* counts = reinterpret_cast<const HullCounts*>(data + layout.countsOffset);
+	std::uint64_t totalVertices = 0;
+	std::uint64_t totalTriangles = 0;
+	for (std::uint32_t i = 0; i < header.hullCount; i++) {
+		totalVertices += counts[i].vertexCount;
+		totalTriangles += counts[i].triangleCount;
+	}
+	if (totalVertices != header.vertexCount || totalTriangles != header.triangleCount)
+		return false;
+
+	const Vec3f* vertices = reinterpret_cast<const Vec3f*>(data + layout.verticesOffset);
+	const Triangle* triangles = reinterpret_cast<const Triangle*>(data + layout.trianglesOffset);
+
+	// Indices are checked, so a damaged file can't make a hull read out of bounds
+	for (std::uint32_t i = 0; i < header.hullCount; i++) {
+		const Triangle* hullTriangles = triangles;
+		for (std::uint32_t t = 0; t < counts[i].triangleCount; t++) {
+			for (int j = 0; j < 3; j++) {
+				if (static_cast<std::uint32_t>(hullTriangles[t][j]) >= counts[i].vertexCount)
+					return false;
+			}
+		}
+		triangles += counts[i].triangleCount;
+	}
+
+	triangles = reinterpret_cast<const Triangle*>(data + layout.trianglesOffset);
+	result.clear();
+	result.reserve(header.hullCount);
+	for (std::uint32_t i = 0; i < header.hullCount; i++) {
+		result.emplace_back(vertices, triangles, static_cast<int>(counts[i].vertexCount), static_cast<int>(counts[i].triangleCount));
+		vertices += counts[i].vertexCount;
+		triangles += counts[i].triangleCount;
+	}
+
+	return true;
+}
+
+bool DecompositionCache::read(const std::string& file, std::uint64_t key, std::vector<Polyhedron>& result) {
+	Util::MappedFile mappedFile(file);
+	if (!mappedFile.isOpen())
+		return false;
+
+	return DecompositionCache::read(mappedFile.getData(), mappedFile.getSize(), key, result);
+}
+
+std::vector<Polyhedron> DecompositionCache::load(const TriangleMesh& mesh, const std::string& cacheDirectory, ThreadPool& pool, const ConvexDecompositionSettings& settings) {
+	if (cacheDirectory.empty())
+		return decomposeConvex(mesh, pool, settings);
+
+	std::uint64_t key = DecompositionCache::getKey(mesh, settings);
+	std::string cacheFile = DecompositionCache::getFileName(cacheDirectory, key);
+
+	std::vector<Polyhedron> hulls;
+	if (DecompositionCache::read(cacheFile, key, hulls))
+		return hulls;
+
+	hulls = decomposeConvex(mesh, pool, settings);
+	if (!hulls.empty() && !DecompositionCache::write(cacheFile, key, hulls))
+		Log::warn("Could not write decomposition cache file %s", cacheFile.c_str());
+
+	return hulls;
+}
+
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../../physics/geometry/polyhedron.h"
+#include "../../physics/geometry/convexDecomposition.h"
+
+class ThreadPool;
+
+namespace P3D {
+
+/*
+	An on disk cache of convex decompositions, as decomposing a detailed mesh takes much longer than loading it
+
+	Entries are keyed by a hash of the vertices and triangles of the mesh and of the decomposition settings,
+	so changing either the mesh or the settings makes a new entry
+*/
+namespace DecompositionCache {
+	std::uint64_t getKey(const TriangleMesh& mesh, const ConvexDecompositionSettings& settings);
+	std::string getFileName(const std::string& cacheDirectory, std::uint64_t key);
+
+	// writes to a temporary file first, so readers never see a partially written entry. Returns false if the file could not be written
+	bool write(const std::string& file, std::uint64_t key, const std::vector<Polyhedron>& hulls);
+	// Returns false if the file does not exist, is not a decomposition cache file of the current version, is damaged, or has a different key
+	bool read(const std::string& file, std::uint64_t key, std::vector<Polyhedron>& result);
+	bool read(const char* data, std::size_t size, std::uint64_t key, std::vector<Polyhedron>& result);
+
+	/*
+		Loads the decomposition of the mesh from the cache in cacheDirectory, or decomposes it on the pool and adds it to the cache
+		Nothing is cached if cacheDirectory is empty
+	*/
+	std::vector<Polyhedron> load(const TriangleMesh& mesh, const std::string& cacheDirectory, ThreadPool& pool, const ConvexDecompositionSettings& settings = ConvexDecompositionSettings());
+};
+
+};
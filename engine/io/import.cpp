@@ -3,8 +3,14 @@
 #include "import.h"
 
 #include <fstream>
+#include <sstream>
+#include <charconv>
+#include <cstring>
+#include <atomic>
 
 #include "../util/stringUtil.h"
+#include "../util/mappedFile.h"
+#include "../physics/threading/threadPool.h"
 #include "../physics/physical.h"
 #include "../graphics/visualShape.h"
 
@@ -314,7 +320,7 @@ Graphics::VisualShape loadBinaryObj(std::istream& input) {
 	return Graphics::VisualShape(vertices, vertexCount, triangles, triangleCount, SharedArrayPtr<const Vec3f>(normals), SharedArrayPtr<const Vec2f>(uvs), SharedArrayPtr<const Vec3f>(tangents), SharedArrayPtr<const Vec3f>(bitangents));
 }
 
-Graphics::VisualShape loadNonBinaryObj(std::istream& input) {
+Graphics::VisualShape OBJImport::loadLineByLine(std::istream& input) {
 	std::vector<Vec3f> vertices;
 	std::vector<Vec3f> normals;
 	std::vector<Vec2f> uvs;
@@ -358,48 +364,473 @@ Graphics::VisualShape loadNonBinaryObj(std::istream& input) {
 	return reorder(vertices, normals, uvs, faces, flags);
 }
 
+/*
+	Streaming obj parser
+
+	The text is split into chunks at line boundaries, which are parsed independently without allocating per line or per token.
+	Relative indices are kept relative to their chunk until the chunks are merged,
+	after which the face corners are deduplicated into vertices with a unique position, uv and normal
+*/
+
+// files smaller than this are parsed on a single thread, and parallel parsing never makes chunks smaller than this
+#define OBJ_MIN_CHUNK_SIZE (1 << 16)
+
+struct ObjCorner {
+	enum : std::uint8_t {
+		RELATIVE_POSITION = 1,
+		RELATIVE_UV = 2,
+		RELATIVE_NORMAL = 4
+	};
+
+	// 0 based, -1 if the corner has no uv or normal
+	int position;
+	int uv;
+	int normal;
+	// the indices which count from the start of the chunk rather than the start of the file
+	std::uint8_t relative;
+};
+
+struct ObjChunk {
+	std::vector<Vec3f> positions;
+	std::vector<Vec3f> normals;
+	std::vector<Vec2f> uvs;
+	// three corners for every triangle
+	std::vector<ObjCorner> corners;
+	const char* error = nullptr;
+};
+
+static inline bool isObjSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* skipObjSpaces(const char* cur, const char* end) {
+	while (cur != end && isObjSpace(*cur))
+		cur++;
+
+	return cur;
+}
+
+static bool parseObjFloat(const char*& cur, const char* end, float& value) {
+	cur = skipObjSpaces(cur, end);
+	if (cur != end && *cur == '+')
+		cur++;
+
+	std::from_chars_result result = std::from_chars(cur, end, value);
+	if (result.ec == std::errc::result_out_of_range) {
+		// denormals and values too large for a float are parsed as a double and rounded
+		double wideValue;
+		result = std::from_chars(cur, end, wideValue);
+		value = static_cast<float>(wideValue);
+	}
+
+	if (result.ec != std::errc())
+		return false;
+
+	cur = result.ptr;
+	return true;
+}
+
+static bool parseObjIndex(const char*& cur, const char* end, std::size_t count, int& index, bool& relative) {
+	int value;
+	std::from_chars_result result = std::from_chars(cur, end, value);
+	if (result.ec != std::errc() || value == 0)
+		return false;
+
+	cur = result.ptr;
+	relative = value < 0;
+	index = relative ? static_cast<int>(count) + value : value - 1;
+
+	return true;
+}
+
+static bool parseObjCorner(const char*& cur, const char* end, const ObjChunk& chunk, ObjCorner& corner) {
+	corner = ObjCorner { -1, -1, -1, 0 };
+	bool relative;
+
+	// Position
+	if (!parseObjIndex(cur, end, chunk.positions.size(), corner.position, relative))
+		return false;
+	if (relative)
+		corner.relative |= ObjCorner::RELATIVE_POSITION;
+	if (cur == end || *cur != '/')
+		return true;
+	cur++;
+
+	// Uv, left out in p//n
+	if (cur != end && *cur != '/') {
+		if (!parseObjIndex(cur, end, chunk.uvs.size(), corner.uv, relative))
+			return false;
+		if (relative)
+			corner.relative |= ObjCorner::RELATIVE_UV;
+	}
+	if (cur == end || *cur != '/')
+		return true;
+	cur++;
+
+	// Normal
+	if (cur == end || isObjSpace(*cur))
+		return true;
+	if (!parseObjIndex(cur, end, chunk.normals.size(), corner.normal, relative))
+		return false;
+	if (relative)
+		corner.relative |= ObjCorner::RELATIVE_NORMAL;
+
+	return true;
+}
+
+static void parseObjFace(const char* cur, const char* end, ObjChunk& chunk) {
+	ObjCorner first;
+	ObjCorner previous;
+	ObjCorner corner;
+	int cornerCount = 0;
+
+	while (true) {
+		cur = skipObjSpaces(cur, end);
+		if (cur == end || *cur == '#')
+			break;
+
+		if (!parseObjCorner(cur, end, chunk, corner)) {
+			chunk.error = "invalid face";
+			return;
+		}
+
+		// Polygons are split into a fan of triangles
+		if (cornerCount == 0) {
+			first = corner;
+		} else if (cornerCount >= 2) {
+			chunk.corners.push_back(first);
+			chunk.corners.push_back(previous);
+			chunk.corners.push_back(corner);
+		}
+
+		previous = corner;
+		cornerCount++;
+	}
+
+	if (cornerCount < 3)
+		chunk.error = "face with less than three corners";
+}
+
+static void parseObjChunk(const char* cur, const char* end, ObjChunk& chunk) {
+	while (cur != end) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(cur, '\n', end - cur));
+		if (lineEnd == nullptr)
+			lineEnd = end;
+
+		const char* line = skipObjSpaces(cur, lineEnd);
+		cur = lineEnd == end ? end : lineEnd + 1;
+
+		if (lineEnd - line < 2)
+			continue;
+
+		if (line[0] == 'v' && isObjSpace(line[1])) {
+			const char* token = line + 1;
+			Vec3f position;
+			if (!parseObjFloat(token, lineEnd, position.x) || !parseObjFloat(token, lineEnd, position.y) || !parseObjFloat(token, lineEnd, position.z)) {
+				chunk.error = "invalid vertex position";
+				return;
+			}
+
+			chunk.positions.push_back(position);
+		} else if (line[0] == 'f' && isObjSpace(line[1])) {
+			parseObjFace(line + 1, lineEnd, chunk);
+			if (chunk.error != nullptr)
+				return;
+		} else if (line[0] == 'v' && line[1] == 't' && lineEnd - line > 2 && isObjSpace(line[2])) {
+			const char* token = line + 2;
+			Vec2f uv;
+			if (!parseObjFloat(token, lineEnd, uv.x) || !parseObjFloat(token, lineEnd, uv.y)) {
+				chunk.error = "invalid vertex uv";
+				return;
+			}
+
+			chunk.uvs.push_back(uv);
+		} else if (line[0] == 'v' && line[1] == 'n' && lineEnd - line > 2 && isObjSpace(line[2])) {
+			const char* token = line + 2;
+			Vec3f normal;
+			if (!parseObjFloat(token, lineEnd, normal.x) || !parseObjFloat(token, lineEnd, normal.y) || !parseObjFloat(token, lineEnd, normal.z)) {
+				chunk.error = "invalid vertex normal";
+				return;
+			}
+
+			chunk.normals.push_back(normal);
+		}
+	}
+}
+
+static bool resolveObjIndex(int& index, bool relative, int base, std::size_t count, bool optional) {
+	if (optional && index == -1 && !relative)
+		return true;
+
+	if (relative)
+		index += base;
+
+	return index >= 0 && static_cast<std::size_t>(index) < count;
+}
+
+static void computeTangents(const Vec3f& p1, const Vec3f& p2, const Vec3f& p3, const Vec2f& uv1, const Vec2f& uv2, const Vec2f& uv3, Vec3f& tangent, Vec3f& bitangent) {
+	Vec3f edge1 = p2 - p1;
+	Vec3f edge2 = p3 - p1;
+	Vec2f dUV1 = uv2 - uv1;
+	Vec2f dUV2 = uv3 - uv1;
+
+	float f = 1.0f / (dUV1.x * dUV2.y - dUV2.x * dUV1.y);
+
+	tangent.x = f * (dUV2.y * edge1.x - dUV1.y * edge2.x);
+	tangent.y = f * (dUV2.y * edge1.y - dUV1.y * edge2.y);
+	tangent.z = f * (dUV2.y * edge1.z - dUV1.y * edge2.z);
+	tangent = normalize(tangent);
+
+	bitangent.x = f * (-dUV2.x * edge1.x + dUV1.x * edge2.x);
+	bitangent.y = f * (-dUV2.x * edge1.y + dUV1.x * edge2.y);
+	bitangent.z = f * (-dUV2.x * edge1.z + dUV1.x * edge2.z);
+	bitangent = normalize(bitangent);
+}
+
+static Graphics::VisualShape buildObjShape(std::vector<ObjChunk>& chunks) {
+	std::size_t positionCount = 0;
+	std::size_t normalCount = 0;
+	std::size_t uvCount = 0;
+	std::size_t cornerCount = 0;
+	for (const ObjChunk& chunk : chunks) {
+		if (chunk.error != nullptr) {
+			Log::error("Could not parse obj file: %s", chunk.error);
+			return Graphics::VisualShape();
+		}
+
+		positionCount += chunk.positions.size();
+		normalCount += chunk.normals.size();
+		uvCount += chunk.uvs.size();
+		cornerCount += chunk.corners.size();
+	}
+
+	// Merge the attributes of all chunks, and resolve the corners against them
+	std::vector<Vec3f> positions;
+	std::vector<Vec3f> normals;
+	std::vector<Vec2f> uvs;
+	positions.reserve(positionCount);
+	normals.reserve(normalCount);
+	uvs.reserve(uvCount);
+
+	for (ObjChunk& chunk : chunks) {
+		int positionBase = static_cast<int>(positions.size());
+		int normalBase = static_cast<int>(normals.size());
+		int uvBase = static_cast<int>(uvs.size());
+
+		for (ObjCorner& corner : chunk.corners) {
+			if (!resolveObjIndex(corner.position, corner.relative & ObjCorner::RELATIVE_POSITION, positionBase, positionCount, false) ||
+				!resolveObjIndex(corner.uv, corner.relative & ObjCorner::RELATIVE_UV, uvBase, uvCount, true) ||
+				!resolveObjIndex(corner.normal, corner.relative & ObjCorner::RELATIVE_NORMAL, normalBase, normalCount, true)) {
+				Log::error("Could not parse obj file: face index out of range");
+				return Graphics::VisualShape();
+			}
+		}
+
+		positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+		normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+		uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+		chunk.positions = std::vector<Vec3f>();
+		chunk.normals = std::vector<Vec3f>();
+		chunk.uvs = std::vector<Vec2f>();
+	}
+
+	bool hasNormals = normalCount > 0;
+	bool hasUvs = uvCount > 0;
+	int triangleCount = static_cast<int>(cornerCount / 3);
+	Triangle* triangleArray = new Triangle[triangleCount];
+
+	// Vertices
+	std::vector<ObjCorner> vertices;
+	if (!hasNormals && !hasUvs) {
+		// Every position is a vertex
+		std::size_t corner = 0;
+		for (const ObjChunk& chunk : chunks) {
+			for (const ObjCorner& objCorner : chunk.corners) {
+				triangleArray[corner / 3][corner % 3] = objCorner.position;
+				corner++;
+			}
+		}
+	} else {
+		// Corners are deduplicated by their uv and normal among the vertices made from the same position
+		std::vector<int> firstVertex(positionCount, -1);
+		std::vector<int> nextVertex;
+		vertices.reserve(positionCount);
+		nextVertex.reserve(positionCount);
+
+		std::size_t corner = 0;
+		for (const ObjChunk& chunk : chunks) {
+			for (const ObjCorner& objCorner : chunk.corners) {
+				int vertex = firstVertex[objCorner.position];
+				while (vertex != -1 && (vertices[vertex].uv != objCorner.uv || vertices[vertex].normal != objCorner.normal))
+					vertex = nextVertex[vertex];
+
+				if (vertex == -1) {
+					vertex = static_cast<int>(vertices.size());
+					vertices.push_back(objCorner);
+					nextVertex.push_back(firstVertex[objCorner.position]);
+					firstVertex[objCorner.position] = vertex;
+				}
+
+				triangleArray[corner / 3][corner % 3] = vertex;
+				corner++;
+			}
+		}
+	}
+	chunks.clear();
+
+	int vertexCount = static_cast<int>(vertices.empty() ? positionCount : vertices.size());
+	Vec3f* positionArray = new Vec3f[vertexCount];
+	Vec3f* normalArray = hasNormals ? new Vec3f[vertexCount] : nullptr;
+	Vec2f* uvArray = nullptr;
+	Vec3f* tangentArray = nullptr;
+	Vec3f* bitangentArray = nullptr;
+	if (hasUvs) {
+		uvArray = new Vec2f[vertexCount];
+		tangentArray = new Vec3f[vertexCount];
+		bitangentArray = new Vec3f[vertexCount];
+	}
+
+	if (vertices.empty()) {
+		std::copy(positions.begin(), positions.end(), positionArray);
+	} else {
+		for (int i = 0; i < vertexCount; i++) {
+			const ObjCorner& vertex = vertices[i];
+			positionArray[i] = positions[vertex.position];
+
+			if (hasNormals && vertex.normal != -1)
+				normalArray[i] = normals[vertex.normal];
+
+			if (hasUvs && vertex.uv != -1)
+				uvArray[i] = Vec2f(uvs[vertex.uv].x, 1.0f - uvs[vertex.uv].y);
+		}
+	}
+
+	// Tangents, from the uvs as they are in the file
+	if (hasUvs) {
+		for (int i = 0; i < triangleCount; i++) {
+			const Triangle& triangle = triangleArray[i];
+			const ObjCorner& v1 = vertices[triangle.firstIndex];
+			const ObjCorner& v2 = vertices[triangle.secondIndex];
+			const ObjCorner& v3 = vertices[triangle.thirdIndex];
+			if (v1.uv == -1 || v2.uv == -1 || v3.uv == -1)
+				continue;
+
+			Vec3f tangent;
+			Vec3f bitangent;
+			computeTangents(positions[v1.position], positions[v2.position], positions[v3.position], uvs[v1.uv], uvs[v2.uv], uvs[v3.uv], tangent, bitangent);
+
+			for (int j = 0; j < 3; j++) {
+				tangentArray[triangle[j]] = tangent;
+				bitangentArray[triangle[j]] = bitangent;
+			}
+		}
+	}
+
+	return Graphics::VisualShape(positionArray, vertexCount, triangleArray, triangleCount, SharedArrayPtr<const Vec3f>(normalArray), SharedArrayPtr<const Vec2f>(uvArray), SharedArrayPtr<const Vec3f>(tangentArray), SharedArrayPtr<const Vec3f>(bitangentArray));
+}
+
+Graphics::VisualShape OBJImport::parse(const char* data, std::size_t size) {
+	std::vector<ObjChunk> chunks(1);
+	parseObjChunk(data, data + size, chunks[0]);
+
+	return buildObjShape(chunks);
+}
+
+Graphics::VisualShape OBJImport::parse(const char* data, std::size_t size, ThreadPool& pool) {
+	std::size_t chunkCount = std::min(pool.getThreadCount() * 4, size / OBJ_MIN_CHUNK_SIZE);
+	if (chunkCount <= 1)
+		return parse(data, size);
+
+	// Chunks start at the beginning of a line
+	const char* end = data + size;
+	std::vector<const char*> chunkStarts(chunkCount + 1);
+	chunkStarts[0] = data;
+	chunkStarts[chunkCount] = end;
+	for (std::size_t i = 1; i < chunkCount; i++) {
+		const char* start = std::max(data + size / chunkCount * i, chunkStarts[i - 1]);
+		const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - start));
+		chunkStarts[i] = newline == nullptr ? end : newline + 1;
+	}
+
+	std::vector<ObjChunk> chunks(chunkCount);
+	std::atomic<std::size_t> nextChunk(0);
+	pool.doInParallel([&] () {
+		for (std::size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+			parseObjChunk(chunkStarts[chunk], chunkStarts[chunk + 1], chunks[chunk]);
+	});
+
+	return buildObjShape(chunks);
+}
+
 Graphics::VisualShape OBJImport::load(std::istream& file, bool binary) {
 	if (binary)
 		return loadBinaryObj(file);
-	else
-		return loadNonBinaryObj(file);
+
+	std::ostringstream text;
+	text << file.rdbuf();
+	std::string data = text.str();
+
+	return OBJImport::parse(data.data(), data.size());
 }
 
-Graphics::VisualShape OBJImport::load(const std::string& file) {
-	bool binary;
+static bool detectObjFormat(const std::string& file, bool& binary) {
 	if (Util::endsWith(file, ".bobj"))
 		binary = true;
 	else if (Util::endsWith(file, ".obj"))
 		binary = false;
 	else
-		return Graphics::VisualShape();
+		return false;
 
-	return OBJImport::load(file, binary);
+	return true;
 }
 
-Graphics::VisualShape OBJImport::load(const std::string& file, bool binary) {
-	/*struct stat buffer;
-	if (stat(file.c_str(), &buffer) == -1) {
-		Log::subject(file.c_str());
-		Log::error("File not found: %s", file.c_str());
-
-		return Graphics::VisualShape();
-	}*/
+static Graphics::VisualShape loadObjFile(const std::string& file, bool binary, ThreadPool* pool) {
+	if (!binary) {
+		// Text files are parsed straight from the mapping, without copying them into a stream
+		Util::MappedFile mappedFile(file);
+		if (!mappedFile.isOpen()) {
+			Log::error("Could not open obj file: %s", file.c_str());
 
-	std::ifstream input;
+			return Graphics::VisualShape();
+		}
 
-	if (binary)
-		input.open(file, std::ios::binary);
-	else
-		input.open(file);
+		if (pool != nullptr)
+			return OBJImport::parse(mappedFile.getData(), mappedFile.getSize(), *pool);
 
-	Graphics::VisualShape shape = load(input, binary);
+		return OBJImport::parse(mappedFile.getData(), mappedFile.getSize());
+	}
 
+	std::ifstream input(file, std::ios::binary);
+	Graphics::VisualShape shape = OBJImport::load(input, binary);
 	input.close();
 
 	return shape;
 }
 
+Graphics::VisualShape OBJImport::load(const std::string& file) {
+	bool binary;
+	if (!detectObjFormat(file, binary))
+		return Graphics::VisualShape();
+
+	return OBJImport::load(file, binary);
+}
+
+Graphics::VisualShape OBJImport::load(const std::string& file, bool binary) {
+	return loadObjFile(file, binary, nullptr);
+}
+
+Graphics::VisualShape OBJImport::load(const std::string& file, ThreadPool& pool) {
+	bool binary;
+	if (!detectObjFormat(file, binary))
+		return Graphics::VisualShape();
+
+	return OBJImport::load(file, binary, pool);
+}
+
+Graphics::VisualShape OBJImport::load(const std::string& file, bool binary, ThreadPool& pool) {
+	return loadObjFile(file, binary, &pool);
+}
+
 /*
 	End of OBJImport
 */
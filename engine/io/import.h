@@ -1,6 +1,15 @@
 #pragma once
 
 #include <istream>
+#include <string>
+#include <cstddef>
+
+#include "../../physics/math/linalg/vec.h"
+#include "../../physics/math/linalg/mat.h"
+#include "../../physics/math/fix.h"
+#include "../../physics/math/position.h"
+
+class ThreadPool;
 
 namespace P3D::Graphics {
 struct VisualShape;
@@ -30,6 +39,24 @@ namespace OBJImport {
 	Graphics::VisualShape load(std::istream& file, bool binary = false);
 	Graphics::VisualShape load(const std::string& file, bool binary);
 	Graphics::VisualShape load(const std::string& file);
+	// text files are parsed on the threads of the given pool, see parse
+	Graphics::VisualShape load(const std::string& file, bool binary, ThreadPool& pool);
+	Graphics::VisualShape load(const std::string& file, ThreadPool& pool);
+
+	/*
+		Parses the text of an obj file, faces with more than three corners are split into triangles
+		Every distinct combination of position, uv and normal used by a face corner becomes its own vertex
+		Returns an empty shape if the text is malformed
+	*/
+	Graphics::VisualShape parse(const char* data, std::size_t size);
+	// large files are split into chunks which are parsed on the threads of the given pool
+	Graphics::VisualShape parse(const char* data, std::size_t size, ThreadPool& pool);
+
+	/*
+		The original parser, which reads the file line by line and gives every position a single uv and normal
+		Kept as a reference for tests and benchmarks
+	*/
+	Graphics::VisualShape loadLineByLine(std::istream& file);
 };
 
 };
\ No newline at end of file
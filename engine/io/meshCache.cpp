@@ -0,0 +1,443 @@
+#include "core.h"
+
+#include "meshCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) || __GNUC__ >= 8
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+#include "import.h"
+#include "../physics/geometry/convexHull.h"
+#include "../util/contentHash.h"
+#include "../util/mappedFile.h"
+#include "../util/stringUtil.h"
+
+namespace P3D {
+
+/*
+	A cache file is a header, followed by the arrays of the mesh in a fixed order, each starting at a multiple of MESH_CACHE_ALIGNMENT
+	Arrays which the mesh does not have are left out
+*/
+static const char MESH_CACHE_MAGIC[8]{'P', '3', 'D', 'M', 'E', 'S', 'H', 'C'};
+static constexpr std::uint32_t MESH_CACHE_VERSION = 3;
+static constexpr std::size_t MESH_CACHE_ALIGNMENT = 64;
+
+// changes whenever OBJImport produces different meshes from the same file, so entries made by older importers are not used
+static constexpr std::uint64_t OBJ_IMPORTER_VERSION = 2;
+
+static constexpr std::uint32_t MESH_CACHE_HAS_NORMALS = 1;
+static constexpr std::uint32_t MESH_CACHE_HAS_UVS = 2;
+static constexpr std::uint32_t MESH_CACHE_HAS_TANGENTS = 4;
+static constexpr std::uint32_t MESH_CACHE_HAS_HULL = 8;
+
+static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec3f must be tightly packed to be stored in a mesh cache");
+static_assert(sizeof(Vec2f) == 2 * sizeof(float), "Vec2f must be tightly packed to be stored in a mesh cache");
+static_assert(sizeof(Triangle) == 3 * sizeof(int), "Triangle must be tightly packed to be stored in a mesh cache");
+
+struct MeshCacheHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t flags;
+	std::uint64_t key;
+	std::uint64_t fileSize;
+	std::uint32_t vertexCount;
+	std::uint32_t triangleCount;
+	std::uint32_t hullVertexCount;
+	std::uint32_t hullTriangleCount;
+	double volume;
+	double centerOfMass[3];
+	double inertiaDiagonal[3];
+	double inertiaOffDiagonal[3];
+};
+
+enum MeshCacheArray {
+	VERTICES,
+	TRIANGLES,
+	NORMALS,
+	UVS,
+	TANGENTS,
+	BITANGENTS,
+	HULL_VERTICES,
+	HULL_TRIANGLES,
+	ARRAY_COUNT
+};
+
+struct MeshCacheLayout {
+	std::size_t offsets[ARRAY_COUNT];
+	std::size_t sizes[ARRAY_COUNT];
+	std::size_t fileSize;
+};
+
+static std::size_t alignMeshCacheOffset(std::size_t offset) {
+	return (offset + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+}
+
+static MeshCacheLayout getLayout(const MeshCacheHeader& header) {
+	std::size_t vertexCount = header.vertexCount;
+	std::size_t hullVertexCount = header.hullVertexCount;
+
+	MeshCacheLayout layout;
+	layout.sizes[VERTICES] = vertexCount * sizeof(Vec3f);
+	layout.sizes[TRIANGLES] = static_cast<std::size_t>(header.triangleCount) * sizeof(Triangle);
+	layout.sizes[NORMALS] = header.flags & MESH_CACHE_HAS_NORMALS ? vertexCount * sizeof(Vec3f) : 0;
+	layout.sizes[UVS] = header.flags & MESH_CACHE_HAS_UVS ? vertexCount * sizeof(Vec2f) : 0;
+	layout.sizes[TANGENTS] = header.flags & MESH_CACHE_HAS_TANGENTS ? vertexCount * sizeof(Vec3f) : 0;
+	layout.sizes[BITANGENTS] = layout.sizes[TANGENTS];
+	layout.sizes[HULL_VERTICES] = hullVertexCount * sizeof(Vec3f);
+	layout.sizes[HULL_TRIANGLES] = static_cast<std::size_t>(header.hullTriangleCount) * sizeof(Triangle);
+
+	std::size_t offset = alignMeshCacheOffset(sizeof(MeshCacheHeader));
+	for (int i = 0; i < ARRAY_COUNT; i++) {
+		layout.offsets[i] = offset;
+		offset = alignMeshCacheOffset(offset + layout.sizes[i]);
+	}
+	layout.fileSize = offset;
+
+	return layout;
+}
+
+std::uint64_t MeshCache::getKey(const char* sourceData, std::size_t sourceSize) {
+	return Util::contentHash(sourceData, sourceSize, OBJ_IMPORTER_VERSION);
+}
+
+std::string MeshCache::getFileName(const std::string& cacheDirectory, std::uint64_t key) {
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.p3dmesh", static_cast<unsigned long long>(key));
+
+	return (fs::path(cacheDirectory) / name).string();
+}
+
+/*
+	Render meshes split vertices where normals or uvs differ, this merges the vertices that share a position again
+	Returns false if the merged triangles don't enclose a volume, which needs every edge to be used once in each direction
+	Vertices and edges are matched by sorting them, which only needs a few flat arrays even for very large meshes
+*/
+static bool weldClosedMesh(const TriangleMesh& mesh, std::vector<Vec3f>& vertices, std::vector<Triangle>& triangles) {
+	std::vector<Vec3f> positions(mesh.vertexCount);
+	mesh.getVertices(positions.data());
+
+	// equal positions end up next to each other, the first vertex of every position is in front
+	std::vector<int> order(mesh.vertexCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&positions] (int a, int b) {
+		const Vec3f& first = positions[a];
+		const Vec3f& second = positions[b];
+		if (first.x != second.x)
+			return first.x < second.x;
+		if (first.y != second.y)
+			return first.y < second.y;
+		if (first.z != second.z)
+			return first.z < second.z;
+		return a < b;
+	});
+
+	std::vector<int> weldedIndex(mesh.vertexCount);
+	for (std::size_t i = 0; i < order.size(); i++) {
+		bool samePosition = i > 0 && positions[order[i]] == positions[order[i - 1]];
+		weldedIndex[order[i]] = samePosition ? weldedIndex[order[i - 1]] : order[i];
+	}
+
+	// welded vertices keep the order in which their positions first appear
+	for (int i = 0; i < mesh.vertexCount; i++) {
+		if (weldedIndex[i] == i) {
+			weldedIndex[i] = static_cast<int>(vertices.size());
+			vertices.push_back(positions[i]);
+		} else {
+			weldedIndex[i] = weldedIndex[weldedIndex[i]];
+		}
+	}
+
+	std::vector<std::uint64_t> edges;
+	std::vector<std::uint64_t> reversedEdges;
+	edges.reserve(static_cast<std::size_t>(mesh.triangleCount) * 3);
+	reversedEdges.reserve(static_cast<std::size_t>(mesh.triangleCount) * 3);
+	double signedVolume = 0.0;
+	for (int i = 0; i < mesh.triangleCount; i++) {
+		Triangle triangle = mesh.getTriangle(i);
+		Triangle welded{weldedIndex[triangle.firstIndex], weldedIndex[triangle.secondIndex], weldedIndex[triangle.thirdIndex]};
+		if (welded.firstIndex == welded.secondIndex || welded.secondIndex == welded.thirdIndex || welded.thirdIndex == welded.firstIndex)
+			return false;
+
+		for (int corner = 0; corner < 3; corner++) {
+			std::uint64_t from = static_cast<std::uint32_t>(welded.indexes[corner]);
+			std::uint64_t to = static_cast<std::uint32_t>(welded.indexes[(corner + 1) % 3]);
+			edges.push_back(from << 32 | to);
+			reversedEdges.push_back(to << 32 | from);
+		}
+
+		Vec3 a = vertices[welded.firstIndex];
+		Vec3 b = vertices[welded.secondIndex];
+		Vec3 c = vertices[welded.thirdIndex];
+		signedVolume += a * (b % c);
+		triangles.push_back(welded);
+	}
+
+	// every edge is used once, and its reverse is used once too, exactly when the edges are unique and the same as the reversed edges
+	std::sort(edges.begin(), edges.end());
+	std::sort(reversedEdges.begin(), reversedEdges.end());
+	if (std::adjacent_find(edges.begin(), edges.end()) != edges.end() || edges != reversedEdges)
+		return false;
+
+	return signedVolume > 0.0;
+}
+
+CachedMesh MeshCache::create(Graphics::VisualShape&& shape, const Polyhedron* hull) {
+	CachedMesh mesh;
+	mesh.shape = std::move(shape);
+
+	if (hull != nullptr) {
+		mesh.hull = *hull;
+		mesh.hasHull = true;
+	}
+
+	Polyhedron massShape;
+	if (mesh.hasHull) {
+		massShape = mesh.hull;
+	} else if (mesh.shape.triangleCount > 0) {
+		std::vector<Vec3f> vertices;
+		std::vector<Triangle> triangles;
+		if (weldClosedMesh(mesh.shape, vertices, triangles))
+			massShape = Polyhedron(vertices.data(), triangles.data(), static_cast<int>(vertices.size()), static_cast<int>(triangles.size()));
+	}
+
+	if (massShape.triangleCount > 0) {
+		mesh.volume = massShape.getVolume();
+		mesh.centerOfMass = massShape.getCenterOfMass();
+		mesh.inertia = massShape.getScalableInertiaAroundCenterOfMass();
+	}
+
+	return mesh;
+}
+
+static void writeMeshCacheArray(std::ostream& output, std::size_t& position, std::size_t offset, const void* data, std::size_t size) {
+	static const char padding[MESH_CACHE_ALIGNMENT] {};
+	output.write(padding, offset - position);
+	output.write(static_cast<const char*>(data), size);
+	position = offset + size;
+}
+
+bool MeshCache::write(const std::string& file, std::uint64_t key, const CachedMesh& mesh) {
+	const Graphics::VisualShape& shape = mesh.shape;
+
+	MeshCacheHeader header;
+	std::memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+	header.version = MESH_CACHE_VERSION;
+	header.flags = 0;
+	if (shape.normals != nullptr)
+		header.flags |= MESH_CACHE_HAS_NORMALS;
+	if (shape.uvs != nullptr)
+		header.flags |= MESH_CACHE_HAS_UVS;
+	if (shape.tangents != nullptr && shape.bitangents != nullptr)
+		header.flags |= MESH_CACHE_HAS_TANGENTS;
+	if (mesh.hasHull)
+		header.flags |= MESH_CACHE_HAS_HULL;
+	header.key = key;
+	header.vertexCount = static_cast<std::uint32_t>(shape.vertexCount);
+	header.triangleCount = static_cast<std::uint32_t>(shape.triangleCount);
+	header.hullVertexCount = mesh.hasHull ? static_cast<std::uint32_t>(mesh.hull.vertexCount) : 0;
+	header.hullTriangleCount = mesh.hasHull ? static_cast<std::uint32_t>(mesh.hull.triangleCount) : 0;
+	header.volume = mesh.volume;
+	Vec3 diagonal = mesh.inertia.getDiagonalConstructors();
+	Vec3 offDiagonal = mesh.inertia.getOffDiagonal();
+	for (int i = 0; i < 3; i++) {
+		header.centerOfMass[i] = mesh.centerOfMass[i];
+		header.inertiaDiagonal[i] = diagonal[i];
+		header.inertiaOffDiagonal[i] = offDiagonal[i];
+	}
+
+	MeshCacheLayout layout = getLayout(header);
+	header.fileSize = layout.fileSize;
+
+	// The meshes store their vertices and triangles as separate x, y and z arrays
+	std::vector<Vec3f> vertices(shape.vertexCount);
+	std::vector<Triangle> triangles(shape.triangleCount);
+	shape.getVertices(vertices.data());
+	shape.getTriangles(triangles.data());
+
+	std::vector<Vec3f> hullVertices(header.hullVertexCount);
+	std::vector<Triangle> hullTriangles(header.hullTriangleCount);
+	if (mesh.hasHull) {
+		mesh.hull.getVertices(hullVertices.data());
+		mesh.hull.getTriangles(hullTriangles.data());
+	}
+
+	fs::path path(file);
+	std::error_code error;
+	if (path.has_parent_path())
+		fs::create_directories(path.parent_path(), error);
+
+	std::string temporaryFile = file + ".tmp";
+	{
+		std::ofstream output(temporaryFile, std::ios::binary | std::ios::trunc);
+		if (!output)
+			return false;
+
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		std::size_t position = sizeof(header);
+		writeMeshCacheArray(output, position, layout.offsets[VERTICES], vertices.data(), layout.sizes[VERTICES]);
+		writeMeshCacheArray(output, position, layout.offsets[TRIANGLES], triangles.data(), layout.sizes[TRIANGLES]);
+		writeMeshCacheArray(output, position, layout.offsets[NORMALS], shape.normals.get(), layout.sizes[NORMALS]);
+		writeMeshCacheArray(output, position, layout.offsets[UVS], shape.uvs.get(), layout.sizes[UVS]);
+		writeMeshCacheArray(output, position, layout.offsets[TANGENTS], shape.tangents.get(), layout.sizes[TANGENTS]);
+		writeMeshCacheArray(output, position, layout.offsets[BITANGENTS], shape.bitangents.get(), layout.sizes[BITANGENTS]);
+		writeMeshCacheArray(output, position, layout.offsets[HULL_VERTICES], hullVertices.data(), layout.sizes[HULL_VERTICES]);
+		writeMeshCacheArray(output, position, layout.offsets[HULL_TRIANGLES], hullTriangles.data(), layout.sizes[HULL_TRIANGLES]);
+		writeMeshCacheArray(output, position, layout.fileSize, nullptr, 0);
+
+		if (!output) {
+			output.close();
+			fs::remove(temporaryFile, error);
+			return false;
+		}
+	}
+
+	fs::rename(temporaryFile, file, error);
+	if (error) {
+		fs::remove(temporaryFile, error);
+		return false;
+	}
+
+	return true;
+}
+
+template<typename T>
+static SharedArrayPtr<const T> copyMeshCacheArray(const char* data, const MeshCacheLayout& layout, MeshCacheArray array) {
+	if (layout.sizes[array] == 0)
+		return SharedArrayPtr<const T>();
+
+	T* result = new T[layout.sizes[array] / sizeof(T)];
+	std::memcpy(result, data + layout.offsets[array], layout.sizes[array]);
+
+	return SharedArrayPtr<const T>(result);
+}
+
+bool MeshCache::read(const char* data, std::size_t size, std::uint64_t key, CachedMesh& result) {
+	if (size < sizeof(MeshCacheHeader))
+		return false;
+
+	MeshCacheHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != MESH_CACHE_VERSION || header.key != key)
+		return false;
+
+	MeshCacheLayout layout = getLayout(header);
+	if (header.fileSize != size || layout.fileSize != size)
+		return false;
+
+	// Indices are checked, so a damaged file can't make the mesh read out of bounds
+	const Triangle* triangles = reinterpret_cast<const Triangle*>(data + layout.offsets[TRIANGLES]);
+	for (std::uint32_t i = 0; i < header.triangleCount; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (static_cast<std::uint32_t>(triangles[i][j]) >= header.vertexCount)
+				return false;
+		}
+	}
+
+	const Triangle* hullTriangles = reinterpret_cast<const Triangle*>(data + layout.offsets[HULL_TRIANGLES]);
+	for (std::uint32_t i = 0; i < header.hullTriangleCount; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (static_cast<std::uint32_t>(hullTriangles[i][j]) >= header.hullVertexCount)
+				return false;
+		}
+	}
+
+	const Vec3f* vertices = reinterpret_cast<const Vec3f*>(data + layout.offsets[VERTICES]);
+	result.shape = Graphics::VisualShape(vertices, static_cast<int>(header.vertexCount), triangles, static_cast<int>(header.triangleCount),
+		copyMeshCacheArray<Vec3f>(data, layout, NORMALS),
+		copyMeshCacheArray<Vec2f>(data, layout, UVS),
+		copyMeshCacheArray<Vec3f>(data, layout, TANGENTS),
+		copyMeshCacheArray<Vec3f>(data, layout, BITANGENTS));
+
+	result.hasHull = (header.flags & MESH_CACHE_HAS_HULL) != 0;
+	if (result.hasHull) {
+		const Vec3f* hullVertices = reinterpret_cast<const Vec3f*>(data + layout.offsets[HULL_VERTICES]);
+		result.hull = Polyhedron(hullVertices, hullTriangles, static_cast<int>(header.hullVertexCount), static_cast<int>(header.hullTriangleCount));
+	} else {
+		result.hull = Polyhedron();
+	}
+
+	result.volume = header.volume;
+	result.centerOfMass = Vec3(header.centerOfMass[0], header.centerOfMass[1], header.centerOfMass[2]);
+	result.inertia = ScalableInertialMatrix(
+		Vec3(header.inertiaDiagonal[0], header.inertiaDiagonal[1], header.inertiaDiagonal[2]),
+		Vec3(header.inertiaOffDiagonal[0], header.inertiaOffDiagonal[1], header.inertiaOffDiagonal[2]));
+
+	return true;
+}
+
+bool MeshCache::read(const std::string& file, std::uint64_t key, CachedMesh& result) {
+	Util::MappedFile mappedFile(file);
+	if (!mappedFile.isOpen())
+		return false;
+
+	return MeshCache::read(mappedFile.getData(), mappedFile.getSize(), key, result);
+}
+
+static Graphics::VisualShape importObj(const std::string& path, ThreadPool* pool) {
+	if (pool != nullptr)
+		return OBJImport::load(path, *pool);
+
+	return OBJImport::load(path);
+}
+
+static Graphics::VisualShape parseObj(const Util::MappedFile& source, ThreadPool* pool) {
+	if (pool != nullptr)
+		return OBJImport::parse(source.getData(), source.getSize(), *pool);
+
+	return OBJImport::parse(source.getData(), source.getSize());
+}
+
+// imported meshes get their convex hull as colission shape, the hull and its mass properties are stored in the cache with the mesh
+static CachedMesh createWithHull(Graphics::VisualShape&& shape, ThreadPool* pool) {
+	std::vector<Vec3f> points(shape.vertexCount);
+	shape.getVertices(points.data());
+
+	Polyhedron hull = pool != nullptr ? convexHull(points.data(), points.size(), *pool) : convexHull(points.data(), points.size());
+	return MeshCache::create(std::move(shape), hull.triangleCount > 0 ? &hull : nullptr);
+}
+
+static CachedMesh loadMesh(const std::string& path, const std::string& cacheDirectory, ThreadPool* pool) {
+	if (cacheDirectory.empty() || !Util::endsWith(path, ".obj"))
+		return createWithHull(importObj(path, pool), pool);
+
+	Util::MappedFile source(path);
+	if (!source.isOpen()) {
+		Log::error("Could not open obj file: %s", path.c_str());
+		return CachedMesh();
+	}
+
+	std::uint64_t key = MeshCache::getKey(source.getData(), source.getSize());
+	std::string cacheFile = MeshCache::getFileName(cacheDirectory, key);
+
+	CachedMesh mesh;
+	if (MeshCache::read(cacheFile, key, mesh))
+		return mesh;
+
+	mesh = createWithHull(parseObj(source, pool), pool);
+	if (mesh.shape.vertexCount > 0 && !MeshCache::write(cacheFile, key, mesh))
+		Log::warn("Could not write mesh cache file %s", cacheFile.c_str());
+
+	return mesh;
+}
+
+CachedMesh MeshCache::load(const std::string& path, const std::string& cacheDirectory) {
+	return loadMesh(path, cacheDirectory, nullptr);
+}
+
+CachedMesh MeshCache::load(const std::string& path, const std::string& cacheDirectory, ThreadPool& pool) {
+	return loadMesh(path, cacheDirectory, &pool);
+}
+
+};
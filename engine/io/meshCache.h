@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "../../graphics/visualShape.h"
+#include "../../physics/geometry/polyhedron.h"
+#include "../../physics/geometry/scalableInertialMatrix.h"
+
+class ThreadPool;
+
+namespace P3D {
+
+/*
+	A mesh as stored in a mesh cache, everything needed to render it and to simulate it
+*/
+struct CachedMesh {
+	Graphics::VisualShape shape;
+
+	// the convex hull used for colissions, empty if none was stored
+	Polyhedron hull;
+	bool hasHull = false;
+
+	/*
+		The mass properties of the hull if there is one, otherwise of the shape with the vertices that share a position merged
+		Left at zero when there is no hull and the shape doesn't enclose a volume, like open or inside out meshes
+	*/
+	double volume = 0.0;
+	Vec3 centerOfMass = Vec3(0.0, 0.0, 0.0);
+	ScalableInertialMatrix inertia = ScalableInertialMatrix(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0));
+};
+
+/*
+	An on disk cache of imported meshes, so every source file only has to be parsed once
+
+	Cache files are named after a hash of the contents of their source file, so a changed source gets a new entry,
+	and files that are moved or copied keep theirs. The arrays in a cache file are stored as they are in memory,
+	aligned so they can be copied straight out of a memory mapping of the file
+*/
+namespace MeshCache {
+	// identifies the cache entry of a source file with the given contents
+	std::uint64_t getKey(const char* sourceData, std::size_t sourceSize);
+	std::string getFileName(const std::string& cacheDirectory, std::uint64_t key);
+
+	// computes the mass properties of the hull if given, otherwise of the mesh if it is closed, see CachedMesh
+	CachedMesh create(Graphics::VisualShape&& shape, const Polyhedron* hull = nullptr);
+
+	// writes to a temporary file first, so readers never see a partially written entry. Returns false if the file could not be written
+	bool write(const std::string& file, std::uint64_t key, const CachedMesh& mesh);
+	/*
+		Returns false if the file does not exist, is not a mesh cache file of the current version, is damaged,
+		or was made from a different source than the one with the given key
+	*/
+	bool read(const std::string& file, std::uint64_t key, CachedMesh& result);
+	bool read(const char* data, std::size_t size, std::uint64_t key, CachedMesh& result);
+
+	/*
+		Loads an obj file from the cache in cacheDirectory, or imports it and adds it to the cache if it isn't in there yet
+		Imported meshes get their convex hull, with the mass properties of that hull
+		Other formats are imported without caching, as is everything if cacheDirectory is empty
+	*/
+	CachedMesh load(const std::string& path, const std::string& cacheDirectory);
+	// sources which are not in the cache yet are parsed on the threads of the given pool
+	CachedMesh load(const std::string& path, const std::string& cacheDirectory, ThreadPool& pool);
+};
+
+};
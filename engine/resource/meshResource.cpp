@@ -1,15 +1,66 @@
 #include "core.h"
 
 #include "meshResource.h"
-#include "../io/import.h"
+
+#include <mutex>
+
+#include "../io/meshCache.h"
 #include "../graphics/visualShape.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/threading/threadPool.h"
 
 namespace P3D::Engine {
 
+std::string MeshAllocator::cacheDirectory = "../res/cache/meshes";
+
+/*
+	Large obj files are parsed in parallel on a pool shared by all loading threads. A pool only runs one job at a time,
+	so threads which find it busy parse their file by themselves
+*/
+static CachedMesh loadCachedMesh(const std::string& path, const std::string& cacheDirectory) {
+	static ThreadPool parsePool;
+	static std::mutex parsePoolMutex;
+
+	std::unique_lock<std::mutex> poolLock(parsePoolMutex, std::try_to_lock);
+	if (poolLock.owns_lock())
+		return MeshCache::load(path, cacheDirectory, parsePool);
+
+	return MeshCache::load(path, cacheDirectory);
+}
+
+// the hull comes with its mass properties from the mesh cache, so they don't have to be computed again
+static Shape createHitbox(const CachedMesh& mesh) {
+	if (!mesh.hasHull)
+		return Shape();
+
+	return polyhedronShape(mesh.hull, mesh.volume, mesh.centerOfMass, mesh.inertia);
+}
+
 MeshResource* MeshAllocator::load(const std::string& name, const std::string& path) {
-	Graphics::VisualShape shape = OBJImport::load(path);
-	Graphics::IndexedMesh* mesh = new Graphics::IndexedMesh(shape);
-	return new MeshResource(name, path, mesh, shape);
+	CachedMesh cachedMesh = loadCachedMesh(path, cacheDirectory);
+	Graphics::IndexedMesh* mesh = new Graphics::IndexedMesh(cachedMesh.shape);
+	return new MeshResource(name, path, mesh, cachedMesh.shape, createHitbox(cachedMesh));
+}
+
+struct MeshData : public ResourceData {
+	Graphics::VisualShape shape;
+	Shape hitbox;
+};
+
+std::unique_ptr<ResourceData> MeshAllocator::decode(const std::string& path) {
+	CachedMesh cachedMesh = loadCachedMesh(path, cacheDirectory);
+
+	std::unique_ptr<MeshData> data = std::make_unique<MeshData>();
+	data->hitbox = createHitbox(cachedMesh);
+	data->shape = std::move(cachedMesh.shape);
+
+	return data;
+}
+
+MeshResource* MeshAllocator::finish(const std::string& name, const std::string& path, std::unique_ptr<ResourceData> data) {
+	MeshData* meshData = static_cast<MeshData*>(data.get());
+	Graphics::IndexedMesh* mesh = new Graphics::IndexedMesh(meshData->shape);
+	return new MeshResource(name, path, mesh, meshData->shape, meshData->hitbox);
 }
 
 };
\ No newline at end of file
@@ -4,20 +4,31 @@
 
 #include "../graphics/mesh/indexedMesh.h"
 #include "../graphics/visualShape.h"
+#include "../physics/geometry/shape.h"
 
 namespace P3D::Engine {
 
 class MeshResource;
 
 class MeshAllocator : public ResourceAllocator<MeshResource> {
+private:
+	static std::string cacheDirectory;
 public:
 	virtual MeshResource* load(const std::string& name, const std::string& path) override;
+
+	virtual std::unique_ptr<ResourceData> decode(const std::string& path) override;
+	virtual MeshResource* finish(const std::string& name, const std::string& path, std::unique_ptr<ResourceData> data) override;
+
+	// imported meshes are cached in this directory between runs, an empty directory turns caching off
+	static void setCacheDirectory(const std::string& directory) { cacheDirectory = directory; }
+	static const std::string& getCacheDirectory() { return cacheDirectory; }
 };
 
 class MeshResource : public Resource {
 private:
 	Graphics::IndexedMesh* mesh;
 	Graphics::VisualShape shape;
+	Shape hitbox;
 public:
 	DEFINE_RESOURCE(Mesh, "../res/fonts/default/default.ttf");
 
@@ -29,6 +40,10 @@ public:
 
 	}
 
+	MeshResource(const std::string& name, const std::string& path, Graphics::IndexedMesh* mesh, Graphics::VisualShape shape, Shape hitbox) : Resource(name, path), mesh(mesh), shape(shape), hitbox(hitbox) {
+
+	}
+
 	Graphics::IndexedMesh* getMesh() {
 		return mesh;
 	};
@@ -37,6 +52,11 @@ public:
 		return shape;
 	}
 
+	// the convex hull of the mesh for parts made from it, has no base shape if the mesh doesn't span a volume
+	Shape getHitbox() {
+		return hitbox;
+	}
+
 	virtual void close() override {
 		mesh->close();
 	}
@@ -170,37 +170,6 @@ float BarChart::getMaxWeight() const {
 
 //! Tree
 
-static void recursiveRenderTree(const P3D::OldBoundsTree::TreeNode& tree, const Vec3f& treeColor, Vec2f origin, float allottedWidth, long long maxCost, const void* selectedObject) {
-	if (!tree.isLeafNode()) {
-		for (int i = 0; i < tree.nodeCount; i++) {
-			Vec2f nextStep = origin + Vec2f(-allottedWidth / 2 + allottedWidth * ((tree.nodeCount != 1) ? (float(i) / (tree.nodeCount - 1)) : 0.5f), -0.1f);
-			float colorDarkning = pow(1.0f * P3D::OldBoundsTree::computeCost(tree[i].bounds) / maxCost, 0.25f);
-
-			//Path::bezierVertical(origin, nextStep, 1.0f, Vec4f(treeColor * colorDarkning, 1.0f), 15);
-			Path::line(origin, nextStep, join(treeColor * colorDarkning, 1.0f), 0.5f);
-
-			recursiveRenderTree(tree[i], treeColor, nextStep, allottedWidth / tree.nodeCount, maxCost, selectedObject);
-		}
-	}
-
-	if (tree.object == selectedObject) {
-		Path::circleFilled(origin, 0.012f, Colors::YELLOW, 8);
-	}
-
-	if (tree.isGroupHead) {
-		Path::circleFilled(origin, 0.006f, Colors::RED, 8);
-	}
-}
-
-void renderTreeStructure(const P3D::OldBoundsTree::BoundsTree<Part>& tree, const Vec3f& treeColor, Vec2f origin, float allottedWidth, const void* selectedObject) {
-	if (tree.isEmpty()) {
-		return;
-	}
-	long long maxCost = P3D::OldBoundsTree::computeCost(tree.rootNode.bounds);
-
-	recursiveRenderTree(tree.rootNode, treeColor, origin, allottedWidth, maxCost, selectedObject);
-}
-
 static void recursiveRenderTree(const P3D::NewBoundsTree::TreeTrunk& curTrunk, int curTrunkSize, const Vec3f& treeColor, Vec2f origin, float allottedWidth, float maxCost, const void* selectedObject) {
 	for(int i = 0; i < curTrunkSize; i++) {
 		const P3D::NewBoundsTree::TreeNodeRef& subNode = curTrunk.subNodes[i];
@@ -4,10 +4,6 @@
 #include "../physics/misc/profiling.h"
 #include "../physics/math/linalg/largeMatrix.h"
 
-namespace P3D::OldBoundsTree {
-template<typename T>
-struct BoundsTree;
-}
 namespace P3D::NewBoundsTree {
 template<typename T>
 struct BoundsTree;
@@ -102,7 +98,6 @@ struct SlidingChart {
 	Vec2 resize();
 };
 
-void renderTreeStructure(const P3D::OldBoundsTree::BoundsTree<Part>& tree, const Vec3f& treeColor, Vec2f origin, float allottedWidth, const void* selectedObject);
 void renderTreeStructure(const P3D::NewBoundsTree::BoundsTree<Part>& tree, const Vec3f& treeColor, Vec2f origin, float allottedWidth, const void* selectedObject);
 
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "../physics/math/constants.h"
 #include "../physics/misc/shapeLibrary.h"
 #include "../physics/geometry/builtinShapeClasses.h"
+#include "../physics/geometry/terrainMeshClass.h"
 
 #include "buffers/bufferLayout.h"
 #include "buffers/vertexBuffer.h"
@@ -183,6 +184,12 @@ VisualData registerMeshFor(const ShapeClass* shapeClass, const Graphics::VisualS
 }
 
 VisualData registerMeshFor(const ShapeClass* shapeClass) {
+	// terrain meshes are drawn as they are instead of as their convex hull
+	if(shapeClass->intersectionClassID == TERRAIN_MESH_CLASS_ID) {
+		VisualShape shape = VisualShape::generateSplitNormalsShape(static_cast<const TerrainMeshClass*>(shapeClass)->asTriangleMesh());
+		return registerMeshFor(shapeClass, shape);
+	}
+
 	VisualShape shape = VisualShape::generateSplitNormalsShape(shapeClass->asPolyhedron());
 	return registerMeshFor(shapeClass, shape);
 }
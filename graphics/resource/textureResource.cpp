@@ -14,4 +14,29 @@ TextureResource* TextureAllocator::load(const std::string& name, const std::stri
 	}
 }
 
+struct TextureData : public ResourceData {
+	std::vector<unsigned char> pixels;
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+};
+
+std::unique_ptr<ResourceData> TextureAllocator::decode(const std::string& path) {
+	std::unique_ptr<TextureData> data = std::make_unique<TextureData>();
+	data->pixels = Texture::decode(path, data->width, data->height, data->channels);
+
+	return data;
+}
+
+TextureResource* TextureAllocator::finish(const std::string& name, const std::string& path, std::unique_ptr<ResourceData> data) {
+	TextureData* textureData = static_cast<TextureData*>(data.get());
+	Texture texture = Texture::fromPixels(textureData->pixels, textureData->width, textureData->height, textureData->channels);
+
+	if (texture.getID() != 0) {
+		return new TextureResource(name, path, std::move(texture));
+	} else {
+		return nullptr;
+	}
+}
+
 };
\ No newline at end of file
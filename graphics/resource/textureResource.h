@@ -11,6 +11,9 @@ class TextureResource;
 class TextureAllocator : public ResourceAllocator<TextureResource> {
 public:
 	virtual TextureResource* load(const std::string& name, const std::string& path) override;
+
+	virtual std::unique_ptr<ResourceData> decode(const std::string& path) override;
+	virtual TextureResource* finish(const std::string& name, const std::string& path, std::unique_ptr<ResourceData> data) override;
 };
 
 class TextureResource : public Resource, public Texture {
@@ -5,6 +5,8 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <cstring>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -54,27 +56,43 @@ int getFormatFromChannels(int channels) {
 	}
 }
 
-Texture Texture::load(const std::string& name) {
-	int width;
-	int height;
-	int channels;
-	stbi_set_flip_vertically_on_load(true);
+std::vector<unsigned char> Texture::decode(const std::string& name, int& width, int& height, int& channels) {
+	// stbi_set_flip_vertically_on_load is global state, the rows are flipped here instead so textures can be decoded on any thread
 	unsigned char* data = stbi_load(name.c_str(), &width, &height, &channels, 0);
 
-	if (data) {
-		int format = getFormatFromChannels(channels);
+	if (data == nullptr) {
+		Log::subject s(name);
+		Log::error("Failed to load texture");
 
-		Texture texture(width, height, data, format);
+		return std::vector<unsigned char>();
+	}
 
-		stbi_image_free(data);
+	std::size_t rowSize = static_cast<std::size_t>(width) * channels;
+	std::vector<unsigned char> pixels(rowSize * height);
+	for (int row = 0; row < height; row++)
+		std::memcpy(pixels.data() + row * rowSize, data + (height - 1 - row) * rowSize, rowSize);
 
-		return texture;
-	} else {
-		Log::subject s(name);
-		Log::error("Failed to load texture");
+	stbi_image_free(data);
 
+	return pixels;
+}
+
+Texture Texture::fromPixels(const std::vector<unsigned char>& pixels, int width, int height, int channels) {
+	if (pixels.empty())
 		return Texture();
-	}
+
+	int format = getFormatFromChannels(channels);
+
+	return Texture(width, height, pixels.data(), format);
+}
+
+Texture Texture::load(const std::string& name) {
+	int width;
+	int height;
+	int channels;
+	std::vector<unsigned char> pixels = decode(name, width, height, channels);
+
+	return fromPixels(pixels, width, height, channels);
 }
 
 Texture* Texture::white() {
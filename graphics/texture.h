@@ -47,6 +47,10 @@ public:
 	Texture* colored(Color color);
 
 	static Texture load(const std::string& name);
+	// Reads and decodes an image file without touching OpenGL, so it may run on any thread. Returns no pixels if the file can't be loaded
+	static std::vector<unsigned char> decode(const std::string& name, int& width, int& height, int& channels);
+	// Uploads decoded pixels, must run on the thread owning the OpenGL context
+	static Texture fromPixels(const std::vector<unsigned char>& pixels, int width, int height, int channels);
 	static Texture* white();
 
 	float getAspect() const;
@@ -137,6 +137,8 @@ void ConstraintGroup::apply() const {
 			mainPACF.rotation = Rotation::fromRotationVec(offsetAngularEffectOnA.getSubVector<3>(3)) * mainPACF.rotation;
 			mainPBCF.position += offsetAngularEffectOnB.getSubVector<3>(0);
 			mainPBCF.rotation = Rotation::fromRotationVec(offsetAngularEffectOnB.getSubVector<3>(3)) * mainPBCF.rotation;
+			constraints[i].physA->mainPhysical->rigidBody.mainPart->updateBounds();
+			constraints[i].physB->mainPhysical->rigidBody.mainPart->updateBounds();
 
 			Vector<double, 6> velAngularEffectOnA = effectOnA.getCol(1);
 			Vector<double, 6> velAngularEffectOnB = effectOnB.getCol(1);
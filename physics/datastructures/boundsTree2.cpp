@@ -3,28 +3,36 @@
 
 #include "aligned_alloc.h"
 
+#include <cmath>
+
 namespace P3D::NewBoundsTree {
 
-BoundsTemplate<float> TreeTrunk::getBoundsOfSubNode(int subNode) const {
-	assert(subNode >= 0 && subNode < BRANCH_FACTOR);
-	BoundsTemplate<float> result;
-	result.min.x = xMin[subNode];
-	result.min.y = yMin[subNode];
-	result.min.z = zMin[subNode];
-	result.max.x = xMax[subNode];
-	result.max.y = yMax[subNode];
-	result.max.z = zMax[subNode];
+// rounding is done explicitly rather than with fesetround, which the compiler does not respect when it reorders the conversions
+static float roundDown(double value) {
+	float result = static_cast<float>(value);
+	if(static_cast<double>(result) > value) result = std::nextafter(result, -std::numeric_limits<float>::infinity());
+	return result;
+}
+static float roundUp(double value) {
+	float result = static_cast<float>(value);
+	if(static_cast<double>(result) < value) result = std::nextafter(result, std::numeric_limits<float>::infinity());
 	return result;
 }
 
-void TreeTrunk::setBoundsOfSubNode(int subNode, const BoundsTemplate<float>& newBounds) {
-	assert(subNode >= 0 && subNode < BRANCH_FACTOR);
-	xMin[subNode] = newBounds.min.x;
-	yMin[subNode] = newBounds.min.y;
-	zMin[subNode] = newBounds.min.z;
-	xMax[subNode] = newBounds.max.x;
-	yMax[subNode] = newBounds.max.y;
-	zMax[subNode] = newBounds.max.z;
+BoundsTemplate<float> toTreeBounds(const Bounds& absoluteBounds, const Position& treeOrigin) {
+	Vec3 relativeMin(absoluteBounds.min - treeOrigin);
+	Vec3 relativeMax(absoluteBounds.max - treeOrigin);
+	return BoundsTemplate<float>(
+		PositionTemplate<float>(roundDown(relativeMin.x), roundDown(relativeMin.y), roundDown(relativeMin.z)),
+		PositionTemplate<float>(roundUp(relativeMax.x), roundUp(relativeMax.y), roundUp(relativeMax.z))
+	);
+}
+
+BoundsTemplate<float> offsetTreeBounds(const BoundsTemplate<float>& treeBounds, const Vec3& offset) {
+	return BoundsTemplate<float>(
+		PositionTemplate<float>(roundDown(treeBounds.min.x + offset.x), roundDown(treeBounds.min.y + offset.y), roundDown(treeBounds.min.z + offset.z)),
+		PositionTemplate<float>(roundUp(treeBounds.max.x + offset.x), roundUp(treeBounds.max.y + offset.y), roundUp(treeBounds.max.z + offset.z))
+	);
 }
 
 void TreeTrunk::setSubNode(int subNode, TreeNodeRef&& newNode, const BoundsTemplate<float>& newBounds) {
@@ -96,6 +104,18 @@ std::array<std::array<bool, BRANCH_FACTOR>, BRANCH_FACTOR> TrunkSIMDHelperFallba
 	return result;
 }
 
+std::array<std::array<bool, BRANCH_FACTOR>, BRANCH_FACTOR> TrunkSIMDHelperFallback::computeBoundsOverlapMatrix(const TreeTrunk& trunkA, int trunkASize, const TreeTrunk& trunkB, int trunkBSize, const Vec3& offsetOfB) {
+	std::array<std::array<bool, BRANCH_FACTOR>, BRANCH_FACTOR> result;
+	for(int a = 0; a < trunkASize; a++) {
+		BoundsTemplate<float> aBounds = trunkA.getBoundsOfSubNode(a);
+		for(int b = 0; b < trunkBSize; b++) {
+			BoundsTemplate<float> bBounds = offsetTreeBounds(trunkB.getBoundsOfSubNode(b), offsetOfB);
+			result[a][b] = intersects(aBounds, bBounds);
+		}
+	}
+	return result;
+}
+
 std::array<std::array<bool, BRANCH_FACTOR>, BRANCH_FACTOR> TrunkSIMDHelperFallback::computeInternalBoundsOverlapMatrix(const TreeTrunk& trunk, int trunkSize) {
 	std::array<std::array<bool, BRANCH_FACTOR>, BRANCH_FACTOR> result;
 
@@ -578,4 +598,32 @@ void BoundsTreePrototype::clear() {
 	this->baseTrunkSize = 0;
 }
 
+bool isValidTreeImage(const TreeImageTrunk* trunks, std::size_t trunkCount, std::size_t objectCount) {
+	if(trunkCount == 0) return true;
+	if(trunks[0].size > BRANCH_FACTOR) return false;
+
+	// a trunk is inside a group if it or one of its parents is a group head, groups can't contain other groups
+	std::vector<bool> isReferenced(trunkCount, false);
+	std::vector<bool> isInsideGroup(trunkCount, false);
+	for(std::size_t t = 0; t < trunkCount; t++) {
+		if(t != 0 && !isReferenced[t]) return false;
+		for(std::uint32_t i = 0; i < trunks[t].size; i++) {
+			std::uint32_t subNode = trunks[t].subNodes[i];
+			std::size_t index = subNode >> TreeImageTrunk::INDEX_SHIFT;
+			if(subNode & TreeImageTrunk::TRUNK_FLAG) {
+				bool isGroupHead = (subNode & TreeImageTrunk::GROUP_HEAD_FLAG) != 0;
+				if(index <= t || index >= trunkCount || isReferenced[index]) return false;
+				if(trunks[index].size < 2 || trunks[index].size > BRANCH_FACTOR) return false;
+				if(isGroupHead && isInsideGroup[t]) return false;
+				isReferenced[index] = true;
+				isInsideGroup[index] = isInsideGroup[t] || isGroupHead;
+			} else {
+				if(subNode & TreeImageTrunk::GROUP_HEAD_FLAG) return false;
+				if(index >= objectCount) return false;
+			}
+		}
+	}
+	return true;
+}
+
 };
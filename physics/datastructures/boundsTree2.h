@@ -14,6 +14,7 @@
 #include <optional>
 #include <iostream>
 #include <stack>
+#include <vector>
 
 namespace P3D::NewBoundsTree {
 
@@ -27,6 +28,25 @@ inline float computeCost(const BoundsTemplate<float>& bounds) {
 	return d.x + d.y + d.z;
 }
 
+/*
+	Trees store their bounds as floats relative to the origin of the tree, so that precision does not degrade far away from the world origin
+	Boundables give their bounds in absolute coordinates, these are shifted to the tree origin exactly before being rounded outward to float
+
+	Not inline on purpose, the tree finds objects by their exact bounds, so every caller must get bit-identical results
+*/
+BoundsTemplate<float> toTreeBounds(const Bounds& absoluteBounds, const Position& treeOrigin);
+inline BoundsTemplate<float> toTreeBounds(const BoundsTemplate<float>& absoluteBounds, const Position& treeOrigin) {
+	if(treeOrigin == Position()) return absoluteBounds;
+	return toTreeBounds(Bounds(absoluteBounds), treeOrigin);
+}
+inline Bounds fromTreeBounds(const BoundsTemplate<float>& treeBounds, const Position& treeOrigin) {
+	Bounds relativeBounds(treeBounds);
+	Vec3Fix originOffset = treeOrigin - Position();
+	return Bounds(relativeBounds.min + originOffset, relativeBounds.max + originOffset);
+}
+// moves bounds of one tree into the space of a tree whose origin is offset from it, rounded outward like toTreeBounds so touching bounds keep touching
+BoundsTemplate<float> offsetTreeBounds(const BoundsTemplate<float>& treeBounds, const Vec3& offset);
+
 
 class TreeNodeRef {
 	friend class TreeTrunk;
@@ -136,8 +156,27 @@ private:
 	float zMax[BRANCH_FACTOR];
 public:
 	TreeNodeRef subNodes[BRANCH_FACTOR];
-	BoundsTemplate<float> getBoundsOfSubNode(int subNode) const;
-	void setBoundsOfSubNode(int subNode, const BoundsTemplate<float>& newBounds);
+	// inline so loops over all subnodes of a trunk can be vectorized
+	inline BoundsTemplate<float> getBoundsOfSubNode(int subNode) const {
+		assert(subNode >= 0 && subNode < BRANCH_FACTOR);
+		BoundsTemplate<float> result;
+		result.min.x = xMin[subNode];
+		result.min.y = yMin[subNode];
+		result.min.z = zMin[subNode];
+		result.max.x = xMax[subNode];
+		result.max.y = yMax[subNode];
+		result.max.z = zMax[subNode];
+		return result;
+	}
+	inline void setBoundsOfSubNode(int subNode, const BoundsTemplate<float>& newBounds) {
+		assert(subNode >= 0 && subNode < BRANCH_FACTOR);
+		xMin[subNode] = newBounds.min.x;
+		yMin[subNode] = newBounds.min.y;
+		zMin[subNode] = newBounds.min.z;
+		xMax[subNode] = newBounds.max.x;
+		yMax[subNode] = newBounds.max.y;
+		zMax[subNode] = newBounds.max.z;
+	}
 	void setSubNode(int subNode, TreeNodeRef&& newNode, const BoundsTemplate<float>& newBounds);
 	void moveSubNode(int from, int to);
 };
@@ -172,6 +211,8 @@ struct TrunkSIMDHelperFallback {
 	static std::array<bool, BRANCH_FACTOR> computeOverlapsWith(const TreeTrunk& trunk, int trunkSize, const BoundsTemplate<float>& bounds);
 	// indexed result[a][b]
 	static std::array<std::array<bool, BRANCH_FACTOR>, BRANCH_FACTOR> computeBoundsOverlapMatrix(const TreeTrunk& trunkA, int trunkASize, const TreeTrunk& trunkB, int trunkBSize);
+	// same as above, for trunks of trees with different origins. offsetOfB is the origin of the tree of trunkB relative to that of trunkA
+	static std::array<std::array<bool, BRANCH_FACTOR>, BRANCH_FACTOR> computeBoundsOverlapMatrix(const TreeTrunk& trunkA, int trunkASize, const TreeTrunk& trunkB, int trunkBSize, const Vec3& offsetOfB);
 	// indexed result[i][j] with j >= i+1
 	static std::array<std::array<bool, BRANCH_FACTOR>, BRANCH_FACTOR> computeInternalBoundsOverlapMatrix(const TreeTrunk& trunk, int trunkSize);
 };
@@ -324,6 +365,38 @@ inline void forEachRecurse(const TreeTrunk& curTrunk, int curTrunkSize, const Fu
 	}
 }
 
+/*
+	Tree queries take a filter of the form std::array<bool, BRANCH_FACTOR>(const TreeTrunk& trunk, int trunkSize)
+	The filter is evaluated for all subnodes of a trunk at once, only subnodes for which it returns true are visited
+	Entries at or beyond trunkSize are ignored, so filters may evaluate all BRANCH_FACTOR subnodes to keep their loops branchless
+
+	filterEachSubNode builds such a trunk filter from a test of the form bool(const BoundsTemplate<float>&)
+*/
+template<typename BoundsTest>
+inline std::array<bool, BRANCH_FACTOR> filterEachSubNode(const TreeTrunk& trunk, const BoundsTest& test) {
+	std::array<bool, BRANCH_FACTOR> results;
+	for(int i = 0; i < BRANCH_FACTOR; i++) {
+		results[i] = test(trunk.getBoundsOfSubNode(i));
+	}
+	return results;
+}
+
+// expects a filter as described above, and a function of the form void(Boundable& object)
+template<typename Boundable, typename Filter, typename Func>
+inline void forEachFilteredRecurse(const TreeTrunk& curTrunk, int curTrunkSize, const Filter& filter, const Func& func) {
+	std::array<bool, BRANCH_FACTOR> passes = filter(curTrunk, curTrunkSize);
+	for(int i = 0; i < curTrunkSize; i++) {
+		if(!passes[i]) continue;
+
+		const TreeNodeRef& subNode = curTrunk.subNodes[i];
+		if(subNode.isTrunkNode()) {
+			forEachFilteredRecurse<Boundable, Filter, Func>(subNode.asTrunk(), subNode.getTrunkSize(), filter, func);
+		} else {
+			func(*static_cast<Boundable*>(subNode.asObject()));
+		}
+	}
+}
+
 // expects a function of the form void(Boundable*, Boundable*)
 // Calls the given function for each pair of leaf nodes from the two trunks 
 template<typename Boundable, typename SIMDHelper, typename Func>
@@ -401,6 +474,40 @@ void forEachColissionBetweenRecursive(const TreeTrunk& trunkA, int trunkASize, c
 	}
 }
 
+// expects a function of the form void(Boundable*, Boundable*)
+// Same as above, for trunks of trees with different origins. offsetOfB is the origin of the tree of trunkB relative to that of trunkA
+template<typename Boundable, typename SIMDHelper, typename Func>
+void forEachColissionBetweenRecursive(const TreeTrunk& trunkA, int trunkASize, const TreeTrunk& trunkB, int trunkBSize, const Vec3& offsetOfB, const Func& func) {
+	OverlapMatrix overlapBetween = SIMDHelper::computeBoundsOverlapMatrix(trunkA, trunkASize, trunkB, trunkBSize, offsetOfB);
+
+	for(int a = 0; a < trunkASize; a++) {
+		const TreeNodeRef& aNode = trunkA.subNodes[a];
+		bool aIsTrunk = aNode.isTrunkNode();
+		for(int b = 0; b < trunkBSize; b++) {
+			if(!overlapBetween[a][b]) continue;
+
+			const TreeNodeRef& bNode = trunkB.subNodes[b];
+			bool bIsTrunk = bNode.isTrunkNode();
+
+			if(aIsTrunk) {
+				if(bIsTrunk) {
+					forEachColissionBetweenRecursive<Boundable, SIMDHelper, Func>(aNode.asTrunk(), aNode.getTrunkSize(), bNode.asTrunk(), bNode.getTrunkSize(), offsetOfB, func);
+				} else {
+					// bring the bounds of b into the space of a
+					forEachColissionWithRecursive<Boundable, SIMDHelper, Func>(aNode.asTrunk(), aNode.getTrunkSize(), static_cast<Boundable*>(bNode.asObject()), offsetTreeBounds(trunkB.getBoundsOfSubNode(b), offsetOfB), func);
+				}
+			} else {
+				if(bIsTrunk) {
+					// bring the bounds of a into the space of b
+					forEachColissionWithRecursive<Boundable, SIMDHelper, Func>(static_cast<Boundable*>(aNode.asObject()), offsetTreeBounds(trunkA.getBoundsOfSubNode(a), -offsetOfB), bNode.asTrunk(), bNode.getTrunkSize(), func);
+				} else {
+					func(static_cast<Boundable*>(aNode.asObject()), static_cast<Boundable*>(bNode.asObject()));
+				}
+			}
+		}
+	}
+}
+
 // expects a function of the form void(Boundable*, Boundable*)
 // Calls the given function for each pair of leaf nodes that are not in the same group and have overlapping bounds
 template<typename Boundable, typename SIMDHelper, typename Func>
@@ -574,6 +681,24 @@ public:
 	}
 };
 
+/*
+	Flat image of the structure of a tree, used to store trees in files
+	Trunk 0 is the base trunk, every other trunk comes after the trunk that references it
+	Objects are replaced by indices handed out by the user of the image, bounds are not part of the image
+*/
+struct TreeImageTrunk {
+	static constexpr std::uint32_t TRUNK_FLAG = 1;
+	static constexpr std::uint32_t GROUP_HEAD_FLAG = 2;
+	static constexpr int INDEX_SHIFT = 2;
+
+	std::uint32_t size;
+	// (index << INDEX_SHIFT) | flags, index is a trunk index if TRUNK_FLAG is set, else an object index
+	std::uint32_t subNodes[BRANCH_FACTOR];
+};
+
+// checks that the image describes a proper tree, with all object indices below objectCount
+bool isValidTreeImage(const TreeImageTrunk* trunks, std::size_t trunkCount, std::size_t objectCount);
+
 class BoundsTreePrototype {
 	TreeTrunk baseTrunk;
 	int baseTrunkSize;
@@ -707,6 +832,60 @@ public:
 	inline void improveStructure() {/*TODO*/}
 	inline void maxImproveStructure() {/*TODO*/ }
 
+	// expects a function of the form std::uint32_t(const void* object)
+	template<typename GetObjectIndex>
+	std::vector<TreeImageTrunk> getImage(const GetObjectIndex& getObjectIndex) const {
+		std::vector<TreeImageTrunk> image;
+		std::vector<const TreeTrunk*> trunksOfImage;
+		image.push_back(TreeImageTrunk{static_cast<std::uint32_t>(this->baseTrunkSize), {}});
+		trunksOfImage.push_back(&this->baseTrunk);
+		// image grows while it is walked, so every trunk is visited after its parent
+		for(std::size_t t = 0; t < image.size(); t++) {
+			const TreeTrunk& trunk = *trunksOfImage[t];
+			for(std::uint32_t i = 0; i < image[t].size; i++) {
+				const TreeNodeRef& subNode = trunk.subNodes[i];
+				if(subNode.isTrunkNode()) {
+					std::uint32_t flags = TreeImageTrunk::TRUNK_FLAG | (subNode.isGroupHead() ? TreeImageTrunk::GROUP_HEAD_FLAG : 0);
+					image[t].subNodes[i] = (static_cast<std::uint32_t>(image.size()) << TreeImageTrunk::INDEX_SHIFT) | flags;
+					image.push_back(TreeImageTrunk{static_cast<std::uint32_t>(subNode.getTrunkSize()), {}});
+					trunksOfImage.push_back(&subNode.asTrunk());
+				} else {
+					image[t].subNodes[i] = getObjectIndex(static_cast<const void*>(subNode.asObject())) << TreeImageTrunk::INDEX_SHIFT;
+				}
+			}
+		}
+		return image;
+	}
+
+	/*
+		Replaces the contents of this tree with the given image, which must pass isValidTreeImage
+		expects a function of the form void*(std::uint32_t objectIndex)
+		The bounds of the loaded tree are left uninitialized, they must be recalculated by the caller
+	*/
+	template<typename GetObjectForIndex>
+	void loadImage(const TreeImageTrunk* trunks, std::size_t trunkCount, const GetObjectForIndex& getObjectForIndex) {
+		this->clear();
+		if(trunkCount == 0) return;
+
+		std::vector<TreeTrunk*> loadedTrunks(trunkCount);
+		loadedTrunks[0] = &this->baseTrunk;
+		for(std::size_t t = 1; t < trunkCount; t++) {
+			loadedTrunks[t] = this->allocator.allocTrunk();
+		}
+		for(std::size_t t = 0; t < trunkCount; t++) {
+			for(std::uint32_t i = 0; i < trunks[t].size; i++) {
+				std::uint32_t subNode = trunks[t].subNodes[i];
+				std::uint32_t index = subNode >> TreeImageTrunk::INDEX_SHIFT;
+				if(subNode & TreeImageTrunk::TRUNK_FLAG) {
+					loadedTrunks[t]->subNodes[i] = TreeNodeRef(loadedTrunks[index], static_cast<int>(trunks[index].size), (subNode & TreeImageTrunk::GROUP_HEAD_FLAG) != 0);
+				} else {
+					loadedTrunks[t]->subNodes[i] = TreeNodeRef(getObjectForIndex(index));
+				}
+			}
+		}
+		this->baseTrunkSize = static_cast<int>(trunks[0].size);
+	}
+
 	BoundsTreeIteratorPrototype begin() const { return BoundsTreeIteratorPrototype(baseTrunk, baseTrunkSize); }
 	IteratorEnd end() const { return IteratorEnd(); }
 
@@ -726,24 +905,24 @@ public:
 };
 
 template<typename Boundable>
-void recalculateBoundsRecursive(TreeTrunk& curTrunk, int curTrunkSize) {
+void recalculateBoundsRecursive(TreeTrunk& curTrunk, int curTrunkSize, const Position& treeOrigin) {
 	for(int i = 0; i < curTrunkSize; i++) {
 		TreeNodeRef& subNode = curTrunk.subNodes[i];
 
 		if(subNode.isTrunkNode()) {
 			TreeTrunk& subTrunk = subNode.asTrunk();
 			int subTrunkSize = subNode.getTrunkSize();
-			recalculateBoundsRecursive<Boundable>(subTrunk, subTrunkSize);
+			recalculateBoundsRecursive<Boundable>(subTrunk, subTrunkSize, treeOrigin);
 			curTrunk.setBoundsOfSubNode(i, TrunkSIMDHelperFallback::getTotalBounds(subTrunk, subTrunkSize));
 		} else {
 			Boundable* object = static_cast<Boundable*>(subNode.asObject());
-			curTrunk.setBoundsOfSubNode(i, object->getBounds());
+			curTrunk.setBoundsOfSubNode(i, toTreeBounds(object->getBounds(), treeOrigin));
 		}
 	}
 }
 
 template<typename Boundable>
-bool updateGroupBoundsRecursive(TreeTrunk& curTrunk, int curTrunkSize, const Boundable* groupRep, const BoundsTemplate<float>& originalGroupRepBounds) {
+bool updateGroupBoundsRecursive(TreeTrunk& curTrunk, int curTrunkSize, const Boundable* groupRep, const BoundsTemplate<float>& originalGroupRepBounds, const Position& treeOrigin) {
 	assert(curTrunkSize >= 0 && curTrunkSize <= BRANCH_FACTOR);
 	std::array<bool, BRANCH_FACTOR> couldContain = TrunkSIMDHelperFallback::getAllContainsBounds(curTrunk, originalGroupRepBounds);
 	for(int i = 0; i < curTrunkSize; i++) {
@@ -755,19 +934,19 @@ bool updateGroupBoundsRecursive(TreeTrunk& curTrunk, int curTrunkSize, const Bou
 			int subTrunkSize = subNode.getTrunkSize();
 			if(subNode.isGroupHead()) {
 				if(containsObjectRecursive(subTrunk, subTrunkSize, groupRep, originalGroupRepBounds)) {
-					recalculateBoundsRecursive<Boundable>(subTrunk, subTrunkSize);
+					recalculateBoundsRecursive<Boundable>(subTrunk, subTrunkSize, treeOrigin);
 					curTrunk.setBoundsOfSubNode(i, TrunkSIMDHelperFallback::getTotalBounds(subTrunk, subTrunkSize));
 					return true;
 				}
 			} else {
-				if(updateGroupBoundsRecursive<Boundable>(subTrunk, subTrunkSize, groupRep, originalGroupRepBounds)) {
+				if(updateGroupBoundsRecursive<Boundable>(subTrunk, subTrunkSize, groupRep, originalGroupRepBounds, treeOrigin)) {
 					curTrunk.setBoundsOfSubNode(i, TrunkSIMDHelperFallback::getTotalBounds(subTrunk, subTrunkSize));
 					return true;
 				}
 			}
 		} else {
 			if(subNode.asObject() == groupRep) {
-				curTrunk.setBoundsOfSubNode(i, groupRep->getBounds());
+				curTrunk.setBoundsOfSubNode(i, toTreeBounds(groupRep->getBounds(), treeOrigin));
 				return true;
 			}
 		}
@@ -788,21 +967,46 @@ public:
 	bool operator!=(IteratorEnd) const { return iter != IteratorEnd{}; }
 };
 
+/*
+	A BoundsTree of objects that provide their own bounds through BoundsTemplate<float> getBounds() or Bounds getBounds(), in absolute coordinates
+
+	The tree stores all bounds as floats relative to its origin, see toTreeBounds
+	For large worlds, objects should be placed in trees with a nearby origin, all bounds handed to and from the tree are kept absolute
+*/
 template<typename Boundable>
 class BoundsTree {
 	BoundsTreePrototype tree;
+	Position origin;
 
 public:
+	BoundsTree() : tree(), origin() {}
+	explicit BoundsTree(const Position& origin) : tree(), origin(origin) {}
+
 	inline const BoundsTreePrototype& getPrototype() const { return tree; }
 	inline BoundsTreePrototype& getPrototype() { return tree; }
 
+	inline const Position& getOrigin() const { return origin; }
+	// moves the origin of this tree, all bounds in the tree are recomputed relative to the new origin
+	void setOrigin(const Position& newOrigin) {
+		this->origin = newOrigin;
+		this->recalculateBounds();
+	}
+
+	inline BoundsTemplate<float> toTreeBounds(const Bounds& absoluteBounds) const {
+		return P3D::NewBoundsTree::toTreeBounds(absoluteBounds, this->origin);
+	}
+	inline BoundsTemplate<float> getTreeBoundsOf(const Boundable* object) const {
+		return P3D::NewBoundsTree::toTreeBounds(object->getBounds(), this->origin);
+	}
+
 	template<typename BoundableIter>
 	struct BoundableIteratorAdapter {
 		BoundableIter iter;
+		const BoundsTree* owner;
 
 		std::pair<const void*, BoundsTemplate<float>> operator*() const {
 			const Boundable* item = *iter;
-			return std::pair<const void*, BoundsTemplate<float>>(static_cast<const void*>(item), item->getBounds());
+			return std::pair<const void*, BoundsTemplate<float>>(static_cast<const void*>(item), owner->getTreeBoundsOf(item));
 		}
 		BoundableIteratorAdapter& operator++() {
 			++iter;
@@ -815,24 +1019,24 @@ public:
 	};
 
 	void add(Boundable* newObject) {
-		tree.add(static_cast<void*>(newObject), newObject->getBounds());
+		tree.add(static_cast<void*>(newObject), getTreeBoundsOf(newObject));
 	}
 	void remove(const Boundable* objectToRemove) {
-		tree.remove(static_cast<const void*>(objectToRemove), objectToRemove->getBounds());
+		tree.remove(static_cast<const void*>(objectToRemove), getTreeBoundsOf(objectToRemove));
 	}
 	void addToGroup(Boundable* newObject, const Boundable* groupRepresentative) {
-		tree.addToGroup(static_cast<void*>(newObject), newObject->getBounds(), static_cast<const void*>(groupRepresentative), groupRepresentative->getBounds());
+		tree.addToGroup(static_cast<void*>(newObject), getTreeBoundsOf(newObject), static_cast<const void*>(groupRepresentative), getTreeBoundsOf(groupRepresentative));
 	}
 	template<typename BoundableIter, typename BoundableIterEnd>
 	void addAllToGroup(BoundableIter iter, const BoundableIterEnd& iterEnd, const Boundable* groupRep) {
 		if(!(iter != iterEnd)) return;
-		modifyGroupRecursive(tree.allocator, tree.baseTrunk, tree.baseTrunkSize, groupRep, groupRep->getBounds(), [this, &iter, &iterEnd](TreeNodeRef& groupNode, BoundsTemplate<float> groupBounds) {
+		modifyGroupRecursive(tree.allocator, tree.baseTrunk, tree.baseTrunkSize, groupRep, getTreeBoundsOf(groupRep), [this, &iter, &iterEnd](TreeNodeRef& groupNode, BoundsTemplate<float> groupBounds) {
 			if(groupNode.isLeafNode()) {
 				TreeTrunk* newTrunk = this->tree.allocator.allocTrunk();
 				newTrunk->setSubNode(0, std::move(groupNode), groupBounds);
 
 				Boundable* newObj = *iter;
-				BoundsTemplate<float> newObjBounds = newObj->getBounds();
+				BoundsTemplate<float> newObjBounds = this->getTreeBoundsOf(newObj);
 				newTrunk->setSubNode(1, TreeNodeRef(newObj), newObjBounds);
 
 				groupNode = TreeNodeRef(newTrunk, 2, true);
@@ -842,7 +1046,7 @@ public:
 			int curTrunkSize = groupNode.getTrunkSize();
 			while(iter != iterEnd) {
 				Boundable* curObj = *iter;
-				BoundsTemplate<float> curObjBounds = curObj->getBounds();
+				BoundsTemplate<float> curObjBounds = this->getTreeBoundsOf(curObj);
 
 				curTrunkSize = addRecursive(this->tree.allocator, trunk, curTrunkSize, TreeNodeRef(curObj), curObjBounds);
 
@@ -852,36 +1056,38 @@ public:
 		});
 	}
 	void mergeGroups(const Boundable* groupRepA, const Boundable* groupRepB) {
-		tree.mergeGroups(static_cast<const void*>(groupRepA), groupRepA->getBounds(), static_cast<const void*>(groupRepB), groupRepB->getBounds());
+		tree.mergeGroups(static_cast<const void*>(groupRepA), getTreeBoundsOf(groupRepA), static_cast<const void*>(groupRepB), getTreeBoundsOf(groupRepB));
 	}
 	bool contains(const Boundable* object) const {
-		return tree.contains(static_cast<const void*>(object), object->getBounds());
+		return tree.contains(static_cast<const void*>(object), getTreeBoundsOf(object));
 	}
 	bool groupContains(const Boundable* groupRep, const Boundable* object) const {
 		assert(this->contains(groupRep));
-		return tree.groupContains(static_cast<const void*>(groupRep), groupRep->getBounds(), static_cast<const void*>(object), object->getBounds());
+		return tree.groupContains(static_cast<const void*>(groupRep), getTreeBoundsOf(groupRep), static_cast<const void*>(object), getTreeBoundsOf(object));
 	}
-	void updateObjectBounds(const Boundable* object, const BoundsTemplate<float>& originalBounds) {
-		tree.updateObjectBounds(static_cast<const void*>(object), originalBounds, object->getBounds());
+	// originalBounds should be what object->getBounds() returned before the object was changed
+	void updateObjectBounds(const Boundable* object, const Bounds& originalBounds) {
+		tree.updateObjectBounds(static_cast<const void*>(object), toTreeBounds(originalBounds), getTreeBoundsOf(object));
 	}
-	void updateObjectGroupBounds(const Boundable* groupRep, const BoundsTemplate<float>& originalGroupRepBounds) {
-		bool success = updateGroupBoundsRecursive<Boundable>(tree.baseTrunk, tree.baseTrunkSize, groupRep, originalGroupRepBounds);
+	// originalGroupRepBounds should be what groupRep->getBounds() returned before the group was changed
+	void updateObjectGroupBounds(const Boundable* groupRep, const Bounds& originalGroupRepBounds) {
+		bool success = updateGroupBoundsRecursive<Boundable>(tree.baseTrunk, tree.baseTrunkSize, groupRep, toTreeBounds(originalGroupRepBounds), this->origin);
 		if(!success) throw "groupRep was not found in tree!";
 	}
 	// oldObject and newObject should have the same bounds
-	void findAndReplaceObject(const Boundable* oldObject, Boundable* newObject, const BoundsTemplate<float>& bounds) {
-		assert(this->tree.contains(oldObject, bounds));
-		tree.findAndReplaceObject(static_cast<const void*>(oldObject), static_cast<void*>(newObject), bounds);
+	void findAndReplaceObject(const Boundable* oldObject, Boundable* newObject, const Bounds& bounds) {
+		assert(this->tree.contains(oldObject, toTreeBounds(bounds)));
+		tree.findAndReplaceObject(static_cast<const void*>(oldObject), static_cast<void*>(newObject), toTreeBounds(bounds));
 	}
 	void disbandGroup(const Boundable* groupRep) {
 		assert(this->contains(groupRep));
-		tree.disbandGroup(static_cast<const void*>(groupRep), groupRep->getBounds());
+		tree.disbandGroup(static_cast<const void*>(groupRep), getTreeBoundsOf(groupRep));
 	}
 	size_t size() const {
 		return tree.size();
 	}
 	size_t groupSize(const Boundable* groupRep) const {
-		return tree.groupSize(static_cast<const void*>(groupRep), groupRep->getBounds());
+		return tree.groupSize(static_cast<const void*>(groupRep), getTreeBoundsOf(groupRep));
 	}
 	bool isEmpty() const {
 		return tree.isEmpty();
@@ -891,23 +1097,34 @@ public:
 	}
 
 	void transferGroupTo(const Boundable* groupRep, BoundsTree& destinationTree) {
-		tree.transferGroupTo(static_cast<const void*>(groupRep), groupRep->getBounds(), destinationTree.tree);
+		BoundsTemplate<float> groupRepBounds = getTreeBoundsOf(groupRep);
+		tree.transferGroupTo(static_cast<const void*>(groupRep), groupRepBounds, destinationTree.tree);
+		if(destinationTree.origin != this->origin) {
+			// the group was moved with the bounds of this tree
+			destinationTree.updateGroupFromStaleBounds(groupRep, groupRepBounds);
+		}
 	}
 
 	// the given iterator should return objects of type Boundable*
 	template<typename GroupIter, typename GroupIterEnd>
 	void transferSplitGroupTo(GroupIter&& iter, const GroupIterEnd& iterEnd, BoundsTree& destinationTree) {
-		tree.transferSplitGroupTo(BoundableIteratorAdapter<GroupIter>{std::move(iter)}, iterEnd, destinationTree.tree);
+		if(!(iter != iterEnd)) return;
+		const Boundable* newGroupRep = *iter;
+		BoundsTemplate<float> newGroupRepBounds = getTreeBoundsOf(newGroupRep);
+		tree.transferSplitGroupTo(BoundableIteratorAdapter<GroupIter>{std::move(iter), this}, iterEnd, destinationTree.tree);
+		if(destinationTree.origin != this->origin) {
+			// the group was moved with the bounds of this tree
+			destinationTree.updateGroupFromStaleBounds(newGroupRep, newGroupRepBounds);
+		}
 	}
 
 	void transferTo(Boundable* obj, BoundsTree& destinationTree) {
-		BoundsTemplate<float> bounds = obj->getBounds();
-		tree.remove(static_cast<void*>(obj), bounds);
-		destinationTree.tree.add(static_cast<void*>(obj), bounds);
+		tree.remove(static_cast<void*>(obj), getTreeBoundsOf(obj));
+		destinationTree.tree.add(static_cast<void*>(obj), destinationTree.getTreeBoundsOf(obj));
 	}
 
 	void moveOutOfGroup(Boundable* obj) {
-		BoundsTemplate<float> bounds = obj->getBounds();
+		BoundsTemplate<float> bounds = getTreeBoundsOf(obj);
 		tree.remove(static_cast<void*>(obj), bounds);
 		tree.add(static_cast<void*>(obj), bounds);
 	}
@@ -915,7 +1132,7 @@ public:
 	// the given iterator should return objects of type Boundable*
 	template<typename GroupIter, typename GroupIterEnd>
 	void splitGroup(GroupIter iter, const GroupIterEnd& iterEnd) {
-		tree.splitGroup(BoundableIteratorAdapter<GroupIter>{std::move(iter)}, iterEnd);
+		tree.splitGroup(BoundableIteratorAdapter<GroupIter>{std::move(iter), this}, iterEnd);
 	}
 
 	// expects a function of the form void(Boundable& object)
@@ -926,8 +1143,8 @@ public:
 
 	// expects a function of the form void(Boundable& object)
 	template<typename Func>
-	void forEachInGroup(const void* groupRepresentative, const BoundsTemplate<float>& groupRepBounds, const Func& func) const {
-		const TreeNodeRef* group = getGroupRecursive(this->tree.baseTrunk, this->tree.baseTrunkSize, groupRepresentative, groupRepBounds);
+	void forEachInGroup(const Boundable* groupRepresentative, const Func& func) const {
+		const TreeNodeRef* group = getGroupRecursive(this->tree.baseTrunk, this->tree.baseTrunkSize, groupRepresentative, getTreeBoundsOf(groupRepresentative));
 		if(group == nullptr) {
 			throw "Group not found!";
 		}
@@ -941,31 +1158,72 @@ public:
 	BoundableCastIterator<Boundable, BoundsTreeIteratorPrototype> begin() const { return BoundableCastIterator<Boundable, BoundsTreeIteratorPrototype>(this->tree.begin()); }
 	IteratorEnd end() const { return IteratorEnd(); }
 
+	/*
+		Filters are given in absolute coordinates, and must provide Filter relativeTo(const Position& treeOrigin) const
+		which returns the same filter expressed relative to the origin of the tree it is run on
+	*/
 	template<typename Filter>
 	IteratorFactoryWithEnd<BoundableCastIterator<Boundable, FilteredTreeIteratorPrototype<Filter>>> iterFiltered(const Filter& filter) const { 
 		return IteratorFactoryWithEnd<BoundableCastIterator<Boundable, FilteredTreeIteratorPrototype<Filter>>>{
 			BoundableCastIterator<Boundable, FilteredTreeIteratorPrototype<Filter>>(
-				FilteredTreeIteratorPrototype<Filter>(this->tree.baseTrunk, this->tree.baseTrunkSize, filter)
+				FilteredTreeIteratorPrototype<Filter>(this->tree.baseTrunk, this->tree.baseTrunkSize, filter.relativeTo(this->origin))
 			)
 		};
 	}
 
+	// expects a filter of the form std::array<bool, BRANCH_FACTOR>(const TreeTrunk& trunk, int trunkSize), as described for iterFiltered, and a function of the form void(Boundable& object)
+	template<typename Filter, typename Func>
+	void forEachFiltered(const Filter& filter, const Func& func) const {
+		if(this->tree.baseTrunkSize == 0) return;
+		Filter relativeFilter = filter.relativeTo(this->origin);
+		forEachFilteredRecurse<Boundable, Filter, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, relativeFilter, func);
+	}
+
 	template<typename Func>
 	void forEachColission(const Func& func) const {
 		forEachColissionInternalRecursive<Boundable, TrunkSIMDHelperFallback, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, func);
 	}
 
+	// trees with different origins are compared with the bounds of other offset and rounded outward to float, so trees that interact should have nearby origins
 	template<typename Func>
 	void forEachColissionWith(const BoundsTree& other, const Func& func) const {
-		forEachColissionBetweenRecursive<Boundable, TrunkSIMDHelperFallback, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, other.tree.baseTrunk, other.tree.baseTrunkSize, func);
+		if(this->origin == other.origin) {
+			forEachColissionBetweenRecursive<Boundable, TrunkSIMDHelperFallback, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, other.tree.baseTrunk, other.tree.baseTrunkSize, func);
+		} else {
+			Vec3 offsetOfOther(other.origin - this->origin);
+			forEachColissionBetweenRecursive<Boundable, TrunkSIMDHelperFallback, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, other.tree.baseTrunk, other.tree.baseTrunkSize, offsetOfOther, func);
+		}
 	}
 
 	void recalculateBounds() {
-		recalculateBoundsRecursive<Boundable>(this->tree.baseTrunk, this->tree.baseTrunkSize);
+		recalculateBoundsRecursive<Boundable>(this->tree.baseTrunk, this->tree.baseTrunkSize, this->origin);
+	}
+
+	// expects a function of the form std::uint32_t(const Boundable& object)
+	template<typename GetObjectIndex>
+	std::vector<TreeImageTrunk> getImage(const GetObjectIndex& getObjectIndex) const {
+		return tree.getImage([&getObjectIndex](const void* object) -> std::uint32_t {
+			return getObjectIndex(*static_cast<const Boundable*>(object));
+		});
+	}
+
+	// replaces the contents of this tree with the given image, see BoundsTreePrototype::loadImage. Expects a function of the form Boundable*(std::uint32_t objectIndex)
+	template<typename GetObjectForIndex>
+	void loadImage(const TreeImageTrunk* trunks, std::size_t trunkCount, const GetObjectForIndex& getObjectForIndex) {
+		tree.loadImage(trunks, trunkCount, [&getObjectForIndex](std::uint32_t objectIndex) -> void* {
+			return static_cast<void*>(getObjectForIndex(objectIndex));
+		});
+		this->recalculateBounds();
 	}
 
 	void improveStructure() {/*TODO*/ }
 	void maxImproveStructure() {/*TODO*/ }
+
+private:
+	void updateGroupFromStaleBounds(const Boundable* groupRep, const BoundsTemplate<float>& staleGroupRepBounds) {
+		bool success = updateGroupBoundsRecursive<Boundable>(tree.baseTrunk, tree.baseTrunkSize, groupRep, staleGroupRepBounds, this->origin);
+		if(!success) throw "groupRep was not found in tree!";
+	}
 };
 
 struct BasicBounded {
@@ -1,4 +1,4 @@
-#include "boundsTree.h"
+#include "boundsTreeOld.h"
 
 #include "buffers.h"
 
@@ -334,6 +334,21 @@ public:
 		return T(total / limit);
 	}
 
+	inline T max() const {
+		size_t limit = size();
+
+		if (limit == 0)
+			return T();
+
+		T result = buf[0];
+
+		for (size_t i = 1; i < limit; i++)
+			if (buf[i] > result)
+				result = buf[i];
+
+		return result;
+	}
+
 	inline void resize(size_t newCapacity) {
 		T* newBuf = new T[newCapacity];
 
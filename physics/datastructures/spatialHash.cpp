@@ -0,0 +1,65 @@
+#include "spatialHash.h"
+
+#include <cmath>
+#include <algorithm>
+
+static std::int32_t getCell(float coord, float cellSize) {
+	return static_cast<std::int32_t>(std::floor(coord / cellSize));
+}
+
+std::uint32_t SpatialHash::getBucket(std::int32_t cellX, std::int32_t cellY, std::int32_t cellZ) const {
+	std::uint32_t hash = static_cast<std::uint32_t>(cellX) * 73856093u ^ static_cast<std::uint32_t>(cellY) * 19349663u ^ static_cast<std::uint32_t>(cellZ) * 83492791u;
+	return hash & bucketMask;
+}
+
+void SpatialHash::getNeighborBuckets(const SpatialHashItem& item, std::uint32_t (&buckets)[27], int& bucketCount) const {
+	std::int32_t cellX = getCell(item.bounds.min.x, cellSize);
+	std::int32_t cellY = getCell(item.bounds.min.y, cellSize);
+	std::int32_t cellZ = getCell(item.bounds.min.z, cellSize);
+
+	bucketCount = 0;
+	for(std::int32_t dx = -1; dx <= 1; dx++) {
+		for(std::int32_t dy = -1; dy <= 1; dy++) {
+			for(std::int32_t dz = -1; dz <= 1; dz++) {
+				std::uint32_t bucket = getBucket(cellX + dx, cellY + dy, cellZ + dz);
+				// different cells may share a bucket, each bucket must only be visited once
+				if(std::find(buckets, buckets + bucketCount, bucket) == buckets + bucketCount) {
+					buckets[bucketCount++] = bucket;
+				}
+			}
+		}
+	}
+}
+
+void SpatialHash::build(std::vector<SpatialHashItem>&& newItems) {
+	float maxExtent = 0.0f;
+	for(const SpatialHashItem& item : newItems) {
+		Vec3f diagonal = item.bounds.getDiagonal();
+		maxExtent = std::max(maxExtent, std::max(diagonal.x, std::max(diagonal.y, diagonal.z)));
+	}
+	// slightly larger than any object, so that rounding in getCell can never put overlapping objects more than one cell apart
+	this->cellSize = (maxExtent > 0.0f) ? maxExtent * 1.001f : 1.0f;
+
+	std::size_t bucketCount = 1;
+	while(bucketCount < newItems.size() * 2) bucketCount *= 2;
+	this->bucketMask = static_cast<std::uint32_t>(bucketCount - 1);
+
+	// counting sort of the items by bucket
+	std::vector<std::uint32_t> itemBuckets(newItems.size());
+	bucketStarts.assign(bucketCount + 1, 0);
+	for(std::size_t i = 0; i < newItems.size(); i++) {
+		const BoundsTemplate<float>& bounds = newItems[i].bounds;
+		std::uint32_t bucket = getBucket(getCell(bounds.min.x, cellSize), getCell(bounds.min.y, cellSize), getCell(bounds.min.z, cellSize));
+		itemBuckets[i] = bucket;
+		bucketStarts[bucket + 1]++;
+	}
+	for(std::size_t b = 0; b < bucketCount; b++) {
+		bucketStarts[b + 1] += bucketStarts[b];
+	}
+	std::vector<std::uint32_t> insertAt(bucketStarts.begin(), bucketStarts.end() - 1);
+	items.resize(newItems.size());
+	for(std::size_t i = 0; i < newItems.size(); i++) {
+		items[insertAt[itemBuckets[i]]++] = newItems[i];
+	}
+	newItems.clear();
+}
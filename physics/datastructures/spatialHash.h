@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../math/bounds.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct SpatialHashItem {
+	BoundsTemplate<float> bounds;
+	void* object;
+	// items of the same group never collide with each other
+	int group;
+};
+
+/*
+	Uniform grid broadphase, meant for large numbers of objects of similar size, such as debris or granular material
+
+	The cell size is the largest extent of any object, every object is stored in the cell of its min corner
+	An object can then only overlap objects in the 3x3x3 cells around its own cell
+	Cells are hashed into a table of buckets, colliding cells only cause extra candidates, which are removed by the bounds test
+
+	After build, forEachColissionOf may be called from multiple threads at once
+*/
+class SpatialHash {
+	float cellSize;
+	std::uint32_t bucketMask;
+	// items, sorted by bucket
+	std::vector<SpatialHashItem> items;
+	// items of bucket b are at bucketStarts[b] .. bucketStarts[b+1]
+	std::vector<std::uint32_t> bucketStarts;
+
+	std::uint32_t getBucket(std::int32_t cellX, std::int32_t cellY, std::int32_t cellZ) const;
+	void getNeighborBuckets(const SpatialHashItem& item, std::uint32_t (&buckets)[27], int& bucketCount) const;
+
+public:
+	SpatialHash() : cellSize(1.0f), bucketMask(0) {}
+
+	void build(std::vector<SpatialHashItem>&& newItems);
+
+	inline std::size_t size() const { return items.size(); }
+
+	// expects a function of the form void(void* a, void* b)
+	// Calls func for each overlapping pair of objects from different groups, where a is item itemIndex, and the other item has a higher index. So every pair is found exactly once over all items
+	template<typename Func>
+	void forEachColissionOf(std::size_t itemIndex, const Func& func) const {
+		const SpatialHashItem& item = items[itemIndex];
+		std::uint32_t buckets[27];
+		int bucketCount;
+		getNeighborBuckets(item, buckets, bucketCount);
+		for(int i = 0; i < bucketCount; i++) {
+			std::uint32_t bucket = buckets[i];
+			std::size_t start = bucketStarts[bucket];
+			if(start <= itemIndex) start = itemIndex + 1;
+			std::size_t end = bucketStarts[bucket + 1];
+			for(std::size_t other = start; other < end; other++) {
+				const SpatialHashItem& otherItem = items[other];
+				if(otherItem.group != item.group && intersects(item.bounds, otherItem.bounds)) {
+					func(item.object, otherItem.object);
+				}
+			}
+		}
+	}
+};
@@ -4,8 +4,11 @@
 #include <math.h>
 
 #include "shapeCreation.h"
+#include "convexHull.h"
 #include "../misc/shapeLibrary.h"
 
+#include <algorithm>
+
 
 CubeClass::CubeClass() : ShapeClass(8, Vec3(0, 0, 0), ScalableInertialMatrix(Vec3(8.0 / 3.0, 8.0 / 3.0, 8.0 / 3.0), Vec3(0, 0, 0)), CUBE_CLASS_ID) {}
 
@@ -95,6 +98,10 @@ BoundingBox SphereClass::getBounds(const Rotation& rotation, const DiagonalMat3&
 	return BoundingBox{-s, -s, -s, s, s, s};
 }
 
+BoundingBox SphereClass::getConservativeBounds(const Rotation& rotation, const DiagonalMat3& scale) const {
+	return this->getBounds(rotation, scale);
+}
+
 double SphereClass::getScaledMaxRadiusSq(DiagonalMat3 scale) const {
 	return scale[0] * scale[0];
 }
@@ -205,6 +212,10 @@ BoundingBox CylinderClass::getBounds(const Rotation& rotation, const DiagonalMat
 	return BoundingBox{-x, -y, -z, x, y, z};
 }
 
+BoundingBox CylinderClass::getConservativeBounds(const Rotation& rotation, const DiagonalMat3& scale) const {
+	return this->getBounds(rotation, scale);
+}
+
 double CylinderClass::getScaledMaxRadiusSq(DiagonalMat3 scale) const {
 	return scale[0] * scale[0] + scale[2] * scale[2];
 }
@@ -232,6 +243,7 @@ void CylinderClass::setScaleY(double newY, DiagonalMat3& scale) const {
 }
 
 PolyhedronShapeClass::PolyhedronShapeClass(Polyhedron&& poly) : poly(poly), ShapeClass(poly.getVolume(), poly.getCenterOfMass(), poly.getScalableInertiaAroundCenterOfMass(), CONVEX_POLYHEDRON_CLASS_ID) {}
+PolyhedronShapeClass::PolyhedronShapeClass(Polyhedron&& poly, double volume, Vec3 centerOfMass, ScalableInertialMatrix inertia) : poly(std::move(poly)), ShapeClass(volume, centerOfMass, inertia, CONVEX_POLYHEDRON_CLASS_ID) {}
 
 bool PolyhedronShapeClass::containsPoint(Vec3 point) const {
 	return poly.containsPoint(point);
@@ -255,6 +267,61 @@ Polyhedron PolyhedronShapeClass::asPolyhedron() const {
 	return poly;
 }
 
+void PolyhedronShapeClass::buildDetailLevels(const int* maxVertexCounts, int count) {
+	std::vector<Vec3f> vertices;
+	for(Vec3f vertex : poly.iterVertices()) vertices.push_back(vertex);
+
+	int previousVertexCount = poly.vertexCount;
+	for(int i = 0; i < count; i++) {
+		if(maxVertexCounts[i] >= previousVertexCount || maxVertexCounts[i] < 4) continue;
+
+		Polyhedron hull = convexHull(vertices.data(), vertices.size(), maxVertexCounts[i]);
+		if(hull.vertexCount == 0) continue;
+
+		// the hull is made of vertices of the polyhedron, so it lies inside it. It's grown around its center until it contains all vertices
+		Vec3f center(0.0f, 0.0f, 0.0f);
+		for(Vec3f vertex : hull.iterVertices()) center += vertex;
+		center = center / float(hull.vertexCount);
+
+		float factor = 1.0f;
+		for(Triangle t : hull.iterTriangles()) {
+			Vec3f a = hull.getVertex(t[0]);
+			Vec3f normal = normalize((hull.getVertex(t[1]) - a) % (hull.getVertex(t[2]) - a));
+			float centerDistance = (a - center) * normal;
+			if(!(centerDistance > 0.0f)) continue;
+			for(const Vec3f& vertex : vertices) {
+				factor = std::max(factor, ((vertex - center) * normal) / centerDistance);
+			}
+		}
+
+		std::vector<Vec3f> grownVertices;
+		std::vector<Triangle> triangles;
+		float radius = 0.0f;
+		for(Vec3f vertex : hull.iterVertices()) {
+			grownVertices.push_back(center + (vertex - center) * factor);
+			radius = std::max(radius, length(vertex - center));
+		}
+		for(Triangle t : hull.iterTriangles()) triangles.push_back(t);
+
+		/*
+			Growing by factor moves the support point of the hull in any direction out by at most (factor - 1) * radius,
+			and the ungrown hull lies inside the polyhedron, so that is how far the grown hull can stick out
+		*/
+		detailLevels.emplace_back(Polyhedron(grownVertices.data(), triangles.data(), hull.vertexCount, hull.triangleCount), (factor - 1.0f) * radius);
+		previousVertexCount = hull.vertexCount;
+	}
+}
+
+const GenericCollidable& PolyhedronShapeClass::getDetailLevel(int level) const {
+	if(level <= 0 || detailLevels.empty()) return *this;
+	return detailLevels[std::min(level, getDetailLevelCount() - 1) - 1];
+}
+
+float PolyhedronShapeClass::getDetailLevelError(int level) const {
+	if(level <= 0 || detailLevels.empty()) return 0.0f;
+	return detailLevels[std::min(level, getDetailLevelCount() - 1) - 1].error;
+}
+
 BoundingBox PolyhedronShapeClassAVX::getBounds(const Rotation& rotation, const DiagonalMat3& scale) const {
 	return poly.getBoundsAVX(Mat3f(rotation.asRotationMatrix() * scale));
 }
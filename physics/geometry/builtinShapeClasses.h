@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "polyhedron.h"
 #include "shapeClass.h"
 
@@ -30,6 +32,7 @@ public:
 	virtual bool containsPoint(Vec3 point) const;
 	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const;
 	virtual BoundingBox getBounds(const Rotation& rotation, const DiagonalMat3& scale) const;
+	virtual BoundingBox getConservativeBounds(const Rotation& rotation, const DiagonalMat3& scale) const override;
 	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const;
 	virtual double getScaledMaxRadius(DiagonalMat3 scale) const;
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const;
@@ -48,6 +51,7 @@ public:
 	virtual bool containsPoint(Vec3 point) const;
 	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const;
 	virtual BoundingBox getBounds(const Rotation& rotation, const DiagonalMat3& scale) const;
+	virtual BoundingBox getConservativeBounds(const Rotation& rotation, const DiagonalMat3& scale) const override;
 	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const;
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const;
 	virtual Polyhedron asPolyhedron() const;
@@ -59,10 +63,40 @@ public:
 
 
 class PolyhedronShapeClass : public ShapeClass {
+public:
+	/*
+		A hull of the polyhedron with fewer vertices, for colissions that don't need the full shape
+		The hull contains the polyhedron and sticks out of it by at most error, in the -1..1 coordinates of the class
+	*/
+	struct DetailLevel : public GenericCollidable {
+		Polyhedron hull;
+		float error;
+
+		DetailLevel(Polyhedron&& hull, float error) : hull(std::move(hull)), error(error) {}
+		virtual Vec3f furthestInDirection(const Vec3f& direction) const override { return hull.furthestInDirection(direction); }
+	};
+
 protected:
 	Polyhedron poly;
+	// from fine to coarse, level 0 is the polyhedron itself and isn't stored
+	std::vector<DetailLevel> detailLevels;
+
 public:
 	PolyhedronShapeClass(Polyhedron&& poly);
+	// for polyhedra whose mass properties were computed before, such as those loaded from a mesh cache
+	PolyhedronShapeClass(Polyhedron&& poly, double volume, Vec3 centerOfMass, ScalableInertialMatrix inertia);
+
+	/*
+		Adds a coarser level of detail for every vertex count, each a hull of at most that many vertices
+		Counts must be decreasing, counts that wouldn't remove any vertices from the previous level are skipped
+	*/
+	void buildDetailLevels(const int* maxVertexCounts, int count);
+	int getDetailLevelCount() const { return static_cast<int>(detailLevels.size()) + 1; }
+	// the collidable for the given level, levels past the coarsest give the coarsest
+	const GenericCollidable& getDetailLevel(int level) const;
+	float getDetailLevelError(int level) const;
+
+	const Polyhedron& getPolyhedron() const { return poly; }
 
 	virtual bool containsPoint(Vec3 point) const override;
 	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const override;
@@ -0,0 +1,582 @@
+#include "convexDecomposition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+#include "convexHull.h"
+#include "shapeCreation.h"
+#include "../part.h"
+#include "../threading/threadPool.h"
+
+namespace {
+
+// hulls are built from voxel corners, which are whole numbers. Up to this resolution all products in ConvexShapeBuilder are exact in floats
+constexpr int MAX_RESOLUTION = 64;
+// the final hulls are built from points rounded to a lattice of this many steps along the longest side of their piece, which keeps them exact as well
+constexpr int HULL_LATTICE = 128;
+// the weight of the difference in size of the two halves of a split, so evenly sized halves are preferred over equally convex but uneven ones
+constexpr double BALANCE_WEIGHT = 0.05;
+
+enum VoxelState : std::uint8_t {
+	EMPTY = 0,
+	SURFACE = 1,
+	OUTSIDE = 2
+};
+
+struct Voxel {
+	int coords[3];
+};
+
+struct VoxelGrid {
+	int size[3];
+	std::vector<std::uint8_t> cells;
+	Vec3 origin;
+	double voxelSize;
+
+	std::size_t index(int x, int y, int z) const {
+		return (static_cast<std::size_t>(z) * size[1] + y) * size[0] + x;
+	}
+
+	// inside the mesh and not touching its surface
+	bool isInterior(int x, int y, int z) const {
+		if(x < 0 || y < 0 || z < 0 || x >= size[0] || y >= size[1] || z >= size[2]) return false;
+		return cells[index(x, y, z)] == EMPTY;
+	}
+};
+
+struct VoxelPiece {
+	std::vector<Voxel> voxels;
+	// the box the piece was cut out of by the split planes, the voxels are those of the mesh in it
+	int regionMin[3];
+	int regionMax[3];
+	// the bounds of the voxels
+	int min[3];
+	int max[3];
+	// in voxels
+	double hullVolume = 0.0;
+	double concavity = 0.0;
+	bool splittable = true;
+};
+
+struct SplitPlane {
+	int axis;
+	int position;
+};
+
+// separating axis test of a triangle against a voxel centered at the origin, the triangle is given relative to the center of the voxel
+bool triangleOverlapsVoxel(const Vec3 (&vertices)[3]) {
+	Vec3 edges[3]{vertices[1] - vertices[0], vertices[2] - vertices[1], vertices[0] - vertices[2]};
+
+	Vec3 normal = edges[0] % edges[1];
+	double planeRadius = 0.5 * (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+	if(std::abs(normal * vertices[0]) > planeRadius) return false;
+
+	for(const Vec3& edge : edges) {
+		for(int boxAxis = 0; boxAxis < 3; boxAxis++) {
+			Vec3 unit(0.0, 0.0, 0.0);
+			unit[boxAxis] = 1.0;
+			Vec3 axis = unit % edge;
+
+			double p0 = axis * vertices[0];
+			double p1 = axis * vertices[1];
+			double p2 = axis * vertices[2];
+			double radius = 0.5 * (std::abs(axis.x) + std::abs(axis.y) + std::abs(axis.z));
+			if(std::min(p0, std::min(p1, p2)) > radius || std::max(p0, std::max(p1, p2)) < -radius) return false;
+		}
+	}
+
+	return true;
+}
+
+VoxelGrid voxelize(const TriangleMesh& mesh, int resolution) {
+	VoxelGrid grid;
+	BoundingBox bounds = mesh.getBounds();
+	double longestSide = std::max(bounds.getWidth(), std::max(bounds.getHeight(), bounds.getDepth()));
+
+	grid.voxelSize = longestSide / resolution;
+	// one layer of empty voxels below the mesh, and at least one above, so the outside is connected
+	grid.origin = bounds.min - Vec3(grid.voxelSize, grid.voxelSize, grid.voxelSize);
+	for(int axis = 0; axis < 3; axis++) {
+		grid.size[axis] = static_cast<int>(std::ceil((bounds.max[axis] - bounds.min[axis]) / grid.voxelSize)) + 3;
+	}
+	grid.cells.assign(static_cast<std::size_t>(grid.size[0]) * grid.size[1] * grid.size[2], EMPTY);
+
+	std::vector<Vec3f> vertices(mesh.vertexCount);
+	std::vector<Triangle> triangles(mesh.triangleCount);
+	mesh.getVertices(vertices.data());
+	mesh.getTriangles(triangles.data());
+
+	for(const Triangle& triangle : triangles) {
+		Vec3 corners[3];
+		int low[3];
+		int high[3];
+		for(int i = 0; i < 3; i++) {
+			corners[i] = (Vec3(vertices[triangle[i]]) - grid.origin) / grid.voxelSize;
+		}
+		for(int axis = 0; axis < 3; axis++) {
+			double lowest = std::min(corners[0][axis], std::min(corners[1][axis], corners[2][axis]));
+			double highest = std::max(corners[0][axis], std::max(corners[1][axis], corners[2][axis]));
+			low[axis] = std::max(0, static_cast<int>(std::floor(lowest)));
+			high[axis] = std::min(grid.size[axis] - 1, static_cast<int>(std::floor(highest)));
+		}
+
+		for(int z = low[2]; z <= high[2]; z++) {
+			for(int y = low[1]; y <= high[1]; y++) {
+				for(int x = low[0]; x <= high[0]; x++) {
+					std::uint8_t& cell = grid.cells[grid.index(x, y, z)];
+					if(cell == SURFACE) continue;
+
+					Vec3 center(x + 0.5, y + 0.5, z + 0.5);
+					Vec3 relative[3]{corners[0] - center, corners[1] - center, corners[2] - center};
+					if(triangleOverlapsVoxel(relative)) cell = SURFACE;
+				}
+			}
+		}
+	}
+
+	// everything the outside can't reach without crossing the surface is inside
+	std::vector<std::size_t> stack{grid.index(0, 0, 0)};
+	grid.cells[stack.back()] = OUTSIDE;
+	while(!stack.empty()) {
+		std::size_t current = stack.back();
+		stack.pop_back();
+
+		int x = static_cast<int>(current % grid.size[0]);
+		int y = static_cast<int>(current / grid.size[0] % grid.size[1]);
+		int z = static_cast<int>(current / grid.size[0] / grid.size[1]);
+		int neighbors[6][3]{{x - 1, y, z}, {x + 1, y, z}, {x, y - 1, z}, {x, y + 1, z}, {x, y, z - 1}, {x, y, z + 1}};
+		for(const int (&neighbor)[3] : neighbors) {
+			if(neighbor[0] < 0 || neighbor[1] < 0 || neighbor[2] < 0) continue;
+			if(neighbor[0] >= grid.size[0] || neighbor[1] >= grid.size[1] || neighbor[2] >= grid.size[2]) continue;
+
+			std::size_t neighborIndex = grid.index(neighbor[0], neighbor[1], neighbor[2]);
+			if(grid.cells[neighborIndex] != EMPTY) continue;
+
+			grid.cells[neighborIndex] = OUTSIDE;
+			stack.push_back(neighborIndex);
+		}
+	}
+
+	return grid;
+}
+
+/*
+	Builds the convex hull of a set of points with whole number coordinates
+	The buffers are kept between hulls, every thread uses its own builder
+*/
+class HullBuilder {
+	ConvexHullBuilder hull;
+
+public:
+	// returns false if the points don't span a volume
+	bool build(const std::vector<Vec3f>& points) {
+		return hull.build(points.data(), points.size());
+	}
+
+	double getVolume() const {
+		double volume = 0.0;
+		const Vec3f* vertices = hull.getVertices();
+		const Triangle* triangles = hull.getTriangles();
+		for(int i = 0; i < hull.getTriangleCount(); i++) {
+			Vec3 v0(vertices[triangles[i][0]]);
+			Vec3 v1(vertices[triangles[i][1]]);
+			Vec3 v2(vertices[triangles[i][2]]);
+			volume += v0 * (v1 % v2);
+		}
+
+		return volume / 6.0;
+	}
+
+	// vertices which ended up inside the hull are left out, the vertices are transformed to origin + vertex * scale
+	Polyhedron toPolyhedron(Vec3 origin, double scale) const {
+		const Vec3f* vertices = hull.getVertices();
+		const Triangle* triangles = hull.getTriangles();
+		int triangleCount = hull.getTriangleCount();
+		std::vector<int> newIndices(hull.getVertexCount(), -1);
+		std::vector<Vec3f> usedVertices;
+		std::vector<Triangle> usedTriangles(triangleCount);
+
+		for(int i = 0; i < triangleCount; i++) {
+			for(int j = 0; j < 3; j++) {
+				int vertex = triangles[i][j];
+				if(newIndices[vertex] == -1) {
+					newIndices[vertex] = static_cast<int>(usedVertices.size());
+					usedVertices.push_back(Vec3f(origin + Vec3(vertices[vertex]) * scale));
+				}
+				usedTriangles[i][j] = newIndices[vertex];
+			}
+		}
+
+		return Polyhedron(usedVertices.data(), usedTriangles.data(), static_cast<int>(usedVertices.size()), triangleCount);
+	}
+};
+
+// the corners of the voxels at both ends of every row of voxels along every axis, the hull of the piece only depends on those
+void getHullPoints(const VoxelPiece& piece, std::vector<Vec3f>& points) {
+	std::vector<std::uint64_t> keys;
+
+	for(int axis = 0; axis < 3; axis++) {
+		int b = (axis + 1) % 3;
+		int c = (axis + 2) % 3;
+		int sizeB = piece.max[b] - piece.min[b] + 1;
+		int sizeC = piece.max[c] - piece.min[c] + 1;
+
+		std::vector<int> low(static_cast<std::size_t>(sizeB) * sizeC, std::numeric_limits<int>::max());
+		std::vector<int> high(static_cast<std::size_t>(sizeB) * sizeC, std::numeric_limits<int>::min());
+		for(const Voxel& voxel : piece.voxels) {
+			std::size_t row = static_cast<std::size_t>(voxel.coords[c] - piece.min[c]) * sizeB + (voxel.coords[b] - piece.min[b]);
+			low[row] = std::min(low[row], voxel.coords[axis]);
+			high[row] = std::max(high[row], voxel.coords[axis] + 1);
+		}
+
+		for(int rowC = 0; rowC < sizeC; rowC++) {
+			for(int rowB = 0; rowB < sizeB; rowB++) {
+				std::size_t row = static_cast<std::size_t>(rowC) * sizeB + rowB;
+				if(low[row] > high[row]) continue;
+
+				for(int corner = 0; corner < 4; corner++) {
+					int coords[3];
+					coords[b] = piece.min[b] + rowB + (corner & 1);
+					coords[c] = piece.min[c] + rowC + (corner >> 1);
+					for(int end : {low[row], high[row]}) {
+						coords[axis] = end;
+						keys.push_back(static_cast<std::uint64_t>(coords[0]) | static_cast<std::uint64_t>(coords[1]) << 21 | static_cast<std::uint64_t>(coords[2]) << 42);
+					}
+				}
+			}
+		}
+	}
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	points.clear();
+	points.reserve(keys.size());
+	for(std::uint64_t key : keys) {
+		points.push_back(Vec3f(static_cast<float>(key & 0x1FFFFF), static_cast<float>(key >> 21 & 0x1FFFFF), static_cast<float>(key >> 42 & 0x1FFFFF)));
+	}
+}
+
+void computeBounds(VoxelPiece& piece) {
+	for(int axis = 0; axis < 3; axis++) {
+		piece.min[axis] = std::numeric_limits<int>::max();
+		piece.max[axis] = std::numeric_limits<int>::min();
+	}
+	for(const Voxel& voxel : piece.voxels) {
+		for(int axis = 0; axis < 3; axis++) {
+			piece.min[axis] = std::min(piece.min[axis], voxel.coords[axis]);
+			piece.max[axis] = std::max(piece.max[axis], voxel.coords[axis]);
+		}
+	}
+}
+
+void evaluate(VoxelPiece& piece, double totalVoxels, HullBuilder& builder, std::vector<Vec3f>& points) {
+	computeBounds(piece);
+	getHullPoints(piece, points);
+	piece.hullVolume = builder.build(points) ? builder.getVolume() : 0.0;
+	piece.concavity = std::max(0.0, piece.hullVolume - piece.voxels.size()) / totalVoxels;
+}
+
+void split(const VoxelPiece& piece, SplitPlane plane, VoxelPiece& below, VoxelPiece& above) {
+	for(int axis = 0; axis < 3; axis++) {
+		below.regionMin[axis] = above.regionMin[axis] = piece.regionMin[axis];
+		below.regionMax[axis] = above.regionMax[axis] = piece.regionMax[axis];
+	}
+	below.regionMax[plane.axis] = plane.position;
+	above.regionMin[plane.axis] = plane.position;
+
+	below.voxels.clear();
+	above.voxels.clear();
+	for(const Voxel& voxel : piece.voxels) {
+		if(voxel.coords[plane.axis] < plane.position) {
+			below.voxels.push_back(voxel);
+		} else {
+			above.voxels.push_back(voxel);
+		}
+	}
+}
+
+std::vector<SplitPlane> getSplitPlanes(const VoxelPiece& piece, int planesPerAxis) {
+	std::vector<SplitPlane> planes;
+	for(int axis = 0; axis < 3; axis++) {
+		int size = piece.max[axis] - piece.min[axis] + 1;
+		if(size < 2) continue;
+
+		int planeCount = std::min(planesPerAxis, size - 1);
+		int previous = piece.min[axis];
+		for(int i = 0; i < planeCount; i++) {
+			int position = piece.min[axis] + static_cast<int>(std::lround(static_cast<double>(i + 1) * size / (planeCount + 1)));
+			position = std::max(piece.min[axis] + 1, std::min(piece.max[axis], position));
+			if(position == previous) continue;
+
+			planes.push_back(SplitPlane{axis, position});
+			previous = position;
+		}
+	}
+
+	return planes;
+}
+
+// clips a convex polygon to the side of an axis aligned plane where the coordinate is above or below position
+void clipPolygon(std::vector<Vec3>& polygon, std::vector<Vec3>& buffer, int axis, double position, bool keepAbove) {
+	buffer.clear();
+	for(std::size_t i = 0; i < polygon.size(); i++) {
+		const Vec3& current = polygon[i];
+		const Vec3& next = polygon[(i + 1) % polygon.size()];
+		double currentDistance = keepAbove ? current[axis] - position : position - current[axis];
+		double nextDistance = keepAbove ? next[axis] - position : position - next[axis];
+
+		if(currentDistance >= 0) buffer.push_back(current);
+		if((currentDistance >= 0) != (nextDistance >= 0)) {
+			Vec3 crossing = current + (next - current) * (currentDistance / (currentDistance - nextDistance));
+			// exactly on the plane, whatever rounding did
+			crossing[axis] = position;
+			buffer.push_back(crossing);
+		}
+	}
+	polygon.swap(buffer);
+}
+
+/*
+	The hull of the part of the mesh in the region of the piece: the triangles clipped to the region,
+	and the corners of the region that are inside the mesh, which span the cuts through the mesh together with the clipped triangles
+	The points are given relative to the lowest corner of the region, in steps of 1 / latticeScale voxels
+	Returns false if the mesh has no volume in the region
+*/
+bool buildRegionHull(const VoxelPiece& piece, const VoxelGrid& grid, const std::vector<Vec3>& triangleCorners, HullBuilder& builder, std::vector<Vec3f>& points, double& latticeScale) {
+	int longestSide = 1;
+	for(int axis = 0; axis < 3; axis++) longestSide = std::max(longestSide, piece.regionMax[axis] - piece.regionMin[axis]);
+	latticeScale = static_cast<double>(HULL_LATTICE) / longestSide;
+
+	std::vector<std::uint64_t> keys;
+	auto addPoint = [&](const Vec3& point) {
+		std::uint64_t coords[3];
+		for(int axis = 0; axis < 3; axis++) {
+			long long coord = std::llround((point[axis] - piece.regionMin[axis]) * latticeScale);
+			coords[axis] = static_cast<std::uint64_t>(std::max(0LL, std::min(static_cast<long long>(HULL_LATTICE), coord)));
+		}
+		keys.push_back(coords[0] | coords[1] << 21 | coords[2] << 42);
+	};
+
+	std::vector<Vec3> polygon;
+	std::vector<Vec3> buffer;
+	for(std::size_t i = 0; i < triangleCorners.size(); i += 3) {
+		bool outside = false;
+		for(int axis = 0; axis < 3 && !outside; axis++) {
+			double lowest = std::min(triangleCorners[i][axis], std::min(triangleCorners[i + 1][axis], triangleCorners[i + 2][axis]));
+			double highest = std::max(triangleCorners[i][axis], std::max(triangleCorners[i + 1][axis], triangleCorners[i + 2][axis]));
+			outside = highest < piece.regionMin[axis] || lowest > piece.regionMax[axis];
+		}
+		if(outside) continue;
+
+		polygon.assign(triangleCorners.begin() + i, triangleCorners.begin() + i + 3);
+		for(int axis = 0; axis < 3 && !polygon.empty(); axis++) {
+			clipPolygon(polygon, buffer, axis, piece.regionMin[axis], true);
+			if(!polygon.empty()) clipPolygon(polygon, buffer, axis, piece.regionMax[axis], false);
+		}
+		for(const Vec3& point : polygon) addPoint(point);
+	}
+
+	// a corner of the region is inside the mesh if the voxels around it are. Near the surface that isn't certain, and the corner is left out
+	for(int corner = 0; corner < 8; corner++) {
+		int coords[3];
+		for(int axis = 0; axis < 3; axis++) coords[axis] = (corner >> axis & 1) ? piece.regionMax[axis] : piece.regionMin[axis];
+
+		bool inside = true;
+		for(int around = 0; around < 8 && inside; around++) {
+			inside = grid.isInterior(coords[0] - (around & 1), coords[1] - (around >> 1 & 1), coords[2] - (around >> 2 & 1));
+		}
+		if(inside) addPoint(Vec3(coords[0], coords[1], coords[2]));
+	}
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	points.clear();
+	points.reserve(keys.size());
+	for(std::uint64_t key : keys) {
+		points.push_back(Vec3f(static_cast<float>(key & 0x1FFFFF), static_cast<float>(key >> 21 & 0x1FFFFF), static_cast<float>(key >> 42 & 0x1FFFFF)));
+	}
+
+	return builder.build(points) && builder.getVolume() > 0.0;
+}
+
+// runs task(i) for every i below taskCount, on the threads of the pool if there is one. Rethrows the first exception of any task
+void runTasks(ThreadPool* pool, std::size_t taskCount, const std::function<void(std::size_t)>& task) {
+	if(pool == nullptr || taskCount <= 1) {
+		for(std::size_t i = 0; i < taskCount; i++) task(i);
+		return;
+	}
+
+	std::atomic<std::size_t> nextTask(0);
+	std::exception_ptr firstException;
+	std::mutex exceptionMutex;
+	pool->doInParallel([&]() {
+		while(true) {
+			std::size_t taskIndex = nextTask++;
+			if(taskIndex >= taskCount) break;
+
+			try {
+				task(taskIndex);
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(exceptionMutex);
+				if(!firstException) firstException = std::current_exception();
+			}
+		}
+	});
+
+	if(firstException) std::rethrow_exception(firstException);
+}
+
+std::vector<Polyhedron> decompose(const TriangleMesh& mesh, ThreadPool* pool, const ConvexDecompositionSettings& settings) {
+	if(mesh.triangleCount == 0) return std::vector<Polyhedron>();
+
+	BoundingBox bounds = mesh.getBounds();
+	if(std::max(bounds.getWidth(), std::max(bounds.getHeight(), bounds.getDepth())) <= 0.0) return std::vector<Polyhedron>();
+
+	int resolution = std::max(1, std::min(MAX_RESOLUTION, settings.resolution));
+	VoxelGrid grid = voxelize(mesh, resolution);
+
+	std::vector<VoxelPiece> pieces(1);
+	for(int axis = 0; axis < 3; axis++) {
+		pieces[0].regionMin[axis] = 0;
+		pieces[0].regionMax[axis] = grid.size[axis];
+	}
+	for(int z = 0; z < grid.size[2]; z++) {
+		for(int y = 0; y < grid.size[1]; y++) {
+			for(int x = 0; x < grid.size[0]; x++) {
+				if(grid.cells[grid.index(x, y, z)] != OUTSIDE) pieces[0].voxels.push_back(Voxel{{x, y, z}});
+			}
+		}
+	}
+	double totalVoxels = static_cast<double>(pieces[0].voxels.size());
+	if(totalVoxels == 0.0) return std::vector<Polyhedron>();
+
+	HullBuilder builder;
+	std::vector<Vec3f> points;
+	evaluate(pieces[0], totalVoxels, builder, points);
+
+	int maxPieces = std::max(1, settings.maxPieces);
+	while(static_cast<int>(pieces.size()) < maxPieces) {
+		VoxelPiece* worst = nullptr;
+		for(VoxelPiece& piece : pieces) {
+			if(piece.splittable && (worst == nullptr || piece.concavity > worst->concavity)) worst = &piece;
+		}
+		if(worst == nullptr || worst->concavity <= settings.maxConcavity) break;
+
+		std::vector<SplitPlane> planes = getSplitPlanes(*worst, std::max(1, settings.planesPerAxis));
+		if(planes.empty()) {
+			worst->splittable = false;
+			continue;
+		}
+
+		// every plane is tried on its own thread, each with its own buffers
+		std::vector<double> costs(planes.size());
+		const VoxelPiece& toSplit = *worst;
+		runTasks(pool, planes.size(), [&](std::size_t planeIndex) {
+			HullBuilder planeBuilder;
+			std::vector<Vec3f> planePoints;
+			VoxelPiece below;
+			VoxelPiece above;
+			split(toSplit, planes[planeIndex], below, above);
+			evaluate(below, totalVoxels, planeBuilder, planePoints);
+			evaluate(above, totalVoxels, planeBuilder, planePoints);
+
+			double balance = std::abs(static_cast<double>(below.voxels.size()) - static_cast<double>(above.voxels.size())) / totalVoxels;
+			costs[planeIndex] = below.concavity + above.concavity + BALANCE_WEIGHT * balance;
+		});
+
+		std::size_t bestPlane = std::min_element(costs.begin(), costs.end()) - costs.begin();
+		VoxelPiece below;
+		VoxelPiece above;
+		split(*worst, planes[bestPlane], below, above);
+		evaluate(below, totalVoxels, builder, points);
+		evaluate(above, totalVoxels, builder, points);
+
+		*worst = std::move(below);
+		pieces.push_back(std::move(above));
+	}
+
+	std::vector<Vec3f> vertices(mesh.vertexCount);
+	std::vector<Triangle> triangles(mesh.triangleCount);
+	mesh.getVertices(vertices.data());
+	mesh.getTriangles(triangles.data());
+	std::vector<Vec3> triangleCorners;
+	triangleCorners.reserve(triangles.size() * 3);
+	for(const Triangle& triangle : triangles) {
+		for(int i = 0; i < 3; i++) triangleCorners.push_back((Vec3(vertices[triangle[i]]) - grid.origin) / grid.voxelSize);
+	}
+
+	std::vector<Polyhedron> hulls(pieces.size());
+	// not a vector<bool>, the pieces are written from different threads
+	std::vector<char> valid(pieces.size(), false);
+	runTasks(pool, pieces.size(), [&](std::size_t pieceIndex) {
+		const VoxelPiece& piece = pieces[pieceIndex];
+		HullBuilder hullBuilder;
+		std::vector<Vec3f> hullPoints;
+		double latticeScale;
+		if(buildRegionHull(piece, grid, triangleCorners, hullBuilder, hullPoints, latticeScale)) {
+			Vec3 regionOrigin = grid.origin + Vec3(piece.regionMin[0], piece.regionMin[1], piece.regionMin[2]) * grid.voxelSize;
+			hulls[pieceIndex] = hullBuilder.toPolyhedron(regionOrigin, grid.voxelSize / latticeScale);
+			valid[pieceIndex] = true;
+		} else if(!piece.voxels.empty()) {
+			// only touched by the surface of an open mesh, the voxels are all there is
+			getHullPoints(piece, hullPoints);
+			if(!hullBuilder.build(hullPoints)) return;
+
+			hulls[pieceIndex] = hullBuilder.toPolyhedron(grid.origin, grid.voxelSize);
+			valid[pieceIndex] = true;
+		}
+	});
+
+	std::vector<Polyhedron> result;
+	result.reserve(hulls.size());
+	for(std::size_t i = 0; i < hulls.size(); i++) {
+		if(valid[i]) result.push_back(std::move(hulls[i]));
+	}
+
+	return result;
+}
+};
+
+std::vector<Polyhedron> decomposeConvex(const TriangleMesh& mesh, const ConvexDecompositionSettings& settings) {
+	return decompose(mesh, nullptr, settings);
+}
+
+std::vector<Polyhedron> decomposeConvex(const TriangleMesh& mesh, ThreadPool& pool, const ConvexDecompositionSettings& settings) {
+	return decompose(mesh, &pool, settings);
+}
+
+std::vector<ConvexPiece> toConvexPieces(const std::vector<Polyhedron>& hulls) {
+	std::vector<ConvexPiece> pieces;
+	pieces.reserve(hulls.size());
+
+	for(const Polyhedron& hull : hulls) {
+		// polyhedronShape centers the shape on the center of its bounds
+		Vec3 center = hull.getBounds().getCenter();
+		pieces.push_back(ConvexPiece{polyhedronShape(hull), CFrame(center)});
+	}
+
+	return pieces;
+}
+
+std::vector<Part*> createCompoundPart(const std::vector<ConvexPiece>& pieces, const GlobalCFrame& cframe, const PartProperties& properties) {
+	std::vector<Part*> parts;
+	if(pieces.empty()) return parts;
+	parts.reserve(pieces.size());
+
+	const CFrame& mainOffset = pieces[0].offset;
+	Part* mainPart = new Part(pieces[0].shape, cframe.localToGlobal(mainOffset), properties);
+	parts.push_back(mainPart);
+	for(std::size_t i = 1; i < pieces.size(); i++) {
+		parts.push_back(new Part(pieces[i].shape, *mainPart, mainOffset.globalToLocal(pieces[i].offset), properties));
+	}
+
+	return parts;
+}
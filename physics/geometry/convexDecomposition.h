@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "polyhedron.h"
+#include "shape.h"
+#include "../math/cframe.h"
+#include "../math/globalCFrame.h"
+
+class ThreadPool;
+class Part;
+struct PartProperties;
+
+struct ConvexDecompositionSettings {
+	// the number of voxels along the longest side of the mesh, at most 64
+	int resolution = 32;
+	// the largest number of convex pieces a mesh is split into
+	int maxPieces = 16;
+	// pieces whose hull is larger than the piece by less than this fraction of the volume of the whole mesh are not split any further
+	double maxConcavity = 0.01;
+	// the number of split planes that are tried along each axis when splitting a piece
+	int planesPerAxis = 8;
+};
+
+/*
+	Approximates a concave mesh by a set of convex hulls, so it can collide as a compound of convex parts
+
+	The mesh is voxelized, and the voxels are split by axis aligned planes until every piece is close enough to its convex hull,
+	or maxPieces pieces have been made. The piece to split next is always the least convex one.
+	Every split cuts a box out of the mesh, the hulls are those of the mesh clipped to these boxes, with their vertices rounded
+	to 1/128th of the size of their box. Closed meshes are filled, for meshes with holes only the voxels touching the surface are used
+
+	The hulls are in the coordinates of the mesh
+*/
+std::vector<Polyhedron> decomposeConvex(const TriangleMesh& mesh, const ConvexDecompositionSettings& settings = ConvexDecompositionSettings());
+// evaluates the split planes of a piece, and builds the final hulls, on the threads of the pool
+std::vector<Polyhedron> decomposeConvex(const TriangleMesh& mesh, ThreadPool& pool, const ConvexDecompositionSettings& settings = ConvexDecompositionSettings());
+
+struct ConvexPiece {
+	Shape shape;
+	// the position of the shape relative to the origin of the decomposed mesh
+	CFrame offset;
+};
+
+/*
+	Turns hulls made by decomposeConvex into shapes, to build a compound rigid body from
+	The offset of every piece is relative to the origin of the decomposed mesh, not to the first piece
+*/
+std::vector<ConvexPiece> toConvexPieces(const std::vector<Polyhedron>& hulls);
+
+/*
+	Creates a part for every piece, which together form one rigid body with the origin of the decomposed mesh at cframe
+	The first part is the main part, the others are attached to it. The caller owns all returned parts
+*/
+std::vector<Part*> createCompoundPart(const std::vector<ConvexPiece>& pieces, const GlobalCFrame& cframe, const PartProperties& properties);
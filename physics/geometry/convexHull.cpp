@@ -0,0 +1,225 @@
+#include "convexHull.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#include "../threading/threadPool.h"
+
+// the number of points a thread partitions at a time
+constexpr std::size_t PARTITION_CHUNK = 1024;
+
+void ConvexHullBuilder::partition(const Vec3f* points, std::size_t first, std::size_t last, float epsilon) {
+	for(std::size_t i = first; i < last; i++) {
+		const Vec3f& point = points[outsidePoints[i]];
+
+		// the point is still above its triangle if that is still part of the hull
+		int triangle = outsideTriangles[i];
+		if(triangle >= 0 && triangle < triangleCount && triangles[triangle] == outsideTriangleVertices[i]) {
+			float distance = planeNormals[triangle] * point - planeOffsets[triangle];
+			if(distance > epsilon) {
+				outsideDistances[i] = distance;
+				continue;
+			}
+		}
+
+		int bestTriangle = -1;
+		float bestDistance = epsilon;
+		for(int j = 0; j < triangleCount; j++) {
+			float distance = planeNormals[j] * point - planeOffsets[j];
+			if(distance > bestDistance) {
+				bestDistance = distance;
+				bestTriangle = j;
+			}
+		}
+
+		outsideTriangles[i] = bestTriangle;
+		if(bestTriangle != -1) outsideTriangleVertices[i] = triangles[bestTriangle];
+		outsideDistances[i] = bestDistance;
+	}
+}
+
+bool ConvexHullBuilder::buildHull(const Vec3f* points, std::size_t pointCount, ThreadPool* pool, int maxVertices) {
+	vertexCount = 0;
+	triangleCount = 0;
+	if(pointCount < 4) return false;
+
+	// points closer than this to a triangle are taken to be on it, which keeps rounding errors from adding points inside the hull
+	Vec3f largest(0.0f, 0.0f, 0.0f);
+	for(std::size_t i = 0; i < pointCount; i++) {
+		for(int axis = 0; axis < 3; axis++) largest[axis] = std::max(largest[axis], std::abs(points[i][axis]));
+	}
+	float epsilon = 3.0f * std::numeric_limits<float>::epsilon() * (largest.x + largest.y + largest.z);
+
+	// the starting tetrahedron is made of points far apart
+	std::size_t first = 0;
+	for(std::size_t i = 1; i < pointCount; i++) {
+		if(points[i].x < points[first].x) first = i;
+	}
+	std::size_t second = first;
+	float bestDistance = 0.0f;
+	for(std::size_t i = 0; i < pointCount; i++) {
+		float distance = lengthSquared(points[i] - points[first]);
+		if(distance > bestDistance) {
+			bestDistance = distance;
+			second = i;
+		}
+	}
+	if(std::sqrt(bestDistance) <= epsilon) return false;
+	Vec3f firstEdge = points[second] - points[first];
+	std::size_t third = first;
+	bestDistance = 0.0f;
+	for(std::size_t i = 0; i < pointCount; i++) {
+		float distance = lengthSquared((points[i] - points[first]) % firstEdge);
+		if(distance > bestDistance) {
+			bestDistance = distance;
+			third = i;
+		}
+	}
+	if(std::sqrt(bestDistance) <= epsilon * length(firstEdge)) return false;
+	Vec3f normal = normalize(firstEdge % (points[third] - points[first]));
+	std::size_t fourth = first;
+	bestDistance = 0.0f;
+	for(std::size_t i = 0; i < pointCount; i++) {
+		float distance = std::abs((points[i] - points[first]) * normal);
+		if(distance > bestDistance) {
+			bestDistance = distance;
+			fourth = i;
+		}
+	}
+	if(bestDistance <= epsilon) return false;
+
+	// the first triangle has to face away from the fourth point
+	if((points[fourth] - points[first]) * normal > 0) std::swap(second, third);
+
+	std::size_t vertexCapacity = pointCount;
+	if(maxVertices > 0) vertexCapacity = std::min(vertexCapacity, static_cast<std::size_t>(std::max(maxVertices, 4)));
+	std::size_t triangleCapacity = 2 * vertexCapacity + 8;
+	vertices.resize(vertexCapacity);
+	triangles.resize(triangleCapacity);
+	neighbors.resize(triangleCapacity);
+	removals.resize(triangleCapacity);
+	edges.resize(triangleCapacity);
+
+	vertices[0] = points[first];
+	vertices[1] = points[second];
+	vertices[2] = points[third];
+	vertices[3] = points[fourth];
+	triangles[0] = Triangle{0, 1, 2};
+	triangles[1] = Triangle{0, 2, 3};
+	triangles[2] = Triangle{0, 3, 1};
+	triangles[3] = Triangle{3, 2, 1};
+
+	ConvexShapeBuilder builder(vertices.data(), triangles.data(), 4, 4, neighbors.data(), removals.data(), edges.data());
+
+	outsidePoints.clear();
+	for(std::size_t i = 0; i < pointCount; i++) {
+		if(i != first && i != second && i != third && i != fourth) outsidePoints.push_back(static_cast<int>(i));
+	}
+	outsideTriangles.assign(outsidePoints.size(), -1);
+	outsideTriangleVertices.resize(outsidePoints.size());
+	outsideDistances.resize(outsidePoints.size());
+
+	std::vector<int> furthestPoint;
+	std::vector<std::size_t> addedPoints;
+	while(static_cast<std::size_t>(builder.vertexCount) < vertexCapacity) {
+		triangleCount = builder.triangleCount;
+
+		planeNormals.resize(triangleCount);
+		planeOffsets.resize(triangleCount);
+		for(int i = 0; i < triangleCount; i++) {
+			const Triangle& t = triangles[i];
+			Vec3f normalVec = (vertices[t[1]] - vertices[t[0]]) % (vertices[t[2]] - vertices[t[0]]);
+			float normalLength = length(normalVec);
+			planeNormals[i] = normalLength > 0.0f ? normalVec / normalLength : Vec3f(0.0f, 0.0f, 0.0f);
+			planeOffsets[i] = planeNormals[i] * vertices[t[0]];
+		}
+
+		std::size_t outsideCount = outsidePoints.size();
+		if(pool != nullptr && outsideCount > PARTITION_CHUNK) {
+			std::atomic<std::size_t> nextChunk(0);
+			pool->doInParallel([&]() {
+				while(true) {
+					std::size_t chunk = nextChunk.fetch_add(PARTITION_CHUNK);
+					if(chunk >= outsideCount) break;
+					partition(points, chunk, std::min(chunk + PARTITION_CHUNK, outsideCount), epsilon);
+				}
+			});
+		} else {
+			partition(points, 0, outsideCount, epsilon);
+		}
+
+		// drop the points inside the hull, and find the point furthest above every triangle
+		furthestPoint.assign(triangleCount, -1);
+		std::size_t keptCount = 0;
+		for(std::size_t i = 0; i < outsideCount; i++) {
+			int triangle = outsideTriangles[i];
+			if(triangle == -1) continue;
+
+			outsidePoints[keptCount] = outsidePoints[i];
+			outsideTriangles[keptCount] = triangle;
+			outsideTriangleVertices[keptCount] = outsideTriangleVertices[i];
+			outsideDistances[keptCount] = outsideDistances[i];
+
+			int& furthest = furthestPoint[triangle];
+			if(furthest == -1 || outsideDistances[keptCount] > outsideDistances[furthest]) furthest = static_cast<int>(keptCount);
+			keptCount++;
+		}
+		outsidePoints.resize(keptCount);
+		outsideTriangles.resize(keptCount);
+		outsideTriangleVertices.resize(keptCount);
+		outsideDistances.resize(keptCount);
+		if(keptCount == 0) break;
+
+		addedPoints.clear();
+		for(int furthest : furthestPoint) {
+			if(furthest != -1) addedPoints.push_back(static_cast<std::size_t>(furthest));
+		}
+		std::sort(addedPoints.begin(), addedPoints.end(), [this](std::size_t a, std::size_t b) {
+			if(outsideDistances[a] != outsideDistances[b]) return outsideDistances[a] > outsideDistances[b];
+			return outsidePoints[a] < outsidePoints[b];
+		});
+
+		// the first point is always added, points whose triangle was removed by a point before them are partitioned again next round
+		for(std::size_t added : addedPoints) {
+			if(static_cast<std::size_t>(builder.vertexCount) >= vertexCapacity) break;
+
+			int triangle = outsideTriangles[added];
+			if(triangle >= builder.triangleCount || !(triangles[triangle] == outsideTriangleVertices[added])) continue;
+
+			builder.addPoint(points[outsidePoints[added]], triangle);
+		}
+	}
+
+	vertexCount = builder.vertexCount;
+	triangleCount = builder.triangleCount;
+
+	return true;
+}
+
+bool ConvexHullBuilder::build(const Vec3f* points, std::size_t pointCount, int maxVertices) {
+	return buildHull(points, pointCount, nullptr, maxVertices);
+}
+
+bool ConvexHullBuilder::build(const Vec3f* points, std::size_t pointCount, ThreadPool& pool, int maxVertices) {
+	return buildHull(points, pointCount, &pool, maxVertices);
+}
+
+Polyhedron ConvexHullBuilder::toPolyhedron() const {
+	if(triangleCount == 0) return Polyhedron();
+
+	return Polyhedron(stripUnusedVertices(vertices.data(), triangles.data(), vertexCount, triangleCount));
+}
+
+Polyhedron convexHull(const Vec3f* points, std::size_t pointCount, int maxVertices) {
+	ConvexHullBuilder builder;
+	builder.build(points, pointCount, maxVertices);
+	return builder.toPolyhedron();
+}
+
+Polyhedron convexHull(const Vec3f* points, std::size_t pointCount, ThreadPool& pool, int maxVertices) {
+	ConvexHullBuilder builder;
+	builder.build(points, pointCount, pool, maxVertices);
+	return builder.toPolyhedron();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "polyhedron.h"
+#include "convexShapeBuilder.h"
+
+class ThreadPool;
+
+/*
+	Builds convex hulls of point clouds with quickhull, using ConvexShapeBuilder to add the points
+
+	Every round all points that are not known to be inside the hull yet are assigned to a triangle they are above,
+	points inside the hull are dropped for good. Then the point furthest above each triangle is added.
+	Points keep their triangle for as long as it is part of the hull, so only the points of removed triangles are tested against the whole hull again.
+	Partitioning the points is done on the threads of the pool if one is given, the result does not depend on the number of threads
+
+	With maxVertices the hull is simplified to at most that many vertices, the furthest points are added first, so the hull is the best
+	fit of that size that quickhull finds. It lies inside the full hull
+
+	The buffers are kept between builds, so one builder can make many hulls without allocating
+*/
+class ConvexHullBuilder {
+	std::vector<Vec3f> vertices;
+	std::vector<Triangle> triangles;
+	std::vector<TriangleNeighbors> neighbors;
+	std::vector<int> removals;
+	std::vector<EdgePiece> edges;
+
+	// the normalized planes of the triangles in the current round
+	std::vector<Vec3f> planeNormals;
+	std::vector<float> planeOffsets;
+
+	// the points that are not known to be inside the hull, with the triangle they are above and how far
+	std::vector<int> outsidePoints;
+	std::vector<int> outsideTriangles;
+	std::vector<Triangle> outsideTriangleVertices;
+	std::vector<float> outsideDistances;
+
+	int vertexCount = 0;
+	int triangleCount = 0;
+
+	bool buildHull(const Vec3f* points, std::size_t pointCount, ThreadPool* pool, int maxVertices);
+	void partition(const Vec3f* points, std::size_t first, std::size_t last, float epsilon);
+
+public:
+	/*
+		Returns false if the points don't span a volume, in that case the builder holds no hull
+		maxVertices limits the number of vertices of the hull, 0 means no limit. A limit below 4 is taken as 4
+	*/
+	bool build(const Vec3f* points, std::size_t pointCount, int maxVertices = 0);
+	bool build(const Vec3f* points, std::size_t pointCount, ThreadPool& pool, int maxVertices = 0);
+
+	// some vertices may have ended up inside the hull, these are not used by any triangle
+	const Vec3f* getVertices() const { return vertices.data(); }
+	const Triangle* getTriangles() const { return triangles.data(); }
+	int getVertexCount() const { return vertexCount; }
+	int getTriangleCount() const { return triangleCount; }
+
+	Polyhedron toPolyhedron() const;
+};
+
+// the convex hull of the points, with at most maxVertices vertices if maxVertices is not 0. Returns an empty Polyhedron if the points don't span a volume
+Polyhedron convexHull(const Vec3f* points, std::size_t pointCount, int maxVertices = 0);
+Polyhedron convexHull(const Vec3f* points, std::size_t pointCount, ThreadPool& pool, int maxVertices = 0);
@@ -10,25 +10,72 @@
 
 #include "../misc/validityHelper.h"
 #include "shapeClass.h"
+#include "builtinShapeClasses.h"
+#include "terrainMeshClass.h"
 
 #include "../catchable_assert.h"
 
 #include <algorithm>
 
 std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform) {
+	// terrain meshes aren't convex, their triangles are tested one by one
+	bool firstIsTerrain = first.baseShape->intersectionClassID == TERRAIN_MESH_CLASS_ID;
+	bool secondIsTerrain = second.baseShape->intersectionClassID == TERRAIN_MESH_CLASS_ID;
+	if(secondIsTerrain) {
+		if(firstIsTerrain) return std::optional<Intersection>();
+		return intersectsTerrain(first, second, relativeTransform);
+	}
+	if(firstIsTerrain) {
+		std::optional<Intersection> result = intersectsTerrain(second, first, ~relativeTransform);
+		if(!result) return result;
+		return Intersection(relativeTransform.localToGlobal(result.value().intersection), -relativeTransform.localToRelative(result.value().exitVector));
+	}
+
 	return intersectsTransformed(*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale);
 }
 
+// the hull of the shape at the given level of detail, shapes without levels of detail are their own hull
+static const GenericCollidable& getDetailLevel(const Shape& shape, int detailLevel, double& error) {
+	if(detailLevel > 0 && shape.baseShape->intersectionClassID == CONVEX_POLYHEDRON_CLASS_ID) {
+		const PolyhedronShapeClass& polyhedron = static_cast<const PolyhedronShapeClass&>(*shape.baseShape);
+		error = polyhedron.getDetailLevelError(detailLevel) * std::max(shape.scale[0], std::max(shape.scale[1], shape.scale[2]));
+		return polyhedron.getDetailLevel(detailLevel);
+	}
+	error = 0.0;
+	return *shape.baseShape;
+}
+
+std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform, int detailLevel, bool refine) {
+	// terrain meshes test the triangles near the other shape with its full shape
+	if(detailLevel <= 0 || first.baseShape->intersectionClassID == TERRAIN_MESH_CLASS_ID || second.baseShape->intersectionClassID == TERRAIN_MESH_CLASS_ID) {
+		return intersectsTransformed(first, second, relativeTransform);
+	}
+
+	double firstError;
+	double secondError;
+	const GenericCollidable& firstHull = getDetailLevel(first, detailLevel, firstError);
+	const GenericCollidable& secondHull = getDetailLevel(second, detailLevel, secondError);
+	if(firstError == 0.0 && secondError == 0.0) {
+		return intersectsTransformed(first, second, relativeTransform);
+	}
+
+	std::optional<Intersection> result = intersectsTransformed(firstHull, secondHull, relativeTransform, first.scale, second.scale);
+	if(result && refine && length(result.value().exitVector) < firstError + secondError) {
+		return intersectsTransformed(first, second, relativeTransform);
+	}
+	return result;
+}
+
 thread_local ComputationBuffers buffers(1000, 2000);
 
 std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond) {
 	ColissionPair info{first, second, relativeTransform, scaleFirst, scaleSecond};
-	physicsMeasure.mark(PhysicsProcess::GJK_COL);
+	auto profileScope = physicsMeasure.scope(PhysicsProcess::GJK_COL);
 	std::optional collides = runGJKTransformed(info, -relativeTransform.position);
 
 	if(collides) {
 		Tetrahedron& result = collides.value();
-		physicsMeasure.mark(PhysicsProcess::EPA);
+		profileScope.mark(PhysicsProcess::EPA);
 		Vec3f intersection;
 		Vec3f exitVector;
 
@@ -63,7 +110,7 @@ std::optional<Intersection> intersectsTransformed(const GenericCollidable& first
 			return std::optional<Intersection>(Intersection(intersection, exitVector));
 		}
 	} else {
-		physicsMeasure.mark(PhysicsProcess::OTHER, PhysicsProcess::GJK_NO_COL);
+		profileScope.mark(PhysicsProcess::OTHER, PhysicsProcess::GJK_NO_COL);
 		return std::optional<Intersection>();
 	}
 }
@@ -21,6 +21,12 @@ struct Intersection {
 };
 
 std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform);
+/*
+	Intersects the shapes using their hulls at the given level of detail, see PolyhedronShapeClass::buildDetailLevels
+	Coarser hulls contain their shapes, so shapes whose hulls don't intersect don't intersect either
+	With refine, intersections shallower than the combined error of the hulls are tested again with the full shapes
+*/
+std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform, int detailLevel, bool refine);
 std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond);
 
 
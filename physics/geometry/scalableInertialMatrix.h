@@ -14,6 +14,10 @@ class ScalableInertialMatrix {
 public:
 	ScalableInertialMatrix(Vec3 diagonalConstructors, Vec3 offDiagonal) : diagonal(diagonalConstructors), offDiagonal(offDiagonal) {}
 
+	// the values this matrix was constructed from, for storing it
+	Vec3 getDiagonalConstructors() const { return diagonal; }
+	Vec3 getOffDiagonal() const { return offDiagonal; }
+
 	SymmetricMat3 toMatrix() const {
 		return SymmetricMat3{
 			diagonal.y + diagonal.z,
@@ -30,6 +30,9 @@ BoundingBox Shape::getBounds() const {
 BoundingBox Shape::getBounds(const Rotation& referenceFrame) const {
 	return baseShape->getBounds(referenceFrame, scale);
 }
+BoundingBox Shape::getConservativeBounds(const Rotation& referenceFrame) const {
+	return baseShape->getConservativeBounds(referenceFrame, scale);
+}
 Vec3 Shape::getCenterOfMass() const {
 	return scale * baseShape->centerOfMass;
 }
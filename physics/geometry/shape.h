@@ -37,6 +37,8 @@ public:
 	
 	[[nodiscard]] BoundingBox getBounds() const;
 	[[nodiscard]] BoundingBox getBounds(const Rotation& referenceFrame) const;
+	// may be larger than getBounds(referenceFrame), see ShapeClass::getConservativeBounds
+	[[nodiscard]] BoundingBox getConservativeBounds(const Rotation& referenceFrame) const;
 	[[nodiscard]] Vec3 getCenterOfMass() const;
 	// defined around the object's Center Of Mass
 	[[nodiscard]] SymmetricMat3 getInertia() const;
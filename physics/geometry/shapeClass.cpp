@@ -1,11 +1,21 @@
 #include "shapeClass.h"
 
+#include <cmath>
+
 ShapeClass::ShapeClass(double volume, Vec3 centerOfMass, ScalableInertialMatrix inertia, int intersectionClassID) : 
 	volume(volume), 
 	centerOfMass(centerOfMass), 
 	inertia(inertia), 
 	intersectionClassID(intersectionClassID) {}
 
+BoundingBox ShapeClass::getConservativeBounds(const Rotation& referenceFrame, const DiagonalMat3& scale) const {
+	Mat3 transform = referenceFrame.asRotationMatrix() * scale;
+	double x = std::abs(transform(0, 0)) + std::abs(transform(0, 1)) + std::abs(transform(0, 2));
+	double y = std::abs(transform(1, 0)) + std::abs(transform(1, 1)) + std::abs(transform(1, 2));
+	double z = std::abs(transform(2, 0)) + std::abs(transform(2, 1)) + std::abs(transform(2, 2));
+	return BoundingBox{-x, -y, -z, x, y, z};
+}
+
 double ShapeClass::getScaledMaxRadius(DiagonalMat3 scale) const {
 	return sqrt(this->getScaledMaxRadiusSq(scale));
 }
@@ -22,11 +22,18 @@ public:
 	const int intersectionClassID;
 
 	ShapeClass(double volume, Vec3 centerOfMass, ScalableInertialMatrix inertia, int intersectionClassID);
+	virtual ~ShapeClass() = default;
 
 	virtual bool containsPoint(Vec3 point) const = 0;
 	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const = 0;
 
 	virtual BoundingBox getBounds(const Rotation& referenceFrame, const DiagonalMat3& scale) const = 0;
+	/*
+		A bounding box that contains getBounds(referenceFrame, scale), but may be larger
+		By default this is the -1..1 box of the class, rotated and scaled, which is much cheaper than getBounds for polyhedra with many vertices
+		Classes with cheap exact bounds override this to return their exact bounds
+	*/
+	virtual BoundingBox getConservativeBounds(const Rotation& referenceFrame, const DiagonalMat3& scale) const;
 
 	virtual double getScaledMaxRadius(DiagonalMat3 scale) const;
 	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const = 0;
@@ -0,0 +1,84 @@
+#include "shapeClassRegistry.h"
+
+#include "polyhedron.h"
+#include "builtinShapeClasses.h"
+
+#include "../../util/contentHash.h"
+
+static bool isSamePolyhedron(const Polyhedron& first, const Polyhedron& second) {
+	if(first.vertexCount != second.vertexCount || first.triangleCount != second.triangleCount) return false;
+
+	for(int i = 0; i < first.vertexCount; i++) {
+		if(first.getVertex(i) != second.getVertex(i)) return false;
+	}
+	for(int i = 0; i < first.triangleCount; i++) {
+		Triangle a = first.getTriangle(i);
+		Triangle b = second.getTriangle(i);
+		if(a[0] != b[0] || a[1] != b[1] || a[2] != b[2]) return false;
+	}
+	return true;
+}
+
+static bool isSameDetail(const std::vector<int>& first, const int* detailVertexCounts, int detailLevelCount) {
+	if(first.size() != static_cast<std::size_t>(detailLevelCount)) return false;
+	for(int i = 0; i < detailLevelCount; i++) {
+		if(first[i] != detailVertexCounts[i]) return false;
+	}
+	return true;
+}
+
+std::uint64_t ShapeClassRegistry::hash(const Polyhedron& poly, const int* detailVertexCounts, int detailLevelCount) {
+	std::vector<Vec3f> vertices(poly.vertexCount);
+	std::vector<Triangle> triangles(poly.triangleCount);
+	poly.getVertices(vertices.data());
+	poly.getTriangles(triangles.data());
+
+	// -0.0 and 0.0 are the same vertex coordinate, but not the same bytes
+	for(Vec3f& vertex : vertices) {
+		for(int axis = 0; axis < 3; axis++) {
+			if(vertex[axis] == 0.0f) vertex[axis] = 0.0f;
+		}
+	}
+
+	std::uint64_t result = Util::contentHash(vertices.data(), vertices.size() * sizeof(Vec3f));
+	result = Util::contentHash(triangles.data(), triangles.size() * sizeof(Triangle), result);
+	if(detailLevelCount > 0) result = Util::contentHash(detailVertexCounts, detailLevelCount * sizeof(int), result);
+	return result;
+}
+
+PolyhedronShapeClass* ShapeClassRegistry::findWithHash(std::uint64_t hash, const Polyhedron& poly, const int* detailVertexCounts, int detailLevelCount) const {
+	auto found = entries.find(hash);
+	if(found == entries.end()) return nullptr;
+
+	for(const Entry& entry : found->second) {
+		if(isSameDetail(entry.detailVertexCounts, detailVertexCounts, detailLevelCount) && isSamePolyhedron(entry.shapeClass->getPolyhedron(), poly)) {
+			return entry.shapeClass;
+		}
+	}
+	return nullptr;
+}
+
+PolyhedronShapeClass* ShapeClassRegistry::find(const Polyhedron& normalizedPoly, const int* detailVertexCounts, int detailLevelCount) const {
+	std::uint64_t key = hash(normalizedPoly, detailVertexCounts, detailLevelCount);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return findWithHash(key, normalizedPoly, detailVertexCounts, detailLevelCount);
+}
+
+PolyhedronShapeClass* ShapeClassRegistry::add(PolyhedronShapeClass* shapeClass, const int* detailVertexCounts, int detailLevelCount) {
+	const Polyhedron& poly = shapeClass->getPolyhedron();
+	std::uint64_t key = hash(poly, detailVertexCounts, detailLevelCount);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	PolyhedronShapeClass* existing = findWithHash(key, poly, detailVertexCounts, detailLevelCount);
+	if(existing != nullptr) return existing;
+
+	entries[key].push_back(Entry{shapeClass, std::vector<int>(detailVertexCounts, detailVertexCounts + detailLevelCount)});
+	classCount++;
+	return shapeClass;
+}
+
+std::size_t ShapeClassRegistry::getClassCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return classCount;
+}
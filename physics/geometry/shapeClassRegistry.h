@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Polyhedron;
+class PolyhedronShapeClass;
+
+/*
+	Interns polyhedron shape classes by their contents, so that parts with the same geometry share one shape class,
+	and with it one copy of its vertices, one mesh on the gpu, and one entry in serialized worlds
+
+	Polyhedra are compared after they are normalized to the -1..1 box, so boxes of any size share one class
+	They are the same if they have exactly the same vertices and triangles in the same order
+	Mass properties follow from the polyhedron, so they aren't compared. Levels of detail are, see PolyhedronShapeClass::buildDetailLevels
+
+	Registered classes are never deleted, like other shape classes. The registry may be used from multiple threads
+*/
+class ShapeClassRegistry {
+	struct Entry {
+		PolyhedronShapeClass* shapeClass;
+		std::vector<int> detailVertexCounts;
+	};
+
+	std::unordered_map<std::uint64_t, std::vector<Entry>> entries;
+	std::size_t classCount = 0;
+	mutable std::mutex mutex;
+
+	static std::uint64_t hash(const Polyhedron& poly, const int* detailVertexCounts, int detailLevelCount);
+	PolyhedronShapeClass* findWithHash(std::uint64_t hash, const Polyhedron& poly, const int* detailVertexCounts, int detailLevelCount) const;
+
+public:
+	// the registered class for the normalized polyhedron with the given levels of detail, or nullptr if there is none
+	PolyhedronShapeClass* find(const Polyhedron& normalizedPoly, const int* detailVertexCounts = nullptr, int detailLevelCount = 0) const;
+	/*
+		Registers the class unless an equal class was registered before, and returns the registered class
+		If that isn't shapeClass, shapeClass is still owned by the caller
+	*/
+	PolyhedronShapeClass* add(PolyhedronShapeClass* shapeClass, const int* detailVertexCounts = nullptr, int detailLevelCount = 0);
+
+	std::size_t getClassCount() const;
+};
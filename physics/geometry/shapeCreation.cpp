@@ -3,9 +3,14 @@
 #include "shapeClass.h"
 #include "polyhedron.h"
 #include "builtinShapeClasses.h"
+#include "terrainMeshClass.h"
+#include "shapeClassRegistry.h"
 
 #include "../../util/cpuid.h"
 
+#include <vector>
+#include <algorithm>
+
 Shape sphereShape(double radius) {
 	return Shape(&SphereClass::instance, radius * 2, radius * 2, radius * 2);
 }
@@ -18,24 +23,124 @@ Shape boxShape(double width, double height, double depth) {
 	return Shape(&CubeClass::instance, width, height, depth);
 }
 
-Shape polyhedronShape(const Polyhedron& poly) {
-	BoundingBox bounds = poly.getBounds();
-	Vec3 center = bounds.getCenter();
-	DiagonalMat3 scale{2 / bounds.getWidth(), 2 / bounds.getHeight(), 2 / bounds.getDepth()};
-
-	PolyhedronShapeClass* shapeClass;
-
+template<typename... MassProperties>
+static PolyhedronShapeClass* createPolyhedronShapeClass(Polyhedron&& poly, const MassProperties&... massProperties) {
 	if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::AVX | Util::CPUIDCheck::AVX2 | Util::CPUIDCheck::FMA)) {
-		shapeClass = new PolyhedronShapeClassAVX(poly.translatedAndScaled(-center, scale));
+		return new PolyhedronShapeClassAVX(std::move(poly), massProperties...);
 	} else if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::SSE | Util::CPUIDCheck::SSE2)) {
 		if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::SSE4_1)) {
-			shapeClass = new PolyhedronShapeClassSSE4(poly.translatedAndScaled(-center, scale));
+			return new PolyhedronShapeClassSSE4(std::move(poly), massProperties...);
 		} else {
-			shapeClass = new PolyhedronShapeClassSSE(poly.translatedAndScaled(-center, scale));
+			return new PolyhedronShapeClassSSE(std::move(poly), massProperties...);
 		}
 	} else {
-		shapeClass = new PolyhedronShapeClassFallback(poly.translatedAndScaled(-center, scale));
+		return new PolyhedronShapeClassFallback(std::move(poly), massProperties...);
 	}
+}
+
+ShapeClassRegistry& getShapeClassRegistry() {
+	static ShapeClassRegistry registry;
+	return registry;
+}
+
+// the registered class for the normalized polyhedron, which is created with the given mass properties if there is none yet
+template<typename... MassProperties>
+static PolyhedronShapeClass* internPolyhedronShapeClass(Polyhedron&& poly, const int* detailVertexCounts, int detailLevelCount, const MassProperties&... massProperties) {
+	ShapeClassRegistry& registry = getShapeClassRegistry();
+	PolyhedronShapeClass* found = registry.find(poly, detailVertexCounts, detailLevelCount);
+	if(found != nullptr) return found;
+
+	PolyhedronShapeClass* created = createPolyhedronShapeClass(std::move(poly), massProperties...);
+	if(detailLevelCount > 0) created->buildDetailLevels(detailVertexCounts, detailLevelCount);
+
+	// another thread may have registered the same polyhedron while this one was created
+	PolyhedronShapeClass* registered = registry.add(created, detailVertexCounts, detailLevelCount);
+	if(registered != created) delete created;
+	return registered;
+}
+
+PolyhedronShapeClass* internPolyhedronShapeClass(Polyhedron&& normalizedPoly) {
+	return internPolyhedronShapeClass(std::move(normalizedPoly), nullptr, 0);
+}
+
+Shape polyhedronShape(const Polyhedron& poly) {
+	BoundingBox bounds = poly.getBounds();
+	Vec3 center = bounds.getCenter();
+	DiagonalMat3 scale{2 / bounds.getWidth(), 2 / bounds.getHeight(), 2 / bounds.getDepth()};
+
+	PolyhedronShapeClass* shapeClass = internPolyhedronShapeClass(poly.translatedAndScaled(-center, scale), nullptr, 0);
+
+	return Shape(shapeClass, bounds.getWidth(), bounds.getHeight(), bounds.getDepth());
+}
+
+Shape polyhedronShape(const Polyhedron& poly, double volume, Vec3 centerOfMass, const ScalableInertialMatrix& inertia) {
+	BoundingBox bounds = poly.getBounds();
+	Vec3 center = bounds.getCenter();
+	DiagonalMat3 scale{2 / bounds.getWidth(), 2 / bounds.getHeight(), 2 / bounds.getDepth()};
+
+	// the mass properties of the shape class are those of the polyhedron normalized to a unit box
+	double xyz = scale[0] * scale[1] * scale[2];
+	Vec3 diagonal = xyz * elementWiseMul(inertia.getDiagonalConstructors(), Vec3(scale[0] * scale[0], scale[1] * scale[1], scale[2] * scale[2]));
+	Vec3 offDiagonal = xyz * elementWiseMul(inertia.getOffDiagonal(), Vec3(scale[1] * scale[2], scale[0] * scale[2], scale[0] * scale[1]));
+
+	PolyhedronShapeClass* shapeClass = internPolyhedronShapeClass(poly.translatedAndScaled(-center, scale), nullptr, 0, volume * xyz, scale * (centerOfMass - center), ScalableInertialMatrix(diagonal, offDiagonal));
+
+	return Shape(shapeClass, bounds.getWidth(), bounds.getHeight(), bounds.getDepth());
+}
+
+Shape polyhedronShape(const Polyhedron& poly, const int* detailVertexCounts, int detailLevelCount) {
+	BoundingBox bounds = poly.getBounds();
+	Vec3 center = bounds.getCenter();
+	DiagonalMat3 scale{2 / bounds.getWidth(), 2 / bounds.getHeight(), 2 / bounds.getDepth()};
+
+	PolyhedronShapeClass* shapeClass = internPolyhedronShapeClass(poly.translatedAndScaled(-center, scale), detailVertexCounts, detailLevelCount);
 
 	return Shape(shapeClass, bounds.getWidth(), bounds.getHeight(), bounds.getDepth());
 }
+
+Shape terrainMeshShape(const TriangleMesh& mesh) {
+	BoundingBox bounds = mesh.getBounds();
+	Vec3 center = bounds.getCenter();
+
+	// flat terrain still needs some thickness to be scaled to the -1..1 box
+	double minimalSize = 0.001 * std::max(bounds.getWidth(), std::max(bounds.getHeight(), bounds.getDepth()));
+	double width = std::max(bounds.getWidth(), minimalSize);
+	double height = std::max(bounds.getHeight(), minimalSize);
+	double depth = std::max(bounds.getDepth(), minimalSize);
+	DiagonalMat3 scale{2 / width, 2 / height, 2 / depth};
+
+	std::vector<Vec3f> vertices(mesh.vertexCount);
+	std::vector<Triangle> triangles(mesh.triangleCount);
+	for(int i = 0; i < mesh.vertexCount; i++) {
+		vertices[i] = Vec3f(scale * (Vec3(mesh.getVertex(i)) - center));
+	}
+	for(int i = 0; i < mesh.triangleCount; i++) {
+		triangles[i] = mesh.getTriangle(i);
+	}
+
+	TerrainMeshClass* shapeClass = new TerrainMeshClass(vertices.data(), triangles.data(), mesh.vertexCount, mesh.triangleCount);
+
+	return Shape(shapeClass, width, height, depth);
+}
+
+Shape heightfieldShape(const float* heights, int countX, int countZ, double cellSize) {
+	std::vector<Vec3f> vertices(static_cast<std::size_t>(countX) * countZ);
+	for(int z = 0; z < countZ; z++) {
+		for(int x = 0; x < countX; x++) {
+			vertices[z * countX + x] = Vec3f(float(x * cellSize), heights[z * countX + x], float(z * cellSize));
+		}
+	}
+
+	// two triangles per cell, facing up
+	std::vector<Triangle> triangles;
+	triangles.reserve(2 * static_cast<std::size_t>(countX - 1) * (countZ - 1));
+	for(int z = 0; z < countZ - 1; z++) {
+		for(int x = 0; x < countX - 1; x++) {
+			int corner = z * countX + x;
+			triangles.push_back(Triangle{corner, corner + countX, corner + 1});
+			triangles.push_back(Triangle{corner + 1, corner + countX, corner + countX + 1});
+		}
+	}
+
+	return terrainMeshShape(TriangleMesh(static_cast<int>(vertices.size()), static_cast<int>(triangles.size()), vertices.data(), triangles.data()));
+}
@@ -3,8 +3,31 @@
 #include "shape.h"
 
 class Polyhedron;
+class ScalableInertialMatrix;
+class PolyhedronShapeClass;
+class ShapeClassRegistry;
 
 Shape sphereShape(double radius);
 Shape cylinderShape(double radius, double height);
 Shape boxShape(double width, double height, double depth);
+// polyhedron shapes with the same geometry share one shape class, see ShapeClassRegistry
 Shape polyhedronShape(const Polyhedron& poly);
+// uses the given volume, center of mass and inertia around the center of mass of poly instead of computing them
+Shape polyhedronShape(const Polyhedron& poly, double volume, Vec3 centerOfMass, const ScalableInertialMatrix& inertia);
+// also builds coarser hulls of at most the given numbers of vertices, see PolyhedronShapeClass::buildDetailLevels
+Shape polyhedronShape(const Polyhedron& poly, const int* detailVertexCounts, int detailLevelCount);
+
+// the registry that polyhedronShape interns its shape classes in
+ShapeClassRegistry& getShapeClassRegistry();
+// the registered shape class for a polyhedron that is already normalized to the -1..1 box, such as one loaded from a world file
+PolyhedronShapeClass* internPolyhedronShapeClass(Polyhedron&& normalizedPoly);
+
+class TriangleMesh;
+
+// a terrain shape for a static triangle mesh, centered on the center of the bounds of the mesh. See TerrainMeshClass
+Shape terrainMeshShape(const TriangleMesh& mesh);
+/*
+	A terrain shape for a grid of countX by countZ heights, stored row by row, with cellSize between the points of the grid
+	The shape is centered on the center of its bounds, with the heights along the y axis
+*/
+Shape heightfieldShape(const float* heights, int countX, int countZ, double cellSize);
@@ -0,0 +1,311 @@
+#include "terrainMeshClass.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "shape.h"
+#include "polyhedron.h"
+#include "convexHull.h"
+#include "genericCollidable.h"
+
+TerrainMeshClass::TerrainMeshClass(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount) :
+	ShapeClass(8, Vec3(0, 0, 0), ScalableInertialMatrix(Vec3(8.0 / 3.0, 8.0 / 3.0, 8.0 / 3.0), Vec3(0, 0, 0)), TERRAIN_MESH_CLASS_ID),
+	vertices(vertices, vertices + vertexCount),
+	triangles(triangles, triangles + triangleCount) {
+	buildHierarchy();
+}
+
+static BoundingBoxTemplate<float> getTriangleBounds(const Vec3f& a, const Vec3f& b, const Vec3f& c) {
+	return BoundingBoxTemplate<float>(
+		std::min(a.x, std::min(b.x, c.x)), std::min(a.y, std::min(b.y, c.y)), std::min(a.z, std::min(b.z, c.z)),
+		std::max(a.x, std::max(b.x, c.x)), std::max(a.y, std::max(b.y, c.y)), std::max(a.z, std::max(b.z, c.z))
+	);
+}
+
+struct HierarchyBuilder {
+	std::vector<TerrainMeshClass::Node>& nodes;
+	std::vector<BoundingBoxTemplate<float>> triangleBounds;
+	std::vector<Vec3f> centers;
+	std::vector<int> order;
+
+	explicit HierarchyBuilder(std::vector<TerrainMeshClass::Node>& nodes) : nodes(nodes), triangleBounds(), centers(), order() {}
+
+	// the children of a node split its triangles in half along the longest side of the box around their centers
+	int build(int first, int last) {
+		int nodeIndex = static_cast<int>(nodes.size());
+		nodes.emplace_back();
+
+		BoundingBoxTemplate<float> bounds = triangleBounds[order[first]];
+		BoundingBoxTemplate<float> centerBounds(centers[order[first]], centers[order[first]]);
+		for(int i = first + 1; i < last; i++) {
+			bounds = bounds.expanded(triangleBounds[order[i]]);
+			centerBounds = centerBounds.expanded(centers[order[i]]);
+		}
+		nodes[nodeIndex].bounds = bounds;
+
+		if(last - first <= TerrainMeshClass::LEAF_SIZE) {
+			nodes[nodeIndex].firstTriangle = first;
+			nodes[nodeIndex].triangleCount = last - first;
+			return nodeIndex;
+		}
+
+		Vec3f size = centerBounds.max - centerBounds.min;
+		int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+		int middle = first + (last - first) / 2;
+		std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + last, [this, axis](int a, int b) {
+			if(centers[a][axis] != centers[b][axis]) return centers[a][axis] < centers[b][axis];
+			return a < b;
+		});
+
+		build(first, middle);
+		int secondChild = build(middle, last);
+		nodes[nodeIndex].secondChild = secondChild;
+		nodes[nodeIndex].triangleCount = 0;
+		return nodeIndex;
+	}
+};
+
+void TerrainMeshClass::buildHierarchy() {
+	nodes.clear();
+	int triangleCount = getTriangleCount();
+	if(triangleCount == 0) return;
+
+	HierarchyBuilder builder(nodes);
+	builder.triangleBounds.resize(triangleCount);
+	builder.centers.resize(triangleCount);
+	builder.order.resize(triangleCount);
+	for(int i = 0; i < triangleCount; i++) {
+		Vec3f a = vertices[triangles[i][0]];
+		Vec3f b = vertices[triangles[i][1]];
+		Vec3f c = vertices[triangles[i][2]];
+		builder.triangleBounds[i] = getTriangleBounds(a, b, c);
+		builder.centers[i] = (a + b + c) / 3.0f;
+	}
+	std::iota(builder.order.begin(), builder.order.end(), 0);
+
+	nodes.reserve(2 * (triangleCount / LEAF_SIZE + 1));
+	builder.build(0, triangleCount);
+
+	std::vector<Triangle> orderedTriangles(triangleCount);
+	for(int i = 0; i < triangleCount; i++) {
+		orderedTriangles[i] = triangles[builder.order[i]];
+	}
+	triangles.swap(orderedTriangles);
+}
+
+// returns the distance along the ray to the triangle, or a negative number if the ray does not cross it
+static double getRayDistance(const Vec3& origin, const Vec3& direction, const Vec3& v0, const Vec3& v1, const Vec3& v2) {
+	const double EPSILON = 0.0000001;
+
+	Vec3 edge1 = v1 - v0;
+	Vec3 edge2 = v2 - v0;
+	Vec3 h = direction % edge2;
+
+	double a = edge1 * h;
+	if(a > -EPSILON && a < EPSILON) return -1.0;
+
+	Vec3 s = origin - v0;
+	double f = 1.0 / a;
+	double u = f * (s * h);
+	if(u < 0.0 || u > 1.0) return -1.0;
+
+	Vec3 q = s % edge1;
+	double v = direction * f * q;
+	if(v < 0.0 || u + v > 1.0) return -1.0;
+
+	double r = edge2 * f * q;
+	return r > EPSILON ? r : -1.0;
+}
+
+static bool rayHitsBox(const Vec3& origin, const Vec3& inverseDirection, const BoundingBoxTemplate<float>& box) {
+	double near = 0.0;
+	double far = std::numeric_limits<double>::max();
+	for(int axis = 0; axis < 3; axis++) {
+		double t0 = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+		double t1 = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+		if(t0 > t1) std::swap(t0, t1);
+		near = std::max(near, t0);
+		far = std::min(far, t1);
+		if(near > far) return false;
+	}
+	return true;
+}
+
+int TerrainMeshClass::countCrossings(const Vec3& origin, const Vec3& direction, double& nearest) const {
+	nearest = std::numeric_limits<double>::max();
+	if(nodes.empty()) return 0;
+
+	Vec3 inverseDirection(1.0 / direction.x, 1.0 / direction.y, 1.0 / direction.z);
+	int crossings = 0;
+
+	int stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while(stackSize > 0) {
+		int nodeIndex = stack[--stackSize];
+		const Node& node = nodes[nodeIndex];
+		if(!rayHitsBox(origin, inverseDirection, node.bounds)) continue;
+
+		if(node.isLeaf()) {
+			for(int i = node.firstTriangle; i < node.firstTriangle + node.triangleCount; i++) {
+				const Triangle& t = triangles[i];
+				double distance = getRayDistance(origin, direction, Vec3(vertices[t[0]]), Vec3(vertices[t[1]]), Vec3(vertices[t[2]]));
+				if(distance >= 0.0) {
+					crossings++;
+					nearest = std::min(nearest, distance);
+				}
+			}
+		} else {
+			stack[stackSize++] = node.secondChild;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+
+	return crossings;
+}
+
+bool TerrainMeshClass::containsPoint(Vec3 point) const {
+	double nearest;
+	return countCrossings(point, Vec3(0.0, 1.0, 0.0), nearest) % 2 == 1;
+}
+
+double TerrainMeshClass::getIntersectionDistance(Vec3 origin, Vec3 direction) const {
+	double nearest;
+	countCrossings(origin, direction, nearest);
+	return nearest;
+}
+
+BoundingBox TerrainMeshClass::getBounds(const Rotation& rotation, const DiagonalMat3& scale) const {
+	if(vertices.empty()) return BoundingBox();
+
+	Mat3 transform = rotation.asRotationMatrix() * scale;
+	Vec3 first = transform * Vec3(vertices[0]);
+	BoundingBox bounds(first, first);
+	for(const Vec3f& vertex : vertices) {
+		bounds = bounds.expanded(transform * Vec3(vertex));
+	}
+	return bounds;
+}
+
+double TerrainMeshClass::getScaledMaxRadiusSq(DiagonalMat3 scale) const {
+	double maxRadiusSq = 0.0;
+	for(const Vec3f& vertex : vertices) {
+		maxRadiusSq = std::max(maxRadiusSq, lengthSquared(scale * Vec3(vertex)));
+	}
+	return maxRadiusSq;
+}
+
+Vec3f TerrainMeshClass::furthestInDirection(const Vec3f& direction) const {
+	if(vertices.empty()) return Vec3f(0.0f, 0.0f, 0.0f);
+
+	Vec3f best = vertices[0];
+	float bestDistance = best * direction;
+	for(const Vec3f& vertex : vertices) {
+		float distance = vertex * direction;
+		if(distance > bestDistance) {
+			bestDistance = distance;
+			best = vertex;
+		}
+	}
+	return best;
+}
+
+Polyhedron TerrainMeshClass::asPolyhedron() const {
+	return convexHull(vertices.data(), vertices.size());
+}
+
+TriangleMesh TerrainMeshClass::asTriangleMesh() const {
+	return TriangleMesh(getVertexCount(), getTriangleCount(), vertices.data(), triangles.data());
+}
+
+// a single triangle of a terrain mesh, centered on its center
+struct TerrainTriangle : public GenericCollidable {
+	Vec3f vertices[3];
+
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override {
+		float d0 = vertices[0] * direction;
+		float d1 = vertices[1] * direction;
+		float d2 = vertices[2] * direction;
+		if(d0 >= d1 && d0 >= d2) return vertices[0];
+		return d1 >= d2 ? vertices[1] : vertices[2];
+	}
+};
+
+// a triangle that may intersect a convex shape, with the distance the shape would have to move along the normal of the triangle to leave it
+struct TerrainContactCandidate {
+	float maxDepth;
+	int triangleIndex;
+	TerrainTriangle triangle;
+	CFrame transform;
+};
+
+std::optional<Intersection> intersectsTerrain(const Shape& convex, const Shape& terrain, const CFrame& relativeTransform) {
+	const TerrainMeshClass& mesh = static_cast<const TerrainMeshClass&>(*terrain.baseShape);
+
+	// the bounds of the convex shape in the coordinates of the unscaled mesh
+	CFrame convexFrame = ~relativeTransform;
+	BoundingBox convexBounds = convex.getBounds(convexFrame.getRotation());
+	DiagonalMat3 inverseScale = ~terrain.scale;
+	BoundingBoxTemplate<float> box(Vec3f(inverseScale * (convexBounds.min + convexFrame.getPosition())), Vec3f(inverseScale * (convexBounds.max + convexFrame.getPosition())));
+
+	std::vector<TerrainContactCandidate> candidates;
+	mesh.forEachTriangleIn(box, [&](int triangleIndex) {
+		Triangle t = mesh.getTriangle(triangleIndex);
+		Vec3f v0 = mesh.getVertex(t[0]);
+		Vec3f v1 = mesh.getVertex(t[1]);
+		Vec3f v2 = mesh.getVertex(t[2]);
+		if(!getTriangleBounds(v0, v1, v2).intersects(box)) return;
+
+		Vec3 a = terrain.scale * Vec3(v0);
+		Vec3 b = terrain.scale * Vec3(v1);
+		Vec3 c = terrain.scale * Vec3(v2);
+		Vec3 normalVec = (b - a) % (c - a);
+		if(lengthSquared(normalVec) == 0.0) return;
+
+		// shapes entirely on one side of the plane of the triangle can't intersect it
+		Vec3 center = (a + b + c) / 3.0;
+		Vec3 localCenter = relativeTransform.localToGlobal(center);
+		Vec3f normal(relativeTransform.localToRelative(normalize(normalVec)));
+		float centerHeight = normal * Vec3f(localCenter);
+		float highest = Vec3f(convex.scale * Vec3(convex.baseShape->furthestInDirection(Vec3f(convex.scale * Vec3(normal))))) * normal;
+		float lowest = Vec3f(convex.scale * Vec3(convex.baseShape->furthestInDirection(Vec3f(convex.scale * Vec3(-normal))))) * normal;
+		if(lowest > centerHeight || highest < centerHeight) return;
+
+		// the triangle is centered on its center, so that GJK starts searching in the right direction
+		TerrainContactCandidate candidate;
+		candidate.maxDepth = std::min(centerHeight - lowest, highest - centerHeight);
+		candidate.triangleIndex = triangleIndex;
+		candidate.triangle.vertices[0] = Vec3f(a - center);
+		candidate.triangle.vertices[1] = Vec3f(b - center);
+		candidate.triangle.vertices[2] = Vec3f(c - center);
+		candidate.transform = CFrame(localCenter, relativeTransform.getRotation());
+		candidates.push_back(candidate);
+	});
+
+	/*
+		Moving the shape out along the normal of a triangle separates them, so the intersection with a triangle is never deeper than maxDepth
+		Triangles are tested from the deepest maxDepth down, until no remaining triangle can be deeper than the deepest intersection found
+	*/
+	std::sort(candidates.begin(), candidates.end(), [](const TerrainContactCandidate& a, const TerrainContactCandidate& b) {
+		if(a.maxDepth != b.maxDepth) return a.maxDepth > b.maxDepth;
+		return a.triangleIndex < b.triangleIndex;
+	});
+
+	std::optional<Intersection> deepest;
+	double deepestDepth = 0.0;
+	for(const TerrainContactCandidate& candidate : candidates) {
+		if(deepest && double(candidate.maxDepth) * candidate.maxDepth <= deepestDepth) break;
+
+		std::optional<Intersection> result = intersectsTransformed(*convex.baseShape, candidate.triangle, candidate.transform, convex.scale, DiagonalMat3::IDENTITY());
+		if(result) {
+			double depth = lengthSquared(result.value().exitVector);
+			if(!deepest || depth > deepestDepth) {
+				deepest = result;
+				deepestDepth = depth;
+			}
+		}
+	}
+
+	return deepest;
+}
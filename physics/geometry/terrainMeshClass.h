@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+
+#include "shapeClass.h"
+#include "triangleMesh.h"
+#include "intersection.h"
+
+class Shape;
+
+#define TERRAIN_MESH_CLASS_ID 20
+
+/*
+	A static triangle mesh, such as a landscape or a heightfield, for parts in the terrain layer
+
+	The mesh does not have to be closed or convex. Convex shapes collide against the triangles of the mesh one by one,
+	the triangles near a shape are found in a bounding volume hierarchy over the triangles of the mesh,
+	so one terrain part replaces the many convex parts a large landscape would otherwise have to be split into
+
+	Terrain is never simulated, so its mass properties are those of the -1..1 box
+	Points are inside the mesh if they are below it, that is if a ray going up from them crosses the mesh an odd number of times
+*/
+class TerrainMeshClass : public ShapeClass {
+public:
+	/*
+		A node of the hierarchy. Leaves refer to triangleCount triangles from firstTriangle on,
+		the first child of other nodes comes right after them, and the second child is at secondChild
+	*/
+	struct Node {
+		BoundingBoxTemplate<float> bounds;
+		union {
+			int firstTriangle;
+			int secondChild;
+		};
+		int triangleCount;
+
+		bool isLeaf() const { return triangleCount != 0; }
+	};
+
+	// the number of triangles in a leaf of the hierarchy
+	static constexpr int LEAF_SIZE = 4;
+
+private:
+	std::vector<Vec3f> vertices;
+	// ordered such that the triangles of every leaf are next to each other
+	std::vector<Triangle> triangles;
+	std::vector<Node> nodes;
+
+	void buildHierarchy();
+	int countCrossings(const Vec3& origin, const Vec3& direction, double& nearest) const;
+
+public:
+	// the vertices must be within the -1..1 box
+	TerrainMeshClass(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount);
+
+	int getVertexCount() const { return static_cast<int>(vertices.size()); }
+	int getTriangleCount() const { return static_cast<int>(triangles.size()); }
+	int getNodeCount() const { return static_cast<int>(nodes.size()); }
+	Vec3f getVertex(int index) const { return vertices[index]; }
+	Triangle getTriangle(int index) const { return triangles[index]; }
+	const Node& getNode(int index) const { return nodes[index]; }
+
+	// calls func(triangleIndex) for the triangles whose bounds intersect the given box
+	template<typename Func>
+	void forEachTriangleIn(const BoundingBoxTemplate<float>& box, const Func& func) const {
+		if(nodes.empty()) return;
+
+		int stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while(stackSize > 0) {
+			int nodeIndex = stack[--stackSize];
+			const Node& node = nodes[nodeIndex];
+			if(!node.bounds.intersects(box)) continue;
+
+			if(node.isLeaf()) {
+				for(int i = node.firstTriangle; i < node.firstTriangle + node.triangleCount; i++) {
+					func(i);
+				}
+			} else {
+				stack[stackSize++] = node.secondChild;
+				stack[stackSize++] = nodeIndex + 1;
+			}
+		}
+	}
+
+	virtual bool containsPoint(Vec3 point) const override;
+	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const override;
+	virtual BoundingBox getBounds(const Rotation& rotation, const DiagonalMat3& scale) const override;
+	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const override;
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override;
+	// a terrain mesh is not a closed polyhedron, this is its convex hull. Use asTriangleMesh for the mesh itself
+	virtual Polyhedron asPolyhedron() const override;
+	TriangleMesh asTriangleMesh() const;
+};
+
+/*
+	The deepest intersection of the convex shape with the triangles of the terrain, local to the convex shape
+	relativeTransform is the transform of the terrain relative to the convex shape
+*/
+std::optional<Intersection> intersectsTerrain(const Shape& convex, const Shape& terrain, const CFrame& relativeTransform);
@@ -2,6 +2,9 @@
 
 #include "hardConstraint.h"
 
+#include <cstring>
+#include <type_traits>
+
 /*
 	Requires a SpeedController argument, this object must provide the following methods:
 
@@ -11,11 +14,17 @@
 */
 template<typename SpeedController>
 class MotorConstraintTemplate : public HardConstraint, public SpeedController {
+	static_assert(std::is_trivially_copyable_v<SpeedController>, "the state of the controller is copied bytewise");
 public:
 	using SpeedController::SpeedController;
 
 	virtual void update(double deltaT) override { SpeedController::update(deltaT); }
 
+	// all of the changing state is in the controller
+	virtual std::size_t getStateSize() const override { return sizeof(SpeedController); }
+	virtual void writeState(char* state) const override { std::memcpy(state, static_cast<const SpeedController*>(this), sizeof(SpeedController)); }
+	virtual void readState(const char* state) override { std::memcpy(static_cast<SpeedController*>(this), state, sizeof(SpeedController)); }
+
 	virtual CFrame getRelativeCFrame() const override {
 		return CFrame(Rotation::rotZ(SpeedController::getValue()));
 	}
@@ -37,11 +46,17 @@ public:
 */
 template<typename LengthController>
 class PistonConstraintTemplate : public HardConstraint, public LengthController {
+	static_assert(std::is_trivially_copyable_v<LengthController>, "the state of the controller is copied bytewise");
 public:
 	using LengthController::LengthController;
 
 	virtual void update(double deltaT) override { LengthController::update(deltaT); }
 
+	// all of the changing state is in the controller
+	virtual std::size_t getStateSize() const override { return sizeof(LengthController); }
+	virtual void writeState(char* state) const override { std::memcpy(state, static_cast<const LengthController*>(this), sizeof(LengthController)); }
+	virtual void readState(const char* state) override { std::memcpy(static_cast<LengthController*>(this), state, sizeof(LengthController)); }
+
 	virtual CFrame getRelativeCFrame() const override {
 		return CFrame(0.0, 0.0, LengthController::getValue());
 	}
@@ -4,6 +4,8 @@
 #include "../motion.h"
 #include "../relativeMotion.h"
 
+#include <cstddef>
+
 
 /*
 	A HardConstraint is a constraint that fully defines one object in terms of another
@@ -16,6 +18,14 @@ public:
 	virtual RelativeMotion getRelativeMotion() const = 0;
 	
 	virtual CFrame getRelativeCFrame() const = 0;
+
+	/*
+		The state that changes as the constraint is updated, like the angle of a motor, so that it can be recorded and restored
+		getStateSize is the number of bytes written by writeState and read by readState, constraints without such state store nothing
+	*/
+	virtual std::size_t getStateSize() const { return 0; }
+	virtual void writeState(char* state) const {}
+	virtual void readState(const char* state) {}
 	
 	virtual ~HardConstraint() {}
 };
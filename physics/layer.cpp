@@ -5,11 +5,15 @@
 #include "misc/debug.h"
 #include "misc/physicsProfiler.h"
 
-#include <assert.h>
+#include "datastructures/spatialHash.h"
 
-//using namespace P3D::OldBoundsTree;
+#include <assert.h>
+#include <cmath>
+#include <atomic>
+#include <algorithm>
 
 WorldLayer::WorldLayer(ColissionLayer* parent) : parent(parent) {}
+WorldLayer::WorldLayer(ColissionLayer* parent, const Position& origin) : tree(origin), parent(parent) {}
 
 WorldLayer::~WorldLayer() {
 	tree.forEach([](Part& p) {
@@ -42,9 +46,9 @@ WorldLayer& WorldLayer::operator=(WorldLayer&& other) noexcept {
 }
 
 void WorldLayer::refresh() {
-	physicsMeasure.mark(PhysicsProcess::UPDATE_TREE_BOUNDS);
+	auto profileScope = physicsMeasure.scope(PhysicsProcess::UPDATE_TREE_BOUNDS);
 	tree.recalculateBounds();
-	physicsMeasure.mark(PhysicsProcess::UPDATE_TREE_STRUCTURE);
+	profileScope.mark(PhysicsProcess::UPDATE_TREE_STRUCTURE);
 	tree.improveStructure();
 }
 
@@ -52,35 +56,23 @@ void WorldLayer::addPart(Part* newPart) {
 	tree.add(newPart);
 }
 
-static P3D::OldBoundsTree::TreeNode createNodeFor(MotorizedPhysical* phys, bool makeGroupHead) {
-	P3D::OldBoundsTree::TreeNode newNode(phys->rigidBody.mainPart, phys->rigidBody.mainPart->getBounds(), makeGroupHead);
-	phys->forEachPartExceptMainPart([&newNode](Part& part) {
-		newNode.addInside(P3D::OldBoundsTree::TreeNode(&part, part.getBounds(), false));
-	});
-	return newNode;
-}
-
-static void addMotorPhysToGroup(P3D::OldBoundsTree::BoundsTree<Part>& tree, MotorizedPhysical* phys, Part* group) {
-	tree.addToGroup(createNodeFor(phys, false), group, group->getBounds());
-}
-
 static void addMotorPhysToGroup(P3D::NewBoundsTree::BoundsTree<Part>& tree, MotorizedPhysical* phys, Part* group) {
 	auto base = tree.getPrototype().getBaseTrunk();
 	P3D::NewBoundsTree::TrunkAllocator& alloc = tree.getPrototype().getAllocator();
-	P3D::NewBoundsTree::modifyGroupRecursive(alloc, base.first, base.second, group, group->getBounds(), [&](P3D::NewBoundsTree::TreeNodeRef& groupNode, const BoundsTemplate<float>& groupNodeBounds) {
+	P3D::NewBoundsTree::modifyGroupRecursive(alloc, base.first, base.second, group, tree.getTreeBoundsOf(group), [&](P3D::NewBoundsTree::TreeNodeRef& groupNode, const BoundsTemplate<float>& groupNodeBounds) {
 		Part* mp = phys->getMainPart();
 		if(groupNode.isLeafNode()) {
 			P3D::NewBoundsTree::TreeTrunk* newTrunk = alloc.allocTrunk();
 			newTrunk->setSubNode(0, std::move(groupNode), groupNodeBounds);
-			newTrunk->setSubNode(1, P3D::NewBoundsTree::TreeNodeRef(mp), mp->getBounds());
+			newTrunk->setSubNode(1, P3D::NewBoundsTree::TreeNodeRef(mp), tree.getTreeBoundsOf(mp));
 			groupNode = P3D::NewBoundsTree::TreeNodeRef(newTrunk, 2, true);
 		} else {
-			P3D::NewBoundsTree::addRecursive(alloc, groupNode.asTrunk(), groupNode.getTrunkSize(), P3D::NewBoundsTree::TreeNodeRef(mp), mp->getBounds());
+			P3D::NewBoundsTree::addRecursive(alloc, groupNode.asTrunk(), groupNode.getTrunkSize(), P3D::NewBoundsTree::TreeNodeRef(mp), tree.getTreeBoundsOf(mp));
 		}
 		P3D::NewBoundsTree::TreeTrunk& curTrunk = groupNode.asTrunk();
 		int curTrunkSize = groupNode.getTrunkSize();
 		phys->forEachPartExceptMainPart([&](Part& part) {
-			curTrunkSize = P3D::NewBoundsTree::addRecursive(alloc, curTrunk, curTrunkSize, P3D::NewBoundsTree::TreeNodeRef(&part), part.getBounds());
+			curTrunkSize = P3D::NewBoundsTree::addRecursive(alloc, curTrunk, curTrunkSize, P3D::NewBoundsTree::TreeNodeRef(&part), tree.getTreeBoundsOf(&part));
 		});
 		groupNode.setTrunkSize(curTrunkSize);
 		return P3D::NewBoundsTree::TrunkSIMDHelperFallback::getTotalBounds(curTrunk, curTrunkSize);
@@ -107,6 +99,7 @@ void WorldLayer::moveOutOfGroup(Part* part) {
 
 void WorldLayer::removePart(Part* partToRemove) {
 	tree.remove(partToRemove);
+	parent->world->structureVersion++;
 	parent->world->onPartRemoved(partToRemove);
 }
 
@@ -152,10 +145,11 @@ int ColissionLayer::getID() const {
 	return this - &world->layers[0];
 }
 
-ColissionLayer::ColissionLayer() : world(nullptr), collidesInternally(true), subLayers{WorldLayer(this), WorldLayer(this)} {}
-ColissionLayer::ColissionLayer(WorldPrototype* world, bool collidesInternally) : world(world), collidesInternally(collidesInternally), subLayers{WorldLayer(this), WorldLayer(this)} {}
+ColissionLayer::ColissionLayer() : world(nullptr), collidesInternally(true), broadphase(BroadphaseType::BOUNDS_TREE), subLayers{WorldLayer(this), WorldLayer(this)} {}
+ColissionLayer::ColissionLayer(WorldPrototype* world, bool collidesInternally) : world(world), collidesInternally(collidesInternally), broadphase(BroadphaseType::BOUNDS_TREE), subLayers{WorldLayer(this), WorldLayer(this)} {}
+ColissionLayer::ColissionLayer(WorldPrototype* world, bool collidesInternally, const Position& origin, BroadphaseType broadphase) : world(world), collidesInternally(collidesInternally), broadphase(broadphase), subLayers{WorldLayer(this, origin), WorldLayer(this, origin)} {}
 
-ColissionLayer::ColissionLayer(ColissionLayer&& other) noexcept : world(other.world), collidesInternally(other.collidesInternally), subLayers{std::move(other.subLayers[0]), std::move(other.subLayers[1])} {
+ColissionLayer::ColissionLayer(ColissionLayer&& other) noexcept : world(other.world), collidesInternally(other.collidesInternally), broadphase(other.broadphase), subLayers{std::move(other.subLayers[0]), std::move(other.subLayers[1])} {
 	other.world = nullptr;
 
 	for(WorldLayer& l : subLayers) {
@@ -166,6 +160,7 @@ ColissionLayer& ColissionLayer::operator=(ColissionLayer&& other) noexcept {
 	std::swap(this->world, other.world);
 	std::swap(this->subLayers, other.subLayers);
 	std::swap(this->collidesInternally, other.collidesInternally);
+	std::swap(this->broadphase, other.broadphase);
 
 	for(WorldLayer& l : subLayers) {
 		l.parent = this;
@@ -180,91 +175,153 @@ void ColissionLayer::refresh() {
 	subLayers[FREE_PARTS_LAYER].refresh();
 }
 
+const Position& ColissionLayer::getOrigin() const {
+	return subLayers[FREE_PARTS_LAYER].tree.getOrigin();
+}
+void ColissionLayer::setOrigin(const Position& newOrigin) {
+	for(WorldLayer& layer : subLayers) {
+		layer.tree.setOrigin(newOrigin);
+	}
+}
+
 
 
-static bool boundsSphereEarlyEnd(const DiagonalMat3& scale, const Vec3& sphereCenter, double sphereRadius) {
-	return std::abs(sphereCenter.x) > scale[0] + sphereRadius || std::abs(sphereCenter.y) > scale[1] + sphereRadius || std::abs(sphereCenter.z) > scale[2] + sphereRadius;
-}
+/*
+	Cheap rejection tests run over all broadphase candidates from index startAt onwards, before they go to GJK
+	First the bounding spheres of both parts are tested, then the bounding sphere of each part against the scaled box of the other
+	The candidates are first gathered into flat arrays, so that the tests themselves are tight loops the compiler can vectorize
+	Rejected candidates are removed from colissions, the order of the remaining candidates is preserved
+*/
+static void runColissionPreTests(std::vector<Colission>& colissions, size_t startAt) {
+	size_t candidateCount = colissions.size() - startAt;
+	if(candidateCount == 0) return;
 
-static bool runColissionPreTests(const Part& p1, const Part& p2) {
-	Vec3 offset = p1.getPosition() - p2.getPosition();
-	if(isLongerThan(offset, p1.maxRadius + p2.maxRadius)) {
-		intersectionStatistics.addToTally(IntersectionResult::PART_DISTANCE_REJECT, 1);
-		return false;
+	Colission* candidates = colissions.data() + startAt;
+
+	std::vector<double> dx(candidateCount), dy(candidateCount), dz(candidateCount), maxDist(candidateCount);
+	std::vector<char> keep(candidateCount);
+
+	// sphere distance test
+	for(size_t i = 0; i < candidateCount; i++) {
+		Vec3 offset = candidates[i].p1->getPosition() - candidates[i].p2->getPosition();
+		dx[i] = offset.x;
+		dy[i] = offset.y;
+		dz[i] = offset.z;
+		maxDist[i] = candidates[i].p1->maxRadius + candidates[i].p2->maxRadius;
 	}
-	if(boundsSphereEarlyEnd(p1.hitbox.scale, p1.getCFrame().globalToLocal(p2.getPosition()), p2.maxRadius)) {
-		intersectionStatistics.addToTally(IntersectionResult::PART_BOUNDS_REJECT, 1);
-		return false;
+	for(size_t i = 0; i < candidateCount; i++) {
+		keep[i] = dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i] <= maxDist[i] * maxDist[i];
 	}
-	if(boundsSphereEarlyEnd(p2.hitbox.scale, p2.getCFrame().globalToLocal(p1.getPosition()), p1.maxRadius)) {
-		intersectionStatistics.addToTally(IntersectionResult::PART_BOUNDS_REJECT, 1);
-		return false;
+	size_t sphereSurvivors = 0;
+	for(size_t i = 0; i < candidateCount; i++) {
+		if(keep[i]) candidates[sphereSurvivors++] = candidates[i];
 	}
 
-	return true;
-}
-
-static void recursiveFindColissionsBetween(std::vector<Colission>& colissions, const P3D::OldBoundsTree::TreeNode& first, const P3D::OldBoundsTree::TreeNode& second) {
-	if(!intersects(first.bounds, second.bounds)) return;
-
-	if(first.isLeafNode() && second.isLeafNode()) {
-		Part* p1 = static_cast<Part*>(first.object);
-		Part* p2 = static_cast<Part*>(second.object);
-		if(runColissionPreTests(*p1, *p2)) {
-			colissions.push_back(Colission{p1, p2, Position(), Vec3()});
+	// oriented box test, the sphere of each part against the box of the other
+	std::vector<double> sx(sphereSurvivors), sy(sphereSurvivors), sz(sphereSurvivors), radius(sphereSurvivors);
+	for(int side = 0; side < 2; side++) {
+		for(size_t i = 0; i < sphereSurvivors; i++) {
+			const Part& boxPart = (side == 0) ? *candidates[i].p1 : *candidates[i].p2;
+			const Part& spherePart = (side == 0) ? *candidates[i].p2 : *candidates[i].p1;
+			Vec3 localCenter = boxPart.getCFrame().globalToLocal(spherePart.getPosition());
+			dx[i] = std::abs(localCenter.x);
+			dy[i] = std::abs(localCenter.y);
+			dz[i] = std::abs(localCenter.z);
+			sx[i] = boxPart.hitbox.scale[0];
+			sy[i] = boxPart.hitbox.scale[1];
+			sz[i] = boxPart.hitbox.scale[2];
+			radius[i] = spherePart.maxRadius;
 		}
-	} else {
-		bool preferFirst = P3D::OldBoundsTree::computeCost(first.bounds) <= P3D::OldBoundsTree::computeCost(second.bounds);
-		if(preferFirst && !first.isLeafNode() || second.isLeafNode()) {
-			// split first
-
-			for(const P3D::OldBoundsTree::TreeNode& node : first) {
-				recursiveFindColissionsBetween(colissions, node, second);
-			}
-		} else {
-			// split second
-
-			for(const P3D::OldBoundsTree::TreeNode& node : second) {
-				recursiveFindColissionsBetween(colissions, first, node);
-			}
+		for(size_t i = 0; i < sphereSurvivors; i++) {
+			keep[i] = (side == 0 || keep[i]) && dx[i] <= sx[i] + radius[i] && dy[i] <= sy[i] + radius[i] && dz[i] <= sz[i] + radius[i];
 		}
 	}
-}
-static void recursiveFindColissionsInternal(std::vector<Colission>& colissions, const P3D::OldBoundsTree::TreeNode& trunkNode) {
-	// within the same node
-	if(trunkNode.isLeafNode() || trunkNode.isGroupHead)
-		return;
-
-	for(int i = 0; i < trunkNode.nodeCount; i++) {
-		const P3D::OldBoundsTree::TreeNode& A = trunkNode[i];
-		recursiveFindColissionsInternal(colissions, A);
-		for(int j = i + 1; j < trunkNode.nodeCount; j++) {
-			const P3D::OldBoundsTree::TreeNode& B = trunkNode[j];
-			recursiveFindColissionsBetween(colissions, A, B);
-		}
+	size_t boxSurvivors = 0;
+	for(size_t i = 0; i < sphereSurvivors; i++) {
+		if(keep[i]) candidates[boxSurvivors++] = candidates[i];
 	}
-}
 
-static void findColissionsBetween(std::vector<Colission>& colissions, const P3D::OldBoundsTree::BoundsTree<Part>& treeA, const P3D::OldBoundsTree::BoundsTree<Part>& treeB) {
-	recursiveFindColissionsBetween(colissions, treeA.rootNode, treeB.rootNode);
-}
-static void findColissionsInternal(std::vector<Colission>& colissions, const P3D::OldBoundsTree::BoundsTree<Part>& tree) {
-	recursiveFindColissionsInternal(colissions, tree.rootNode);
+	intersectionStatistics.addToTally(IntersectionResult::PART_DISTANCE_REJECT, candidateCount - sphereSurvivors);
+	intersectionStatistics.addToTally(IntersectionResult::PART_BOUNDS_REJECT, sphereSurvivors - boxSurvivors);
+
+	colissions.resize(startAt + boxSurvivors);
 }
 
 static void findColissionsBetween(std::vector<Colission>& colissions, const P3D::NewBoundsTree::BoundsTree<Part>& treeA, const P3D::NewBoundsTree::BoundsTree<Part>& treeB) {
+	size_t startAt = colissions.size();
 	treeA.forEachColissionWith(treeB, [&colissions](Part* a, Part* b) {
 		colissions.push_back(Colission{a, b});
 	});
+	runColissionPreTests(colissions, startAt);
 }
 static void findColissionsInternal(std::vector<Colission>& colissions, const P3D::NewBoundsTree::BoundsTree<Part>& tree) {
+	size_t startAt = colissions.size();
 	tree.forEachColission([&colissions](Part* a, Part* b) {
 		colissions.push_back(Colission{a, b});
 	});
+	runColissionPreTests(colissions, startAt);
+}
+
+/*
+	Every group in the tree gets its own group index, a group is either a group head trunk or a leaf which is not part of a group head
+*/
+static void gatherSpatialHashItemsRecursive(const P3D::NewBoundsTree::TreeTrunk& curTrunk, int curTrunkSize, int curGroup, int& nextGroup, std::vector<SpatialHashItem>& items) {
+	for(int i = 0; i < curTrunkSize; i++) {
+		const P3D::NewBoundsTree::TreeNodeRef& subNode = curTrunk.subNodes[i];
+		if(subNode.isTrunkNode()) {
+			int subGroup = (curGroup == -1 && subNode.isGroupHead()) ? nextGroup++ : curGroup;
+			gatherSpatialHashItemsRecursive(subNode.asTrunk(), subNode.getTrunkSize(), subGroup, nextGroup, items);
+		} else {
+			int group = (curGroup == -1) ? nextGroup++ : curGroup;
+			items.push_back(SpatialHashItem{curTrunk.getBoundsOfSubNode(i), subNode.asObject(), group});
+		}
+	}
+}
+
+static void findColissionsInternalSpatialHash(std::vector<Colission>& colissions, const P3D::NewBoundsTree::BoundsTree<Part>& tree, ThreadPool& pool) {
+	size_t startAt = colissions.size();
+
+	std::vector<SpatialHashItem> items;
+	int groupCount = 0;
+	std::pair<const P3D::NewBoundsTree::TreeTrunk&, int> baseTrunk = tree.getPrototype().getBaseTrunk();
+	gatherSpatialHashItemsRecursive(baseTrunk.first, baseTrunk.second, -1, groupCount, items);
+
+	SpatialHash hash;
+	hash.build(std::move(items));
+
+	// the items are split into chunks which the threads claim one by one, results are kept per chunk so the order of the colissions does not depend on the threads
+	constexpr size_t CHUNK_SIZE = 1024;
+	size_t chunkCount = (hash.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	std::vector<std::vector<Colission>> chunkColissions(chunkCount);
+	std::atomic<size_t> nextChunk(0);
+
+	pool.doInParallel([&]() {
+		while(true) {
+			size_t chunk = nextChunk++;
+			if(chunk >= chunkCount) break;
+
+			std::vector<Colission>& foundColissions = chunkColissions[chunk];
+			size_t chunkEnd = std::min(hash.size(), (chunk + 1) * CHUNK_SIZE);
+			for(size_t i = chunk * CHUNK_SIZE; i < chunkEnd; i++) {
+				hash.forEachColissionOf(i, [&foundColissions](void* a, void* b) {
+					foundColissions.push_back(Colission{static_cast<Part*>(a), static_cast<Part*>(b)});
+				});
+			}
+		}
+	});
+
+	for(const std::vector<Colission>& foundColissions : chunkColissions) {
+		colissions.insert(colissions.end(), foundColissions.begin(), foundColissions.end());
+	}
+	runColissionPreTests(colissions, startAt);
 }
 
 void ColissionLayer::getInternalColissions(ColissionBuffer& curColissions) const {
-	findColissionsInternal(curColissions.freePartColissions, subLayers[0].tree);
+	if(broadphase == BroadphaseType::SPATIAL_HASH) {
+		findColissionsInternalSpatialHash(curColissions.freePartColissions, subLayers[0].tree, world->pool);
+	} else {
+		findColissionsInternal(curColissions.freePartColissions, subLayers[0].tree);
+	}
 	findColissionsBetween(curColissions.freeTerrainColissions, subLayers[0].tree, subLayers[1].tree);
 }
 void getColissionsBetween(const ColissionLayer& a, const ColissionLayer& b, ColissionBuffer& curColissions) {
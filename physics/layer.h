@@ -15,6 +15,7 @@ public:
 	ColissionLayer* parent;
 
 	explicit WorldLayer(ColissionLayer* parent);
+	WorldLayer(ColissionLayer* parent, const Position& origin);
 
 	WorldLayer(WorldLayer&& other) noexcept;
 	WorldLayer& operator=(WorldLayer&& other) noexcept;
@@ -62,6 +63,17 @@ WorldLayer* getLayerByID(std::vector<ColissionLayer>& knownLayers, int id);
 const WorldLayer* getLayerByID(const std::vector<ColissionLayer>& knownLayers, int id);
 int getMaxLayerID(const std::vector<ColissionLayer>& knownLayers);
 
+/*
+	How the internal colissions of the free parts in a ColissionLayer are found
+	BOUNDS_TREE: the NewBoundsTree of the layer is queried directly, works well for any mix of part sizes
+	SPATIAL_HASH: a uniform grid is built from the tree every tick and queried in parallel, meant for layers of many similar size parts
+	The tree is kept up to date in both cases, it is still used for colissions with terrain and other layers, filters and part lookup
+*/
+enum class BroadphaseType {
+	BOUNDS_TREE,
+	SPATIAL_HASH
+};
+
 class ColissionLayer {
 public:
 	static constexpr int FREE_PARTS_LAYER = 0;
@@ -73,15 +85,25 @@ public:
 	// terrainLayer
 	WorldPrototype* world;
 	bool collidesInternally;
+	BroadphaseType broadphase;
 
 	ColissionLayer();
 	ColissionLayer(WorldPrototype* world, bool collidesInternally);
+	/*
+		Bounds in the trees of this layer are stored as floats relative to origin
+		For very large worlds, parts far from the world origin should be put in a layer with a nearby origin, to keep their bounds precise
+	*/
+	ColissionLayer(WorldPrototype* world, bool collidesInternally, const Position& origin, BroadphaseType broadphase = BroadphaseType::BOUNDS_TREE);
 
 	ColissionLayer(ColissionLayer&& other) noexcept;
 	ColissionLayer& operator=(ColissionLayer&& other) noexcept;
 
 	void refresh();
 
+	const Position& getOrigin() const;
+	// moves the origin of this layer, recomputing the bounds of all parts in it
+	void setOrigin(const Position& newOrigin);
+
 	void getInternalColissions(ColissionBuffer& curColissions) const;
 
 	int getID() const;
@@ -5,8 +5,6 @@
 
 #include <fenv.h>
 
-#define USE_NEW_BOUNDSTREE
-
 template<typename T>
 struct BoundsTemplate {
 	PositionTemplate<T> min;
@@ -10,15 +10,16 @@ struct OutOfBoundsFilter {
 	OutOfBoundsFilter() = default;
 	OutOfBoundsFilter(const Bounds& bounds) : bounds(bounds) {}
 
-	bool operator()(const P3D::OldBoundsTree::TreeNode& node) const {
-		return !this->bounds.contains(node.bounds);
+	OutOfBoundsFilter relativeTo(const Position& treeOrigin) const {
+		Vec3Fix originOffset = treeOrigin - Position();
+		return OutOfBoundsFilter(Bounds(bounds.min - originOffset, bounds.max - originOffset));
 	}
-	std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> operator()(const P3D::NewBoundsTree::TreeTrunk& trunk, int trunkSize) const {
-		std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> results;
-		for(int i = 0; i < trunkSize; i++) {
-			results[i] = !this->bounds.contains(trunk.getBoundsOfSubNode(i));
-		}
-		return results;
+
+	std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> operator()(const P3D::NewBoundsTree::TreeTrunk& trunk, int) const {
+		BoundsTemplate<float> floatBounds(this->bounds);
+		return P3D::NewBoundsTree::filterEachSubNode(trunk, [&floatBounds](const BoundsTemplate<float>& subNodeBounds) {
+			return !floatBounds.contains(subNodeBounds);
+		});
 	}
 	bool operator()(const Part& part) const {
 		return true;
@@ -1,24 +1,54 @@
 #pragma once
 
 #include "../../math/bounds.h"
+#include "../../math/ray.h"
 #include "../../datastructures/boundsTree.h"
 #include "../../part.h"
 
+#include <algorithm>
+#include <limits>
+
 struct RayIntersectBoundsFilter {
 	Ray ray;
 
 	RayIntersectBoundsFilter() = default;
 	RayIntersectBoundsFilter(const Ray& ray) : ray(ray) {}
 
-	bool operator()(const P3D::OldBoundsTree::TreeNode& node) const {
-		return doRayAndBoundsIntersect(node.bounds, this->ray);
+	RayIntersectBoundsFilter relativeTo(const Position& treeOrigin) const {
+		return RayIntersectBoundsFilter(Ray{ray.origin - (treeOrigin - Position()), ray.direction});
 	}
-	std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> operator()(const P3D::NewBoundsTree::TreeTrunk& trunk, int trunkSize) const {
-		std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> results;
-		for(int i = 0; i < trunkSize; i++) {
-			results[i] = doRayAndBoundsIntersect(trunk.getBoundsOfSubNode(i), this->ray);
+
+	/*
+		Narrows [tEnter, tExit] to the part of the line between min and max along one axis
+		A line parallel to the slab is either inside it everywhere or nowhere, dividing by its zero direction would give NaN for origins on the slab
+	*/
+	static void clipToSlab(float min, float max, float origin, float direction, float& tEnter, float& tExit) {
+		if(direction == 0.0f) {
+			if(origin < min || origin > max) {
+				tEnter = std::numeric_limits<float>::infinity();
+				tExit = -std::numeric_limits<float>::infinity();
+			}
+			return;
 		}
-		return results;
+		float t1 = (min - origin) / direction;
+		float t2 = (max - origin) / direction;
+		if(t1 > t2) std::swap(t1, t2);
+		if(t1 > tEnter) tEnter = t1;
+		if(t2 < tExit) tExit = t2;
+	}
+
+	// slab test in float relative to the ray origin, same as doRayAndBoundsIntersect this tests against the whole line through the ray
+	std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> operator()(const P3D::NewBoundsTree::TreeTrunk& trunk, int) const {
+		Vec3f origin(static_cast<float>(ray.origin.x), static_cast<float>(ray.origin.y), static_cast<float>(ray.origin.z));
+		Vec3f direction(static_cast<float>(ray.direction.x), static_cast<float>(ray.direction.y), static_cast<float>(ray.direction.z));
+		return P3D::NewBoundsTree::filterEachSubNode(trunk, [&origin, &direction](const BoundsTemplate<float>& subNodeBounds) {
+			float tEnter = -std::numeric_limits<float>::infinity();
+			float tExit = std::numeric_limits<float>::infinity();
+			clipToSlab(subNodeBounds.min.x, subNodeBounds.max.x, origin.x, direction.x, tEnter, tExit);
+			clipToSlab(subNodeBounds.min.y, subNodeBounds.max.y, origin.y, direction.y, tEnter, tExit);
+			clipToSlab(subNodeBounds.min.z, subNodeBounds.max.z, origin.z, direction.z, tEnter, tExit);
+			return tEnter <= tExit;
+		});
 	}
 	bool operator()(const Part& part) const {
 		return true;
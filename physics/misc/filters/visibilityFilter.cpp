@@ -3,8 +3,6 @@
 #include "../../../util/log.h"
 #include "../../math/linalg/trigonometry.h"
 
-using namespace P3D::OldBoundsTree;
-
 VisibilityFilter::VisibilityFilter(const Position& origin, Vec3 normals[5], double maxDepth) :
 	origin(origin), 
 	up(normals[0]), down(normals[1]), left(normals[2]), right(normals[3]), forward(normals[4]),
@@ -65,8 +63,31 @@ VisibilityFilter VisibilityFilter::forSubWindow(const Position& origin, const Ve
 	);
 }
 
-bool VisibilityFilter::operator()(const TreeNode& node) const {
-	return operator()(node.bounds);
+VisibilityFilter VisibilityFilter::relativeTo(const Position& treeOrigin) const {
+	VisibilityFilter result = *this;
+	result.origin = origin - (treeOrigin - Position());
+	return result;
+}
+
+// same test as for Bounds, but done in float relative to the origin, for all subnodes of the trunk at once
+std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> VisibilityFilter::operator()(const P3D::NewBoundsTree::TreeTrunk& trunk, int) const {
+	Vec3f originf(static_cast<float>(origin.x), static_cast<float>(origin.y), static_cast<float>(origin.z));
+	float offsets[5] { 0,0,0,0,static_cast<float>(maxDepth) };
+	Vec3f normals[5] { Vec3f(up), Vec3f(down), Vec3f(left), Vec3f(right), Vec3f(forward) };
+
+	return P3D::NewBoundsTree::filterEachSubNode(trunk, [&](const BoundsTemplate<float>& bounds) {
+		bool visible = true;
+		for (int i = 0; i < 5; i++) {
+			const Vec3f& normal = normals[i];
+			Vec3f cornerOfInterest(
+				(normal.x >= 0) ? bounds.min.x : bounds.max.x,
+				(normal.y >= 0) ? bounds.min.y : bounds.max.y,
+				(normal.z >= 0) ? bounds.min.z : bounds.max.z
+			);
+			visible &= (cornerOfInterest - originf) * normal <= offsets[i];
+		}
+		return visible;
+	});
 }
 
 bool VisibilityFilter::operator()(const Position& point) const {
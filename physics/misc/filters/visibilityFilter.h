@@ -63,7 +63,10 @@ public:
 	*/
 	static VisibilityFilter forSubWindow(const Position& origin, const Vec3& cameraForward, const Vec3& cameraUp, double fov, double aspect, double maxDepth, double left, double right, double down, double up);
 	
-	bool operator()(const P3D::OldBoundsTree::TreeNode& node) const;
+	// returns this filter with its origin expressed relative to treeOrigin, for use on trees that store their bounds relative to treeOrigin
+	VisibilityFilter relativeTo(const Position& treeOrigin) const;
+
+	std::array<bool, P3D::NewBoundsTree::BRANCH_FACTOR> operator()(const P3D::NewBoundsTree::TreeTrunk& trunk, int trunkSize) const;
 	bool operator()(const Position& point) const;
 	bool operator()(const Part& part) const;
 	bool operator()(const Bounds& bounds) const;
@@ -5,6 +5,7 @@ const char * physicsLabels[]{
 	"GJK No Col",
 	"EPA",
 	"Collision",
+	"Narrowphase",
 	"Externals",
 	"Col. Handling",
 	"Constraints",
@@ -12,6 +13,7 @@ const char * physicsLabels[]{
 	"Tree Structure",
 	"Wait for lock",
 	"Updates",
+	"Render Snapshot",
 	"Queue",
 	"Other"
 };
@@ -47,7 +49,17 @@ BreakdownAverageProfiler<PhysicsProcess> physicsMeasure(physicsLabels, 100);
 HistoricTally<long long, IntersectionResult> intersectionStatistics(intersectionLabels, 1);
 CircularBuffer<int> gjkCollideIterStats(1);
 CircularBuffer<int> gjkNoCollideIterStats(1);
+CircularBuffer<int> commandQueueDepth(100);
+CircularBuffer<std::chrono::nanoseconds> commandQueueLatency(100);
+CircularBuffer<std::chrono::nanoseconds> tickJitter(100);
 
 HistoricTally<long long, IterationTime> GJKCollidesIterationStatistics(iterationLabels, 1);
 HistoricTally<long long, IterationTime> GJKNoCollidesIterationStatistics(iterationLabels, 1);
 HistoricTally<long long, IterationTime> EPAIterationStatistics(iterationLabels, 1);
+
+void setPhysicsTraceRecorder(TraceRecorder* recorder) {
+	physicsMeasure.setTraced(PhysicsProcess::GJK_COL, false);
+	physicsMeasure.setTraced(PhysicsProcess::GJK_NO_COL, false);
+	physicsMeasure.setTraced(PhysicsProcess::EPA, false);
+	physicsMeasure.setTraceRecorder(recorder);
+}
@@ -7,6 +7,7 @@ enum class PhysicsProcess {
 	GJK_NO_COL,
 	EPA,
 	COLISSION_OTHER,
+	NARROWPHASE,
 	EXTERNALS,
 	COLISSION_HANDLING,
 	CONSTRAINTS,
@@ -14,6 +15,7 @@ enum class PhysicsProcess {
 	UPDATE_TREE_STRUCTURE,
 	WAIT_FOR_LOCK,
 	UPDATING,
+	RENDER_SNAPSHOT,
 	QUEUE,
 	OTHER,
 	COUNT
@@ -39,6 +41,14 @@ extern BreakdownAverageProfiler<PhysicsProcess> physicsMeasure;
 extern HistoricTally<long long, IntersectionResult> intersectionStatistics;
 extern CircularBuffer<int> gjkCollideIterStats;
 extern CircularBuffer<int> gjkNoCollideIterStats;
+// the number of queued world operations run at the end of each tick, and the longest any of them waited
+extern CircularBuffer<int> commandQueueDepth;
+extern CircularBuffer<std::chrono::nanoseconds> commandQueueLatency;
+// how late the ticker thread woke up for each tick
+extern CircularBuffer<std::chrono::nanoseconds> tickJitter;
 extern HistoricTally<long long, IterationTime> GJKCollidesIterationStatistics;
 extern HistoricTally<long long, IterationTime> GJKNoCollidesIterationStatistics;
 extern HistoricTally<long long, IterationTime> EPAIterationStatistics;
+
+// records the phases of every physics tick into recorder, or stops recording when it is nullptr. GJK and EPA are left out, they run for every colission candidate
+void setPhysicsTraceRecorder(TraceRecorder* recorder);
@@ -2,9 +2,11 @@
 
 #include <chrono>
 #include <map>
+#include <atomic>
 
 #include "../datastructures/buffers.h"
 #include "../datastructures/parallelArray.h"
+#include "traceRecorder.h"
 
 class TimerMeasure {
 	std::chrono::high_resolution_clock::time_point lastClock = std::chrono::high_resolution_clock::now();
@@ -60,49 +62,214 @@ public:
 	}
 };
 
+/*
+	Measures how much time is spent in each ProcessType, and keeps a history of these breakdowns per tick
+
+	Every thread measures into its own context, so processes can be timed from worker threads as well. The thread that calls end() adds up
+	what all threads measured since the last end() without locking. Times of different threads are summed, so with worker threads
+	the total of a breakdown can exceed the length of the tick
+
+	mark() switches the process the calling thread is currently timing. scope() times a process until the returned scope is destroyed,
+	and then continues timing the process that was active before it, so time spent in a nested scope isn't counted for the outer process
+
+	With a TraceRecorder set, every mark, scope and end() also records a span for the traced processes
+
+	The per thread contexts are shared by all profilers of the same ProcessType, there should only be one profiler for each ProcessType
+
+	Compiling with P3D_DISABLE_PROFILING removes all measurements, only the tick rate is still recorded
+*/
 template<typename ProcessType>
 class BreakdownAverageProfiler : public HistoricTally<std::chrono::nanoseconds, ProcessType> {
-	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
-	ProcessType currentProcess = static_cast<ProcessType>(-1);
+	static constexpr size_t PROCESS_COUNT = static_cast<size_t>(ProcessType::COUNT);
+	static constexpr ProcessType NO_PROCESS = static_cast<ProcessType>(-1);
 
+	// only written by its own thread, except for collectedNanos which is only used by the thread calling end()
+	struct alignas(64) ThreadContext {
+		ProcessType currentProcess = NO_PROCESS;
+		std::chrono::steady_clock::time_point startTime;
+		uint32_t threadIndex;
+		// the process set by the latest mark and when it was set, marks are recorded as spans around the spans of nested scopes
+		ProcessType markProcess = NO_PROCESS;
+		std::chrono::steady_clock::time_point markStartTime;
+		std::chrono::steady_clock::time_point tickStartTime;
+		// the total time this context has measured for each process, never decreases
+		std::atomic<long long> measuredNanos[PROCESS_COUNT]{};
+		// the part of measuredNanos that has already been added to a tally
+		long long collectedNanos[PROCESS_COUNT]{};
+		std::atomic<bool> inUse{true};
+		ThreadContext* next = nullptr;
 
-public:
-	CircularBuffer<std::chrono::high_resolution_clock::time_point> tickHistory;
+		ThreadContext(uint32_t threadIndex) : threadIndex(threadIndex) {}
 
-	inline BreakdownAverageProfiler(char const * const labels[static_cast<size_t>(ProcessType::COUNT)], size_t capacity) : HistoricTally<std::chrono::nanoseconds, ProcessType>(labels, capacity), tickHistory(capacity) {}
+		inline std::chrono::steady_clock::time_point switchTo(ProcessType process, ProcessType countOldProcessAs) {
+			std::chrono::steady_clock::time_point curTime = std::chrono::steady_clock::now();
+			if(currentProcess != NO_PROCESS) {
+				std::atomic<long long>& total = measuredNanos[static_cast<size_t>(countOldProcessAs)];
+				std::chrono::nanoseconds timeTaken = curTime - startTime;
+				total.store(total.load(std::memory_order_relaxed) + timeTaken.count(), std::memory_order_relaxed);
+			}
+			startTime = curTime;
+			currentProcess = process;
+			return curTime;
+		}
+	};
 
-	inline void mark(ProcessType process) {
-		std::chrono::high_resolution_clock::time_point curTime = std::chrono::high_resolution_clock::now();
-		if(currentProcess != static_cast<ProcessType>(-1)) {
-			HistoricTally<std::chrono::nanoseconds, ProcessType>::addToTally(currentProcess, curTime - startTime);
+	// contexts are never freed, the context of a thread that has exited is reused by the next thread that starts profiling
+	static inline std::atomic<ThreadContext*> contexts{nullptr};
+	static inline std::atomic<uint32_t> contextCount{0};
+
+	struct ThreadContextHandle {
+		ThreadContext* context = nullptr;
+		~ThreadContextHandle() {
+			if(context != nullptr) context->inUse.store(false, std::memory_order_release);
+		}
+	};
+
+	static ThreadContext* acquireContext() {
+		for(ThreadContext* context = contexts.load(std::memory_order_acquire); context != nullptr; context = context->next) {
+			bool wasInUse = false;
+			if(context->inUse.compare_exchange_strong(wasInUse, true, std::memory_order_acq_rel)) {
+				context->currentProcess = NO_PROCESS;
+				context->markProcess = NO_PROCESS;
+				return context;
+			}
 		}
-		startTime = curTime;
-		currentProcess = process;
+		ThreadContext* newContext = new ThreadContext(contextCount++);
+		newContext->next = contexts.load(std::memory_order_relaxed);
+		while(!contexts.compare_exchange_weak(newContext->next, newContext, std::memory_order_release, std::memory_order_relaxed));
+		return newContext;
 	}
 
-	inline void mark(ProcessType process, ProcessType overrideOldProcess) {
-		std::chrono::high_resolution_clock::time_point curTime = std::chrono::high_resolution_clock::now();
-		if (currentProcess != static_cast<ProcessType>(-1)) {
-			HistoricTally<std::chrono::nanoseconds, ProcessType>::addToTally(overrideOldProcess, curTime - startTime);
+	inline void markOnContext(ThreadContext& context, ProcessType process, ProcessType countOldProcessAs) {
+		// an overriding mark renames the span of the previous mark, unless a scope was running inside it
+		ProcessType spanProcess = (context.currentProcess == context.markProcess) ? countOldProcessAs : context.markProcess;
+		std::chrono::steady_clock::time_point curTime = context.switchTo(process, countOldProcessAs);
+		if(context.markProcess == NO_PROCESS) {
+			context.tickStartTime = curTime;
+		} else {
+			recordSpan(spanProcess, context, context.markStartTime, curTime);
+		}
+		context.markProcess = process;
+		context.markStartTime = curTime;
+	}
+
+	static inline ThreadContext& getThreadContext() {
+		thread_local ThreadContextHandle handle;
+		if(handle.context == nullptr) handle.context = acquireContext();
+		return *handle.context;
+	}
+
+	std::atomic<TraceRecorder*> traceRecorder{nullptr};
+	bool isTraced[PROCESS_COUNT];
+
+	inline void recordSpan(ProcessType process, const ThreadContext& context, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+		TraceRecorder* recorder = traceRecorder.load(std::memory_order_acquire);
+		if(recorder != nullptr && process != NO_PROCESS && isTraced[static_cast<size_t>(process)]) {
+			recorder->addSpan(TraceSpan{this->labels[static_cast<size_t>(process)], context.threadIndex, start, end});
+		}
+	}
+
+public:
+	CircularBuffer<std::chrono::steady_clock::time_point> tickHistory;
+
+#ifndef P3D_DISABLE_PROFILING
+	class Scope {
+		BreakdownAverageProfiler& profiler;
+		ThreadContext& context;
+		ProcessType outerProcess;
+		std::chrono::steady_clock::time_point spanStartTime;
+	public:
+		inline Scope(BreakdownAverageProfiler& profiler, ThreadContext& context, ProcessType process) : profiler(profiler), context(context), outerProcess(context.currentProcess) {
+			spanStartTime = context.switchTo(process, outerProcess);
+		}
+		inline ~Scope() {
+			ProcessType process = context.currentProcess;
+			profiler.recordSpan(process, context, spanStartTime, context.switchTo(outerProcess, process));
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		// continues this scope as another process
+		inline void mark(ProcessType process) {
+			mark(process, context.currentProcess);
+		}
+		// continues this scope as another process, and counts the time since the last mark as overrideOldProcess
+		inline void mark(ProcessType process, ProcessType overrideOldProcess) {
+			std::chrono::steady_clock::time_point curTime = context.switchTo(process, overrideOldProcess);
+			profiler.recordSpan(overrideOldProcess, context, spanStartTime, curTime);
+			spanStartTime = curTime;
 		}
-		startTime = curTime;
-		currentProcess = process;
+	};
+#else
+	class Scope {
+	public:
+		inline void mark(ProcessType) {}
+		inline void mark(ProcessType, ProcessType) {}
+	};
+#endif
+
+	inline BreakdownAverageProfiler(char const * const labels[static_cast<size_t>(ProcessType::COUNT)], size_t capacity) : HistoricTally<std::chrono::nanoseconds, ProcessType>(labels, capacity), tickHistory(capacity) {
+		for(size_t i = 0; i < PROCESS_COUNT; i++) {
+			isTraced[i] = true;
+		}
+	}
+
+	// spans are recorded into the given recorder until it is set back to nullptr, which must happen before the recorder is destroyed
+	inline void setTraceRecorder(TraceRecorder* recorder) {
+		traceRecorder.store(recorder, std::memory_order_release);
+	}
+	// all processes are traced by default, very short and frequent processes can be left out to keep traces small
+	inline void setTraced(ProcessType process, bool traced) {
+		isTraced[static_cast<size_t>(process)] = traced;
+	}
+
+	[[nodiscard]] inline Scope scope([[maybe_unused]] ProcessType process) {
+#ifndef P3D_DISABLE_PROFILING
+		return Scope(*this, getThreadContext(), process);
+#else
+		return Scope();
+#endif
+	}
+
+	inline void mark([[maybe_unused]] ProcessType process) {
+#ifndef P3D_DISABLE_PROFILING
+		ThreadContext& context = getThreadContext();
+		markOnContext(context, process, context.currentProcess);
+#endif
+	}
+
+	inline void mark([[maybe_unused]] ProcessType process, [[maybe_unused]] ProcessType overrideOldProcess) {
+#ifndef P3D_DISABLE_PROFILING
+		markOnContext(getThreadContext(), process, overrideOldProcess);
+#endif
 	}
 
+	// ends the current tick, collecting the time measured by all threads into the tally of this tick
 	inline void end() {
-		std::chrono::high_resolution_clock::time_point curTime = std::chrono::high_resolution_clock::now();
-		this->addToTally(currentProcess, curTime - startTime);
-		tickHistory.add(curTime);
+#ifndef P3D_DISABLE_PROFILING
+		ThreadContext& ownContext = getThreadContext();
+		bool tickWasMarked = ownContext.markProcess != NO_PROCESS;
+		markOnContext(ownContext, NO_PROCESS, ownContext.currentProcess);
 
-		currentProcess = static_cast<ProcessType>(-1);
+		for(ThreadContext* context = contexts.load(std::memory_order_acquire); context != nullptr; context = context->next) {
+			for(size_t i = 0; i < PROCESS_COUNT; i++) {
+				long long measured = context->measuredNanos[i].load(std::memory_order_relaxed);
+				this->addToTally(static_cast<ProcessType>(i), std::chrono::nanoseconds(measured - context->collectedNanos[i]));
+				context->collectedNanos[i] = measured;
+			}
+		}
+		TraceRecorder* recorder = traceRecorder.load(std::memory_order_acquire);
+		if(recorder != nullptr && tickWasMarked) recorder->endTick(ownContext.tickStartTime, ownContext.markStartTime);
+#endif
+		tickHistory.add(std::chrono::steady_clock::now());
 		this->nextTally();
 	}
 
 	inline double getAvgTPS() {
 		size_t numTicks = tickHistory.size();
 		if(numTicks != 0) {
-			std::chrono::high_resolution_clock::time_point firstTime = tickHistory.tail();
-			std::chrono::high_resolution_clock::time_point lastTime = tickHistory.front();
+			std::chrono::steady_clock::time_point firstTime = tickHistory.tail();
+			std::chrono::steady_clock::time_point lastTime = tickHistory.front();
 			std::chrono::nanoseconds delta = lastTime - firstTime;
 
 			double timeTaken = delta.count() * 1E-9;
@@ -2,6 +2,8 @@
 
 #include "../geometry/polyhedron.h"
 #include "../geometry/builtinShapeClasses.h"
+#include "../geometry/terrainMeshClass.h"
+#include "../geometry/shapeCreation.h"
 #include "../geometry/shape.h"
 #include "../geometry/shapeClass.h"
 #include "../part.h"
@@ -22,9 +24,19 @@
 #include <limits.h>
 #include <string>
 #include <iostream>
+#include <iterator>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <exception>
+#include <algorithm>
 
+#include "validityHelper.h"
+#include "../../util/blockCompression.h"
 
-#define CURRENT_VERSION_ID 2
+
+#define CURRENT_VERSION_ID 4
 
 #pragma region serializeComponents
 
@@ -32,31 +44,24 @@ void serializePolyhedron(const Polyhedron& poly, std::ostream& ostream) {
 	::serialize<int>(poly.vertexCount, ostream);
 	::serialize<int>(poly.triangleCount, ostream);
 
-	for(int i = 0; i < poly.vertexCount; i++) {
-		::serialize<Vec3f>(poly.getVertex(i), ostream);
-	}
-	for(int i = 0; i < poly.triangleCount; i++) {
-		::serialize<Triangle>(poly.getTriangle(i), ostream);
-	}
+	std::vector<Vec3f> vertices(poly.vertexCount);
+	std::vector<Triangle> triangles(poly.triangleCount);
+	poly.getVertices(vertices.data());
+	poly.getTriangles(triangles.data());
+	::serializeArray<Vec3f>(vertices.data(), vertices.size(), ostream);
+	::serializeArray<Triangle>(triangles.data(), triangles.size(), ostream);
 }
 Polyhedron deserializePolyhedron(std::istream& istream) {
 	uint32_t vertexCount = ::deserialize<uint32_t>(istream);
 	uint32_t triangleCount = ::deserialize<uint32_t>(istream);
 
-	Vec3f* vertices = new Vec3f[vertexCount];
-	Triangle* triangles = new Triangle[triangleCount];
+	std::vector<Vec3f> vertices(vertexCount);
+	std::vector<Triangle> triangles(triangleCount);
+	::deserializeArray<Vec3f>(vertices.data(), vertexCount, istream);
+	::deserializeArray<Triangle>(triangles.data(), triangleCount, istream);
+	if(!istream) throw SerializationException("Polyhedron is truncated");
 
-	for(uint32_t i = 0; i < vertexCount; i++) {
-		vertices[i] = ::deserialize<Vec3f>(istream);
-	}
-	for(uint32_t i = 0; i < triangleCount; i++) {
-		triangles[i] = ::deserialize<Triangle>(istream);
-	}
-
-	Polyhedron result(vertices, triangles, vertexCount, triangleCount);
-	delete[] vertices;
-	delete[] triangles;
-	return result;
+	return Polyhedron(vertices.data(), triangles.data(), vertexCount, triangleCount);
 }
 
 void ShapeSerializer::include(const Shape& shape) {
@@ -174,8 +179,34 @@ void serializePolyhedronShapeClass(const PolyhedronShapeClass& polyhedron, std::
 }
 PolyhedronShapeClass* deserializePolyhedronShapeClass(std::istream& istream) {
 	Polyhedron poly = ::deserializePolyhedron(istream);
-	PolyhedronShapeClass* result = new PolyhedronShapeClass(std::move(poly));
-	return result;
+	return internPolyhedronShapeClass(std::move(poly));
+}
+
+void serializeTerrainMeshClass(const TerrainMeshClass& terrain, std::ostream& ostream) {
+	::serialize<int>(terrain.getVertexCount(), ostream);
+	::serialize<int>(terrain.getTriangleCount(), ostream);
+
+	std::vector<Vec3f> vertices(terrain.getVertexCount());
+	std::vector<Triangle> triangles(terrain.getTriangleCount());
+	for(int i = 0; i < terrain.getVertexCount(); i++) vertices[i] = terrain.getVertex(i);
+	for(int i = 0; i < terrain.getTriangleCount(); i++) triangles[i] = terrain.getTriangle(i);
+	::serializeArray<Vec3f>(vertices.data(), vertices.size(), ostream);
+	::serializeArray<Triangle>(triangles.data(), triangles.size(), ostream);
+}
+TerrainMeshClass* deserializeTerrainMeshClass(std::istream& istream) {
+	uint32_t vertexCount = ::deserialize<uint32_t>(istream);
+	uint32_t triangleCount = ::deserialize<uint32_t>(istream);
+
+	std::vector<Vec3f> vertices(vertexCount);
+	std::vector<Triangle> triangles(triangleCount);
+	::deserializeArray<Vec3f>(vertices.data(), vertexCount, istream);
+	::deserializeArray<Triangle>(triangles.data(), triangleCount, istream);
+	if(!istream) throw SerializationException("Terrain mesh is truncated");
+	for(const Triangle& triangle : triangles) {
+		if(!isValidTriangle(triangle, vertexCount)) throw SerializationException("Terrain mesh has a triangle with invalid vertex indices");
+	}
+
+	return new TerrainMeshClass(vertices.data(), triangles.data(), vertexCount, triangleCount);
 }
 
 void serializeDirectionalGravity(const DirectionalGravity& gravity, std::ostream& ostream) {
@@ -190,15 +221,6 @@ DirectionalGravity* deserializeDirectionalGravity(std::istream& istream) {
 
 #pragma region serializePartPhysicalAndRelated
 
-static void serializeLayer(const Part& part, std::ostream& ostream) {
-	::serialize<uint32_t>(part.getLayerID(), ostream);
-}
-static WorldLayer* deserializeLayer(std::vector<ColissionLayer>& knownLayers, std::istream& istream) {
-	uint32_t id = ::deserialize<uint32_t>(istream);
-	return getLayerByID(knownLayers, id);
-}
-
-
 void SerializationSessionPrototype::serializePartData(const Part& part, std::ostream& ostream) {
 	shapeSerializer.serializeShape(part.hitbox, ostream);
 	::serialize<PartProperties>(part.properties, ostream);
@@ -217,28 +239,34 @@ Part* DeSerializationSessionPrototype::deserializePartData(const GlobalCFrame& c
 Part* DeSerializationSessionPrototype::deserializePartExternalData(Part&& part, std::istream& istream) {
 	return new Part(std::move(part));
 }
+bool DeSerializationSessionPrototype::canDeserializePartExternalDataInParallel() const {
+	return true;
+}
 
+// parts of physicals are stored in the part columns, rigid bodies only refer to them by index
 void SerializationSessionPrototype::serializeRigidBodyInContext(const RigidBody& rigidBody, std::ostream& ostream) {
-	serializeLayer(*rigidBody.mainPart, ostream);
-	serializePartData(*rigidBody.mainPart, ostream);
+	::serialize<uint32_t>(this->partIndexMap.at(rigidBody.mainPart), ostream);
 	::serialize<uint32_t>(static_cast<uint32_t>(rigidBody.parts.size()), ostream);
 	for(const AttachedPart& atPart : rigidBody.parts) {
 		::serialize<CFrame>(atPart.attachment, ostream);
-		serializeLayer(*atPart.part, ostream);
-		serializePartData(*atPart.part, ostream);
+		::serialize<uint32_t>(this->partIndexMap.at(atPart.part), ostream);
 	}
 }
 
-RigidBody DeSerializationSessionPrototype::deserializeRigidBodyWithContext(const GlobalCFrame& cframeOfMain, std::vector<ColissionLayer>& layers, std::istream& istream) {
-	WorldLayer* layer = deserializeLayer(layers, istream);
-	Part* mainPart = deserializePartData(cframeOfMain, layer, istream);
+Part* DeSerializationSessionPrototype::deserializePartIndex(std::istream& istream) const {
+	uint32_t index = ::deserialize<uint32_t>(istream);
+	if(index >= indexToPartMap.size()) throw SerializationException("Part index " + std::to_string(index) + " is out of range");
+	return indexToPartMap[index];
+}
+
+RigidBody DeSerializationSessionPrototype::deserializeRigidBodyWithContext(std::istream& istream) const {
+	Part* mainPart = deserializePartIndex(istream);
 	RigidBody result(mainPart);
 	uint32_t size = ::deserialize<uint32_t>(istream);
 	result.parts.reserve(size);
 	for(uint32_t i = 0; i < size; i++) {
 		CFrame attach = ::deserialize<CFrame>(istream);
-		WorldLayer* layer = deserializeLayer(layers, istream); 
-		Part* newPart = deserializePartData(cframeOfMain.localToGlobal(attach), layer, istream);
+		Part* newPart = deserializePartIndex(istream);
 		result.parts.push_back(AttachedPart{attach, newPart});
 	}
 	return result;
@@ -294,33 +322,30 @@ void SerializationSessionPrototype::serializePhysicalInContext(const Physical& p
 
 void SerializationSessionPrototype::serializeMotorizedPhysicalInContext(const MotorizedPhysical& phys, std::ostream& ostream) {
 	::serialize<Motion>(phys.motionOfCenterOfMass, ostream);
-	::serialize<GlobalCFrame>(phys.getMainPart()->getCFrame(), ostream);
 
 	serializePhysicalInContext(phys, ostream);
 }
 
-void DeSerializationSessionPrototype::deserializeConnectionsOfPhysicalWithContext(std::vector<ColissionLayer>& layers, Physical& physToPopulate, std::istream& istream) {
+void DeSerializationSessionPrototype::deserializeConnectionsOfPhysicalWithContext(Physical& physToPopulate, std::istream& istream, std::vector<Physical*>& physicalsInOrder) const {
 	uint32_t childrenCount = ::deserialize<uint32_t>(istream);
 	physToPopulate.childPhysicals.reserve(childrenCount);
 	for(uint32_t i = 0; i < childrenCount; i++) {
 		HardPhysicalConnection connection = deserializeHardPhysicalConnection(istream);
-		GlobalCFrame cframeOfConnectedPhys = physToPopulate.getCFrame().localToGlobal(connection.getRelativeCFrameToParent());
-		RigidBody b = deserializeRigidBodyWithContext(cframeOfConnectedPhys, layers, istream);
+		RigidBody b = deserializeRigidBodyWithContext(istream);
 		physToPopulate.childPhysicals.emplace_back(std::move(b), &physToPopulate, std::move(connection));
 		ConnectedPhysical& currentlyWorkingOn = physToPopulate.childPhysicals.back();
-		indexToPhysicalMap.push_back(static_cast<Physical*>(&currentlyWorkingOn));
-		deserializeConnectionsOfPhysicalWithContext(layers, currentlyWorkingOn, istream);
+		physicalsInOrder.push_back(static_cast<Physical*>(&currentlyWorkingOn));
+		deserializeConnectionsOfPhysicalWithContext(currentlyWorkingOn, istream, physicalsInOrder);
 	}
 }
 
-MotorizedPhysical* DeSerializationSessionPrototype::deserializeMotorizedPhysicalWithContext(std::vector<ColissionLayer>& layers, std::istream& istream) {
+MotorizedPhysical* DeSerializationSessionPrototype::deserializeMotorizedPhysicalWithContext(std::istream& istream, std::vector<Physical*>& physicalsInOrder) const {
 	Motion motion = ::deserialize<Motion>(istream);
-	GlobalCFrame cf = ::deserialize<GlobalCFrame>(istream);
-	MotorizedPhysical* mainPhys = new MotorizedPhysical(deserializeRigidBodyWithContext(cf, layers, istream));
-	indexToPhysicalMap.push_back(static_cast<Physical*>(mainPhys));
+	MotorizedPhysical* mainPhys = new MotorizedPhysical(deserializeRigidBodyWithContext(istream));
+	physicalsInOrder.push_back(static_cast<Physical*>(mainPhys));
 	mainPhys->motionOfCenterOfMass = motion;
 
-	deserializeConnectionsOfPhysicalWithContext(layers, *mainPhys, istream);
+	deserializeConnectionsOfPhysicalWithContext(*mainPhys, istream, physicalsInOrder);
 
 	mainPhys->refreshPhysicalProperties();
 	return mainPhys;
@@ -372,23 +397,238 @@ static void assertVersionCorrect(std::istream& istream) {
 }
 
 
-void SerializationSessionPrototype::serializeWorldLayer(const WorldLayer& layer, std::ostream& ostream) {
-	uint32_t numberOfUnPhysicaledPartsInLayer = 0;
-	layer.tree.forEach([&numberOfUnPhysicaledPartsInLayer](const Part& p) {
-		if(p.parent == nullptr) {
-			numberOfUnPhysicaledPartsInLayer++;
+#pragma region worldFile
+
+/*
+	A world file is a header, followed by a table of sections, followed by the sections themselves
+	Every section starts at a multiple of WORLD_FILE_SECTION_ALIGNMENT, so that the column sections can be used in place when the file is memory mapped
+
+	Parts are stored as columns, one section per property, with one element per part. Terrain parts come first, then the parts of all physicals
+	Physicals, constraints and trees refer to parts by their index in these columns
+	Trees are stored as images of their structure, so loading them does not require inserting every part again
+
+	Parts, physicals and trees don't depend on each other within their own sections, and are loaded in parallel on the world's thread pool
+*/
+static const char WORLD_FILE_MAGIC[8]{'P', '3', 'D', 'W', 'O', 'R', 'L', 'D'};
+static constexpr std::size_t WORLD_FILE_SECTION_ALIGNMENT = 64;
+
+enum class WorldFileSectionType : uint32_t {
+	SHAPE_CLASSES = 0,
+	WORLD_INFO = 1,
+	PART_CFRAMES = 2,
+	PART_SCALES = 3,
+	PART_SHAPE_CLASSES = 4,
+	PART_PROPERTIES = 5,
+	PART_LAYERS = 6,
+	PART_EXTERNAL_DATA_OFFSETS = 7,
+	PART_EXTERNAL_DATA = 8,
+	PHYSICALS = 9,
+	TREE_DIRECTORY = 10,
+	TREE_TRUNKS = 11,
+	CONSTRAINTS = 12,
+	EXTERNAL_FORCES = 13,
+	// the start of each MotorizedPhysical in the PHYSICALS section, followed by the end of the section
+	PHYSICAL_OFFSETS = 14
+};
+
+struct WorldFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t sectionCount;
+};
+
+// a compressed section starts with its uncompressed size as a uint64_t, followed by a block made by Util::compressBlock
+static constexpr uint32_t WORLD_FILE_SECTION_COMPRESSED = 1;
+
+struct WorldFileSection {
+	uint32_t type;
+	uint32_t flags;
+	uint64_t offset;
+	// the size of the section as stored in the file
+	uint64_t size;
+};
+
+// one entry per WorldLayer, in the order of ColissionLayer::getID
+struct WorldFileTreeDirectoryEntry {
+	uint64_t firstTrunk;
+	uint64_t trunkCount;
+};
+
+class WorldFileWriter {
+	std::vector<std::pair<WorldFileSectionType, std::vector<char>>> sections;
+	std::vector<uint32_t> sectionFlags;
+	bool compress;
+public:
+	WorldFileWriter(bool compress) : compress(compress) {}
+
+	void addSection(WorldFileSectionType type, std::vector<char>&& data) {
+		uint32_t flags = 0;
+		if(compress) {
+			std::vector<char> compressed = Util::compressBlock(data.data(), data.size());
+			// sections that don't shrink are stored as they are, so they can still be used in place
+			if(compressed.size() + sizeof(uint64_t) < data.size()) {
+				std::vector<char> stored(sizeof(uint64_t) + compressed.size());
+				uint64_t uncompressedSize = data.size();
+				std::memcpy(stored.data(), &uncompressedSize, sizeof(uint64_t));
+				std::memcpy(stored.data() + sizeof(uint64_t), compressed.data(), compressed.size());
+				data = std::move(stored);
+				flags |= WORLD_FILE_SECTION_COMPRESSED;
+			}
 		}
-	});
+		sections.emplace_back(type, std::move(data));
+		sectionFlags.push_back(flags);
+	}
+	template<typename T>
+	void addColumn(WorldFileSectionType type, const std::vector<T>& column) {
+		static_assert(std::is_trivially_copyable<T>::value, "Columns must be trivially copyable");
+		const char* columnData = reinterpret_cast<const char*>(column.data());
+		addSection(type, std::vector<char>(columnData, columnData + column.size() * sizeof(T)));
+	}
+
+	void write(std::ostream& ostream) const {
+		WorldFileHeader header;
+		std::memcpy(header.magic, WORLD_FILE_MAGIC, sizeof(header.magic));
+		header.version = CURRENT_VERSION_ID;
+		header.sectionCount = static_cast<uint32_t>(sections.size());
+
+		std::vector<WorldFileSection> table(sections.size());
+		uint64_t curOffset = sizeof(WorldFileHeader) + sizeof(WorldFileSection) * sections.size();
+		for(size_t i = 0; i < sections.size(); i++) {
+			curOffset = (curOffset + WORLD_FILE_SECTION_ALIGNMENT - 1) / WORLD_FILE_SECTION_ALIGNMENT * WORLD_FILE_SECTION_ALIGNMENT;
+			table[i] = WorldFileSection{static_cast<uint32_t>(sections[i].first), sectionFlags[i], curOffset, sections[i].second.size()};
+			curOffset += sections[i].second.size();
+		}
+
+		::serialize<WorldFileHeader>(header, ostream);
+		::serialize(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(WorldFileSection), ostream);
+		uint64_t writtenSoFar = sizeof(WorldFileHeader) + sizeof(WorldFileSection) * sections.size();
+		const char padding[WORLD_FILE_SECTION_ALIGNMENT]{};
+		for(size_t i = 0; i < sections.size(); i++) {
+			::serialize(padding, static_cast<size_t>(table[i].offset - writtenSoFar), ostream);
+			::serialize(sections[i].second.data(), sections[i].second.size(), ostream);
+			writtenSoFar = table[i].offset + table[i].size;
+		}
+	}
+};
+
+class WorldFileReader {
+	const char* fileData;
+	size_t fileSize;
+	const WorldFileSection* sections;
+	uint32_t sectionCount;
+	// compressed sections are decompressed once when the file is opened, uncompressed sections are used in place
+	std::vector<std::vector<char>> decompressedSections;
+public:
+	WorldFileReader(const char* fileData, size_t fileSize) : fileData(fileData), fileSize(fileSize) {
+		if(fileSize < sizeof(WorldFileHeader)) throw SerializationException("File is too small to be a world file");
+		WorldFileHeader header;
+		std::memcpy(&header, fileData, sizeof(WorldFileHeader));
+		if(std::memcmp(header.magic, WORLD_FILE_MAGIC, sizeof(header.magic)) != 0) throw SerializationException("This is not a world file!");
+		if(header.version != CURRENT_VERSION_ID) {
+			throw SerializationException(
+				"This serialization version is outdated and cannot be read! Current " +
+				std::to_string(CURRENT_VERSION_ID) +
+				" version from file: " +
+				std::to_string(header.version)
+			);
+		}
+		if(reinterpret_cast<std::uintptr_t>(fileData) % alignof(uint64_t) != 0) throw SerializationException("World file data is not aligned");
+		if((fileSize - sizeof(WorldFileHeader)) / sizeof(WorldFileSection) < header.sectionCount) throw SerializationException("World file section table is truncated");
+
+		this->sections = reinterpret_cast<const WorldFileSection*>(fileData + sizeof(WorldFileHeader));
+		this->sectionCount = header.sectionCount;
+		for(uint32_t i = 0; i < sectionCount; i++) {
+			if(sections[i].offset > fileSize || sections[i].size > fileSize - sections[i].offset) throw SerializationException("World file section " + std::to_string(i) + " lies outside of the file");
+		}
+
+		decompressedSections.resize(sectionCount);
+		for(uint32_t i = 0; i < sectionCount; i++) {
+			if(sections[i].flags & WORLD_FILE_SECTION_COMPRESSED) {
+				if(sections[i].size < sizeof(uint64_t)) throw SerializationException("World file section " + std::to_string(i) + " is truncated");
+				const char* storedData = fileData + sections[i].offset;
+				uint64_t uncompressedSize;
+				std::memcpy(&uncompressedSize, storedData, sizeof(uint64_t));
+				// every byte of a block expands to at most 255 bytes, anything larger is corrupt and must not be allocated
+				if(uncompressedSize / 255 > sections[i].size) throw SerializationException("World file section " + std::to_string(i) + " has an invalid size");
+				decompressedSections[i].resize(static_cast<size_t>(uncompressedSize));
+				Util::decompressBlock(storedData + sizeof(uint64_t), static_cast<size_t>(sections[i].size) - sizeof(uint64_t), decompressedSections[i].data(), decompressedSections[i].size());
+			}
+		}
+	}
+
+	std::pair<const char*, size_t> getSection(WorldFileSectionType type) const {
+		for(uint32_t i = 0; i < sectionCount; i++) {
+			if(sections[i].type == static_cast<uint32_t>(type)) {
+				if(sections[i].flags & WORLD_FILE_SECTION_COMPRESSED) {
+					return std::pair<const char*, size_t>(decompressedSections[i].data(), decompressedSections[i].size());
+				}
+				return std::pair<const char*, size_t>(fileData + sections[i].offset, static_cast<size_t>(sections[i].size));
+			}
+		}
+		throw SerializationException("World file is missing section " + std::to_string(static_cast<uint32_t>(type)));
+	}
+
+	template<typename T>
+	size_t getColumnSize(WorldFileSectionType type) const {
+		std::pair<const char*, size_t> section = getSection(type);
+		if(section.second % sizeof(T) != 0) throw SerializationException("World file section " + std::to_string(static_cast<uint32_t>(type)) + " is not a whole number of elements");
+		return section.second / sizeof(T);
+	}
+
+	// the returned column points into the file
+	template<typename T>
+	const T* getColumn(WorldFileSectionType type, size_t expectedSize) const {
+		if(getColumnSize<T>(type) != expectedSize) throw SerializationException("World file column " + std::to_string(static_cast<uint32_t>(type)) + " has the wrong size");
+		const char* columnData = getSection(type).first;
+		if(reinterpret_cast<std::uintptr_t>(columnData) % alignof(T) != 0) throw SerializationException("World file column " + std::to_string(static_cast<uint32_t>(type)) + " is not aligned");
+		return reinterpret_cast<const T*>(columnData);
+	}
+};
 
-	::serialize<uint32_t>(numberOfUnPhysicaledPartsInLayer, ostream);
-	layer.tree.forEach([this, &ostream](const Part& p) {
-		if(p.parent == nullptr) {
-			::serialize<GlobalCFrame>(p.getCFrame(), ostream);
-			this->serializePartData(p, ostream);
+/*
+	Splits the range 0..itemCount into chunks of chunkSize, and calls func(chunkStart, chunkEnd) for every chunk on the pool's threads
+	The first exception thrown by any chunk is rethrown on the calling thread once all threads are done
+*/
+template<typename Func>
+static void forEachChunkInParallel(ThreadPool& pool, size_t itemCount, const Func& func, size_t chunkSize = 256) {
+	size_t chunkCount = (itemCount + chunkSize - 1) / chunkSize;
+	if(chunkCount <= 1) {
+		func(0, itemCount);
+		return;
+	}
+	std::atomic<size_t> nextChunk(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr firstException;
+	std::mutex exceptionMutex;
+	pool.doInParallel([&]() {
+		while(!failed) {
+			size_t chunk = nextChunk++;
+			if(chunk >= chunkCount) break;
+			try {
+				func(chunk * chunkSize, std::min(itemCount, (chunk + 1) * chunkSize));
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(exceptionMutex);
+				if(!failed) {
+					firstException = std::current_exception();
+					failed = true;
+				}
+			}
 		}
 	});
+	if(firstException) std::rethrow_exception(firstException);
+}
+
+static void addPartsOfPhysical(const Physical& phys, std::vector<const Part*>& parts) {
+	for(const Part& p : phys.rigidBody) {
+		parts.push_back(&p);
+	}
+	for(const ConnectedPhysical& p : phys.childPhysicals) {
+		addPartsOfPhysical(p, parts);
+	}
 }
 
+#pragma endregion
+
 void SerializationSessionPrototype::serializeWorld(const WorldPrototype& world, std::ostream& ostream) {
 	for(const MotorizedPhysical* p : world.physicals) {
 		collectMotorizedPhysicalInformation(*p);
@@ -403,91 +643,267 @@ void SerializationSessionPrototype::serializeWorld(const WorldPrototype& world,
 		}
 	}
 
-	serializeCollectedHeaderInformation(ostream);
-	
+	// the part table, in the same order as the physicals will refer to them
+	std::vector<const Part*> parts;
+	for(const ColissionLayer& clayer : world.layers) {
+		for(const WorldLayer& layer : clayer.subLayers) {
+			layer.tree.forEach([&parts](const Part& p) {
+				if(p.parent == nullptr) {
+					parts.push_back(&p);
+				}
+			});
+		}
+	}
+	for(const MotorizedPhysical* p : world.physicals) {
+		addPartsOfPhysical(*p, parts);
+	}
+	for(size_t i = 0; i < parts.size(); i++) {
+		this->partIndexMap.emplace(parts[i], static_cast<uint32_t>(i));
+	}
+
+	WorldFileWriter file(this->compressWorldFiles);
 
-	// actually serialize the world
+	// every section is written into the same buffer, and moved out when it is done
+	OutputBuffer sectionBuffer;
+	std::ostream sectionStream(&sectionBuffer);
 
-	::serialize<uint64_t>(world.age, ostream);
+	serializeCollectedHeaderInformation(sectionStream);
+	file.addSection(WorldFileSectionType::SHAPE_CLASSES, sectionBuffer.release());
 
-	::serialize<uint32_t>(world.getLayerCount(), ostream);
+	::serialize<uint64_t>(world.age, sectionStream);
+	::serialize<uint32_t>(world.getLayerCount(), sectionStream);
 	for(int i = 0; i < world.getLayerCount(); i++) {
 		for(int j = 0; j <= i; j++) {
-			::serialize<bool>(world.doLayersCollide(i, j), ostream);
+			::serialize<bool>(world.doLayersCollide(i, j), sectionStream);
 		}
 	}
-
 	for(const ColissionLayer& layer : world.layers) {
-		serializeWorldLayer(layer.subLayers[ColissionLayer::TERRAIN_PARTS_LAYER], ostream);
+		::serialize<Position>(layer.getOrigin(), sectionStream);
+		::serialize<uint32_t>(static_cast<uint32_t>(layer.broadphase), sectionStream);
 	}
-
-	::serialize<uint32_t>(world.physicals.size(), ostream);
+	file.addSection(WorldFileSectionType::WORLD_INFO, sectionBuffer.release());
+
+	std::vector<GlobalCFrame> cframes(parts.size());
+	std::vector<DiagonalMat3> scales(parts.size());
+	std::vector<uint32_t> shapeClassIDs(parts.size());
+	std::vector<PartProperties> properties(parts.size());
+	std::vector<uint32_t> layerIDs(parts.size());
+	std::vector<uint64_t> externalDataOffsets(parts.size() + 1);
+	for(size_t i = 0; i < parts.size(); i++) {
+		const Part& part = *parts[i];
+		cframes[i] = part.getCFrame();
+		scales[i] = part.hitbox.scale;
+		shapeClassIDs[i] = shapeSerializer.sharedShapeClassSerializer.getIDFor(part.hitbox.baseShape);
+		properties[i] = part.properties;
+		layerIDs[i] = static_cast<uint32_t>(part.getLayerID());
+		externalDataOffsets[i] = static_cast<uint64_t>(sectionBuffer.size());
+		this->serializePartExternalData(part, sectionStream);
+	}
+	externalDataOffsets[parts.size()] = static_cast<uint64_t>(sectionBuffer.size());
+	file.addColumn(WorldFileSectionType::PART_CFRAMES, cframes);
+	file.addColumn(WorldFileSectionType::PART_SCALES, scales);
+	file.addColumn(WorldFileSectionType::PART_SHAPE_CLASSES, shapeClassIDs);
+	file.addColumn(WorldFileSectionType::PART_PROPERTIES, properties);
+	file.addColumn(WorldFileSectionType::PART_LAYERS, layerIDs);
+	file.addColumn(WorldFileSectionType::PART_EXTERNAL_DATA_OFFSETS, externalDataOffsets);
+	file.addSection(WorldFileSectionType::PART_EXTERNAL_DATA, sectionBuffer.release());
+
+	std::vector<uint64_t> physicalOffsets;
+	physicalOffsets.reserve(world.physicals.size() + 1);
 	for(const MotorizedPhysical* p : world.physicals) {
-		serializeMotorizedPhysicalInContext(*p, ostream);
+		physicalOffsets.push_back(static_cast<uint64_t>(sectionBuffer.size()));
+		serializeMotorizedPhysicalInContext(*p, sectionStream);
+	}
+	physicalOffsets.push_back(static_cast<uint64_t>(sectionBuffer.size()));
+	file.addSection(WorldFileSectionType::PHYSICALS, sectionBuffer.release());
+	file.addColumn(WorldFileSectionType::PHYSICAL_OFFSETS, physicalOffsets);
+
+	std::vector<WorldFileTreeDirectoryEntry> treeDirectory;
+	std::vector<P3D::NewBoundsTree::TreeImageTrunk> treeTrunks;
+	for(const ColissionLayer& clayer : world.layers) {
+		for(const WorldLayer& layer : clayer.subLayers) {
+			std::vector<P3D::NewBoundsTree::TreeImageTrunk> image = layer.tree.getImage([this](const Part& p) {
+				return this->partIndexMap.at(&p);
+			});
+			treeDirectory.push_back(WorldFileTreeDirectoryEntry{treeTrunks.size(), image.size()});
+			treeTrunks.insert(treeTrunks.end(), image.begin(), image.end());
+		}
 	}
+	file.addColumn(WorldFileSectionType::TREE_DIRECTORY, treeDirectory);
+	file.addColumn(WorldFileSectionType::TREE_TRUNKS, treeTrunks);
 
-	::serialize<std::uint32_t>(static_cast<std::uint32_t>(world.constraints.size()), ostream);
+	::serialize<std::uint32_t>(static_cast<std::uint32_t>(world.constraints.size()), sectionStream);
 	for(const ConstraintGroup& cg : world.constraints) {
-		::serialize<std::uint32_t>(static_cast<std::uint32_t>(cg.constraints.size()), ostream);
+		::serialize<std::uint32_t>(static_cast<std::uint32_t>(cg.constraints.size()), sectionStream);
 		for(const PhysicalConstraint& c : cg.constraints) {
-			this->serializeConstraintInContext(c, ostream);
+			this->serializeConstraintInContext(c, sectionStream);
 		}
 	}
-	::serialize<uint32_t>(world.externalForces.size(), ostream);
+	file.addSection(WorldFileSectionType::CONSTRAINTS, sectionBuffer.release());
+
+	::serialize<uint32_t>(static_cast<uint32_t>(world.externalForces.size()), sectionStream);
 	for(ExternalForce* force : world.externalForces) {
-		dynamicExternalForceSerializer.serialize(*force, ostream);
+		dynamicExternalForceSerializer.serialize(*force, sectionStream);
 	}
-}
+	file.addSection(WorldFileSectionType::EXTERNAL_FORCES, sectionBuffer.release());
 
-void DeSerializationSessionPrototype::deserializeWorldLayer(WorldLayer& layer, std::istream& istream) {
-	uint32_t extraPartsInLayer = ::deserialize<uint32_t>(istream);
-	for(uint32_t i = 0; i < extraPartsInLayer; i++) {
-		GlobalCFrame cf = ::deserialize<GlobalCFrame>(istream);
-		layer.tree.add(deserializePartData(cf, &layer, istream));
-	}
+	file.write(ostream);
 }
 
 void DeSerializationSessionPrototype::deserializeWorld(WorldPrototype& world, std::istream& istream) {
-	this->deserializeAndCollectHeaderInformation(istream);
+	std::vector<char> fileData((std::istreambuf_iterator<char>(istream)), std::istreambuf_iterator<char>());
+	this->deserializeWorld(world, fileData.data(), fileData.size());
+}
+
+void DeSerializationSessionPrototype::deserializeWorld(WorldPrototype& world, const char* fileData, std::size_t fileSize) {
+	WorldFileReader file(fileData, fileSize);
+
+	std::pair<const char*, size_t> headerSection = file.getSection(WorldFileSectionType::SHAPE_CLASSES);
+	MemoryInputBuffer sectionBuffer(headerSection.first, headerSection.first + headerSection.second);
+	std::istream sectionStream(&sectionBuffer);
+	this->deserializeAndCollectHeaderInformation(sectionStream);
 
-	world.age = ::deserialize<uint64_t>(istream);
+	std::pair<const char*, size_t> worldInfoSection = file.getSection(WorldFileSectionType::WORLD_INFO);
+	sectionBuffer.setRange(worldInfoSection.first, worldInfoSection.first + worldInfoSection.second);
+	sectionStream.clear();
+
+	world.age = ::deserialize<uint64_t>(sectionStream);
 
 	world.layers.clear();
-	uint32_t layerCount = ::deserialize<uint32_t>(istream);
+	uint32_t layerCount = ::deserialize<uint32_t>(sectionStream);
+	std::vector<bool> layerMask;
+	for(uint32_t i = 0; i < layerCount; i++) {
+		for(uint32_t j = 0; j <= i; j++) {
+			layerMask.push_back(::deserialize<bool>(sectionStream));
+		}
+	}
 	world.layers.reserve(layerCount);
 	for(uint32_t i = 0; i < layerCount; i++) {
-		world.layers.emplace_back(&world, false);
+		Position origin = ::deserialize<Position>(sectionStream);
+		BroadphaseType broadphase = static_cast<BroadphaseType>(::deserialize<uint32_t>(sectionStream));
+		world.layers.emplace_back(&world, false, origin, broadphase);
 	}
+	size_t maskIndex = 0;
 	for(int i = 0; i < world.getLayerCount(); i++) {
 		for(int j = 0; j <= i; j++) {
-			bool layersCollide = ::deserialize<bool>(istream);
-			world.setLayersCollide(i, j, layersCollide);
+			world.setLayersCollide(i, j, layerMask[maskIndex++]);
 		}
 	}
-	for(ColissionLayer& layer : world.layers) {
-		deserializeWorldLayer(layer.subLayers[ColissionLayer::TERRAIN_PARTS_LAYER], istream);
+	if(!sectionStream) throw SerializationException("World info section is truncated");
+
+	size_t partCount = file.getColumnSize<GlobalCFrame>(WorldFileSectionType::PART_CFRAMES);
+	const GlobalCFrame* cframes = file.getColumn<GlobalCFrame>(WorldFileSectionType::PART_CFRAMES, partCount);
+	const DiagonalMat3* scales = file.getColumn<DiagonalMat3>(WorldFileSectionType::PART_SCALES, partCount);
+	const uint32_t* shapeClassIDs = file.getColumn<uint32_t>(WorldFileSectionType::PART_SHAPE_CLASSES, partCount);
+	const PartProperties* properties = file.getColumn<PartProperties>(WorldFileSectionType::PART_PROPERTIES, partCount);
+	const uint32_t* layerIDs = file.getColumn<uint32_t>(WorldFileSectionType::PART_LAYERS, partCount);
+	const uint64_t* externalDataOffsets = file.getColumn<uint64_t>(WorldFileSectionType::PART_EXTERNAL_DATA_OFFSETS, partCount + 1);
+	std::pair<const char*, size_t> externalData = file.getSection(WorldFileSectionType::PART_EXTERNAL_DATA);
+
+	indexToPartMap.resize(partCount);
+	auto createParts = [&](size_t firstPart, size_t endPart) {
+		MemoryInputBuffer externalDataBuffer(externalData.first, externalData.first);
+		std::istream externalDataStream(&externalDataBuffer);
+		for(size_t i = firstPart; i < endPart; i++) {
+			if(layerIDs[i] >= layerCount * ColissionLayer::NUMBER_OF_SUBLAYERS) throw SerializationException("Part " + std::to_string(i) + " has an invalid layer");
+			if(externalDataOffsets[i] > externalDataOffsets[i + 1] || externalDataOffsets[i + 1] > externalData.second) throw SerializationException("Part " + std::to_string(i) + " has invalid external data");
+
+			externalDataBuffer.setRange(externalData.first + externalDataOffsets[i], externalData.first + externalDataOffsets[i + 1]);
+			externalDataStream.clear();
+
+			Shape shape(shapeDeserializer.sharedShapeClassDeserializer.getObject(shapeClassIDs[i]), scales[i][0] * 2, scales[i][1] * 2, scales[i][2] * 2);
+			Part* newPart = this->deserializePartExternalData(Part(shape, cframes[i], properties[i]), externalDataStream);
+			newPart->layer = getLayerByID(world.layers, static_cast<int>(layerIDs[i]));
+			indexToPartMap[i] = newPart;
+		}
+	};
+	if(this->canDeserializePartExternalDataInParallel()) {
+		forEachChunkInParallel(world.pool, partCount, createParts);
+	} else {
+		createParts(0, partCount);
 	}
 
-	uint32_t numberOfPhysicals = ::deserialize<uint32_t>(istream);
-	world.physicals.reserve(numberOfPhysicals);
-	for(uint32_t i = 0; i < numberOfPhysicals; i++) {
-		world.addPhysicalWithExistingLayers(deserializeMotorizedPhysicalWithContext(world.layers, istream));
+	std::pair<const char*, size_t> physicalsSection = file.getSection(WorldFileSectionType::PHYSICALS);
+	size_t physicalCount = file.getColumnSize<uint64_t>(WorldFileSectionType::PHYSICAL_OFFSETS);
+	if(physicalCount == 0) throw SerializationException("World file physical offsets are empty");
+	physicalCount--;
+	const uint64_t* physicalOffsets = file.getColumn<uint64_t>(WorldFileSectionType::PHYSICAL_OFFSETS, physicalCount + 1);
+	std::vector<MotorizedPhysical*> loadedPhysicals(physicalCount);
+	// the physicals of each MotorizedPhysical in the order they were written, these are concatenated afterwards for the constraints to refer to
+	std::vector<std::vector<Physical*>> physicalsInOrder(physicalCount);
+	forEachChunkInParallel(world.pool, physicalCount, [&](size_t firstPhysical, size_t endPhysical) {
+		MemoryInputBuffer physicalBuffer(physicalsSection.first, physicalsSection.first);
+		std::istream physicalStream(&physicalBuffer);
+		for(size_t i = firstPhysical; i < endPhysical; i++) {
+			if(physicalOffsets[i] > physicalOffsets[i + 1] || physicalOffsets[i + 1] > physicalsSection.second) throw SerializationException("Physical " + std::to_string(i) + " lies outside of the physicals section");
+			physicalBuffer.setRange(physicalsSection.first + physicalOffsets[i], physicalsSection.first + physicalOffsets[i + 1]);
+			physicalStream.clear();
+			loadedPhysicals[i] = deserializeMotorizedPhysicalWithContext(physicalStream, physicalsInOrder[i]);
+			if(!physicalStream) throw SerializationException("Physical " + std::to_string(i) + " is truncated");
+		}
+	});
+	world.physicals.reserve(physicalCount);
+	for(size_t i = 0; i < physicalCount; i++) {
+		loadedPhysicals[i]->world = &world;
+		world.physicals.push_back(loadedPhysicals[i]);
+		indexToPhysicalMap.insert(indexToPhysicalMap.end(), physicalsInOrder[i].begin(), physicalsInOrder[i].end());
 	}
+	world.structureVersion++;
+
+	// every part must end up in exactly one tree, the tree of its own layer
+	size_t layerTreeCount = static_cast<size_t>(layerCount) * ColissionLayer::NUMBER_OF_SUBLAYERS;
+	const WorldFileTreeDirectoryEntry* treeDirectory = file.getColumn<WorldFileTreeDirectoryEntry>(WorldFileSectionType::TREE_DIRECTORY, layerTreeCount);
+	size_t totalTrunkCount = file.getColumnSize<P3D::NewBoundsTree::TreeImageTrunk>(WorldFileSectionType::TREE_TRUNKS);
+	const P3D::NewBoundsTree::TreeImageTrunk* treeTrunks = file.getColumn<P3D::NewBoundsTree::TreeImageTrunk>(WorldFileSectionType::TREE_TRUNKS, totalTrunkCount);
+	std::unique_ptr<std::atomic<bool>[]> partIsInTree(new std::atomic<bool>[partCount]());
+	forEachChunkInParallel(world.pool, layerTreeCount, [&](size_t firstTree, size_t endTree) {
+		for(size_t t = firstTree; t < endTree; t++) {
+			const WorldFileTreeDirectoryEntry& entry = treeDirectory[t];
+			if(entry.firstTrunk > totalTrunkCount || entry.trunkCount > totalTrunkCount - entry.firstTrunk) throw SerializationException("Tree " + std::to_string(t) + " lies outside of the tree section");
+			const P3D::NewBoundsTree::TreeImageTrunk* image = treeTrunks + entry.firstTrunk;
+			size_t imageSize = static_cast<size_t>(entry.trunkCount);
+			if(!P3D::NewBoundsTree::isValidTreeImage(image, imageSize, partCount)) throw SerializationException("Tree " + std::to_string(t) + " is invalid");
+
+			WorldLayer* layer = getLayerByID(world.layers, static_cast<int>(t));
+			for(size_t trunk = 0; trunk < imageSize; trunk++) {
+				for(uint32_t i = 0; i < image[trunk].size; i++) {
+					uint32_t subNode = image[trunk].subNodes[i];
+					if(subNode & P3D::NewBoundsTree::TreeImageTrunk::TRUNK_FLAG) continue;
+					uint32_t partIndex = subNode >> P3D::NewBoundsTree::TreeImageTrunk::INDEX_SHIFT;
+					if(partIsInTree[partIndex].exchange(true) || indexToPartMap[partIndex]->layer != layer) throw SerializationException("Part " + std::to_string(partIndex) + " is in the wrong tree");
+				}
+			}
+			layer->tree.loadImage(image, imageSize, [this](uint32_t partIndex) {
+				return indexToPartMap[partIndex];
+			});
+		}
+	}, 1);
+	for(size_t i = 0; i < partCount; i++) {
+		if(!partIsInTree[i]) throw SerializationException("Part " + std::to_string(i) + " is not in any tree");
+	}
+	world.objectCount = partCount;
 
-	std::uint32_t constraintCount = ::deserialize<std::uint32_t>(istream);
+	std::pair<const char*, size_t> constraintsSection = file.getSection(WorldFileSectionType::CONSTRAINTS);
+	sectionBuffer.setRange(constraintsSection.first, constraintsSection.first + constraintsSection.second);
+	sectionStream.clear();
+	std::uint32_t constraintCount = ::deserialize<std::uint32_t>(sectionStream);
 	world.constraints.reserve(constraintCount);
 	for(std::uint32_t cg = 0; cg < constraintCount; cg++) {
 		ConstraintGroup group;
-		std::uint32_t numberOfConstraintsInGroup = ::deserialize<std::uint32_t>(istream);
+		std::uint32_t numberOfConstraintsInGroup = ::deserialize<std::uint32_t>(sectionStream);
 		for(std::uint32_t c = 0; c < numberOfConstraintsInGroup; c++) {
-			group.constraints.push_back(this->deserializeConstraintInContext(istream));
+			group.constraints.push_back(this->deserializeConstraintInContext(sectionStream));
 		}
 		world.constraints.push_back(std::move(group));
 	}
-	uint32_t forceCount = ::deserialize<uint32_t>(istream);
+
+	std::pair<const char*, size_t> externalForcesSection = file.getSection(WorldFileSectionType::EXTERNAL_FORCES);
+	sectionBuffer.setRange(externalForcesSection.first, externalForcesSection.first + externalForcesSection.second);
+	sectionStream.clear();
+	uint32_t forceCount = ::deserialize<uint32_t>(sectionStream);
 	world.externalForces.reserve(forceCount);
 	for(uint32_t i = 0; i < forceCount; i++) {
-		ExternalForce* force = dynamicExternalForceSerializer.deserialize(istream);
+		ExternalForce* force = dynamicExternalForceSerializer.deserialize(sectionStream);
 		world.externalForces.push_back(force);
 	}
 }
@@ -563,6 +979,8 @@ static DynamicSerializerRegistry<Constraint>::ConcreteDynamicSerializer<BarConst
 
 static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<PolyhedronShapeClass> polyhedronSerializer
 (serializePolyhedronShapeClass, deserializePolyhedronShapeClass, 0);
+static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<TerrainMeshClass> terrainMeshSerializer
+(serializeTerrainMeshClass, deserializeTerrainMeshClass, 1);
 
 static DynamicSerializerRegistry<ExternalForce>::ConcreteDynamicSerializer<DirectionalGravity> gravitySerializer
 (serializeDirectionalGravity, deserializeDirectionalGravity, 0);
@@ -578,8 +996,14 @@ DynamicSerializerRegistry<HardConstraint> dynamicHardConstraintSerializer{
 	{typeid(SinusoidalPistonConstraint), &pistonConstraintSerializer},
 	{typeid(MotorConstraintTemplate<SineWaveController>), &sinusiodalMotorConstraintSerializer}
 };
+// polyhedronShape creates one of the instruction set specific subclasses, they are all stored as plain polyhedra
 DynamicSerializerRegistry<ShapeClass> dynamicShapeClassSerializer{
-	{typeid(PolyhedronShapeClass), &polyhedronSerializer}
+	{typeid(PolyhedronShapeClass), &polyhedronSerializer},
+	{typeid(PolyhedronShapeClassAVX), &polyhedronSerializer},
+	{typeid(PolyhedronShapeClassSSE), &polyhedronSerializer},
+	{typeid(PolyhedronShapeClassSSE4), &polyhedronSerializer},
+	{typeid(PolyhedronShapeClassFallback), &polyhedronSerializer},
+	{typeid(TerrainMeshClass), &terrainMeshSerializer}
 };
 DynamicSerializerRegistry<ExternalForce> dynamicExternalForceSerializer{
 	{typeid(DirectionalGravity), &gravitySerializer}
@@ -71,6 +71,9 @@ protected:
 	ShapeSerializer shapeSerializer;
 	std::map<const Physical*, std::uint32_t> physicalIndexMap;
 	std::uint32_t currentPhysicalIndex = 0;
+	// index of each part in the part columns of a world file
+	std::unordered_map<const Part*, std::uint32_t> partIndexMap;
+	bool compressWorldFiles = false;
 
 private:
 	void collectMotorizedPhysicalInformation(const MotorizedPhysical& motorizedPhys);
@@ -81,7 +84,6 @@ private:
 	void serializePhysicalInContext(const Physical& phys, std::ostream& ostream);
 	void serializeRigidBodyInContext(const RigidBody& rigidBody, std::ostream& ostream);
 
-	void serializeWorldLayer(const WorldLayer& layer, std::ostream& ostream);
 	void serializeConstraintInContext(const PhysicalConstraint& constraint, std::ostream& ostream);
 
 protected:
@@ -97,25 +99,33 @@ public:
 	Implicitly the builtin ShapeClasses from the physics engine, such as cubeClass and sphereClass are also included in this list */
 	SerializationSessionPrototype(const std::vector<const ShapeClass*>& knownShapeClasses = std::vector<const ShapeClass*>());
 
+	// compresses the sections of world files written by this session, this makes the files smaller, but they can no longer be read in place
+	void setWorldFileCompression(bool enabled) { this->compressWorldFiles = enabled; }
+
+	// writes the world in the sectioned world file format, see world.grammar
 	void serializeWorld(const WorldPrototype& world, std::ostream& ostream);
 	void serializeParts(const Part* const parts[], size_t partCount, std::ostream& ostream);
 };
 
 class DeSerializationSessionPrototype {
 private:
-	MotorizedPhysical* deserializeMotorizedPhysicalWithContext(std::vector<ColissionLayer>& layers, std::istream& istream);
-	void deserializeConnectionsOfPhysicalWithContext(std::vector<ColissionLayer>& layers, Physical& physToPopulate, std::istream& istream);
-	RigidBody deserializeRigidBodyWithContext(const GlobalCFrame& cframeOfMain, std::vector<ColissionLayer>& layers, std::istream& istream);
+	// these only read the session, so physicals can be deserialized in parallel. The deserialized physicals are added to physicalsInOrder
+	MotorizedPhysical* deserializeMotorizedPhysicalWithContext(std::istream& istream, std::vector<Physical*>& physicalsInOrder) const;
+	void deserializeConnectionsOfPhysicalWithContext(Physical& physToPopulate, std::istream& istream, std::vector<Physical*>& physicalsInOrder) const;
+	RigidBody deserializeRigidBodyWithContext(std::istream& istream) const;
 	PhysicalConstraint deserializeConstraintInContext(std::istream& istream);
-	void deserializeWorldLayer(WorldLayer& layer, std::istream& istream);
+	Part* deserializePartIndex(std::istream& istream) const;
 protected:
 	ShapeDeserializer shapeDeserializer;
 	std::vector<Physical*> indexToPhysicalMap;
+	std::vector<Part*> indexToPartMap;
 
 	// creates a part with the given cframe, layer, and extra data it deserializes
 	// calls deserializePartExternalData for extending this deserialization
 	Part* deserializePartData(const GlobalCFrame& cframe, WorldLayer* layer, std::istream& istream);
 	virtual Part* deserializePartExternalData(Part&& part, std::istream& istream);
+	// whether deserializePartExternalData may be called from several threads at once, when loading a world
+	virtual bool canDeserializePartExternalDataInParallel() const;
 
 	virtual void deserializeAndCollectHeaderInformation(std::istream& istream);
 
@@ -125,7 +135,13 @@ public:
 	DeSerializationSessionPrototype(const std::vector<const ShapeClass*>& knownShapeClasses = std::vector<const ShapeClass*>());
 
 
+	// reads the whole stream into memory, and deserializes it as below
 	void deserializeWorld(WorldPrototype& world, std::istream& istream);
+	/*
+		Deserializes a world file that is entirely in memory, such as a memory mapped file
+		Part columns and tree images are used in place, fileData must be aligned to at least 8 bytes, as given by mmap or new
+	*/
+	void deserializeWorld(WorldPrototype& world, const char* fileData, std::size_t fileSize);
 	std::vector<Part*> deserializeParts(std::istream& istream);
 };
 
@@ -160,6 +176,7 @@ private:
 	}
 public:
 	using SerializationSessionPrototype::SerializationSessionPrototype;
+	using SerializationSessionPrototype::setWorldFileCompression;
 
 
 	void serializeWorld(const World<ExtendedPartType>& world, std::ostream& ostream) {
@@ -184,6 +201,9 @@ protected:
 	
 	virtual ExtendedPartType* deserializeExtendedPart(Part&& partPrototype, std::istream& istream) = 0;
 
+	// extended parts often register themselves elsewhere, so by default they are created one at a time
+	virtual bool canDeserializePartExternalDataInParallel() const override { return false; }
+
 private:
 	inline virtual Part* deserializePartExternalData(Part&& part, std::istream& istream) final override { return deserializeExtendedPart(std::move(part), istream); }
 
@@ -191,6 +211,7 @@ public:
 	using DeSerializationSessionPrototype::DeSerializationSessionPrototype;
 
 	void deserializeWorld(World<ExtendedPartType>& world, std::istream& istream) { DeSerializationSessionPrototype::deserializeWorld(world, istream); }
+	void deserializeWorld(World<ExtendedPartType>& world, const char* fileData, std::size_t fileSize) { DeSerializationSessionPrototype::deserializeWorld(world, fileData, fileSize); }
 	std::vector<ExtendedPartType*> deserializeParts(std::istream& istream) {
 		return castVector<ExtendedPartType>(DeSerializationSessionPrototype::deserializeParts(istream));
 	}
@@ -0,0 +1,145 @@
+#include "traceRecorder.h"
+
+#include <fstream>
+#include <set>
+#include <cstdio>
+
+TraceRecorder::TraceRecorder(size_t capacity, bool ringBuffer) : capacity(capacity), ringBuffer(ringBuffer), epoch(std::chrono::steady_clock::now()) {}
+
+void TraceRecorder::addSpan(const TraceSpan& span) {
+	std::lock_guard<std::mutex> lg(lock);
+	if(spans.size() < capacity) {
+		spans.push_back(span);
+		nextSpan = spans.size() % capacity;
+		if(nextSpan == 0) hasComeAround = true;
+	} else if(ringBuffer && capacity != 0) {
+		spans[nextSpan] = span;
+		nextSpan = (nextSpan + 1) % capacity;
+	} else {
+		droppedSpanCount++;
+	}
+}
+
+std::vector<TraceSpan> TraceRecorder::getSpansInOrder() const {
+	if(!hasComeAround) return spans;
+	std::vector<TraceSpan> result;
+	result.reserve(spans.size());
+	result.insert(result.end(), spans.begin() + nextSpan, spans.end());
+	result.insert(result.end(), spans.begin(), spans.begin() + nextSpan);
+	return result;
+}
+
+void TraceRecorder::endTick(std::chrono::steady_clock::time_point tickStart, std::chrono::steady_clock::time_point tickEnd) {
+	std::string fileToWrite;
+	std::vector<TraceSpan> captured;
+	{
+		std::lock_guard<std::mutex> lg(lock);
+		if(slowTickThreshold.count() == 0 || tickEnd - tickStart <= slowTickThreshold) return;
+
+		capturedSpans = getSpansInOrder();
+		captureCount++;
+		if(captureFileName.empty()) return;
+		fileToWrite = captureFileName;
+		captured = capturedSpans;
+	}
+	// written outside the lock, so worker threads don't wait for the file
+	std::ofstream file(fileToWrite);
+	writeChromeTrace(file, captured);
+}
+
+void TraceRecorder::setSlowTickCapture(std::chrono::nanoseconds threshold, std::string fileName) {
+	std::lock_guard<std::mutex> lg(lock);
+	slowTickThreshold = threshold;
+	captureFileName = std::move(fileName);
+}
+
+size_t TraceRecorder::getCaptureCount() const {
+	std::lock_guard<std::mutex> lg(lock);
+	return captureCount;
+}
+
+size_t TraceRecorder::getSpanCount() const {
+	std::lock_guard<std::mutex> lg(lock);
+	return spans.size();
+}
+
+size_t TraceRecorder::getDroppedSpanCount() const {
+	std::lock_guard<std::mutex> lg(lock);
+	return droppedSpanCount;
+}
+
+static void writeEscaped(std::ostream& output, const char* text) {
+	for(const char* c = text; *c != '\0'; c++) {
+		if(*c == '"' || *c == '\\') output << '\\';
+		output << *c;
+	}
+}
+
+static void writeMicroseconds(std::ostream& output, std::chrono::nanoseconds time) {
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "%.3f", time.count() / 1000.0);
+	output << buf;
+}
+
+void TraceRecorder::writeChromeTrace(std::ostream& output, const std::vector<TraceSpan>& spansToWrite) const {
+	output << "{\"traceEvents\":[";
+	bool isFirst = true;
+
+	std::set<uint32_t> threads;
+	for(const TraceSpan& span : spansToWrite) {
+		threads.insert(span.threadIndex);
+	}
+	for(uint32_t thread : threads) {
+		if(!isFirst) output << ',';
+		isFirst = false;
+		output << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":\"Thread " << thread << "\"}}";
+	}
+
+	for(const TraceSpan& span : spansToWrite) {
+		if(!isFirst) output << ',';
+		isFirst = false;
+		output << "\n{\"name\":\"";
+		writeEscaped(output, span.name);
+		output << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.threadIndex << ",\"ts\":";
+		writeMicroseconds(output, span.start - epoch);
+		output << ",\"dur\":";
+		writeMicroseconds(output, span.end - span.start);
+		output << '}';
+	}
+	output << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void TraceRecorder::writeChromeTrace(std::ostream& output) const {
+	std::vector<TraceSpan> spansToWrite;
+	{
+		std::lock_guard<std::mutex> lg(lock);
+		spansToWrite = getSpansInOrder();
+	}
+	writeChromeTrace(output, spansToWrite);
+}
+
+void TraceRecorder::writeCapturedChromeTrace(std::ostream& output) const {
+	std::vector<TraceSpan> spansToWrite;
+	{
+		std::lock_guard<std::mutex> lg(lock);
+		spansToWrite = capturedSpans;
+	}
+	writeChromeTrace(output, spansToWrite);
+}
+
+bool TraceRecorder::saveChromeTrace(const char* fileName) const {
+	std::ofstream file(fileName);
+	if(!file) return false;
+	writeChromeTrace(file);
+	return bool(file);
+}
+
+void TraceRecorder::clear() {
+	std::lock_guard<std::mutex> lg(lock);
+	spans.clear();
+	nextSpan = 0;
+	hasComeAround = false;
+	droppedSpanCount = 0;
+	capturedSpans.clear();
+	captureCount = 0;
+}
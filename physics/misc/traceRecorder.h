@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+struct TraceSpan {
+	const char* name;
+	uint32_t threadIndex;
+	std::chrono::steady_clock::time_point start;
+	std::chrono::steady_clock::time_point end;
+};
+
+/*
+	Records the spans a BreakdownAverageProfiler measures, and writes them as a Chrome trace, which chrome://tracing and the Perfetto UI can open
+
+	In ring buffer mode only the latest capacity spans are kept, otherwise recording stops once capacity spans have been recorded
+	With a slow tick capture set, the spans in the buffer are saved whenever a tick takes longer than the threshold,
+	so a recorder can run in ring buffer mode on a server and keep the ticks that led up to a hitch
+*/
+class TraceRecorder {
+	mutable std::mutex lock;
+	std::vector<TraceSpan> spans;
+	size_t capacity;
+	size_t nextSpan = 0;
+	bool hasComeAround = false;
+	bool ringBuffer;
+	size_t droppedSpanCount = 0;
+	// timestamps in the trace are relative to the creation of the recorder
+	std::chrono::steady_clock::time_point epoch;
+
+	std::chrono::nanoseconds slowTickThreshold = std::chrono::nanoseconds(0);
+	std::string captureFileName;
+	std::vector<TraceSpan> capturedSpans;
+	size_t captureCount = 0;
+
+	std::vector<TraceSpan> getSpansInOrder() const;
+	void writeChromeTrace(std::ostream& output, const std::vector<TraceSpan>& spansToWrite) const;
+public:
+	TraceRecorder(size_t capacity, bool ringBuffer);
+
+	// may be called from any thread
+	void addSpan(const TraceSpan& span);
+	// called by the profiler at the end of every tick, to check for slow ticks
+	void endTick(std::chrono::steady_clock::time_point tickStart, std::chrono::steady_clock::time_point tickEnd);
+
+	/*
+		Captures the recorded spans whenever a tick takes longer than threshold, a threshold of 0 turns capturing off
+		If a file name is given, every capture is also written to that file, replacing the previous capture
+	*/
+	void setSlowTickCapture(std::chrono::nanoseconds threshold, std::string fileName = std::string());
+	size_t getCaptureCount() const;
+
+	size_t getSpanCount() const;
+	size_t getDroppedSpanCount() const;
+
+	void writeChromeTrace(std::ostream& output) const;
+	// writes the spans of the latest slow tick capture
+	void writeCapturedChromeTrace(std::ostream& output) const;
+	bool saveChromeTrace(const char* fileName) const;
+
+	void clear();
+};
@@ -5,7 +5,7 @@
 #include "../math/linalg/largeMatrix.h"
 #include "../math/cframe.h"
 #include "../motion.h"
-#include "../datastructures/boundsTree.h"
+#include "../datastructures/boundsTreeOld.h"
 #include "../datastructures/boundsTree2.h"
 
 #include <cmath>
@@ -161,7 +161,7 @@ bool isMotorizedPhysicalValid(const MotorizedPhysical* mainPhys);
 namespace P3D::NewBoundsTree {
 
 template<typename Boundable>
-inline bool isBoundsTreeValidRecursive(const TreeTrunk& curNode, int curNodeSize, int depth = 0) {
+inline bool isBoundsTreeValidRecursive(const TreeTrunk& curNode, int curNodeSize, const Position& treeOrigin, int depth = 0) {
 	for(int i = 0; i < curNodeSize; i++) {
 		const TreeNodeRef& subNode = curNode.subNodes[i];
 
@@ -178,13 +178,13 @@ inline bool isBoundsTreeValidRecursive(const TreeTrunk& curNode, int curNodeSize
 				return false;
 			}
 
-			if(!isBoundsTreeValidRecursive<Boundable>(subTrunk, subTrunkSize, depth + 1)) {
+			if(!isBoundsTreeValidRecursive<Boundable>(subTrunk, subTrunkSize, treeOrigin, depth + 1)) {
 				std::cout << "(" << i << "/" << curNodeSize << ")\n";
 				return false;
 			}
 		} else {
 			const Boundable* itemB = static_cast<const Boundable*>(subNode.asObject());
-			if(foundBounds != itemB->getBounds()) {
+			if(foundBounds != toTreeBounds(itemB->getBounds(), treeOrigin)) {
 				std::cout << "(" << i << "/" << curNodeSize << ") Leaf not up to date\n";
 				return false;
 			}
@@ -194,14 +194,14 @@ inline bool isBoundsTreeValidRecursive(const TreeTrunk& curNode, int curNodeSize
 }
 
 template<typename Boundable>
-bool isBoundsTreeValid(const BoundsTreePrototype& tree) {
+bool isBoundsTreeValid(const BoundsTreePrototype& tree, const Position& treeOrigin = Position()) {
 	std::pair<const TreeTrunk&, int> baseTrunk = tree.getBaseTrunk();
-	return isBoundsTreeValidRecursive<Boundable>(baseTrunk.first, baseTrunk.second);
+	return isBoundsTreeValidRecursive<Boundable>(baseTrunk.first, baseTrunk.second, treeOrigin);
 }
 
 template<typename Boundable>
 bool isBoundsTreeValid(const BoundsTree<Boundable>& tree) {
-	return isBoundsTreeValid<Boundable>(tree.getPrototype());
+	return isBoundsTreeValid<Boundable>(tree.getPrototype(), tree.getOrigin());
 }
 
 template<typename Boundable>
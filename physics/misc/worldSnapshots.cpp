@@ -0,0 +1,277 @@
+#include "worldSnapshots.h"
+
+#include "../world.h"
+#include "../physical.h"
+#include "../hardconstraints/hardConstraint.h"
+
+#include <cstring>
+#include <cassert>
+
+static PhysicalSnapshotState getSnapshotState(const MotorizedPhysical& phys) {
+	return PhysicalSnapshotState{phys.getCFrame(), phys.motionOfCenterOfMass, phys.totalForce, phys.totalMoment};
+}
+
+static ConnectionSnapshotState getSnapshotState(const HardPhysicalConnection& connection) {
+	return ConnectionSnapshotState{connection.attachOnChild, connection.attachOnParent};
+}
+
+// appends the state of the constraint to data, and returns where it starts
+static size_t appendConstraintState(std::vector<char>& data, const HardConstraint& constraint) {
+	size_t offset = data.size();
+	data.resize(offset + constraint.getStateSize());
+	constraint.writeState(data.data() + offset);
+	return offset;
+}
+
+// fields are compared bitwise, restoring must give back exactly the recorded state
+template<typename T>
+static bool isBitwiseEqual(const T& a, const T& b) {
+	return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+template<typename T>
+static void appendField(std::vector<char>& data, const T& field) {
+	const char* bytes = reinterpret_cast<const char*>(&field);
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static void readField(const char*& data, T& field) {
+	std::memcpy(&field, data, sizeof(T));
+	data += sizeof(T);
+}
+
+bool WorldSnapshotBuffer::Snapshot::isKeyframe() const {
+	return keyframeAge == age;
+}
+
+WorldSnapshotBuffer::WorldSnapshotBuffer(size_t capacity, size_t keyframeInterval) : snapshots(capacity), keyframeInterval(keyframeInterval) {
+	assert(capacity >= 1);
+	assert(keyframeInterval >= 1);
+}
+
+bool WorldSnapshotBuffer::isKeyframeUpToDate(const WorldPrototype& world) const {
+	if(snapshotCount == 0 || snapshotsSinceKeyframe >= keyframeInterval) return false;
+	// the next snapshot would overwrite its own keyframe
+	if(nextSlot == latestKeyframeSlot) return false;
+	return snapshots[latestKeyframeSlot].structureVersion == world.structureVersion;
+}
+
+void WorldSnapshotBuffer::recordKeyframe(const WorldPrototype& world, Snapshot& snapshot, size_t slot) {
+	snapshot.keyframeSlot = slot;
+	snapshot.keyframeAge = world.age;
+	snapshot.structureVersion = world.structureVersion;
+	snapshot.states.clear();
+	snapshot.states.reserve(world.physicals.size());
+	snapshot.connections.clear();
+	snapshot.constraintStates.clear();
+	for(const MotorizedPhysical* phys : world.physicals) {
+		snapshot.states.push_back(getSnapshotState(*phys));
+		phys->forEachHardConstraint([&snapshot](const Physical& parent, const ConnectedPhysical& child) {
+			const HardPhysicalConnection& connection = child.connectionToParent;
+			snapshot.connections.push_back(getSnapshotState(connection));
+			appendConstraintState(snapshot.constraintStates, *connection.constraintWithParent);
+		});
+	}
+	snapshot.changedFields.clear();
+	snapshot.changedData.clear();
+}
+
+void WorldSnapshotBuffer::recordDelta(const WorldPrototype& world, Snapshot& snapshot, const Snapshot& keyframe) {
+	snapshot.keyframeSlot = latestKeyframeSlot;
+	snapshot.keyframeAge = keyframe.age;
+	snapshot.states.clear();
+	snapshot.connections.clear();
+	snapshot.constraintStates.clear();
+
+	snapshot.changedFields.clear();
+	snapshot.changedFields.reserve(keyframe.states.size() + keyframe.connections.size());
+	snapshot.changedData.clear();
+	size_t connectionIndex = 0;
+	const char* baseConstraintState = keyframe.constraintStates.data();
+	for(size_t i = 0; i < world.physicals.size(); i++) {
+		const MotorizedPhysical& phys = *world.physicals[i];
+		const PhysicalSnapshotState& base = keyframe.states[i];
+		uint8_t changed = 0;
+		if(!isBitwiseEqual(phys.getCFrame(), base.cframe)) {
+			changed |= CFRAME_CHANGED;
+			appendField(snapshot.changedData, phys.getCFrame());
+		}
+		if(!isBitwiseEqual(phys.motionOfCenterOfMass, base.motionOfCenterOfMass)) {
+			changed |= MOTION_CHANGED;
+			appendField(snapshot.changedData, phys.motionOfCenterOfMass);
+		}
+		if(!isBitwiseEqual(phys.totalForce, base.totalForce) || !isBitwiseEqual(phys.totalMoment, base.totalMoment)) {
+			changed |= FORCES_CHANGED;
+			appendField(snapshot.changedData, phys.totalForce);
+			appendField(snapshot.changedData, phys.totalMoment);
+		}
+		snapshot.changedFields.push_back(changed);
+
+		phys.forEachHardConstraint([&](const Physical& parent, const ConnectedPhysical& child) {
+			const HardPhysicalConnection& connection = child.connectionToParent;
+			ConnectionSnapshotState state = getSnapshotState(connection);
+			const ConnectionSnapshotState& baseState = keyframe.connections[connectionIndex++];
+			uint8_t connectionChanged = 0;
+			if(!isBitwiseEqual(state, baseState)) {
+				connectionChanged |= ATTACHMENT_CHANGED;
+				appendField(snapshot.changedData, state);
+			}
+			// the state is written in place, and dropped again if it matches the keyframe
+			size_t stateSize = connection.constraintWithParent->getStateSize();
+			size_t offset = appendConstraintState(snapshot.changedData, *connection.constraintWithParent);
+			if(std::memcmp(snapshot.changedData.data() + offset, baseConstraintState, stateSize) == 0) {
+				snapshot.changedData.resize(offset);
+			} else {
+				connectionChanged |= CONSTRAINT_CHANGED;
+			}
+			baseConstraintState += stateSize;
+			snapshot.changedFields.push_back(connectionChanged);
+		});
+	}
+}
+
+void WorldSnapshotBuffer::record(const WorldPrototype& world) {
+	// ages must keep increasing for findSlot, a world that was rolled back drops the snapshots after the restored age
+	while(snapshotCount > 0 && getNewestAge() >= world.age) {
+		nextSlot = (nextSlot + snapshots.size() - 1) % snapshots.size();
+		snapshots[nextSlot].isUsed = false;
+		snapshotCount--;
+		if(snapshotsSinceKeyframe > 0) snapshotsSinceKeyframe--;
+	}
+	if(snapshotCount > 0 && !snapshots[latestKeyframeSlot].isUsed) {
+		snapshotsSinceKeyframe = keyframeInterval;
+	}
+
+	bool makeKeyframe = !isKeyframeUpToDate(world);
+	size_t slot = nextSlot;
+	Snapshot& snapshot = snapshots[slot];
+	snapshot.age = world.age;
+	snapshot.isUsed = true;
+	if(makeKeyframe) {
+		recordKeyframe(world, snapshot, slot);
+		latestKeyframeSlot = slot;
+		snapshotsSinceKeyframe = 0;
+	} else {
+		recordDelta(world, snapshot, snapshots[latestKeyframeSlot]);
+		snapshotsSinceKeyframe++;
+	}
+
+	nextSlot = (nextSlot + 1) % snapshots.size();
+	if(snapshotCount < snapshots.size()) snapshotCount++;
+}
+
+std::ptrdiff_t WorldSnapshotBuffer::findSlot(size_t age) const {
+	if(snapshotCount == 0) return -1;
+	size_t oldestSlot = (nextSlot + snapshots.size() - snapshotCount) % snapshots.size();
+	// binary search over the ring, ages are increasing from the oldest to the newest snapshot
+	size_t low = 0;
+	size_t high = snapshotCount;
+	while(low < high) {
+		size_t mid = (low + high) / 2;
+		if(snapshots[(oldestSlot + mid) % snapshots.size()].age < age) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	if(low == snapshotCount) return -1;
+	size_t slot = (oldestSlot + low) % snapshots.size();
+	return (snapshots[slot].age == age) ? static_cast<std::ptrdiff_t>(slot) : -1;
+}
+
+bool WorldSnapshotBuffer::canRestore(const WorldPrototype& world, size_t age) const {
+	std::ptrdiff_t slot = findSlot(age);
+	if(slot < 0) return false;
+	const Snapshot& snapshot = snapshots[slot];
+	const Snapshot& keyframe = snapshots[snapshot.keyframeSlot];
+	// the keyframe may have been overwritten by a newer snapshot
+	if(!keyframe.isUsed || keyframe.age != snapshot.keyframeAge) return false;
+	return keyframe.structureVersion == world.structureVersion;
+}
+
+bool WorldSnapshotBuffer::restore(WorldPrototype& world, size_t age) const {
+	if(!canRestore(world, age)) return false;
+	const Snapshot& snapshot = snapshots[findSlot(age)];
+	const Snapshot& keyframe = snapshots[snapshot.keyframeSlot];
+
+	const char* changedData = snapshot.changedData.data();
+	const uint8_t* changedFields = snapshot.changedFields.data();
+	size_t connectionIndex = 0;
+	const char* constraintState = keyframe.constraintStates.data();
+	for(size_t i = 0; i < world.physicals.size(); i++) {
+		MotorizedPhysical& phys = *world.physicals[i];
+		PhysicalSnapshotState state = keyframe.states[i];
+		if(!snapshot.isKeyframe()) {
+			uint8_t changed = *changedFields++;
+			if(changed & CFRAME_CHANGED) readField(changedData, state.cframe);
+			if(changed & MOTION_CHANGED) readField(changedData, state.motionOfCenterOfMass);
+			if(changed & FORCES_CHANGED) {
+				readField(changedData, state.totalForce);
+				readField(changedData, state.totalMoment);
+			}
+		}
+
+		phys.forEachHardConstraint([&](Physical& parent, ConnectedPhysical& child) {
+			HardPhysicalConnection& connection = child.connectionToParent;
+			ConnectionSnapshotState connectionState = keyframe.connections[connectionIndex++];
+			const char* stateOfConstraint = constraintState;
+			constraintState += connection.constraintWithParent->getStateSize();
+			if(!snapshot.isKeyframe()) {
+				uint8_t connectionChanged = *changedFields++;
+				if(connectionChanged & ATTACHMENT_CHANGED) readField(changedData, connectionState);
+				if(connectionChanged & CONSTRAINT_CHANGED) {
+					stateOfConstraint = changedData;
+					changedData += connection.constraintWithParent->getStateSize();
+				}
+			}
+			connection.attachOnChild = connectionState.attachOnChild;
+			connection.attachOnParent = connectionState.attachOnParent;
+			connection.constraintWithParent->readState(stateOfConstraint);
+		});
+		// the center of mass and inertia depend on where the connected physicals are
+		if(!phys.childPhysicals.empty()) phys.refreshPhysicalProperties();
+
+		phys.setCFrame(state.cframe);
+		phys.motionOfCenterOfMass = state.motionOfCenterOfMass;
+		phys.totalForce = state.totalForce;
+		phys.totalMoment = state.totalMoment;
+	}
+
+	for(ColissionLayer& layer : world.layers) {
+		layer.refresh();
+	}
+	world.age = age;
+	return true;
+}
+
+size_t WorldSnapshotBuffer::getOldestAge() const {
+	if(snapshotCount == 0) return 0;
+	return snapshots[(nextSlot + snapshots.size() - snapshotCount) % snapshots.size()].age;
+}
+
+size_t WorldSnapshotBuffer::getNewestAge() const {
+	if(snapshotCount == 0) return 0;
+	return snapshots[(nextSlot + snapshots.size() - 1) % snapshots.size()].age;
+}
+
+size_t WorldSnapshotBuffer::getSnapshotSize(size_t age) const {
+	std::ptrdiff_t slot = findSlot(age);
+	if(slot < 0) return 0;
+	const Snapshot& snapshot = snapshots[slot];
+	if(snapshot.isKeyframe()) {
+		return snapshot.states.size() * sizeof(PhysicalSnapshotState) + snapshot.connections.size() * sizeof(ConnectionSnapshotState) + snapshot.constraintStates.size();
+	} else {
+		return snapshot.changedFields.size() + snapshot.changedData.size();
+	}
+}
+
+void WorldSnapshotBuffer::clear() {
+	for(Snapshot& snapshot : snapshots) {
+		snapshot.isUsed = false;
+	}
+	nextSlot = 0;
+	snapshotCount = 0;
+	snapshotsSinceKeyframe = 0;
+	latestKeyframeSlot = 0;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "../math/globalCFrame.h"
+#include "../math/linalg/vec.h"
+#include "../motion.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class WorldPrototype;
+
+/*
+	The state of a MotorizedPhysical that changes from tick to tick
+	ConnectedPhysicals follow from the main physical through their connections, which are stored separately
+*/
+struct PhysicalSnapshotState {
+	GlobalCFrame cframe;
+	Motion motionOfCenterOfMass;
+	Vec3 totalForce;
+	Vec3 totalMoment;
+};
+
+// The attachments of a ConnectedPhysical to its parent, the state of the constraint between them is stored next to it
+struct ConnectionSnapshotState {
+	CFrame attachOnChild;
+	CFrame attachOnParent;
+};
+
+/*
+	A ring buffer of the recent states of a world, for rollback and replay
+
+	Every snapshot is either a keyframe, which holds the full state of every physical and of every connection between physicals,
+	or a delta against the latest keyframe, which only holds the fields of physicals and connections that differ from that keyframe
+	Deltas are never stacked on other deltas, so restoring any recorded tick applies at most one keyframe and one delta
+
+	Only the state of existing physicals is recorded. Whenever the structureVersion of the world changes the next snapshot is a new keyframe,
+	and snapshots from before such a change can no longer be restored into the world. Full structural state is saved with serializeWorld
+*/
+class WorldSnapshotBuffer {
+public:
+	enum ChangedFields : uint8_t {
+		CFRAME_CHANGED = 1,
+		MOTION_CHANGED = 2,
+		FORCES_CHANGED = 4,
+		ATTACHMENT_CHANGED = 8,
+		CONSTRAINT_CHANGED = 16
+	};
+private:
+	struct Snapshot {
+		size_t age = 0;
+		bool isUsed = false;
+		// the slot and age of the keyframe this snapshot is relative to, a keyframe refers to itself
+		size_t keyframeSlot = 0;
+		size_t keyframeAge = 0;
+
+		// keyframes only, connections are in the order of forEachHardConstraint of every physical, with their constraint states packed in the same order
+		size_t structureVersion = 0;
+		std::vector<PhysicalSnapshotState> states;
+		std::vector<ConnectionSnapshotState> connections;
+		std::vector<char> constraintStates;
+
+		/*
+			deltas only, a combination of ChangedFields for every physical of the keyframe followed by every connection of that physical,
+			and the changed fields themselves in the same order
+		*/
+		std::vector<uint8_t> changedFields;
+		std::vector<char> changedData;
+
+		bool isKeyframe() const;
+	};
+
+	std::vector<Snapshot> snapshots;
+	// the slot that the next snapshot is recorded in
+	size_t nextSlot = 0;
+	size_t snapshotCount = 0;
+	size_t keyframeInterval;
+	size_t snapshotsSinceKeyframe = 0;
+	size_t latestKeyframeSlot = 0;
+
+	void recordKeyframe(const WorldPrototype& world, Snapshot& snapshot, size_t slot);
+	void recordDelta(const WorldPrototype& world, Snapshot& snapshot, const Snapshot& keyframe);
+	bool isKeyframeUpToDate(const WorldPrototype& world) const;
+	// returns the slot of the snapshot of the given age, or -1 if it is not in the buffer
+	std::ptrdiff_t findSlot(size_t age) const;
+public:
+	// capacity is the number of snapshots kept, a new keyframe is recorded at least every keyframeInterval snapshots
+	WorldSnapshotBuffer(size_t capacity, size_t keyframeInterval);
+
+	// records the current state of the world as the snapshot for world.age, overwriting the oldest snapshot when the buffer is full
+	void record(const WorldPrototype& world);
+
+	/*
+		Restores the world to the state it had when the snapshot for the given age was recorded, and sets world.age back to that age
+		Returns false and leaves the world untouched if there is no such snapshot, or if the structure of the world has changed since
+	*/
+	bool restore(WorldPrototype& world, size_t age) const;
+	bool canRestore(const WorldPrototype& world, size_t age) const;
+
+	// snapshots are kept in order of recording, returns 0 if the buffer is empty
+	size_t getOldestAge() const;
+	size_t getNewestAge() const;
+	size_t getSnapshotCount() const { return snapshotCount; }
+	size_t getCapacity() const { return snapshots.size(); }
+
+	// the number of bytes of state stored for the snapshot of the given age, 0 if it is not in the buffer
+	size_t getSnapshotSize(size_t age) const;
+
+	void clear();
+};
@@ -17,6 +17,7 @@
 namespace {
 	void recalculate(Part* part) {
 		part->maxRadius = part->hitbox.getMaxRadius();
+		part->updateBounds();
 	}
 
 	void recalculateAndUpdateParent(Part* part, const Bounds& oldBounds) {
@@ -30,20 +31,24 @@ namespace {
 
 Part::Part(const Shape& shape, const GlobalCFrame& position, const PartProperties& properties) : 
 	hitbox(shape), properties(properties), maxRadius(shape.getMaxRadius()), cframe(position) {
+	this->updateBounds();
 }
 
 Part::Part(const Shape& shape, Part& attachTo, const CFrame& attach, const PartProperties& properties) : 
 	hitbox(shape), properties(properties), maxRadius(shape.getMaxRadius()), cframe(attachTo.cframe.localToGlobal(attach)) {
+	this->updateBounds();
 	attachTo.attach(this, attach);
 }
 
 Part::Part(const Shape& shape, Part& attachTo, HardConstraint* constraint, const CFrame& attachToParent, const CFrame& attachToThis, const PartProperties& properties) : 
 	hitbox(shape), properties(properties), maxRadius(shape.getMaxRadius()), cframe(attachTo.getCFrame().localToGlobal(attachToParent.localToGlobal(constraint->getRelativeCFrame()).localToGlobal(attachToThis))) {
+	this->updateBounds();
 	attachTo.attach(this, constraint, attachToParent, attachToThis);
 }
 
 Part::Part(Part&& other) noexcept :
 	cframe(other.cframe),
+	cachedRelativeBounds(other.cachedRelativeBounds),
 	layer(other.layer),
 	parent(other.parent), 
 	hitbox(std::move(other.hitbox)), 
@@ -58,6 +63,7 @@ Part::Part(Part&& other) noexcept :
 }
 Part& Part::operator=(Part&& other) noexcept {
 	this->cframe = other.cframe;
+	this->cachedRelativeBounds = other.cachedRelativeBounds;
 	this->layer = other.layer;
 	this->parent = other.parent;
 	this->hitbox = std::move(other.hitbox);
@@ -94,8 +100,12 @@ void Part::removeFromWorld() {
 }
 
 PartIntersection Part::intersects(const Part& other) const {
+	return this->intersects(other, 0, false);
+}
+
+PartIntersection Part::intersects(const Part& other, int detailLevel, bool refine) const {
 	CFrame relativeTransform = this->cframe.globalToLocal(other.cframe);
-	std::optional<Intersection> result = intersectsTransformed(this->hitbox, other.hitbox, relativeTransform);
+	std::optional<Intersection> result = intersectsTransformed(this->hitbox, other.hitbox, relativeTransform, detailLevel, refine);
 	if(result) {
 		Position intersection = this->cframe.localToGlobal(result.value().intersection);
 		Vec3 exitVector = this->cframe.localToRelative(result.value().exitVector);
@@ -114,25 +124,16 @@ BoundingBox Part::getLocalBounds() const {
 	return BoundingBox(-v, v);
 }
 
-#ifdef USE_NEW_BOUNDSTREE
-BoundsTemplate<float> Part::getBounds() const {
-	BoundingBox boundsOfHitbox = this->hitbox.getBounds(this->cframe.getRotation());
-
-	assert(isVecValid(boundsOfHitbox.min));
-	assert(isVecValid(boundsOfHitbox.max));
+void Part::updateBounds() {
+	this->cachedRelativeBounds = this->hitbox.getConservativeBounds(this->cframe.getRotation());
 
-	return BoundsTemplate<float>(boundsOfHitbox + getPosition());
+	assert(isVecValid(this->cachedRelativeBounds.min));
+	assert(isVecValid(this->cachedRelativeBounds.max));
 }
-#else
-Bounds Part::getBounds() const {
-	BoundingBox boundsOfHitbox = this->hitbox.getBounds(this->cframe.getRotation());
-	
-	assert(isVecValid(boundsOfHitbox.min));
-	assert(isVecValid(boundsOfHitbox.max));
 
-	return boundsOfHitbox + getPosition();
+Bounds Part::getBounds() const {
+	return this->cachedRelativeBounds + getPosition();
 }
-#endif
 
 void Part::scale(double scaleX, double scaleY, double scaleZ) {
 	Bounds oldBounds = this->getBounds();
@@ -150,6 +151,7 @@ void Part::setCFrame(const GlobalCFrame& newCFrame) {
 	Bounds oldBounds = this->getBounds();
 	if(this->parent == nullptr) {
 		this->cframe = newCFrame;
+		this->updateBounds();
 	} else {
 		this->parent->setPartCFrame(this, newCFrame);
 	}
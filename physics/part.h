@@ -54,6 +54,12 @@ class Part {
 
 	GlobalCFrame cframe;
 
+	/*
+		Bounds of the hitbox in the current rotation, relative to the position of the part
+		Recalculated by updateBounds whenever the rotation or the hitbox changes, translations keep them valid
+	*/
+	BoundingBox cachedRelativeBounds;
+
 public:
 	WorldLayer* layer = nullptr;
 	Physical* parent = nullptr;
@@ -75,15 +81,19 @@ public:
 	WorldPrototype* getWorld();
 
 	PartIntersection intersects(const Part& other) const;
+	// uses the hulls of the parts at the given level of detail, see intersectsTransformed
+	PartIntersection intersects(const Part& other, int detailLevel, bool refine) const;
 	void scale(double scaleX, double scaleY, double scaleZ);
 	void setScale(const DiagonalMat3& scale);
 	
-#ifdef USE_NEW_BOUNDSTREE
-	BoundsTemplate<float> getBounds() const;
-#else
+	/*
+		Conservative world space bounds of the hitbox, see Shape::getConservativeBounds
+		Only reads the cached bounds, so it may be called from multiple threads at once
+	*/
 	Bounds getBounds() const;
-#endif
 	BoundingBox getLocalBounds() const;
+	// must be called after the rotation of the cframe or the hitbox is changed without going through Part
+	void updateBounds();
 
 	Position getPosition() const { return cframe.getPosition(); }
 	double getMass() const { return hitbox.getVolume() * properties.density; }
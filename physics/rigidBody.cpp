@@ -17,17 +17,20 @@ RigidBody::RigidBody(Part* mainPart) :
 void RigidBody::attach(RigidBody&& otherBody, const CFrame& attachment) {
 	const GlobalCFrame& cf = this->getCFrame();
 	otherBody.mainPart->cframe = cf.localToGlobal(attachment);
+	otherBody.mainPart->updateBounds();
 	this->parts.push_back(AttachedPart{attachment, otherBody.mainPart});
 
 	for(AttachedPart& ap : otherBody.parts) {
 		CFrame globalAttach = attachment.localToGlobal(ap.attachment);
 		this->parts.push_back(AttachedPart{globalAttach, ap.part});
 		ap.part->cframe = cf.localToGlobal(globalAttach);
+		ap.part->updateBounds();
 	}
 }
 void RigidBody::attach(Part* part, const CFrame& attachment) {
 	parts.push_back(AttachedPart{attachment, part});
 	part->cframe = getCFrame().localToGlobal(attachment);
+	part->updateBounds();
 
 	refreshWithNewParts();
 }
@@ -132,8 +135,10 @@ void RigidBody::refreshWithNewParts() {
 
 void RigidBody::setCFrame(const GlobalCFrame& newCFrame) {
 	this->mainPart->cframe = newCFrame;
+	this->mainPart->updateBounds();
 	for(const AttachedPart& p : parts) {
 		p.part->cframe = newCFrame.localToGlobal(p.attachment);
+		p.part->updateBounds();
 	}
 }
 
@@ -160,8 +165,10 @@ void RigidBody::rotateAroundLocalPoint(const Vec3& localPoint, const Rotation& r
 	Vec3 relativeRotationOffset = rotation * relPoint - relPoint;
 	mainPart->cframe.rotate(rotation);
 	mainPart->cframe -= relativeRotationOffset;
+	mainPart->updateBounds();
 	for(AttachedPart& atPart : parts) {
 		atPart.part->cframe = mainPart->cframe.localToGlobal(atPart.attachment);
+		atPart.part->updateBounds();
 	}
 }
 
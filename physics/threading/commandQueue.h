@@ -0,0 +1,232 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+/*
+	A type erased void() callable, like std::function<void()>, but callables up to INLINE_SIZE bytes are stored inside the command itself
+	Most queued operations are small lambdas, so queueing them doesn't allocate
+*/
+class QueuedCommand {
+public:
+	static constexpr std::size_t INLINE_SIZE = 64;
+
+private:
+	template<typename Func>
+	static constexpr bool isStoredInline = sizeof(Func) <= INLINE_SIZE && alignof(Func) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Func>;
+
+	alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+	void(*invoker)(void* storage) = nullptr;
+	// moves the callable from one storage to the other and destroys the original, or only destroys it if to is nullptr
+	void(*relocator)(void* from, void* to) = nullptr;
+
+	template<typename Func>
+	static Func* getCallable(void* storage) {
+		if constexpr(isStoredInline<Func>) {
+			return std::launder(reinterpret_cast<Func*>(storage));
+		} else {
+			return *std::launder(reinterpret_cast<Func**>(storage));
+		}
+	}
+
+	void reset() {
+		if(relocator != nullptr) relocator(storage, nullptr);
+		invoker = nullptr;
+		relocator = nullptr;
+	}
+
+	void moveFrom(QueuedCommand& other) noexcept {
+		if(other.relocator != nullptr) other.relocator(other.storage, storage);
+		invoker = other.invoker;
+		relocator = other.relocator;
+		other.invoker = nullptr;
+		other.relocator = nullptr;
+	}
+
+public:
+	QueuedCommand() = default;
+
+	template<typename Func, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, QueuedCommand>>>
+	QueuedCommand(Func&& func) {
+		using F = std::decay_t<Func>;
+		if constexpr(isStoredInline<F>) {
+			new(storage) F(std::forward<Func>(func));
+			relocator = [](void* from, void* to) {
+				F* callable = getCallable<F>(from);
+				if(to != nullptr) new(to) F(std::move(*callable));
+				callable->~F();
+			};
+		} else {
+			new(storage) F*(new F(std::forward<Func>(func)));
+			relocator = [](void* from, void* to) {
+				if(to != nullptr) {
+					new(to) F*(getCallable<F>(from));
+				} else {
+					delete getCallable<F>(from);
+				}
+			};
+		}
+		invoker = [](void* storage) {
+			(*getCallable<F>(storage))();
+		};
+	}
+
+	QueuedCommand(QueuedCommand&& other) noexcept {
+		moveFrom(other);
+	}
+	QueuedCommand& operator=(QueuedCommand&& other) noexcept {
+		if(this != &other) {
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+	QueuedCommand(const QueuedCommand&) = delete;
+	QueuedCommand& operator=(const QueuedCommand&) = delete;
+
+	~QueuedCommand() {
+		reset();
+	}
+
+	void operator()() {
+		invoker(storage);
+	}
+
+	explicit operator bool() const {
+		return invoker != nullptr;
+	}
+};
+
+/*
+	A queue of commands that any number of threads can push to without locking, and that one thread drains
+
+	Commands are pushed into a fixed size ring buffer, claiming a slot only takes an atomic compare and swap
+	When the ring buffer is full commands go to an overflow list under a mutex instead, until the consumer has drained it,
+	so that the commands of any one producer always run in the order they were pushed
+*/
+class CommandQueue {
+	struct Slot {
+		// equals the position this slot can be written at when it is free, and that position + 1 when it holds a command
+		std::atomic<std::size_t> sequence;
+		QueuedCommand command;
+		std::chrono::steady_clock::time_point queuedAt;
+	};
+	struct OverflowCommand {
+		QueuedCommand command;
+		std::chrono::steady_clock::time_point queuedAt;
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	std::size_t mask;
+
+	// producers and the consumer are kept on different cache lines
+	alignas(64) std::atomic<std::size_t> enqueuePos{0};
+	alignas(64) std::size_t dequeuePos = 0;
+
+	std::atomic<bool> hasOverflow{false};
+	std::mutex overflowLock;
+	std::vector<OverflowCommand> overflow;
+	// only used by the consumer, swapped with overflow so the mutex isn't held while commands run
+	std::vector<OverflowCommand> drainingOverflow;
+
+	bool tryPushToRing(QueuedCommand& command, std::chrono::steady_clock::time_point queuedAt) {
+		std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while(true) {
+			Slot& slot = slots[pos & mask];
+			std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+			if(difference == 0) {
+				if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					slot.command = std::move(command);
+					slot.queuedAt = queuedAt;
+					slot.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			} else if(difference < 0) {
+				// the slot still holds a command from a full lap ago
+				return false;
+			} else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+public:
+	struct DrainStatistics {
+		std::size_t commandCount = 0;
+		// the longest time a command waited in the queue before it ran
+		std::chrono::nanoseconds maxLatency = std::chrono::nanoseconds(0);
+	};
+
+	// capacity must be a power of two
+	explicit CommandQueue(std::size_t capacity = 4096) : slots(new Slot[capacity]), mask(capacity - 1) {
+		assert(capacity != 0 && (capacity & (capacity - 1)) == 0);
+		for(std::size_t i = 0; i < capacity; i++) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	CommandQueue(const CommandQueue&) = delete;
+	CommandQueue& operator=(const CommandQueue&) = delete;
+
+	// may be called from any thread
+	template<typename Func>
+	void push(Func&& func) {
+		QueuedCommand command(std::forward<Func>(func));
+		std::chrono::steady_clock::time_point queuedAt = std::chrono::steady_clock::now();
+		if(!hasOverflow.load(std::memory_order_acquire) && tryPushToRing(command, queuedAt)) return;
+
+		std::lock_guard<std::mutex> lg(overflowLock);
+		overflow.push_back(OverflowCommand{std::move(command), queuedAt});
+		hasOverflow.store(true, std::memory_order_release);
+	}
+
+	/*
+		Runs all commands that were queued before the call, in order. Commands pushed to the ring buffer while draining, also by the commands themselves, run on the next drain,
+		but commands that overflowed while draining run in this drain if the ring buffer was emptied before the overflow list is taken
+		May only be called from one thread at a time
+	*/
+	DrainStatistics drain() {
+		DrainStatistics statistics;
+		auto runCommand = [&statistics](QueuedCommand& command, std::chrono::steady_clock::time_point queuedAt) {
+			std::chrono::nanoseconds latency = std::chrono::steady_clock::now() - queuedAt;
+			if(latency > statistics.maxLatency) statistics.maxLatency = latency;
+			statistics.commandCount++;
+			command();
+		};
+
+		std::size_t drainEnd = enqueuePos.load(std::memory_order_acquire);
+		while(dequeuePos != drainEnd) {
+			Slot& slot = slots[dequeuePos & mask];
+			// a producer claimed this slot but is still writing it, the rest is left for the next drain
+			if(slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+
+			QueuedCommand command = std::move(slot.command);
+			std::chrono::steady_clock::time_point queuedAt = slot.queuedAt;
+			slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+			dequeuePos++;
+			runCommand(command, queuedAt);
+		}
+
+		// overflowed commands were pushed after everything in the ring buffer, so they may only run once the ring buffer is empty
+		if(hasOverflow.load(std::memory_order_acquire) && dequeuePos == enqueuePos.load(std::memory_order_acquire)) {
+			{
+				std::lock_guard<std::mutex> lg(overflowLock);
+				drainingOverflow.swap(overflow);
+				hasOverflow.store(false, std::memory_order_release);
+			}
+			for(OverflowCommand& overflowed : drainingOverflow) {
+				runCommand(overflowed.command, overflowed.queuedAt);
+			}
+			drainingOverflow.clear();
+		}
+		return statistics;
+	}
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "../math/globalCFrame.h"
+#include "../math/linalg/mat.h"
+
+/*
+	The value that identifies a part in a RenderSnapshot
+	By default this is the address of the part, which may no longer be valid by the time a snapshot is read, so it should only be compared
+	Part types that carry their own id, like an entity, specialize this to store that id instead
+*/
+template<typename T>
+struct RenderSnapshotID {
+	using type = const T*;
+
+	static type of(const T& part) { return &part; }
+};
+
+template<typename T>
+struct RenderSnapshotPart {
+	typename RenderSnapshotID<T>::type id;
+	GlobalCFrame cframe;
+	DiagonalMat3 scale;
+	// the physical and main physical of the part, like the id these should only be compared, to find which parts are attached together
+	const void* physical;
+	const void* mainPhysical;
+	bool isMainPart;
+	bool isMainPhysical;
+};
+
+/*
+	The state of all parts of a world that is needed for rendering, copied at the end of a tick
+	It is published through a TripleBuffer, so that it can be read without taking the world's lock
+*/
+template<typename T>
+struct RenderSnapshot {
+	// increases with every published snapshot, also when the world was modified without ticking
+	std::size_t version = 0;
+	// the age of the world when this snapshot was taken
+	std::size_t age = 0;
+	std::vector<RenderSnapshotPart<T>> parts;
+};
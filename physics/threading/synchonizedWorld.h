@@ -1,52 +1,63 @@
 #pragma once
 
-#include <queue>
+#include <atomic>
 #include <mutex>
 #include <shared_mutex>
-#include <functional>
 
 #include "../world.h"
 #include "sharedLockGuard.h"
+#include "commandQueue.h"
+#include "tripleBuffer.h"
+#include "renderSnapshot.h"
 #include "../misc/physicsProfiler.h"
 
 template<typename T = Part>
 class SynchronizedWorld : public World<T> {
 	mutable std::shared_mutex lock;
-	mutable std::mutex queueLock;
-	mutable std::mutex readQueueLock;
 
-	std::queue<std::function<void()>> waitingOperations;
-	mutable std::queue<std::function<void()>> waitingReadOnlyOperations;
+	// operations that couldn't get the lock right away, these run on the physics thread at the end of the next tick
+	CommandQueue waitingOperations;
+	mutable CommandQueue waitingReadOnlyOperations;
+
+	TripleBuffer<RenderSnapshot<T>> renderSnapshots;
+	std::size_t renderSnapshotVersion = 0;
+	// set by modifications, which leave publishing to the next tick or getRenderSnapshot so that a burst of them copies the parts only once
+	std::atomic<bool> renderSnapshotDirty{false};
 
 	template<typename Func>
 	void pushOperation(const Func& func) {
-		std::lock_guard<std::mutex> lg(queueLock);
-		waitingOperations.emplace(func);
+		waitingOperations.push(func);
 	}
 	template<typename Func>
 	void pushReadOnlyOperation(const Func& func) const {
-		std::lock_guard<std::mutex> lg(readQueueLock);
-		waitingReadOnlyOperations.emplace(func);
+		waitingReadOnlyOperations.push(func);
 	}
 
 	void processQueue() {
-		std::lock_guard<std::mutex> lg(queueLock);
+		CommandQueue::DrainStatistics statistics = waitingOperations.drain();
+		commandQueueDepth.add(static_cast<int>(statistics.commandCount));
+		commandQueueLatency.add(statistics.maxLatency);
+	}
 
-		while (!waitingOperations.empty()) {
-			std::function<void()>& operation = waitingOperations.front();
-			operation();
-			waitingOperations.pop();
+	// must be called while holding lock, shared or exclusive, by only one thread at a time, which is the physics thread or getRenderSnapshot
+	void publishRenderSnapshot() {
+		renderSnapshotDirty.store(false, std::memory_order_relaxed);
+		RenderSnapshot<T>& snapshot = renderSnapshots.getWriteBuffer();
+		snapshot.version = ++renderSnapshotVersion;
+		snapshot.age = this->age;
+		snapshot.parts.clear();
+		for(const T& part : this->iterParts()) {
+			const Physical* physical = part.parent;
+			snapshot.parts.push_back(RenderSnapshotPart<T>{
+				RenderSnapshotID<T>::of(part), part.getCFrame(), part.hitbox.scale,
+				physical, physical != nullptr ? physical->mainPhysical : nullptr, part.isMainPart(), physical != nullptr && physical->isMainPhysical()
+			});
 		}
+		renderSnapshots.publish();
 	}
 
 	void processReadQueue() const {
-		std::lock_guard<std::mutex> lg(readQueueLock);
-
-		while (!waitingReadOnlyOperations.empty()) {
-			std::function<void()>& operation = waitingReadOnlyOperations.front();
-			operation();
-			waitingReadOnlyOperations.pop();
-		}
+		waitingReadOnlyOperations.drain();
 	}
 
 public:
@@ -57,12 +68,14 @@ public:
 	void syncModification(const Func& function) {
 		std::lock_guard<std::shared_mutex> lg(lock);
 		function();
+		renderSnapshotDirty.store(true, std::memory_order_release);
 	}
 	template<typename Func>
 	void asyncModification(const Func& function) {
 		if (lock.try_lock()) {
 			UnlockOnDestroy lg(lock);
 			function();
+			renderSnapshotDirty.store(true, std::memory_order_release);
 		} else {
 			pushOperation(function);
 		}
@@ -106,7 +119,23 @@ public:
 		physicsMeasure.mark(PhysicsProcess::WAIT_FOR_LOCK);
 		mutLock.downgrade();
 
+		physicsMeasure.mark(PhysicsProcess::RENDER_SNAPSHOT);
+		publishRenderSnapshot();
+
 		physicsMeasure.mark(PhysicsProcess::QUEUE);
 		processReadQueue();
 	}
+
+	/*
+		Returns the latest state of the parts that is needed for rendering, without taking the world's lock
+		It is published at the end of every tick, modifications through this world made since then are published here if the lock is free
+		May only be called from one thread, usually the render thread. The returned snapshot stays unchanged until the next call
+	*/
+	const RenderSnapshot<T>& getRenderSnapshot() {
+		if(renderSnapshotDirty.load(std::memory_order_acquire) && lock.try_lock()) {
+			UnlockOnDestroy lg(lock);
+			publishRenderSnapshot();
+		}
+		return renderSnapshots.getReadBuffer();
+	}
 };
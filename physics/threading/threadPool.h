@@ -5,6 +5,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <cstddef>
 
 class ThreadPool {
 	std::function<void()> funcToRun = []() {};
@@ -21,11 +22,11 @@ class ThreadPool {
 	std::condition_variable threadsFinished;
 	int threadsWorking = 0; 
 
-	// No explicit protection required since only the main thread may write to it and only in the destructor, so not when a new job is presented
+	// No explicit protection required since only the main thread may write to it and only in the destructor and setThreadCount, so not when a new job is presented
 	bool shouldExit = false;
 
-public:
-	ThreadPool() : threads(std::thread::hardware_concurrency() - 1) {
+	void startThreads(std::size_t workerCount) {
+		threads = std::vector<std::thread>(workerCount);
 		for(std::thread& t : threads) {
 			t = std::thread([this]() {
 				std::unique_lock<std::mutex> selfLock(mtx); // locks mtx
@@ -48,14 +49,39 @@ public:
 		}
 	}
 
-	// cleanup
-	~ThreadPool() {
+	void stopThreads() {
 		shouldExit = true;
 		mtx.lock();
 		shouldStart = true;
 		mtx.unlock();
 		threadStarter.notify_all();// all threads start running
 		for(std::thread& t : threads) t.join(); // let threads exit
+		threads.clear();
+	}
+
+public:
+	ThreadPool() {
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		startThreads(hardwareThreads > 1 ? hardwareThreads - 1 : 0);
+	}
+
+	// cleanup
+	~ThreadPool() {
+		stopThreads();
+	}
+
+	// the number of threads that run the work given to doInParallel, including the calling thread
+	std::size_t getThreadCount() const {
+		return threads.size() + 1;
+	}
+
+	// replaces the worker threads, so that doInParallel uses threadCount threads including the calling thread. May not be called during doInParallel
+	void setThreadCount(std::size_t threadCount) {
+		stopThreads();
+		shouldExit = false;
+		shouldStart = false;
+		threadsWorking = 0;
+		startThreads(threadCount > 1 ? threadCount - 1 : 0);
 	}
 
 	// this work function may only return once all work has been completed
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+	Passes the latest version of some data from one writer thread to one reader thread, without either of them ever waiting on the other
+
+	The writer fills getWriteBuffer() and then publishes it, the reader always gets the most recently published buffer from getReadBuffer()
+	Of the three buffers one is owned by the writer, one by the reader, and the third holds the latest published data in between
+	Buffers are reused, so data such as vectors keep their capacity from one publish to the next
+*/
+template<typename T>
+class TripleBuffer {
+	static constexpr std::uint8_t INDEX_MASK = 0x3;
+	// set when the middle buffer holds data the reader hasn't taken yet
+	static constexpr std::uint8_t HAS_NEW_DATA = 0x4;
+
+	T buffers[3]{};
+	std::atomic<std::uint8_t> middle{1};
+	// only used by the writer
+	std::uint8_t writeIndex = 0;
+	// only used by the reader
+	std::uint8_t readIndex = 2;
+
+public:
+	TripleBuffer() = default;
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// the buffer the writer may fill, its contents are whatever was published three publishes ago
+	T& getWriteBuffer() {
+		return buffers[writeIndex];
+	}
+
+	// makes the write buffer available to the reader, and gives the writer a new buffer to fill
+	void publish() {
+		std::uint8_t oldMiddle = middle.exchange(writeIndex | HAS_NEW_DATA, std::memory_order_acq_rel);
+		writeIndex = oldMiddle & INDEX_MASK;
+	}
+
+	bool hasNewData() const {
+		return (middle.load(std::memory_order_relaxed) & HAS_NEW_DATA) != 0;
+	}
+
+	// returns the latest published buffer, it remains valid and unchanged until the next call to getReadBuffer
+	const T& getReadBuffer() {
+		if(hasNewData()) {
+			std::uint8_t oldMiddle = middle.exchange(readIndex, std::memory_order_acq_rel);
+			readIndex = oldMiddle & INDEX_MASK;
+		}
+		return buffers[readIndex];
+	}
+};
@@ -5,10 +5,12 @@
 #include "layer.h"
 #include "misc/validityHelper.h"
 
-//using namespace P3D::OldBoundsTree;
 //using namespace P3D::NewBoundsTree;
 
+// checks the whole world on every change, which makes adding n parts take O(n^2), so it is left out of release builds
+#ifndef NDEBUG
 #define CHECK_WORLD_VALIDITY
+#endif
 
 #ifdef CHECK_WORLD_VALIDITY
 #define ASSERT_VALID if (!isValid()) throw "World not valid!";
@@ -120,8 +122,14 @@ void WorldPrototype::setLayersCollide(int layer1, int layer2, bool collide) {
 }
 
 int WorldPrototype::createLayer(bool collidesInternally, bool collidesWithOthers) {
+	return this->createLayer(collidesInternally, collidesWithOthers, Position());
+}
+int WorldPrototype::createLayer(bool collidesInternally, bool collidesWithOthers, BroadphaseType broadphase) {
+	return this->createLayer(collidesInternally, collidesWithOthers, Position(), broadphase);
+}
+int WorldPrototype::createLayer(bool collidesInternally, bool collidesWithOthers, const Position& origin, BroadphaseType broadphase) {
 	int layerIndex = layers.size();
-	layers.emplace_back(this, collidesInternally);
+	layers.emplace_back(this, collidesInternally, origin, broadphase);
 	if(collidesWithOthers) {
 		for(int i = 0; i < layerIndex; i++) {
 			colissionMask.emplace_back(i, layerIndex);
@@ -135,13 +143,6 @@ void WorldPrototype::deleteLayer(int layerIndex, int layerToMoveTo) {
 
 
 
-static void createNodeFor(P3D::OldBoundsTree::BoundsTree<Part>& tree, MotorizedPhysical* phys) {
-	P3D::OldBoundsTree::TreeNode newNode(phys->rigidBody.mainPart, phys->rigidBody.mainPart->getBounds(), true);
-	phys->forEachPartExceptMainPart([&newNode](Part& part) {
-		newNode.addInside(P3D::OldBoundsTree::TreeNode(&part, part.getBounds(), false));
-	});
-	tree.add(std::move(newNode));
-}
 static void createNodeFor(P3D::NewBoundsTree::BoundsTree<Part>& tree, MotorizedPhysical* phys) {
 	if(phys->isSinglePart()) {
 		tree.add(phys->getMainPart());
@@ -151,7 +152,7 @@ static void createNodeFor(P3D::NewBoundsTree::BoundsTree<Part>& tree, MotorizedP
 		int newNodeSize = 0;
 
 		phys->forEachPart([&alloc, &newNode, &newNodeSize, &tree](Part& p) {
-			newNodeSize = P3D::NewBoundsTree::addRecursive(alloc, *newNode, newNodeSize, P3D::NewBoundsTree::TreeNodeRef(static_cast<void*>(&p)), p.getBounds());
+			newNodeSize = P3D::NewBoundsTree::addRecursive(alloc, *newNode, newNodeSize, P3D::NewBoundsTree::TreeNodeRef(static_cast<void*>(&p)), tree.getTreeBoundsOf(&p));
 		});
 		tree.getPrototype().addGroupTrunk(newNode, newNodeSize);
 	}
@@ -169,6 +170,7 @@ void WorldPrototype::addPart(Part* part, int layerIndex) {
 	part->ensureHasParent();
 	physicals.push_back(part->parent->mainPhysical);
 	part->parent->mainPhysical->world = this;
+	structureVersion++;
 
 
 	WorldLayer* worldLayer = &layers[layerIndex].subLayers[ColissionLayer::FREE_PARTS_LAYER];
@@ -189,7 +191,6 @@ void WorldPrototype::addPart(Part* part, int layerIndex) {
 	ASSERT_VALID;
 }
 
-#ifdef USE_NEW_BOUNDSTREE
 static void createNewNodeFor(MotorizedPhysical* motorPhys, P3D::NewBoundsTree::BoundsTree<Part>& layer, Part* repPart) {
 	size_t totalParts = 0;
 	motorPhys->forEachPart([&layer, &totalParts](Part& p) {
@@ -208,27 +209,17 @@ static void createNewNodeFor(MotorizedPhysical* motorPhys, P3D::NewBoundsTree::B
 
 		motorPhys->forEachPart([&alloc, &newNode, &newNodeSize, &layer, repPart](Part& p) {
 			if(&p.layer->tree == &layer) {
-				newNodeSize = P3D::NewBoundsTree::addRecursive(alloc, *newNode, newNodeSize, P3D::NewBoundsTree::TreeNodeRef(static_cast<void*>(&p)), p.getBounds());
+				newNodeSize = P3D::NewBoundsTree::addRecursive(alloc, *newNode, newNodeSize, P3D::NewBoundsTree::TreeNodeRef(static_cast<void*>(&p)), layer.getTreeBoundsOf(&p));
 			}
 		});
 		layer.getPrototype().addGroupTrunk(newNode, newNodeSize);
 	}
 }
-#else
-static void createNewNodeFor(MotorizedPhysical* motorPhys, P3D::OldBoundsTree::BoundsTree<Part>& layer, Part* repPart) {
-	P3D::OldBoundsTree::TreeNode newNode(repPart, repPart->getBounds(), true);
-	motorPhys->forEachPart([&newNode, &layer, repPart](Part& p) {
-		if(&p.layer->tree == &layer && &p != repPart) {
-			newNode.addInside(P3D::OldBoundsTree::TreeNode(&p, p.getBounds()));
-		}
-	});
-	layer.add(std::move(newNode));
-}
-#endif
 
 void WorldPrototype::addPhysicalWithExistingLayers(MotorizedPhysical* motorPhys) {
 	physicals.push_back(motorPhys);
 	motorPhys->world = this;
+	structureVersion++;
 
 	std::vector<FoundLayerRepresentative> foundLayers = findAllLayersIn(motorPhys);
 
@@ -241,6 +232,7 @@ void WorldPrototype::addPhysicalWithExistingLayers(MotorizedPhysical* motorPhys)
 
 void WorldPrototype::addTerrainPart(Part* part, int layerIndex) {
 	objectCount++;
+	structureVersion++;
 
 	WorldLayer* worldLayer = &layers[layerIndex].subLayers[ColissionLayer::TERRAIN_PARTS_LAYER];
 	part->layer = worldLayer;
@@ -278,6 +270,7 @@ void WorldPrototype::clear() {
 		partsToDelete.push_back(&p);
 	}
 	this->objectCount = 0;
+	this->structureVersion++;
 	for(ColissionLayer& cl : this->layers) {
 		for(WorldLayer& layer : cl.subLayers) {
 			layer.tree.clear();
@@ -295,6 +288,7 @@ size_t WorldPrototype::getLayerCount() const {
 
 void WorldPrototype::notifyMainPhysicalObsolete(MotorizedPhysical* motorPhys) {
 	physicals.erase(std::remove(physicals.begin(), physicals.end(), motorPhys));
+	structureVersion++;
 
 	ASSERT_VALID;
 }
@@ -308,6 +302,7 @@ void WorldPrototype::optimizeLayers() {
 void WorldPrototype::notifyNewPhysicalCreated(MotorizedPhysical* newPhysical) {
 	physicals.push_back(newPhysical);
 	newPhysical->world = this;
+	structureVersion++;
 }
 
 static void assignLayersForPhysicalRecurse(const Physical& phys, std::vector<std::pair<WorldLayer*, std::vector<const Part*>>>& foundLayers) {
@@ -388,12 +383,14 @@ void WorldPrototype::notifyPhysicalsMerged(const MotorizedPhysical* firstPhysica
 		assert(secondPhysical->world == this);
 		removePhysicalFromList(this->physicals, secondPhysical);
 	}
+	structureVersion++;
 }
 
 void WorldPrototype::notifyNewPartAddedToPhysical(const MotorizedPhysical* physical, Part* newPart) {
 	assert(physical->world == this);
 
 	onPartAdded(newPart);
+	structureVersion++;
 }
 
 void WorldPrototype::onPartAdded(Part* newPart) {}
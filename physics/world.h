@@ -14,6 +14,7 @@
 #include <mutex>
 
 #include <memory>
+#include <limits>
 
 class ExternalForce;
 class WorldLayer;
@@ -148,6 +149,30 @@ using FilteredWorldIterator = FilteredWorldIteratorTemplate<false, Filter>;
 template<typename Filter>
 using FilteredConstWorldIterator = FilteredWorldIteratorTemplate<true, Filter>;
 
+/*
+	Decides which level of detail the narrowphase uses for each colission, see PolyhedronShapeClass::buildDetailLevels
+	The first part of a colission decides its level, for colissions with terrain that is the free part
+	By default all colissions use the full shapes
+*/
+struct ColissionDetailSettings {
+	Position focus;
+	// colissions within this distance of the focus use the full shapes, every further multiple of it uses one level coarser
+	double detailDistance = std::numeric_limits<double>::infinity();
+	// colissions of parts moving faster than this relative to each other use one level coarser, fast impacts are over before their shapes matter much
+	double coarseSpeed = std::numeric_limits<double>::infinity();
+	/*
+		Coarse hulls stick out of their shapes, so contacts shallower than the error of the hulls may not be contacts of the full shapes
+		With this those contacts are tested again with the full shapes, which keeps parts from resting on their hulls
+		but tests most resting contacts twice
+	*/
+	bool refineShallowContacts = false;
+	/*
+		The most colissions per tick that may use the full shapes, either directly or by refining shallow contacts
+		Further colissions use at least the first coarser level and are never refined, this trades accuracy for time when many parts touch at once
+	*/
+	size_t fullDetailBudget = std::numeric_limits<size_t>::max();
+};
+
 class WorldPrototype {
 private:
 	friend class Physical;
@@ -185,7 +210,7 @@ private:
 	*/
 	void notifyMainPhysicalObsolete(MotorizedPhysical* part);
 
-	void parallelRefineColission(std::vector<Colission>& colissions);
+	void parallelRefineColission(std::vector<Colission>& colissions, size_t& fullDetailCount);
 
 protected:
 	// World tick steps
@@ -222,9 +247,13 @@ public:
 		These lists signify which layers collide
 	*/
 	std::vector<std::pair<int, int>> colissionMask;
+
+	ColissionDetailSettings colissionDetail;
 	
 	size_t age = 0;
 	size_t objectCount = 0;
+	// increases whenever parts or physicals are added, removed, split or merged, state recorded for an older version may not fit the world anymore
+	size_t structureVersion = 0;
 	double deltaT;
 
 
@@ -249,6 +278,9 @@ public:
 	void setLayersCollide(int layer1, int layer2, bool collide);
 
 	int createLayer(bool collidesInternally, bool collidesWithOthers);
+	// creates a layer whose bounds are stored relative to the given origin, and which uses the given broadphase for its internal colissions, see ColissionLayer
+	int createLayer(bool collidesInternally, bool collidesWithOthers, const Position& origin, BroadphaseType broadphase = BroadphaseType::BOUNDS_TREE);
+	int createLayer(bool collidesInternally, bool collidesWithOthers, BroadphaseType broadphase);
 	void deleteLayer(int layerIndex, int layerToMoveTo);
 
 
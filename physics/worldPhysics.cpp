@@ -14,6 +14,8 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 
 /*
 	exitVector is the distance p2 must travel so that the shapes are no longer colliding
@@ -204,10 +206,10 @@ void WorldPrototype::applyExternalForces() {
 	}
 }
 
-static PartIntersection safeIntersects(const Part& p1, const Part& p2) {
+static PartIntersection safeIntersects(const Part& p1, const Part& p2, int detailLevel, bool refine) {
 #ifdef CATCH_INTERSECTION_ERRORS
 	try {
-		return p1.intersects(p2);
+		return p1.intersects(p2, detailLevel, refine);
 	} catch(const std::exception& err) {
 		Log::fatal("Error occurred during intersection: %s", err.what());
 
@@ -222,10 +224,23 @@ static PartIntersection safeIntersects(const Part& p1, const Part& p2) {
 		throw "exit";
 	}
 #else
-	return p1.intersects(p2);
+	return p1.intersects(p2, detailLevel, refine);
 #endif
 }
 
+// the level of detail a colission would use by distance and speed alone
+static int selectDetailLevel(const ColissionDetailSettings& settings, const Colission& col) {
+	int level = 0;
+	if(std::isfinite(settings.detailDistance)) {
+		double distance = length(Vec3(col.p1->getCenterOfMass() - settings.focus));
+		level += static_cast<int>(std::min(distance / settings.detailDistance, 1000.0));
+	}
+	if(std::isfinite(settings.coarseSpeed)) {
+		if(lengthSquared(col.p1->getVelocity() - col.p2->getVelocity()) > settings.coarseSpeed * settings.coarseSpeed) level++;
+	}
+	return level;
+}
+
 /*static void refineColission(std::vector<Colission>& colissions) {
 
 	for (size_t i = 0; i < colissions.size();) {
@@ -256,55 +271,74 @@ static PartIntersection safeIntersects(const Part& p1, const Part& p2) {
 }*/
 
 
-void WorldPrototype::parallelRefineColission(std::vector<Colission>& colissions) {
-
-	std::vector<Colission> wantedColission;
+/*
+	Runs the narrowphase on all candidate colissions in parallel, and removes the candidates that don't intersect
+	Results are stored per candidate and gathered in the order of the candidates afterwards, 
+	so the colissions, and thereby the order in which their impulses are applied, don't depend on the number of threads or their scheduling
+*/
+void WorldPrototype::parallelRefineColission(std::vector<Colission>& colissions, size_t& fullDetailCount) {
 	const size_t workEnd = colissions.size();
-	size_t currIndex = 0;
-	std::mutex colissionMutex, statsMutex, indexMutex, vecMutex;
+	std::vector<PartIntersection> results(workEnd);
+
+	// levels are chosen in the order of the colissions, so the budget goes to the same colissions regardless of the threads
+	std::vector<int> detailLevels(workEnd);
+	std::vector<char> refine(workEnd);
+	for(size_t i = 0; i < workEnd; i++) {
+		int level = selectDetailLevel(this->colissionDetail, colissions[i]);
+		bool mayUseFullShapes = level == 0 || this->colissionDetail.refineShallowContacts;
+		if(!mayUseFullShapes) {
+			detailLevels[i] = level;
+			refine[i] = false;
+		} else if(fullDetailCount < this->colissionDetail.fullDetailBudget) {
+			fullDetailCount++;
+			detailLevels[i] = level;
+			refine[i] = this->colissionDetail.refineShallowContacts;
+		} else {
+			detailLevels[i] = std::max(level, 1);
+			refine[i] = false;
+		}
+	}
+	std::atomic<size_t> currIndex(0);
+	std::mutex statsMutex;
 
 	this->pool.doInParallel([&]{
+		auto profileScope = physicsMeasure.scope(PhysicsProcess::NARROWPHASE);
+		long long colissionCount = 0;
+		long long rejectCount = 0;
 		while (true) {
-
-			indexMutex.lock();
-			size_t claimedWork = currIndex;
-			currIndex++;
-			indexMutex.unlock();
+			size_t claimedWork = currIndex++;
 
 			if (claimedWork >= workEnd) {
 				break;
 			}
 
-			Colission col = colissions[claimedWork];
-			PartIntersection result = safeIntersects(*col.p1, *col.p2);
-
-			if (result.intersects) {
-				
-				statsMutex.lock();
-				intersectionStatistics.addToTally(IntersectionResult::COLISSION, 1);
-				statsMutex.unlock();
-				
-
-				// add extra information
-				col.intersection = result.intersection;
-				col.exitVector = result.exitVector;
-				
-				
-				vecMutex.lock();
-				wantedColission.push_back(col);
-				vecMutex.unlock();
-			}
-			else {
-				
-				statsMutex.lock();
-				intersectionStatistics.addToTally(IntersectionResult::GJK_REJECT, 1);
-				statsMutex.unlock();
-				
+			const Colission& col = colissions[claimedWork];
+			results[claimedWork] = safeIntersects(*col.p1, *col.p2, detailLevels[claimedWork], refine[claimedWork] != 0);
 
+			if (results[claimedWork].intersects) {
+				colissionCount++;
+			} else {
+				rejectCount++;
 			}
-		}	
+		}
+
+		statsMutex.lock();
+		intersectionStatistics.addToTally(IntersectionResult::COLISSION, colissionCount);
+		intersectionStatistics.addToTally(IntersectionResult::GJK_REJECT, rejectCount);
+		statsMutex.unlock();
 	});
-	colissions.swap(wantedColission);
+
+	size_t wantedCount = 0;
+	for (size_t i = 0; i < workEnd; i++) {
+		if (results[i].intersects) {
+			Colission col = colissions[i];
+			// add extra information
+			col.intersection = results[i].intersection;
+			col.exitVector = results[i].exitVector;
+			colissions[wantedCount++] = col;
+		}
+	}
+	colissions.resize(wantedCount);
 }
 
 void WorldPrototype::findColissions() {
@@ -321,8 +355,9 @@ void WorldPrototype::findColissions() {
 		getColissionsBetween(layers[collidingLayers.first], layers[collidingLayers.second], curColissions);
 	}
 
-	parallelRefineColission(curColissions.freePartColissions);
-	parallelRefineColission(curColissions.freeTerrainColissions);
+	size_t fullDetailCount = 0;
+	parallelRefineColission(curColissions.freePartColissions, fullDetailCount);
+	parallelRefineColission(curColissions.freeTerrainColissions, fullDetailCount);
 
 }
 
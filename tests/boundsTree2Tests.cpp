@@ -1,6 +1,8 @@
 #include "testsMain.h"
 
 #include "../physics/datastructures/boundsTree2.h"
+#include "../physics/datastructures/spatialHash.h"
+#include "../physics/misc/filters/rayIntersectsBoundsFilter.h"
 
 #include "testsMain.h"
 
@@ -422,6 +424,154 @@ TEST_CASE(testForEachColissionBetween) {
 	}
 }
 
+TEST_CASE(testForEachColissionBetweenDifferentOrigins) {
+	BoundsTree<BasicBounded> tree1(Position(64.0, -32.0, 16.0));
+	BoundsTree<BasicBounded> tree2(Position(-16.0, 8.0, 128.0));
+
+	constexpr int itemCount = 100;
+
+	std::vector<BasicBounded> allItems1 = generateBoundsTreeItems(itemCount);
+	std::vector<BasicBounded> allItems2 = generateBoundsTreeItems(itemCount);
+
+	createGroups(tree1, allItems1);
+	createGroups(tree2, allItems2);
+
+	ASSERT_TRUE(isBoundsTreeValid(tree1));
+	ASSERT_TRUE(isBoundsTreeValid(tree2));
+
+	std::set<std::pair<BasicBounded*, BasicBounded*>> foundColissions;
+
+	tree1.forEachColissionWith(tree2, [&](BasicBounded* a, BasicBounded* b) {
+		std::pair<BasicBounded*, BasicBounded*> col(a, b);
+		ASSERT_FALSE(foundColissions.find(col) != foundColissions.end()); // no duplicate colissions
+		foundColissions.insert(col);
+	});
+
+	for(BasicBounded& a : allItems1) {
+		for(BasicBounded& b : allItems2) {
+			std::pair<BasicBounded*, BasicBounded*> col(&a, &b);
+
+			bool wasFound = foundColissions.find(col) != foundColissions.end();
+
+			bool shouldBeFound = intersects(a.bounds, b.bounds);
+
+			ASSERT_STRICT(wasFound == shouldBeFound);
+		}
+	}
+}
+
+TEST_CASE(testBoundsTreeSetOrigin) {
+	BoundsTree<BasicBounded> tree;
+
+	constexpr int itemCount = 100;
+
+	std::vector<BasicBounded> allItems = generateBoundsTreeItems(itemCount);
+
+	std::vector<std::vector<BasicBounded*>> groups = createGroups(tree, allItems);
+
+	tree.setOrigin(Position(1000.0, -2000.0, 500.0));
+
+	ASSERT_TRUE(isBoundsTreeValid(tree));
+	ASSERT_TRUE(groupsMatchTree(groups, tree));
+
+	for(int iter = 0; iter < 100; iter++) {
+		BasicBounded& selectedItem = allItems[generateSize_t(allItems.size())];
+		BoundsTemplate<float> oldBounds = selectedItem.getBounds();
+		selectedItem.bounds = generateBoundsTreeBounds();
+
+		tree.updateObjectBounds(&selectedItem, oldBounds);
+		ASSERT_TRUE(tree.contains(&selectedItem));
+		ASSERT_TRUE(isBoundsTreeValid(tree));
+	}
+}
+
+TEST_CASE(testAxisAlignedRayFilter) {
+	BoundsTree<BasicBounded> tree;
+	BasicBounded unitBox{BoundsTemplate<float>(PositionTemplate<float>(0.0f, 0.0f, 0.0f), PositionTemplate<float>(1.0f, 1.0f, 1.0f))};
+	BasicBounded otherBox{BoundsTemplate<float>(PositionTemplate<float>(3.0f, 0.0f, 0.0f), PositionTemplate<float>(4.0f, 1.0f, 1.0f))};
+	tree.add(&unitBox);
+	tree.add(&otherBox);
+
+	auto findHits = [&](const Ray& ray) {
+		std::set<BasicBounded*> hits;
+		tree.forEachFiltered(RayIntersectBoundsFilter(ray), [&](BasicBounded& hit) { hits.insert(&hit); });
+		return hits;
+	};
+
+	// rays along y whose origin lies on the x and z planes of the box, where a zero direction gives 0 * inf
+	std::set<BasicBounded*> onFaces = findHits(Ray{Position(0.0, -5.0, 1.0), Vec3(0.0, 1.0, 0.0)});
+	ASSERT_TRUE(onFaces.count(&unitBox) == 1);
+	ASSERT_TRUE(onFaces.count(&otherBox) == 0);
+	std::set<BasicBounded*> onOtherFaces = findHits(Ray{Position(1.0, 5.0, 0.0), Vec3(0.0, -1.0, 0.0)});
+	ASSERT_TRUE(onOtherFaces.count(&unitBox) == 1);
+
+	std::set<BasicBounded*> beside = findHits(Ray{Position(1.5, -5.0, 0.5), Vec3(0.0, 1.0, 0.0)});
+	ASSERT_TRUE(beside.empty());
+
+	std::set<BasicBounded*> throughBoth = findHits(Ray{Position(-5.0, 0.0, 0.5), Vec3(1.0, 0.0, 0.0)});
+	ASSERT_TRUE(throughBoth.size() == 2);
+}
+
+TEST_CASE(testTouchingBoundsAcrossTreeOrigins) {
+	// the min of touchingBox lands an ulp past the max of box when offset from its tree origin with round to nearest
+	BasicBounded box{BoundsTemplate<float>(PositionTemplate<float>(-1.0f, 0.0f, 0.0f), PositionTemplate<float>(0.13f, 1.0f, 1.0f))};
+	BasicBounded touchingBox{BoundsTemplate<float>(PositionTemplate<float>(0.13f, 0.0f, 0.0f), PositionTemplate<float>(1.13f, 1.0f, 1.0f))};
+	BoundsTree<BasicBounded> tree;
+	BoundsTree<BasicBounded> otherTree(Position(4.07, 0.0, 0.0));
+	tree.add(&box);
+	otherTree.add(&touchingBox);
+
+	int colissionsFound = 0;
+	tree.forEachColissionWith(otherTree, [&](BasicBounded* a, BasicBounded* b) {
+		ASSERT_TRUE(a == &box && b == &touchingBox);
+		colissionsFound++;
+	});
+	ASSERT_TRUE(colissionsFound == 1);
+
+	colissionsFound = 0;
+	otherTree.forEachColissionWith(tree, [&](BasicBounded* a, BasicBounded* b) {
+		colissionsFound++;
+	});
+	ASSERT_TRUE(colissionsFound == 1);
+}
+
+TEST_CASE(testSpatialHashMatchesBoundsTree) {
+	BoundsTree<BasicBounded> tree;
+
+	constexpr int itemCount = 300;
+
+	std::vector<BasicBounded> allItems = generateBoundsTreeItems(itemCount);
+
+	std::vector<std::vector<BasicBounded*>> groups = createGroups(tree, allItems);
+
+	std::vector<SpatialHashItem> hashItems;
+	for(size_t groupIndex = 0; groupIndex < groups.size(); groupIndex++) {
+		for(BasicBounded* item : groups[groupIndex]) {
+			hashItems.push_back(SpatialHashItem{item->getBounds(), item, static_cast<int>(groupIndex)});
+		}
+	}
+	SpatialHash hash;
+	hash.build(std::move(hashItems));
+
+	std::set<std::pair<void*, void*>> treeColissions;
+	tree.forEachColission([&](BasicBounded* a, BasicBounded* b) {
+		if(b < a) std::swap(a, b);
+		treeColissions.insert(std::pair<void*, void*>(a, b));
+	});
+
+	std::set<std::pair<void*, void*>> hashColissions;
+	for(size_t i = 0; i < hash.size(); i++) {
+		hash.forEachColissionOf(i, [&](void* a, void* b) {
+			if(b < a) std::swap(a, b);
+			std::pair<void*, void*> col(a, b);
+			ASSERT_FALSE(hashColissions.find(col) != hashColissions.end()); // no duplicate colissions
+			hashColissions.insert(col);
+		});
+	}
+
+	ASSERT_TRUE(treeColissions == hashColissions);
+}
+
 TEST_CASE(testUpdatePartBounds) {
 	BoundsTree<BasicBounded> tree;
 
@@ -471,4 +621,36 @@ TEST_CASE(testUpdateGroupBounds) {
 }
 
 
+TEST_CASE(testBoundsTreeImage) {
+	BoundsTree<BasicBounded> tree;
+
+	constexpr int itemCount = 100;
+
+	std::vector<BasicBounded> allItems = generateBoundsTreeItems(itemCount);
+
+	std::vector<std::vector<BasicBounded*>> groups = createGroups(tree, allItems);
+
+	std::vector<TreeImageTrunk> image = tree.getImage([&](const BasicBounded& obj) {
+		return static_cast<std::uint32_t>(&obj - allItems.data());
+	});
+	ASSERT_TRUE(isValidTreeImage(image.data(), image.size(), allItems.size()));
+
+	BoundsTree<BasicBounded> loadedTree;
+	loadedTree.loadImage(image.data(), image.size(), [&](std::uint32_t index) {
+		return &allItems[index];
+	});
+	ASSERT_TRUE(isBoundsTreeValid(loadedTree));
+	ASSERT_TRUE(groupsMatchTree(groups, loadedTree));
+	ASSERT_TRUE(loadedTree.size() == tree.size());
+
+	// objects out of range
+	ASSERT_FALSE(isValidTreeImage(image.data(), image.size(), allItems.size() - 1));
+
+	// a trunk referring back to the base trunk
+	ASSERT_TRUE(image.size() > 1);
+	std::vector<TreeImageTrunk> cyclicImage = image;
+	cyclicImage.back().subNodes[0] = TreeImageTrunk::TRUNK_FLAG;
+	ASSERT_FALSE(isValidTreeImage(cyclicImage.data(), cyclicImage.size(), allItems.size()));
+}
+
 };
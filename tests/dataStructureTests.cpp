@@ -5,7 +5,19 @@
 #include "../physics/misc/toString.h"
 #include "../physics/misc/validityHelper.h"
 
-#include "../physics/datastructures/boundsTree.h"
+#include "../physics/datastructures/boundsTreeOld.h"
+#include "../physics/threading/tripleBuffer.h"
+#include "../physics/threading/commandQueue.h"
+#include "../physics/misc/profiling.h"
+#include "../physics/misc/traceRecorder.h"
+
+#include <thread>
+#include <array>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <sstream>
+#include <string>
 
 using namespace P3D::OldBoundsTree;
 
@@ -85,3 +97,255 @@ TEST_CASE(testMergeGroups) {
 		}
 	}
 }
+
+TEST_CASE(tripleBufferReadsLatestPublished) {
+	TripleBuffer<int> buffer;
+	ASSERT_FALSE(buffer.hasNewData());
+
+	buffer.getWriteBuffer() = 1;
+	buffer.publish();
+	buffer.getWriteBuffer() = 2;
+	buffer.publish();
+	ASSERT_TRUE(buffer.hasNewData());
+	ASSERT_STRICT(buffer.getReadBuffer() == 2);
+	ASSERT_FALSE(buffer.hasNewData());
+	// reading again without a new publish gives the same buffer
+	ASSERT_STRICT(buffer.getReadBuffer() == 2);
+
+	buffer.getWriteBuffer() = 3;
+	buffer.publish();
+	ASSERT_STRICT(buffer.getReadBuffer() == 3);
+}
+
+TEST_CASE(tripleBufferConcurrentReadsAreNeverTorn) {
+	// every published buffer is filled with a single value, a reader seeing two different values would be reading a buffer that is being written
+	TripleBuffer<std::array<int, 256>> buffer;
+	constexpr int PUBLISH_COUNT = 20000;
+
+	std::thread writer([&buffer]() {
+		for(int i = 1; i <= PUBLISH_COUNT; i++) {
+			buffer.getWriteBuffer().fill(i);
+			buffer.publish();
+		}
+	});
+
+	int lastSeen = 0;
+	bool tornReadFound = false;
+	bool wentBackInTime = false;
+	while(lastSeen < PUBLISH_COUNT) {
+		const std::array<int, 256>& values = buffer.getReadBuffer();
+		for(int v : values) {
+			if(v != values[0]) tornReadFound = true;
+		}
+		if(values[0] < lastSeen) wentBackInTime = true;
+		lastSeen = values[0];
+	}
+	writer.join();
+	ASSERT_FALSE(tornReadFound);
+	ASSERT_FALSE(wentBackInTime);
+}
+
+TEST_CASE(commandQueueRunsInOrder) {
+	CommandQueue queue(4);
+	std::vector<int> ran;
+	// small enough to fit in the command, and too large for it
+	std::array<int, 64> largeCapture{};
+	largeCapture[63] = 100;
+	for(int i = 0; i < 10; i++) {
+		if(i % 2 == 0) {
+			queue.push([&ran, i]() { ran.push_back(i); });
+		} else {
+			queue.push([&ran, i, largeCapture]() { ran.push_back(i + largeCapture[63] - 100); });
+		}
+	}
+	// 4 fit in the ring buffer, the rest overflowed
+	CommandQueue::DrainStatistics statistics = queue.drain();
+	ASSERT_STRICT(statistics.commandCount == 10);
+	ASSERT_STRICT(ran.size() == 10);
+	for(int i = 0; i < 10; i++) {
+		ASSERT_STRICT(ran[i] == i);
+	}
+	ASSERT_STRICT(queue.drain().commandCount == 0);
+}
+
+TEST_CASE(commandQueuePushDuringDrainRunsNextDrain) {
+	CommandQueue queue(8);
+	int count = 0;
+	queue.push([&]() {
+		count++;
+		queue.push([&]() { count += 10; });
+	});
+	ASSERT_STRICT(queue.drain().commandCount == 1);
+	ASSERT_STRICT(count == 1);
+	ASSERT_STRICT(queue.drain().commandCount == 1);
+	ASSERT_STRICT(count == 11);
+}
+
+TEST_CASE(commandQueueDestroysUnrunCommands) {
+	std::shared_ptr<int> tracked = std::make_shared<int>(5);
+	{
+		CommandQueue queue(2);
+		for(int i = 0; i < 5; i++) {
+			queue.push([tracked]() {});
+		}
+		ASSERT_STRICT(tracked.use_count() == 6);
+	}
+	ASSERT_STRICT(tracked.use_count() == 1);
+}
+
+TEST_CASE(commandQueueConcurrentProducersKeepTheirOrder) {
+	constexpr int PRODUCER_COUNT = 4;
+	constexpr int COMMANDS_PER_PRODUCER = 20000;
+	// a small ring buffer, so that the producers regularly overflow
+	CommandQueue queue(64);
+	std::vector<int> lastSeen(PRODUCER_COUNT, -1);
+	bool outOfOrder = false;
+	int totalRan = 0;
+
+	std::vector<std::thread> producers;
+	for(int p = 0; p < PRODUCER_COUNT; p++) {
+		producers.emplace_back([&, p]() {
+			for(int i = 0; i < COMMANDS_PER_PRODUCER; i++) {
+				queue.push([&, p, i]() {
+					if(lastSeen[p] != i - 1) outOfOrder = true;
+					lastSeen[p] = i;
+					totalRan++;
+				});
+			}
+		});
+	}
+	while(totalRan < PRODUCER_COUNT * COMMANDS_PER_PRODUCER) {
+		queue.drain();
+		std::this_thread::yield();
+	}
+	for(std::thread& t : producers) t.join();
+	ASSERT_FALSE(outOfOrder);
+	ASSERT_STRICT(totalRan == PRODUCER_COUNT * COMMANDS_PER_PRODUCER);
+}
+
+#ifndef P3D_DISABLE_PROFILING
+enum class TestProcess {
+	OUTER,
+	INNER,
+	WORKER,
+	COUNT
+};
+static const char* testProcessLabels[]{"Outer", "Inner", "Worker"};
+
+TEST_CASE(profilerNestedScopesCountExclusiveTime) {
+	BreakdownAverageProfiler<TestProcess> profiler(testProcessLabels, 10);
+	using namespace std::chrono;
+
+	profiler.mark(TestProcess::OUTER);
+	steady_clock::time_point innerStart = steady_clock::now();
+	{
+		auto scope = profiler.scope(TestProcess::INNER);
+		std::this_thread::sleep_for(milliseconds(20));
+	}
+	nanoseconds innerTime = steady_clock::now() - innerStart;
+	profiler.end();
+
+	auto tally = profiler.history.front();
+	ASSERT_TRUE(tally[static_cast<size_t>(TestProcess::INNER)] >= milliseconds(20));
+	ASSERT_TRUE(tally[static_cast<size_t>(TestProcess::INNER)] <= innerTime);
+	// the time spent in the inner scope isn't counted for the outer process
+	ASSERT_TRUE(tally[static_cast<size_t>(TestProcess::OUTER)] < milliseconds(20));
+}
+
+TEST_CASE(profilerCollectsTimeFromAllThreads) {
+	BreakdownAverageProfiler<TestProcess> profiler(testProcessLabels, 10);
+	using namespace std::chrono;
+
+	std::vector<std::thread> workers;
+	for(int i = 0; i < 4; i++) {
+		workers.emplace_back([&profiler]() {
+			auto scope = profiler.scope(TestProcess::WORKER);
+			std::this_thread::sleep_for(milliseconds(5));
+		});
+	}
+	for(std::thread& t : workers) t.join();
+	profiler.end();
+	ASSERT_TRUE(profiler.history.front()[static_cast<size_t>(TestProcess::WORKER)] >= milliseconds(20));
+
+	// time that was already collected isn't counted again
+	profiler.end();
+	ASSERT_TRUE(profiler.history.front()[static_cast<size_t>(TestProcess::WORKER)] == nanoseconds(0));
+}
+
+TEST_CASE(traceRecorderRecordsNestedSpans) {
+	BreakdownAverageProfiler<TestProcess> profiler(testProcessLabels, 10);
+	TraceRecorder recorder(100, false);
+	profiler.setTraceRecorder(&recorder);
+
+	profiler.mark(TestProcess::OUTER);
+	{
+		auto scope = profiler.scope(TestProcess::INNER);
+	}
+	std::thread worker([&profiler]() {
+		auto scope = profiler.scope(TestProcess::WORKER);
+	});
+	worker.join();
+	profiler.end();
+	profiler.setTraceRecorder(nullptr);
+
+	// the inner scope, the worker scope, and the outer mark around the inner scope
+	ASSERT_STRICT(recorder.getSpanCount() == 3);
+
+	std::stringstream trace;
+	recorder.writeChromeTrace(trace);
+	std::string json = trace.str();
+	ASSERT_TRUE(json.find("\"traceEvents\"") != std::string::npos);
+	ASSERT_TRUE(json.find("\"name\":\"Outer\",\"ph\":\"X\"") != std::string::npos);
+	ASSERT_TRUE(json.find("\"name\":\"Inner\",\"ph\":\"X\"") != std::string::npos);
+	ASSERT_TRUE(json.find("\"name\":\"Worker\",\"ph\":\"X\"") != std::string::npos);
+}
+
+TEST_CASE(traceRecorderRingBufferKeepsLatestSpans) {
+	TraceRecorder recorder(4, true);
+	static const char* names[]{"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	for(int i = 0; i < 10; i++) {
+		recorder.addSpan(TraceSpan{names[i], 0, now, now});
+	}
+	ASSERT_STRICT(recorder.getSpanCount() == 4);
+	std::stringstream trace;
+	recorder.writeChromeTrace(trace);
+	std::string json = trace.str();
+	ASSERT_TRUE(json.find("\"name\":\"5\"") == std::string::npos);
+	size_t positions[4];
+	for(int i = 0; i < 4; i++) {
+		positions[i] = json.find(std::string("\"name\":\"") + names[6 + i] + "\"");
+		ASSERT_TRUE(positions[i] != std::string::npos);
+	}
+	ASSERT_TRUE(positions[0] < positions[1] && positions[1] < positions[2] && positions[2] < positions[3]);
+
+	TraceRecorder limitedRecorder(4, false);
+	for(int i = 0; i < 10; i++) {
+		limitedRecorder.addSpan(TraceSpan{names[i], 0, now, now});
+	}
+	ASSERT_STRICT(limitedRecorder.getSpanCount() == 4);
+	ASSERT_STRICT(limitedRecorder.getDroppedSpanCount() == 6);
+}
+
+TEST_CASE(traceRecorderCapturesSlowTicks) {
+	using namespace std::chrono;
+	BreakdownAverageProfiler<TestProcess> profiler(testProcessLabels, 10);
+	TraceRecorder recorder(100, true);
+	recorder.setSlowTickCapture(milliseconds(10));
+	profiler.setTraceRecorder(&recorder);
+
+	profiler.mark(TestProcess::OUTER);
+	profiler.end();
+	ASSERT_STRICT(recorder.getCaptureCount() == 0);
+
+	profiler.mark(TestProcess::OUTER);
+	std::this_thread::sleep_for(milliseconds(15));
+	profiler.end();
+	profiler.setTraceRecorder(nullptr);
+	ASSERT_STRICT(recorder.getCaptureCount() == 1);
+
+	std::stringstream captured;
+	recorder.writeCapturedChromeTrace(captured);
+	ASSERT_TRUE(captured.str().find("\"name\":\"Outer\"") != std::string::npos);
+}
+#endif
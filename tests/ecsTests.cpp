@@ -1,9 +1,12 @@
 #include "testsMain.h"
 
 #include "../engine/ecs/registry.h"
+#include "../engine/ecs/systemScheduler.h"
 #include "../util/intrusivePointer.h"
 #include "../application/ecs/components.h"
 
+#include <vector>
+
 TEST_CASE(idGeneration) {
 	using namespace P3D::Engine;
 	Registry16 registry;
@@ -135,4 +138,239 @@ TEST_CASE(getFromView) {
 		intrusive_ptr<A> component = view.get<A>(entity);
 		ASSERT_TRUE(component->idx > 0 && component->idx < 4);
 	}
-}
\ No newline at end of file
+}
+TEST_CASE(removeKeepsOtherComponents) {
+	using namespace P3D::Engine;
+	Registry32 registry;
+
+	struct A : public RefCountable {
+		int idx;
+		A(int idx) : idx(idx) {}
+	};
+
+	std::vector<Registry32::entity_type> ids;
+	for (int i = 0; i < 100; i++) {
+		auto id = registry.create();
+		registry.add<A>(id, i);
+		ids.push_back(id);
+	}
+
+	for (int i = 0; i < 100; i += 3)
+		ASSERT_TRUE(registry.remove<A>(ids[i]));
+	ASSERT_FALSE(registry.remove<A>(ids[0]));
+
+	for (int i = 0; i < 100; i++) {
+		if (i % 3 == 0) {
+			ASSERT_FALSE(registry.has<A>(ids[i]));
+		} else {
+			ASSERT_TRUE(registry.get<A>(ids[i])->idx == i);
+		}
+	}
+	ASSERT_TRUE(registry.pool<A>().size() == 66);
+}
+
+TEST_CASE(destroyRemovesComponents) {
+	using namespace P3D::Engine;
+	Registry32 registry;
+
+	struct A : public RefCountable {};
+	struct B : public RefCountable {};
+
+	auto id1 = registry.create();
+	auto id2 = registry.create();
+	registry.add<A>(id1);
+	registry.add<B>(id1);
+	registry.add<A>(id2);
+
+	registry.destroy(id1);
+	ASSERT_FALSE(registry.contains(id1));
+	ASSERT_TRUE(registry.pool<A>().size() == 1);
+	ASSERT_TRUE(registry.pool<B>().size() == 0);
+	ASSERT_TRUE(registry.has<A>(id2));
+
+	// the id is reused, without the components of the destroyed entity
+	auto id3 = registry.create();
+	ASSERT_TRUE(id3 == id1);
+	ASSERT_FALSE(registry.has<A>(id3));
+}
+
+TEST_CASE(viewIteratesSmallestPool) {
+	using namespace P3D::Engine;
+	Registry32 registry;
+
+	struct A : public RefCountable {};
+	struct B : public RefCountable {
+		int idx;
+		B(int idx) : idx(idx) {}
+	};
+
+	for (int i = 0; i < 1000; i++) {
+		auto id = registry.create();
+		registry.add<A>(id);
+		if (i % 100 == 0)
+			registry.add<B>(id, i);
+	}
+
+	std::size_t count = 0;
+	auto view = registry.view<A, B>();
+	for (auto entity : view) {
+		ASSERT_TRUE(view.get<B>(entity)->idx % 100 == 0);
+		count++;
+	}
+	ASSERT_TRUE(count == 10);
+}
+
+TEST_CASE(eachVisitsComponentsAcrossPages) {
+	using namespace P3D::Engine;
+	Registry32 registry;
+
+	// components don't have to be RefCountable to be stored and iterated
+	struct Position {
+		float x;
+		Position(float x) : x(x) {}
+	};
+
+	std::size_t amount = Registry32::component_pool<Position>::page_size * 2 + 10;
+	for (std::size_t i = 0; i < amount; i++) {
+		auto id = registry.create();
+		registry.add<Position>(id, static_cast<float>(i));
+	}
+	ASSERT_TRUE(registry.pool<Position>().page_count() == 3);
+
+	std::size_t visited = 0;
+	bool allMatch = true;
+	registry.each<Position>([&] (Registry32::entity_type entity, Position& position) {
+		if (position.x != static_cast<float>(entity - 1))
+			allMatch = false;
+		position.x += 1.0f;
+		visited++;
+	});
+	ASSERT_TRUE(visited == amount);
+	ASSERT_TRUE(allMatch);
+	ASSERT_TRUE(registry.pool<Position>().get(5)->x == 5.0f);
+}
+
+TEST_CASE(refsToAddedComponentsStayValid) {
+	using namespace P3D::Engine;
+	Registry32 registry;
+
+	struct A : public RefCountable {
+		int idx;
+		A(int idx) : idx(idx) {}
+	};
+
+	auto first = registry.create();
+	Ref<A> firstComponent = registry.add<A>(first, 7);
+	// adding many components of the same type doesn't move earlier ones
+	for (int i = 0; i < 5000; i++) {
+		auto id = registry.create();
+		registry.add<A>(id, i);
+	}
+	ASSERT_TRUE(firstComponent->idx == 7);
+	ASSERT_TRUE(firstComponent.get() == registry.get<A>(first).get());
+}
+
+TEST_CASE(refsOutliveRemovedComponents) {
+	using namespace P3D::Engine;
+	Registry32 registry;
+
+	struct A : public RefCountable {
+		int idx;
+		A(int idx) : idx(idx) {}
+	};
+
+	std::vector<Registry32::entity_type> ids;
+	for (int i = 0; i < 10; i++) {
+		ids.push_back(registry.create());
+		registry.add<A>(ids[i], i);
+	}
+
+	// removing a component moves the last one into its slot, the component a Ref points to must not move with it
+	Ref<A> last = registry.get<A>(ids[9]);
+	Ref<A> removed = registry.get<A>(ids[0]);
+	ASSERT_TRUE(registry.remove<A>(ids[0]));
+	ASSERT_TRUE(removed->idx == 0);
+	ASSERT_TRUE(last->idx == 9);
+	ASSERT_TRUE(last.get() == registry.get<A>(ids[9]).get());
+
+	Ref<A> replaced = registry.get<A>(ids[5]);
+	registry.add<A>(ids[5], 50);
+	ASSERT_TRUE(replaced->idx == 5);
+	ASSERT_TRUE(registry.get<A>(ids[5])->idx == 50);
+
+	Ref<A> destroyed = registry.get<A>(ids[3]);
+	Ref<A> other = registry.get<A>(ids[4]);
+	registry.destroy(ids[3]);
+	ASSERT_TRUE(destroyed->idx == 3);
+	ASSERT_TRUE(other->idx == 4);
+	ASSERT_TRUE(destroyed->count == 1);
+	ASSERT_TRUE(other->count == 2);
+}
+
+TEST_CASE(schedulerStagesFollowDeclaredAccess) {
+	using namespace P3D::Engine;
+	Registry32 registry;
+	ThreadPool pool;
+	SystemScheduler32 scheduler(registry, pool);
+
+	struct A {};
+	struct B {};
+	struct C {};
+
+	auto noop = [] (Registry32&) {};
+	std::size_t writeA = scheduler.addSystem("writeA", Reads<>{}, Writes<A>{}, noop);
+	std::size_t writeB = scheduler.addSystem("writeB", Reads<>{}, Writes<B>{}, noop);
+	std::size_t readA = scheduler.addSystem("readA", Reads<A>{}, Writes<>{}, noop);
+	std::size_t readAAgain = scheduler.addSystem("readAAgain", Reads<A>{}, Writes<C>{}, noop);
+	std::size_t writeAAfterReads = scheduler.addSystem("writeAAfterReads", Reads<B>{}, Writes<A>{}, noop);
+	std::size_t readC = scheduler.addSystem("readC", Reads<C>{}, Writes<>{}, noop);
+
+	ASSERT_TRUE(scheduler.getStage(writeA) == 0);
+	ASSERT_TRUE(scheduler.getStage(writeB) == 0);
+	ASSERT_TRUE(scheduler.getStage(readA) == 1);
+	ASSERT_TRUE(scheduler.getStage(readAAgain) == 1);
+	ASSERT_TRUE(scheduler.getStage(writeAAfterReads) == 2);
+	ASSERT_TRUE(scheduler.getStage(readC) == 2);
+	ASSERT_TRUE(scheduler.getStageCount() == 3);
+}
+
+TEST_CASE(schedulerRunsSystemsInDependencyOrder) {
+	using namespace P3D::Engine;
+	Registry32 registry;
+	ThreadPool pool;
+	pool.setThreadCount(4);
+	SystemScheduler32 scheduler(registry, pool);
+
+	struct Velocity { int value; Velocity(int value) : value(value) {} };
+	struct Position { int value; Position(int value) : value(value) {} };
+	struct Total { long long value = 0; };
+
+	std::size_t amount = Registry32::component_pool<Position>::page_size * 5 + 7;
+	for (std::size_t i = 0; i < amount; i++) {
+		auto id = registry.create();
+		registry.add<Velocity>(id, static_cast<int>(i));
+		registry.add<Position>(id, 0);
+	}
+	auto totalEntity = registry.create();
+	registry.add<Total>(totalEntity);
+
+	auto& velocities = registry.pool<Velocity>();
+	scheduler.addEachSystem<Position>("move", Reads<Velocity>{}, Writes<Position>{}, [&velocities] (Registry32::entity_type entity, Position& position) {
+		position.value += velocities.get(entity)->value;
+	});
+	scheduler.addSystem("sum", Reads<Position>{}, Writes<Total>{}, [totalEntity] (Registry32& registry) {
+		long long total = 0;
+		registry.each<Position>([&total] (Registry32::entity_type, Position& position) {
+			total += position.value;
+		});
+		registry.pool<Total>().get(totalEntity)->value = total;
+	});
+
+	scheduler.update();
+	scheduler.update();
+
+	long long expected = 0;
+	for (std::size_t i = 0; i < amount; i++)
+		expected += 2 * static_cast<long long>(i);
+	ASSERT_TRUE(registry.pool<Total>().get(totalEntity)->value == expected);
+}
@@ -25,7 +25,7 @@
 #include "../physics/layer.h"
 #include "../physics/world.h"
 
-#include "../physics/datastructures/boundsTree.h"
+#include "../physics/datastructures/boundsTreeOld.h"
 
 template<typename T>
 T generate() {
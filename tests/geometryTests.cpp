@@ -11,14 +11,28 @@
 #include "../physics/math/boundingBox.h"
 
 #include "../physics/geometry/shape.h"
+#include "../physics/geometry/convexHull.h"
+#include "../physics/geometry/convexDecomposition.h"
+#include "../physics/geometry/terrainMeshClass.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/geometry/intersection.h"
+#include "../physics/geometry/builtinShapeClasses.h"
+#include "../physics/geometry/shapeClassRegistry.h"
+#include "../physics/threading/threadPool.h"
+#include "../physics/part.h"
+#include "../physics/physical.h"
 
 #include "../physics/misc/shapeLibrary.h"
+#include "../physics/misc/validityHelper.h"
 
 #include "testValues.h"
 #include "generators.h"
 
 #include "../util/cpuid.h"
 
+#include <algorithm>
+#include <random>
+
 #define ASSERT(condition) ASSERT_TOLERANT(condition, 0.00001)
 
 template<typename T, typename Tol, size_t Size>
@@ -258,3 +272,390 @@ TEST_CASE(testTriangleMeshOptimizedFurthestInDirection) {
 		}
 	}
 }
+
+// an L shaped mesh, made of two overlapping boxes
+static TriangleMesh createLShape() {
+	Polyhedron parts[2]{Library::createBox(3.0f, 1.0f, 1.0f).translated(Vec3f(1.0f, 0.0f, 0.0f)), Library::createBox(1.0f, 3.0f, 1.0f).translated(Vec3f(0.0f, 1.0f, 0.0f))};
+
+	std::vector<Vec3f> vertices;
+	std::vector<Triangle> triangles;
+	for(const Polyhedron& part : parts) {
+		int offset = static_cast<int>(vertices.size());
+		for(int i = 0; i < part.vertexCount; i++) vertices.push_back(part.getVertex(i));
+		for(int i = 0; i < part.triangleCount; i++) {
+			Triangle t = part.getTriangle(i);
+			triangles.push_back(Triangle{t[0] + offset, t[1] + offset, t[2] + offset});
+		}
+	}
+
+	return TriangleMesh(static_cast<int>(vertices.size()), static_cast<int>(triangles.size()), vertices.data(), triangles.data());
+}
+
+static double getTotalVolume(const std::vector<Polyhedron>& hulls) {
+	double volume = 0.0;
+	for(const Polyhedron& hull : hulls) volume += hull.getVolume();
+	return volume;
+}
+
+TEST_CASE(convexDecompositionOfConvexMesh) {
+	Polyhedron box = Library::createBox(2.0f, 1.0f, 1.0f);
+	std::vector<Polyhedron> hulls = decomposeConvex(box);
+
+	ASSERT_TRUE(hulls.size() == 1);
+	// the vertices of the hull are rounded to 1/128th of its size
+	for(int i = 0; i < box.vertexCount; i++) {
+		ASSERT_TRUE(hulls[0].containsPoint(box.getVertex(i) * 0.98f));
+		ASSERT_FALSE(hulls[0].containsPoint(box.getVertex(i) * 1.02f));
+	}
+	ASSERT_TOLERANT(hulls[0].getVolume() == box.getVolume(), box.getVolume() * 0.03);
+}
+
+TEST_CASE(convexDecompositionOfConcaveMesh) {
+	TriangleMesh lShape = createLShape();
+	std::vector<Polyhedron> hulls = decomposeConvex(lShape);
+
+	// the hull of the whole L would be 1.6 times its volume
+	ASSERT_TRUE(hulls.size() >= 2);
+	ASSERT_TOLERANT(getTotalVolume(hulls) == 5.0, 5.0 * 0.05);
+
+	// every corner of the L is in one of the pieces
+	for(int i = 0; i < lShape.vertexCount; i++) {
+		Vec3f vertex = lShape.getVertex(i);
+		Vec3f inside = vertex + (Vec3f(0.5f, 0.5f, 0.0f) - vertex) * 0.02f;
+		bool contained = false;
+		for(const Polyhedron& hull : hulls) {
+			if(hull.containsPoint(inside)) contained = true;
+		}
+		ASSERT_TRUE(contained);
+	}
+}
+
+TEST_CASE(convexDecompositionIsIndependentOfThreads) {
+	TriangleMesh lShape = createLShape();
+	ThreadPool pool;
+	pool.setThreadCount(4);
+
+	std::vector<Polyhedron> serial = decomposeConvex(lShape);
+	std::vector<Polyhedron> parallel = decomposeConvex(lShape, pool);
+
+	ASSERT_TRUE(serial.size() == parallel.size());
+	for(std::size_t i = 0; i < serial.size(); i++) {
+		ASSERT_TRUE(serial[i].vertexCount == parallel[i].vertexCount);
+		ASSERT_TOLERANT(serial[i].getVolume() == parallel[i].getVolume(), 0.0);
+	}
+}
+
+TEST_CASE(convexDecompositionMakesCompoundPart) {
+	std::vector<Polyhedron> hulls = decomposeConvex(createLShape());
+	std::vector<ConvexPiece> pieces = toConvexPieces(hulls);
+	ASSERT_TRUE(pieces.size() == hulls.size());
+
+	PartProperties properties{1.0, 0.5, 0.5};
+	GlobalCFrame meshCFrame(1.0, 2.0, 3.0);
+	std::vector<Part*> parts = createCompoundPart(pieces, meshCFrame, properties);
+	ASSERT_TRUE(parts.size() == pieces.size());
+
+	Part* main = parts[0];
+	ASSERT_TRUE(main->parent != nullptr);
+	ASSERT_TRUE(main->parent->rigidBody.getPartCount() == pieces.size());
+	ASSERT_TOLERANT(main->parent->rigidBody.mass == getTotalVolume(hulls), 0.001);
+
+	// every piece ends up where its offset puts it relative to the origin of the mesh
+	for(std::size_t i = 0; i < pieces.size(); i++) {
+		Vec3 relativePosition = parts[i]->getCFrame().getPosition() - meshCFrame.getPosition();
+		ASSERT_TOLERANT(relativePosition == pieces[i].offset.getPosition(), 0.0001);
+	}
+	for(std::size_t i = parts.size(); i > 1; i--) delete parts[i - 1];
+	delete main;
+}
+
+static std::vector<Vec3f> createPointCloud(std::size_t pointCount, unsigned int seed) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+	std::vector<Vec3f> points;
+	while(points.size() < pointCount) {
+		Vec3f point(coordinate(random), coordinate(random), coordinate(random));
+		if(lengthSquared(point) <= 1.0f) points.push_back(point);
+	}
+	return points;
+}
+
+static bool isOnOrInside(const Polyhedron& hull, Vec3f point) {
+	for(int i = 0; i < hull.triangleCount; i++) {
+		Triangle t = hull.getTriangle(i);
+		Vec3f v0 = hull.getVertex(t[0]);
+		Vec3f normal = normalize((hull.getVertex(t[1]) - v0) % (hull.getVertex(t[2]) - v0));
+		if((point - v0) * normal > 0.0001f) return false;
+	}
+	return true;
+}
+
+TEST_CASE(convexHullOfGrid) {
+	std::vector<Vec3f> points;
+	for(int x = 0; x <= 6; x++) {
+		for(int y = 0; y <= 6; y++) {
+			for(int z = 0; z <= 6; z++) {
+				points.push_back(Vec3f(x * 0.5f, y * 0.25f, z * 0.125f));
+			}
+		}
+	}
+	Polyhedron hull = convexHull(points.data(), points.size());
+
+	ASSERT_TRUE(isValid(hull));
+	ASSERT_TOLERANT(hull.getVolume() == 3.0 * 1.5 * 0.75, 0.0001);
+	for(int i = 0; i < hull.vertexCount; i++) {
+		Vec3f vertex = hull.getVertex(i);
+		ASSERT_TRUE((vertex.x == 0.0f || vertex.x == 3.0f) && (vertex.y == 0.0f || vertex.y == 1.5f) && (vertex.z == 0.0f || vertex.z == 0.75f));
+	}
+}
+
+TEST_CASE(convexHullContainsAllPoints) {
+	std::vector<Vec3f> points = createPointCloud(5000, 17);
+	Polyhedron hull = convexHull(points.data(), points.size());
+
+	ASSERT_TRUE(isValid(hull));
+	for(const Vec3f& point : points) {
+		ASSERT_TRUE(isOnOrInside(hull, point));
+	}
+	// the vertices of the hull are points of the cloud
+	for(int i = 0; i < hull.vertexCount; i++) {
+		ASSERT_TRUE(std::find(points.begin(), points.end(), hull.getVertex(i)) != points.end());
+	}
+}
+
+TEST_CASE(convexHullIsIndependentOfThreads) {
+	std::vector<Vec3f> points = createPointCloud(20000, 5);
+	ThreadPool pool;
+	pool.setThreadCount(4);
+
+	Polyhedron serial = convexHull(points.data(), points.size());
+	Polyhedron parallel = convexHull(points.data(), points.size(), pool);
+
+	ASSERT_TRUE(serial.vertexCount == parallel.vertexCount);
+	ASSERT_TRUE(serial.triangleCount == parallel.triangleCount);
+	for(int i = 0; i < serial.vertexCount; i++) {
+		ASSERT_TRUE(serial.getVertex(i) == parallel.getVertex(i));
+	}
+}
+
+TEST_CASE(convexHullSimplified) {
+	std::vector<Vec3f> points = createPointCloud(5000, 3);
+	Polyhedron full = convexHull(points.data(), points.size());
+	Polyhedron simplified = convexHull(points.data(), points.size(), 32);
+
+	ASSERT_TRUE(isValid(simplified));
+	ASSERT_TRUE(full.vertexCount > 32);
+	ASSERT_TRUE(simplified.vertexCount <= 32);
+	for(int i = 0; i < simplified.vertexCount; i++) {
+		ASSERT_TRUE(isOnOrInside(full, simplified.getVertex(i)));
+	}
+	ASSERT_TRUE(simplified.getVolume() <= full.getVolume());
+	ASSERT_TRUE(simplified.getVolume() > full.getVolume() * 0.7);
+}
+
+TEST_CASE(convexHullOfFlatPoints) {
+	std::vector<Vec3f> points;
+	for(int i = 0; i < 20; i++) points.push_back(Vec3f(float(i % 5), float(i / 5), 0.0f));
+
+	ConvexHullBuilder builder;
+	ASSERT_FALSE(builder.build(points.data(), points.size()));
+	ASSERT_TRUE(convexHull(points.data(), points.size()).vertexCount == 0);
+}
+
+// a 9 by 9 heightfield rising from 0 to 0.8 along x, centered on (4, 0.4, 4)
+static Shape createRampTerrain() {
+	std::vector<float> heights(81);
+	for(int z = 0; z < 9; z++) {
+		for(int x = 0; x < 9; x++) {
+			heights[z * 9 + x] = x * 0.1f;
+		}
+	}
+	return heightfieldShape(heights.data(), 9, 9, 1.0);
+}
+
+TEST_CASE(terrainMeshHierarchyContainsAllTriangles) {
+	Shape terrain = createRampTerrain();
+	const TerrainMeshClass& mesh = static_cast<const TerrainMeshClass&>(*terrain.baseShape);
+
+	ASSERT_TRUE(mesh.getTriangleCount() == 128);
+	ASSERT_TRUE(mesh.getNodeCount() < mesh.getTriangleCount());
+
+	std::vector<int> found(mesh.getTriangleCount(), 0);
+	mesh.forEachTriangleIn(BoundingBoxTemplate<float>(-2.0f, -2.0f, -2.0f, 2.0f, 2.0f, 2.0f), [&](int triangleIndex) {
+		found[triangleIndex]++;
+	});
+	for(int count : found) {
+		ASSERT_TRUE(count == 1);
+	}
+
+	// the bounds of every leaf contain its triangles
+	for(int i = 0; i < mesh.getNodeCount(); i++) {
+		const TerrainMeshClass::Node& node = mesh.getNode(i);
+		if(!node.isLeaf()) continue;
+		ASSERT_TRUE(node.triangleCount <= TerrainMeshClass::LEAF_SIZE);
+		for(int j = node.firstTriangle; j < node.firstTriangle + node.triangleCount; j++) {
+			for(int corner = 0; corner < 3; corner++) {
+				ASSERT_TRUE(node.bounds.containsPoint(mesh.getVertex(mesh.getTriangle(j)[corner])));
+			}
+		}
+	}
+
+	// a small box only finds the triangles near it
+	int nearCount = 0;
+	mesh.forEachTriangleIn(BoundingBoxTemplate<float>(-0.1f, -1.0f, -0.1f, 0.1f, 1.0f, 0.1f), [&](int triangleIndex) {
+		nearCount++;
+	});
+	ASSERT_TRUE(nearCount > 0 && nearCount < 32);
+}
+
+TEST_CASE(terrainMeshRaysAndPoints) {
+	Shape terrain = createRampTerrain();
+
+	ASSERT_TOLERANT(terrain.getWidth() == 8.0, 0.00001);
+	ASSERT_TOLERANT(terrain.getHeight() == 0.8, 0.00001);
+	// the surface at (4.5, 4.3) of the heightfield is at 0.45, which is 0.05 above the center of the shape
+	ASSERT_TRUE(terrain.containsPoint(Vec3(0.5, 0.0, 0.3)));
+	ASSERT_FALSE(terrain.containsPoint(Vec3(0.5, 0.1, 0.3)));
+	ASSERT_TOLERANT(terrain.getIntersectionDistance(Vec3(0.5, 1.0, 0.3), Vec3(0.0, -1.0, 0.0)) == 0.95, 0.0001);
+	ASSERT_TRUE(terrain.getIntersectionDistance(Vec3(0.5, 1.0, 0.3), Vec3(0.0, 1.0, 0.0)) > 1000.0);
+}
+
+TEST_CASE(terrainMeshIntersectsBox) {
+	std::vector<float> heights(100, 0.0f);
+	Shape terrain = heightfieldShape(heights.data(), 10, 10, 1.0);
+	Shape box = boxShape(1.0, 1.0, 1.0);
+
+	// the box sinks 0.05 into the flat terrain, over the edges between several triangles
+	CFrame terrainRelativeToBox(Vec3(0.3, -0.45, -0.2));
+	std::optional<Intersection> result = intersectsTransformed(box, terrain, terrainRelativeToBox);
+	ASSERT_TRUE(result.has_value());
+	Vec3 exitVector = result.value().exitVector;
+	ASSERT_TOLERANT(std::abs(exitVector.y) == 0.05, 0.001);
+	ASSERT_TOLERANT(exitVector.x == 0.0, 0.001);
+	ASSERT_TOLERANT(exitVector.z == 0.0, 0.001);
+
+	// the other way around the exit vector is reversed
+	std::optional<Intersection> reversed = intersectsTransformed(terrain, box, ~terrainRelativeToBox);
+	ASSERT_TRUE(reversed.has_value());
+	ASSERT_TOLERANT(terrainRelativeToBox.localToRelative(reversed.value().exitVector) == -exitVector, 0.001);
+
+	ASSERT_FALSE(intersectsTransformed(box, terrain, CFrame(Vec3(0.3, -0.55, -0.2))).has_value());
+	ASSERT_FALSE(intersectsTransformed(box, terrain, CFrame(Vec3(0.3, 0.55, -0.2))).has_value());
+	ASSERT_FALSE(intersectsTransformed(box, terrain, CFrame(Vec3(10.0, -0.45, 0.0))).has_value());
+}
+
+TEST_CASE(detailLevelsContainPolyhedron) {
+	const int detailVertexCounts[]{100000, 32, 40, 12};
+	Shape sphere = polyhedronShape(Library::createSphere(1.0, 3), detailVertexCounts, 4);
+	const PolyhedronShapeClass& shapeClass = static_cast<const PolyhedronShapeClass&>(*sphere.baseShape);
+	Polyhedron poly = shapeClass.asPolyhedron();
+
+	// counts that don't remove vertices are skipped
+	ASSERT_STRICT(shapeClass.getDetailLevelCount() == 3);
+	ASSERT_TRUE(&shapeClass.getDetailLevel(0) == &shapeClass);
+	ASSERT_TRUE(&shapeClass.getDetailLevel(5) == &shapeClass.getDetailLevel(2));
+	ASSERT_TRUE(shapeClass.getDetailLevelError(0) == 0.0f);
+	ASSERT_TRUE(shapeClass.getDetailLevelError(1) > 0.0f);
+	ASSERT_TRUE(shapeClass.getDetailLevelError(2) >= shapeClass.getDetailLevelError(1));
+
+	std::mt19937 random(42);
+	std::normal_distribution<float> coordinate;
+	for(int level = 1; level < 3; level++) {
+		const PolyhedronShapeClass::DetailLevel& detailLevel = static_cast<const PolyhedronShapeClass::DetailLevel&>(shapeClass.getDetailLevel(level));
+		ASSERT_TRUE(detailLevel.hull.vertexCount <= (level == 1 ? 32 : 12));
+		ASSERT_TRUE(isValid(detailLevel.hull));
+
+		for(int i = 0; i < 200; i++) {
+			Vec3f direction = normalize(Vec3f(coordinate(random), coordinate(random), coordinate(random)));
+			float polySupport = poly.furthestInDirection(direction) * direction;
+			float hullSupport = detailLevel.furthestInDirection(direction) * direction;
+			ASSERT_TRUE(hullSupport >= polySupport - 0.00001f);
+			ASSERT_TRUE(hullSupport <= polySupport + detailLevel.error + 0.00001f);
+		}
+	}
+}
+
+TEST_CASE(detailLevelIntersections) {
+	const int detailVertexCounts[]{12};
+	Shape sphere = polyhedronShape(Library::createSphere(1.0, 3), detailVertexCounts, 1);
+	const PolyhedronShapeClass& shapeClass = static_cast<const PolyhedronShapeClass&>(*sphere.baseShape);
+	double error = shapeClass.getDetailLevelError(1);
+
+	// beyond the error of the hulls the shapes are apart at every level
+	CFrame apart(Vec3(2.0 + 2.0 * error + 0.01, 0.0, 0.0));
+	ASSERT_FALSE(intersectsTransformed(sphere, sphere, apart, 0, false).has_value());
+	ASSERT_FALSE(intersectsTransformed(sphere, sphere, apart, 1, false).has_value());
+
+	// deep intersections are found at every level
+	CFrame deep(Vec3(1.2, 0.13, 0.07), Rotation::fromEulerAngles(0.3, 0.2, 0.1));
+	ASSERT_TRUE(intersectsTransformed(sphere, sphere, deep, 0, false).has_value());
+	ASSERT_TRUE(intersectsTransformed(sphere, sphere, deep, 1, false).has_value());
+	ASSERT_TRUE(intersectsTransformed(sphere, sphere, deep, 1, true).has_value());
+
+	// between the sphere and the corner of its hull, only the hull touches a small box. Refining tests the full shape
+	const PolyhedronShapeClass::DetailLevel& detailLevel = static_cast<const PolyhedronShapeClass::DetailLevel&>(shapeClass.getDetailLevel(1));
+	Vec3f corner = detailLevel.hull.getVertex(0);
+	for(Vec3f vertex : detailLevel.hull.iterVertices()) {
+		if(lengthSquared(vertex) > lengthSquared(corner)) corner = vertex;
+	}
+	ASSERT_TRUE(length(corner) > 1.01f);
+	Shape smallBox = boxShape(0.001, 0.001, 0.001);
+	CFrame betweenHullAndSphere(Vec3(corner) * ((1.0 + length(corner)) / 2 / length(corner)));
+	ASSERT_FALSE(intersectsTransformed(sphere, smallBox, betweenHullAndSphere, 0, false).has_value());
+	ASSERT_TRUE(intersectsTransformed(sphere, smallBox, betweenHullAndSphere, 1, false).has_value());
+	ASSERT_FALSE(intersectsTransformed(sphere, smallBox, betweenHullAndSphere, 1, true).has_value());
+}
+
+TEST_CASE(identicalPolyhedraShareShapeClass) {
+	Shape box = polyhedronShape(Library::createBox(1.0f, 2.0f, 3.0f));
+	Shape sameBox = polyhedronShape(Library::createBox(1.0f, 2.0f, 3.0f));
+	// normalized to the -1..1 box, boxes of all sizes are the same polyhedron
+	Shape otherBox = polyhedronShape(Library::createBox(0.3f, 5.0f, 1.0f));
+	Shape movedBox = polyhedronShape(Library::createBox(1.0f, 2.0f, 3.0f).translated(Vec3f(4.0f, -2.0f, 1.0f)));
+	Shape icosahedron = polyhedronShape(Library::icosahedron);
+
+	ASSERT_TRUE(box.baseShape == sameBox.baseShape);
+	ASSERT_TRUE(box.baseShape == otherBox.baseShape);
+	ASSERT_TRUE(box.baseShape == movedBox.baseShape);
+	ASSERT_TRUE(box.baseShape != icosahedron.baseShape);
+	ASSERT_TOLERANT(otherBox.getWidth() == 0.3, 0.00001);
+
+	// levels of detail are part of the class
+	const int detailVertexCounts[]{12};
+	Shape detailedSphere = polyhedronShape(Library::createSphere(1.0, 2), detailVertexCounts, 1);
+	Shape sameDetailedSphere = polyhedronShape(Library::createSphere(1.0, 2), detailVertexCounts, 1);
+	Shape sphere = polyhedronShape(Library::createSphere(1.0, 2));
+	ASSERT_TRUE(detailedSphere.baseShape == sameDetailedSphere.baseShape);
+	ASSERT_TRUE(detailedSphere.baseShape != sphere.baseShape);
+}
+
+TEST_CASE(shapeClassRegistryInterns) {
+	Polyhedron box = Library::createCube(2.0f);
+	Vec3f vertices[8];
+	Triangle triangles[12];
+	box.getVertices(vertices);
+	box.getTriangles(triangles);
+	vertices[0] = vertices[0] * 0.9f;
+	Polyhedron cornerMoved(vertices, triangles, 8, 12);
+
+	PolyhedronShapeClass boxClass{Polyhedron(box)};
+	PolyhedronShapeClass sameClass{Polyhedron(box)};
+	PolyhedronShapeClass cornerMovedClass{Polyhedron(cornerMoved)};
+
+	ShapeClassRegistry registry;
+	ASSERT_TRUE(registry.find(box) == nullptr);
+	ASSERT_TRUE(registry.add(&boxClass) == &boxClass);
+	ASSERT_TRUE(registry.find(box) == &boxClass);
+	ASSERT_TRUE(registry.find(cornerMoved) == nullptr);
+
+	// an equal class that comes later is not registered
+	ASSERT_TRUE(registry.add(&sameClass) == &boxClass);
+
+	ASSERT_TRUE(registry.add(&cornerMovedClass) == &cornerMovedClass);
+	ASSERT_TRUE(registry.find(cornerMoved) == &cornerMovedClass);
+	ASSERT_STRICT(registry.getClassCount() == 2);
+
+	// the same polyhedron with levels of detail is another class
+	const int detailVertexCounts[]{6};
+	ASSERT_TRUE(registry.find(box, detailVertexCounts, 1) == nullptr);
+}
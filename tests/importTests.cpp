@@ -0,0 +1,374 @@
+#include "testsMain.h"
+
+#include "compare.h"
+#include "../physics/misc/toString.h"
+
+#include "../engine/io/import.h"
+#include "../engine/io/meshCache.h"
+#include "../engine/io/decompositionCache.h"
+#include "../graphics/visualShape.h"
+#include "../physics/threading/threadPool.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/misc/shapeLibrary.h"
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+using namespace P3D;
+
+static Graphics::VisualShape parseText(const std::string& text) {
+	return OBJImport::parse(text.data(), text.size());
+}
+
+// a grid of size by size quads, with uvs and normals if requested
+static std::string generateGridObj(int size, bool withAttributes) {
+	std::ostringstream obj;
+	obj << "# generated grid\no grid\n";
+	for (int y = 0; y <= size; y++) {
+		for (int x = 0; x <= size; x++) {
+			obj << "v " << x * 0.5 << ' ' << (x * y % 7) * 0.125 << ' ' << -y * 0.5 << '\n';
+			if (withAttributes)
+				obj << "vt " << x / double(size) << ' ' << y / double(size) << "\nvn 0 1 0\n";
+		}
+	}
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			int a = y * (size + 1) + x + 1;
+			int b = a + 1;
+			int c = a + size + 2;
+			int d = a + size + 1;
+			if (withAttributes)
+				obj << "f " << a << '/' << a << '/' << a << ' ' << b << '/' << b << '/' << b << ' ' << c << '/' << c << '/' << c << ' ' << d << '/' << d << '/' << d << '\n';
+			else
+				obj << "f " << a << ' ' << b << ' ' << c << ' ' << d << '\n';
+		}
+	}
+
+	return obj.str();
+}
+
+static bool shapesEqual(const Graphics::VisualShape& first, const Graphics::VisualShape& second) {
+	if (first.vertexCount != second.vertexCount || first.triangleCount != second.triangleCount)
+		return false;
+
+	for (int i = 0; i < first.vertexCount; i++) {
+		if (first.getVertex(i) != second.getVertex(i))
+			return false;
+	}
+
+	for (int i = 0; i < first.triangleCount; i++) {
+		if (!(first.getTriangle(i) == second.getTriangle(i)))
+			return false;
+	}
+
+	return true;
+}
+
+TEST_CASE(objParseMatchesLineByLine) {
+	std::string text = generateGridObj(20, false);
+	std::istringstream stream(text);
+
+	Graphics::VisualShape reference = OBJImport::loadLineByLine(stream);
+	Graphics::VisualShape shape = parseText(text);
+
+	ASSERT_TRUE(shape.vertexCount == 21 * 21);
+	ASSERT_TRUE(shape.triangleCount == 20 * 20 * 2);
+	ASSERT_TRUE(shapesEqual(reference, shape));
+}
+
+TEST_CASE(objParsePolygonsAndRelativeIndices) {
+	Graphics::VisualShape shape = parseText(
+		"v 0 0 0\r\n"
+		"v 1 0 0\r\n"
+		"v 1 1 0\r\n"
+		"v +0.5 1.5e0 0\r\n"
+		"v 0 1 0\r\n"
+		"f -5 -4 -3 -2 -1 # a pentagon\r\n"
+		"f 1 2 3");
+
+	ASSERT_TRUE(shape.vertexCount == 5);
+	ASSERT_TRUE(shape.triangleCount == 4);
+	ASSERT_TRUE(shape.getVertex(3) == Vec3f(0.5f, 1.5f, 0.0f));
+	ASSERT_TRUE(shape.getTriangle(0) == (Triangle { 0, 1, 2 }));
+	ASSERT_TRUE(shape.getTriangle(1) == (Triangle { 0, 2, 3 }));
+	ASSERT_TRUE(shape.getTriangle(2) == (Triangle { 0, 3, 4 }));
+	ASSERT_TRUE(shape.getTriangle(3) == (Triangle { 0, 1, 2 }));
+}
+
+TEST_CASE(objParseSplitsVerticesAtSeams) {
+	// two triangles sharing an edge, but with a different normal on either side
+	Graphics::VisualShape shape = parseText(
+		"v 0 0 0\n"
+		"v 1 0 0\n"
+		"v 0 1 0\n"
+		"v 0 0 1\n"
+		"vn 0 0 1\n"
+		"vn 0 1 0\n"
+		"f 1//1 2//1 3//1\n"
+		"f 1//2 4//2 2//2\n");
+
+	ASSERT_TRUE(shape.vertexCount == 6);
+	ASSERT_TRUE(shape.triangleCount == 2);
+	for (int i = 0; i < shape.triangleCount; i++) {
+		Triangle triangle = shape.getTriangle(i);
+		Vec3f expectedNormal = i == 0 ? Vec3f(0.0f, 0.0f, 1.0f) : Vec3f(0.0f, 1.0f, 0.0f);
+		for (int j = 0; j < 3; j++)
+			ASSERT_TRUE(shape.normals[triangle[j]] == expectedNormal);
+	}
+	ASSERT_TRUE(shape.getVertex(shape.getTriangle(1)[1]) == Vec3f(0.0f, 0.0f, 1.0f));
+}
+
+TEST_CASE(objParseInParallelMatchesSerial) {
+	std::string text = generateGridObj(150, true);
+	ThreadPool pool;
+	pool.setThreadCount(4);
+
+	Graphics::VisualShape serial = parseText(text);
+	Graphics::VisualShape parallel = OBJImport::parse(text.data(), text.size(), pool);
+
+	ASSERT_TRUE(serial.vertexCount == 151 * 151);
+	ASSERT_TRUE(shapesEqual(serial, parallel));
+	for (int i = 0; i < serial.vertexCount; i++) {
+		ASSERT_TRUE(serial.uvs[i] == parallel.uvs[i]);
+		ASSERT_TRUE(serial.normals[i] == parallel.normals[i]);
+	}
+}
+
+TEST_CASE(objParseRejectsMalformedInput) {
+	ASSERT_TRUE(parseText("v 0 0 0\nv 1 0 0\nf 1 2 3\n").triangleCount == 0);
+	ASSERT_TRUE(parseText("v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2\n").triangleCount == 0);
+	ASSERT_TRUE(parseText("v 0 0 zero\n").vertexCount == 0);
+	ASSERT_TRUE(parseText("v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 x\n").triangleCount == 0);
+}
+
+static std::string getTemporaryFileName(const char* name) {
+	return std::string("p3dTest_") + name;
+}
+
+TEST_CASE(meshCacheRoundTrip) {
+	std::string text = generateGridObj(10, true);
+	std::uint64_t key = MeshCache::getKey(text.data(), text.size());
+	Polyhedron hull = Library::createBox(2.0f, 1.0f, 3.0f);
+	CachedMesh mesh = MeshCache::create(parseText(text), &hull);
+	ASSERT_TOLERANT(mesh.volume == 6.0, 0.00001);
+
+	std::string file = getTemporaryFileName("meshCacheRoundTrip.p3dmesh");
+	ASSERT_TRUE(MeshCache::write(file, key, mesh));
+
+	CachedMesh loaded;
+	bool wasRead = MeshCache::read(file, key, loaded);
+	std::remove(file.c_str());
+	ASSERT_TRUE(wasRead);
+
+	ASSERT_TRUE(shapesEqual(mesh.shape, loaded.shape));
+	for (int i = 0; i < mesh.shape.vertexCount; i++) {
+		ASSERT_TRUE(mesh.shape.normals[i] == loaded.shape.normals[i]);
+		ASSERT_TRUE(mesh.shape.uvs[i] == loaded.shape.uvs[i]);
+		ASSERT_TRUE(mesh.shape.tangents[i] == loaded.shape.tangents[i]);
+	}
+
+	ASSERT_TRUE(loaded.hasHull);
+	ASSERT_TRUE(loaded.hull.vertexCount == hull.vertexCount);
+	for (int i = 0; i < hull.vertexCount; i++)
+		ASSERT_TRUE(loaded.hull.getVertex(i) == hull.getVertex(i));
+	ASSERT_TRUE(loaded.volume == mesh.volume);
+	ASSERT_TRUE(loaded.centerOfMass == mesh.centerOfMass);
+	ASSERT_TOLERANT(loaded.inertia.toMatrix() == mesh.inertia.toMatrix(), 0.0);
+}
+
+TEST_CASE(meshCacheRejectsStaleAndDamagedFiles) {
+	std::string text = generateGridObj(4, false);
+	std::uint64_t key = MeshCache::getKey(text.data(), text.size());
+	CachedMesh mesh = MeshCache::create(parseText(text));
+
+	std::string file = getTemporaryFileName("meshCacheRejects.p3dmesh");
+	ASSERT_TRUE(MeshCache::write(file, key, mesh));
+
+	std::string data;
+	{
+		std::ifstream input(file, std::ios::binary);
+		std::ostringstream contents;
+		contents << input.rdbuf();
+		data = contents.str();
+	}
+	std::remove(file.c_str());
+
+	CachedMesh loaded;
+	ASSERT_TRUE(MeshCache::read(data.data(), data.size(), key, loaded));
+	ASSERT_FALSE(MeshCache::read(data.data(), data.size(), key + 1, loaded));
+	ASSERT_FALSE(MeshCache::read(data.data(), data.size() - 1, key, loaded));
+	ASSERT_FALSE(MeshCache::read(data.data(), 10, key, loaded));
+	ASSERT_FALSE(MeshCache::read(file, key, loaded));
+
+	// a triangle pointing outside of the mesh, the triangles follow the 128 byte header and the 25 vertices, aligned to 64 bytes
+	std::string damaged = data;
+	int badIndex = 1000;
+	std::memcpy(&damaged[448], &badIndex, sizeof(int));
+	ASSERT_FALSE(MeshCache::read(damaged.data(), damaged.size(), key, loaded));
+}
+
+TEST_CASE(meshCacheMassPropertiesNeedAClosedMesh) {
+	// a 2x2x2 cube with a normal per face, so the importer splits every corner into three vertices
+	std::string cube =
+		"v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\nv -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\n"
+		"vn 0 0 -1\nvn 0 0 1\nvn 0 -1 0\nvn 0 1 0\nvn -1 0 0\nvn 1 0 0\n"
+		"f 1//1 4//1 3//1 2//1\nf 5//2 6//2 7//2 8//2\nf 1//3 2//3 6//3 5//3\n"
+		"f 4//4 8//4 7//4 3//4\nf 1//5 5//5 8//5 4//5\nf 2//6 3//6 7//6 6//6\n";
+	CachedMesh closed = MeshCache::create(parseText(cube));
+	ASSERT_TRUE(closed.shape.vertexCount == 24);
+	ASSERT_TOLERANT(closed.volume == 8.0, 0.00001);
+	ASSERT_TOLERANT(closed.centerOfMass == Vec3(0.0, 0.0, 0.0), 0.00001);
+
+	CachedMesh open = MeshCache::create(parseText(generateGridObj(4, true)));
+	ASSERT_TRUE(open.volume == 0.0);
+	ASSERT_TRUE(open.centerOfMass == Vec3(0.0, 0.0, 0.0));
+}
+
+TEST_CASE(meshCacheLoadAddsEntry) {
+	std::string objFile = getTemporaryFileName("meshCacheLoad.obj");
+	std::string cacheDirectory = getTemporaryFileName("meshCacheDirectory");
+	std::string text = generateGridObj(6, true);
+	{
+		std::ofstream output(objFile, std::ios::binary);
+		output << text;
+	}
+
+	std::string cacheFile = MeshCache::getFileName(cacheDirectory, MeshCache::getKey(text.data(), text.size()));
+	std::remove(cacheFile.c_str());
+
+	CachedMesh imported = MeshCache::load(objFile, cacheDirectory);
+	std::ifstream cacheStream(cacheFile, std::ios::binary);
+	bool cacheWritten = cacheStream.good();
+	cacheStream.close();
+	CachedMesh cached = MeshCache::load(objFile, cacheDirectory);
+
+	std::filesystem::remove_all(cacheDirectory);
+	std::remove(objFile.c_str());
+
+	ASSERT_TRUE(cacheWritten);
+	ASSERT_TRUE(imported.shape.triangleCount == 6 * 6 * 2);
+	ASSERT_TRUE(shapesEqual(imported.shape, cached.shape));
+
+	// the hull is built on import and read back from the cache with its mass properties
+	ASSERT_TRUE(imported.hasHull);
+	ASSERT_TRUE(cached.hasHull);
+	ASSERT_TRUE(cached.hull.vertexCount == imported.hull.vertexCount);
+	ASSERT_TOLERANT(imported.volume == imported.hull.getVolume(), 0.00001);
+	ASSERT_TRUE(cached.volume == imported.volume);
+	ASSERT_TRUE(cached.centerOfMass == imported.centerOfMass);
+}
+
+TEST_CASE(meshCacheLoadInParallelMatchesSerial) {
+	std::string objFile = getTemporaryFileName("meshCacheLoadParallel.obj");
+	std::string text = generateGridObj(150, true);
+	{
+		std::ofstream output(objFile, std::ios::binary);
+		output << text;
+	}
+	ThreadPool pool;
+	pool.setThreadCount(4);
+
+	Graphics::VisualShape serial = OBJImport::load(objFile);
+	Graphics::VisualShape parallel = OBJImport::load(objFile, pool);
+	CachedMesh parallelMesh = MeshCache::load(objFile, "", pool);
+	std::remove(objFile.c_str());
+
+	ASSERT_TRUE(serial.vertexCount == 151 * 151);
+	ASSERT_TRUE(shapesEqual(serial, parallel));
+	ASSERT_TRUE(shapesEqual(serial, parallelMesh.shape));
+}
+
+TEST_CASE(polyhedronShapeWithPrecomputedMassProperties) {
+	Polyhedron poly = Library::createPrism(7, 0.5f, 2.0f).translated(Vec3f(1.0f, 2.0f, -1.0f));
+	Shape computed = polyhedronShape(poly);
+	Shape precomputed = polyhedronShape(poly, poly.getVolume(), poly.getCenterOfMass(), poly.getScalableInertiaAroundCenterOfMass());
+
+	ASSERT_TOLERANT(precomputed.getVolume() == computed.getVolume(), 0.00001);
+	ASSERT_TOLERANT(precomputed.getCenterOfMass() == computed.getCenterOfMass(), 0.00001);
+	ASSERT_TOLERANT(precomputed.getInertia() == computed.getInertia(), 0.00001);
+}
+
+static Polyhedron createStep() {
+	// two boxes on top of each other, the upper one half as wide
+	Polyhedron lower = Library::createBox(2.0f, 1.0f, 1.0f);
+	Polyhedron upper = Library::createBox(1.0f, 1.0f, 1.0f).translated(Vec3f(-0.5f, 1.0f, 0.0f));
+
+	std::vector<Vec3f> vertices;
+	std::vector<Triangle> triangles;
+	for (const Polyhedron* part : {&lower, &upper}) {
+		int offset = static_cast<int>(vertices.size());
+		for (int i = 0; i < part->vertexCount; i++)
+			vertices.push_back(part->getVertex(i));
+		for (int i = 0; i < part->triangleCount; i++) {
+			Triangle t = part->getTriangle(i);
+			triangles.push_back(Triangle { t[0] + offset, t[1] + offset, t[2] + offset });
+		}
+	}
+
+	return Polyhedron(vertices.data(), triangles.data(), static_cast<int>(vertices.size()), static_cast<int>(triangles.size()));
+}
+
+TEST_CASE(decompositionCacheRoundTrip) {
+	Polyhedron step = createStep();
+	ConvexDecompositionSettings settings;
+	std::uint64_t key = DecompositionCache::getKey(step, settings);
+	std::vector<Polyhedron> hulls = decomposeConvex(step, settings);
+	ASSERT_TRUE(hulls.size() >= 2);
+
+	std::string file = getTemporaryFileName("decompositionCacheRoundTrip.p3dhulls");
+	ASSERT_TRUE(DecompositionCache::write(file, key, hulls));
+
+	std::vector<Polyhedron> loaded;
+	bool wasRead = DecompositionCache::read(file, key, loaded);
+	bool wrongKeyRead = DecompositionCache::read(file, key + 1, loaded);
+	std::remove(file.c_str());
+	ASSERT_TRUE(wasRead);
+	ASSERT_FALSE(wrongKeyRead);
+
+	ASSERT_TRUE(loaded.size() == hulls.size());
+	for (std::size_t i = 0; i < hulls.size(); i++) {
+		ASSERT_TRUE(loaded[i].vertexCount == hulls[i].vertexCount);
+		ASSERT_TRUE(loaded[i].triangleCount == hulls[i].triangleCount);
+		for (int j = 0; j < hulls[i].vertexCount; j++)
+			ASSERT_TRUE(loaded[i].getVertex(j) == hulls[i].getVertex(j));
+	}
+}
+
+TEST_CASE(decompositionCacheKeyDependsOnMeshAndSettings) {
+	Polyhedron step = createStep();
+	ConvexDecompositionSettings settings;
+	ConvexDecompositionSettings finerSettings;
+	finerSettings.resolution = 48;
+
+	std::uint64_t key = DecompositionCache::getKey(step, settings);
+	ASSERT_TRUE(key == DecompositionCache::getKey(createStep(), settings));
+	ASSERT_TRUE(key != DecompositionCache::getKey(step, finerSettings));
+	ASSERT_TRUE(key != DecompositionCache::getKey(step.translated(Vec3f(0.0f, 0.1f, 0.0f)), settings));
+}
+
+TEST_CASE(decompositionCacheLoadAddsEntry) {
+	std::string cacheDirectory = getTemporaryFileName("decompositionCacheDirectory");
+	Polyhedron step = createStep();
+	ThreadPool pool;
+
+	std::string cacheFile = DecompositionCache::getFileName(cacheDirectory, DecompositionCache::getKey(step, ConvexDecompositionSettings()));
+	std::remove(cacheFile.c_str());
+
+	std::vector<Polyhedron> decomposed = DecompositionCache::load(step, cacheDirectory, pool);
+	std::ifstream cacheStream(cacheFile, std::ios::binary);
+	bool cacheWritten = cacheStream.good();
+	cacheStream.close();
+	std::vector<Polyhedron> cached = DecompositionCache::load(step, cacheDirectory, pool);
+
+	std::filesystem::remove_all(cacheDirectory);
+
+	ASSERT_TRUE(cacheWritten);
+	ASSERT_TRUE(cached.size() == decomposed.size());
+	for (std::size_t i = 0; i < cached.size(); i++)
+		ASSERT_TOLERANT(cached[i].getVolume() == decomposed[i].getVolume(), 0.0);
+}
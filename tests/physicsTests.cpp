@@ -7,6 +7,7 @@
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <sstream>
 
 #include "../physics/world.h"
 #include "../physics/inertia.h"
@@ -15,10 +16,15 @@
 #include "../physics/math/linalg/eigen.h"
 #include "../physics/geometry/shape.h"
 #include "../physics/geometry/shapeCreation.h"
+#include "../physics/geometry/terrainMeshClass.h"
 #include "../physics/externalforces/gravityForce.h"
 #include "../physics/hardconstraints/motorConstraint.h"
 #include "../physics/hardconstraints/sinusoidalPistonConstraint.h"
 #include "../physics/hardconstraints/fixedConstraint.h"
+#include "../physics/misc/serialization.h"
+#include "../physics/misc/worldSnapshots.h"
+#include "../physics/threading/synchonizedWorld.h"
+#include "../util/blockCompression.h"
 #include "../util/log.h"
 
 
@@ -1039,3 +1045,392 @@ TEST_CASE(setVelocity) {
 		}
 	}
 }
+
+static void checkBlockCompressionRoundTrip(const std::vector<char>& data) {
+	std::vector<char> compressed = Util::compressBlock(data.data(), data.size());
+	std::vector<char> decompressed(data.size());
+	Util::decompressBlock(compressed.data(), compressed.size(), decompressed.data(), decompressed.size());
+	ASSERT_TRUE(decompressed == data);
+}
+
+TEST_CASE(blockCompressionRoundTrip) {
+	checkBlockCompressionRoundTrip(std::vector<char>());
+	checkBlockCompressionRoundTrip(std::vector<char>{1, 2, 3, 4, 5});
+
+	std::vector<char> repeating(100000);
+	for(size_t i = 0; i < repeating.size(); i++) repeating[i] = static_cast<char>(i % 37);
+	checkBlockCompressionRoundTrip(repeating);
+	ASSERT_TRUE(Util::compressBlock(repeating.data(), repeating.size()).size() < repeating.size() / 10);
+
+	std::vector<char> noise(10000);
+	for(char& c : noise) c = static_cast<char>(generateInt(256));
+	checkBlockCompressionRoundTrip(noise);
+
+	// a truncated block must be rejected, not read out of bounds
+	std::vector<char> compressed = Util::compressBlock(repeating.data(), repeating.size());
+	std::vector<char> output(repeating.size());
+	bool rejected = false;
+	try {
+		Util::decompressBlock(compressed.data(), compressed.size() / 2, output.data(), output.size());
+	} catch(SerializationException&) {
+		rejected = true;
+	}
+	ASSERT_TRUE(rejected);
+}
+
+static void checkWorldSerializationRoundTrip(const WorldPrototype& world, int farLayer, bool compress) {
+	std::stringstream file;
+	SerializationSessionPrototype serializer;
+	serializer.setWorldFileCompression(compress);
+	serializer.serializeWorld(world, file);
+
+	WorldPrototype loadedWorld(DELTA_T);
+	DeSerializationSessionPrototype deserializer;
+	deserializer.deserializeWorld(loadedWorld, file);
+
+	ASSERT_TRUE(loadedWorld.isValid());
+	ASSERT_STRICT(loadedWorld.age == world.age);
+	ASSERT_STRICT(loadedWorld.getPartCount() == world.getPartCount());
+	ASSERT_STRICT(loadedWorld.physicals.size() == world.physicals.size());
+	ASSERT_STRICT(loadedWorld.getLayerCount() == world.getLayerCount());
+	ASSERT_STRICT(loadedWorld.externalForces.size() == world.externalForces.size());
+	ASSERT_TRUE(loadedWorld.layers[farLayer].getOrigin() == world.layers[farLayer].getOrigin());
+	ASSERT_TRUE(loadedWorld.layers[farLayer].broadphase == BroadphaseType::SPATIAL_HASH);
+	ASSERT_FALSE(loadedWorld.doLayersCollide(0, farLayer));
+
+	// parts are written in a fixed order, so both worlds list their parts in the same order
+	std::vector<const Part*> originalParts;
+	for(const Part& p : world.iterParts()) originalParts.push_back(&p);
+	std::vector<const Part*> loadedParts;
+	for(const Part& p : loadedWorld.iterParts()) loadedParts.push_back(&p);
+	ASSERT_STRICT(loadedParts.size() == originalParts.size());
+	for(size_t i = 0; i < loadedParts.size(); i++) {
+		ASSERT(loadedParts[i]->getCFrame() == originalParts[i]->getCFrame());
+		ASSERT(loadedParts[i]->hitbox.scale == originalParts[i]->hitbox.scale);
+		ASSERT(loadedParts[i]->hitbox.getVolume() == originalParts[i]->hitbox.getVolume());
+		ASSERT_STRICT(loadedParts[i]->getLayerID() == originalParts[i]->getLayerID());
+		ASSERT_STRICT((loadedParts[i]->parent == nullptr) == (originalParts[i]->parent == nullptr));
+	}
+}
+
+TEST_CASE(worldSerializationRoundTrip) {
+	WorldPrototype world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -1, 0)));
+	int farLayer = world.createLayer(true, false, Position(1000.0, 0.0, -1000.0), BroadphaseType::SPATIAL_HASH);
+
+	Part* flooring = new Part(boxShape(200.0, 0.3, 200.0), GlobalCFrame(), {1.0, 1.0, 0.7});
+	Part* housePart = new Part(polyhedronShape(Library::house), GlobalCFrame(0.3, 2.0, 0.5, Rotation::fromEulerAngles(0.3, 0.7, 0.9)), {1.0, 1.0, 0.7});
+	Part* attachedPart = new Part(sphereShape(0.5), GlobalCFrame(), {2.0, 0.5, 0.5});
+	Part* farPart = new Part(cylinderShape(0.5, 2.0), GlobalCFrame(1001.0, 3.0, -999.0), {1.0, 0.5, 0.5});
+	world.addTerrainPart(flooring);
+	housePart->attach(attachedPart, CFrame(1.0, 0.0, 0.0));
+	world.addPart(housePart);
+	world.addPart(farPart, farLayer);
+	for(int i = 0; i < 10; i++) {
+		world.tick();
+	}
+
+	checkWorldSerializationRoundTrip(world, farLayer, false);
+	checkWorldSerializationRoundTrip(world, farLayer, true);
+}
+
+TEST_CASE(worldSnapshotRollback) {
+	WorldPrototype world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -1, 0)));
+
+	Part* flooring = new Part(boxShape(200.0, 0.3, 200.0), GlobalCFrame(), {1.0, 1.0, 0.7});
+	Part* fallingPart = new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 2.0, 0.0, Rotation::fromEulerAngles(0.3, 0.7, 0.9)), {1.0, 1.0, 0.7});
+	Part* attachedPart = new Part(sphereShape(0.5), GlobalCFrame(), {2.0, 0.5, 0.5});
+	Part* restingPart = new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(5.0, 0.65, 0.0), {1.0, 1.0, 0.7});
+	world.addTerrainPart(flooring);
+	fallingPart->attach(attachedPart, CFrame(1.0, 0.0, 0.0));
+	world.addPart(fallingPart);
+	world.addPart(restingPart);
+	fallingPart->parent->mainPhysical->motionOfCenterOfMass = Motion(Vec3(0.5, 0.0, 0.0), Vec3(1.0, 0.0, 0.3));
+
+	WorldSnapshotBuffer snapshots(8, 3);
+	std::vector<GlobalCFrame> fallingCFrames;
+	std::vector<GlobalCFrame> attachedCFrames;
+	std::vector<Motion> fallingMotions;
+	for(int i = 0; i < 20; i++) {
+		snapshots.record(world);
+		fallingCFrames.push_back(fallingPart->getCFrame());
+		attachedCFrames.push_back(attachedPart->getCFrame());
+		fallingMotions.push_back(fallingPart->parent->mainPhysical->motionOfCenterOfMass);
+		world.tick();
+	}
+	ASSERT_STRICT(snapshots.getSnapshotCount() == 8);
+	ASSERT_STRICT(snapshots.getOldestAge() == 12);
+	ASSERT_STRICT(snapshots.getNewestAge() == 19);
+	ASSERT_FALSE(snapshots.canRestore(world, 11));
+	ASSERT_FALSE(snapshots.restore(world, 20));
+
+	// every recorded tick restores exactly, keyframes and deltas alike
+	for(size_t age : {19, 13, 17, 15, 18}) {
+		ASSERT_TRUE(snapshots.restore(world, age));
+		ASSERT_STRICT(world.age == age);
+		ASSERT(fallingPart->getCFrame() == fallingCFrames[age]);
+		ASSERT(attachedPart->getCFrame() == attachedCFrames[age]);
+		ASSERT(fallingPart->parent->mainPhysical->motionOfCenterOfMass.getVelocity() == fallingMotions[age].getVelocity());
+		ASSERT(fallingPart->parent->mainPhysical->motionOfCenterOfMass.getAngularVelocity() == fallingMotions[age].getAngularVelocity());
+	}
+
+	// replaying from a restored tick gives the same simulation
+	ASSERT_TRUE(snapshots.restore(world, 14));
+	for(int i = 14; i < 19; i++) {
+		world.tick();
+	}
+	ASSERT_STRICT(world.age == 19);
+	ASSERT(fallingPart->getCFrame() == fallingCFrames[19]);
+
+	// snapshots of a rolled back world continue from the restored tick
+	ASSERT_TRUE(snapshots.restore(world, 16));
+	snapshots.record(world);
+	ASSERT_STRICT(snapshots.getNewestAge() == 16);
+	ASSERT_FALSE(snapshots.canRestore(world, 17));
+
+	// snapshots don't describe newly added physicals
+	world.addPart(new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(-5.0, 3.0, 0.0), {1.0, 1.0, 0.7}));
+	ASSERT_FALSE(snapshots.restore(world, 15));
+	world.tick();
+	snapshots.record(world);
+	ASSERT_TRUE(snapshots.canRestore(world, world.age));
+}
+
+TEST_CASE(worldSnapshotRestoresConnections) {
+	WorldPrototype world(DELTA_T);
+	Part* base = new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 5.0, 0.0), basicProperties);
+	SinusoidalPistonConstraint* piston = new SinusoidalPistonConstraint(0.0, 2.0, 1.3);
+	ConstantSpeedMotorConstraint* motor = new ConstantSpeedMotorConstraint(0.7);
+	Part* pistonPart = new Part(boxShape(0.5, 0.5, 0.5), *base, piston, CFrame(0.0, 0.0, 0.5), CFrame(0.0, 0.0, -0.25), basicProperties);
+	Part* motorPart = new Part(boxShape(0.5, 0.5, 0.5), *pistonPart, motor, CFrame(0.5, 0.0, 0.0), CFrame(), basicProperties);
+	world.addPart(base);
+	base->parent->mainPhysical->motionOfCenterOfMass = Motion(Vec3(0.5, 0.0, 0.0), Vec3(0.2, 0.0, 0.3));
+	HardPhysicalConnection& pistonConnection = static_cast<ConnectedPhysical*>(pistonPart->parent)->connectionToParent;
+
+	WorldSnapshotBuffer snapshots(8, 3);
+	std::vector<double> pistonSteps;
+	std::vector<double> motorAngles;
+	std::vector<GlobalCFrame> motorPartCFrames;
+	std::vector<Vec3> centersOfMass;
+	for(int i = 0; i < 10; i++) {
+		snapshots.record(world);
+		pistonSteps.push_back(piston->currentStepInPeriod);
+		motorAngles.push_back(motor->currentAngle);
+		motorPartCFrames.push_back(motorPart->getCFrame());
+		centersOfMass.push_back(base->parent->mainPhysical->totalCenterOfMass);
+		world.tick();
+	}
+
+	for(size_t age : {9, 4, 7, 5, 8}) {
+		ASSERT_TRUE(snapshots.restore(world, age));
+		ASSERT_STRICT(piston->currentStepInPeriod == pistonSteps[age]);
+		ASSERT_STRICT(motor->currentAngle == motorAngles[age]);
+		ASSERT(motorPart->getCFrame() == motorPartCFrames[age]);
+		ASSERT(base->parent->mainPhysical->totalCenterOfMass == centersOfMass[age]);
+	}
+
+	// moved attachments are recorded in deltas
+	ASSERT_TRUE(snapshots.restore(world, 9));
+	CFrame originalAttachment = pistonConnection.attachOnParent;
+	pistonConnection.attachOnParent = CFrame(0.0, 1.0, 0.5);
+	snapshots.record(world);
+	ASSERT_TRUE(snapshots.restore(world, 8));
+	ASSERT(pistonConnection.attachOnParent == originalAttachment);
+	ASSERT_TRUE(snapshots.restore(world, 9));
+	ASSERT(pistonConnection.attachOnParent == CFrame(0.0, 1.0, 0.5));
+
+	// any structural change makes older snapshots unusable, even if the list of physicals looks the same afterwards
+	size_t structureVersion = world.structureVersion;
+	base->attach(new Part(sphereShape(0.3), GlobalCFrame(), basicProperties), CFrame(-1.0, 0.0, 0.0));
+	ASSERT_TRUE(world.structureVersion != structureVersion);
+	ASSERT_STRICT(world.physicals.size() == 1);
+	ASSERT_FALSE(snapshots.canRestore(world, 9));
+	ASSERT_FALSE(snapshots.restore(world, 8));
+}
+
+// FNV-1a over the exact bits of the state of every physical, any difference in the simulation changes the hash
+static uint64_t hashWorldState(const WorldPrototype& world) {
+	uint64_t hash = 14695981039346656037ULL;
+	auto hashBytes = [&hash](const void* data, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for(size_t i = 0; i < size; i++) {
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+	};
+	for(const MotorizedPhysical* phys : world.iterPhysicals()) {
+		GlobalCFrame cframe = phys->getCFrame();
+		hashBytes(&cframe, sizeof(cframe));
+		hashBytes(&phys->motionOfCenterOfMass, sizeof(phys->motionOfCenterOfMass));
+	}
+	return hash;
+}
+
+static uint64_t simulatePileOfBoxes(size_t threadCount) {
+	WorldPrototype world(DELTA_T);
+	world.pool.setThreadCount(threadCount);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+	int hashLayer = world.createLayer(true, true, BroadphaseType::SPATIAL_HASH);
+
+	world.addTerrainPart(new Part(boxShape(40.0, 1.0, 40.0), GlobalCFrame(), {1.0, 0.7, 0.5}));
+	for(int x = 0; x < 4; x++) {
+		for(int y = 0; y < 4; y++) {
+			for(int z = 0; z < 4; z++) {
+				GlobalCFrame cframe(x * 0.9, 1.0 + y * 1.1, z * 0.9, Rotation::fromEulerAngles(0.1 * x, 0.2 * y, 0.3 * z));
+				Part* box = new Part(boxShape(1.0, 1.0, 1.0), cframe, {1.0, 0.7, 0.5});
+				world.addPart(box, (x + y + z) % 2 == 0 ? 0 : hashLayer);
+			}
+		}
+	}
+	for(int i = 0; i < 100; i++) {
+		world.tick();
+	}
+	return hashWorldState(world);
+}
+
+TEST_CASE(simulationIndependentOfThreadCount) {
+	uint64_t singleThreaded = simulatePileOfBoxes(1);
+	ASSERT_STRICT(simulatePileOfBoxes(1) == singleThreaded);
+	ASSERT_STRICT(simulatePileOfBoxes(2) == singleThreaded);
+	ASSERT_STRICT(simulatePileOfBoxes(4) == singleThreaded);
+	ASSERT_STRICT(simulatePileOfBoxes(7) == singleThreaded);
+}
+
+// World<T> needs a type derived from Part
+struct RenderedPart : public Part {
+	using Part::Part;
+};
+
+TEST_CASE(renderSnapshotFollowsTicksAndModifications) {
+	SynchronizedWorld<RenderedPart> world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -1, 0)));
+	RenderedPart* fallingPart = new RenderedPart(boxShape(1.0, 2.0, 3.0), GlobalCFrame(0.0, 5.0, 0.0), {1.0, 1.0, 0.7});
+	world.syncModification([&]() {
+		world.addPart(fallingPart);
+	});
+
+	const RenderSnapshot<RenderedPart>& added = world.getRenderSnapshot();
+	ASSERT_STRICT(added.parts.size() == 1);
+	ASSERT_STRICT(added.parts[0].id == fallingPart);
+	size_t addedVersion = added.version;
+
+	// modifications made since the last snapshot are published together when it is read
+	world.syncModification([&]() {
+		fallingPart->setCFrame(GlobalCFrame(0.0, 6.0, 0.0));
+	});
+	world.syncModification([&]() {
+		fallingPart->setCFrame(GlobalCFrame(0.0, 5.0, 0.0));
+	});
+	const RenderSnapshot<RenderedPart>& moved = world.getRenderSnapshot();
+	ASSERT_STRICT(moved.version == addedVersion + 1);
+	ASSERT(moved.parts[0].cframe == fallingPart->getCFrame());
+	size_t movedVersion = moved.version;
+
+	for(int i = 0; i < 5; i++) {
+		world.tick();
+	}
+	const RenderSnapshot<RenderedPart>& ticked = world.getRenderSnapshot();
+	ASSERT_STRICT(ticked.version == movedVersion + 5);
+	ASSERT_STRICT(ticked.age == world.age);
+	ASSERT_STRICT(ticked.parts.size() == 1);
+	ASSERT(ticked.parts[0].cframe == fallingPart->getCFrame());
+	ASSERT(ticked.parts[0].scale == fallingPart->hitbox.scale);
+	ASSERT_TRUE(ticked.parts[0].cframe.getPosition().y < 5.0);
+}
+
+TEST_CASE(boxRestsOnTerrainMesh) {
+	WorldPrototype world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -1, 0)));
+
+	std::vector<float> heights(21 * 21, 0.0f);
+	Part* terrain = new Part(heightfieldShape(heights.data(), 21, 21, 1.0), GlobalCFrame(), basicProperties);
+	Part* box = new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.3, 1.5, -0.2), basicProperties);
+	world.addTerrainPart(terrain);
+	world.addPart(box);
+
+	for(int i = 0; i < 500; i++) {
+		world.tick();
+	}
+
+	// a single contact point per tick lets the box shuffle a little while it settles
+	Position restingPosition = box->getCFrame().getPosition();
+	ASSERT_TOLERANT(double(restingPosition.y) == 0.5, 0.01);
+	ASSERT_TOLERANT(restingPosition == Position(0.3, 0.5, -0.2), 0.05);
+
+	std::stringstream file;
+	SerializationSessionPrototype serializer;
+	serializer.serializeWorld(world, file);
+
+	WorldPrototype loadedWorld(DELTA_T);
+	DeSerializationSessionPrototype deserializer;
+	deserializer.deserializeWorld(loadedWorld, file);
+
+	ASSERT_STRICT(loadedWorld.getPartCount() == 2);
+	for(const Part& p : loadedWorld.iterParts()) {
+		if(p.hitbox.baseShape->intersectionClassID != TERRAIN_MESH_CLASS_ID) continue;
+		const TerrainMeshClass& loadedMesh = static_cast<const TerrainMeshClass&>(*p.hitbox.baseShape);
+		const TerrainMeshClass& originalMesh = static_cast<const TerrainMeshClass&>(*terrain->hitbox.baseShape);
+		ASSERT_STRICT(loadedMesh.getTriangleCount() == originalMesh.getTriangleCount());
+		ASSERT_STRICT(loadedMesh.getNodeCount() == originalMesh.getNodeCount());
+		ASSERT(p.hitbox.scale == terrain->hitbox.scale);
+	}
+}
+
+static double getDiscRestingHeight(const ColissionDetailSettings& colissionDetail) {
+	WorldPrototype world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -1, 0)));
+	world.colissionDetail = colissionDetail;
+
+	const int detailVertexCounts[]{12};
+	Part* floor = new Part(boxShape(20.0, 1.0, 20.0), GlobalCFrame(0.0, -0.5, 0.0), basicProperties);
+	Part* disc = new Part(polyhedronShape(Library::createPrism(64, 1.0, 0.5), detailVertexCounts, 1), GlobalCFrame(0.0, 0.5, 0.0, Rotation::Predefined::X_90), basicProperties);
+	world.addTerrainPart(floor);
+	world.addPart(disc);
+
+	for(int i = 0; i < 300; i++) {
+		world.tick();
+	}
+	return double(disc->getCFrame().getPosition().y);
+}
+
+TEST_CASE(coarseColissionsRestOnHulls) {
+	ColissionDetailSettings fullDetail;
+	ColissionDetailSettings coarse;
+	coarse.detailDistance = 0.001;
+	ColissionDetailSettings refined = coarse;
+	refined.refineShallowContacts = true;
+	ColissionDetailSettings overBudget;
+	overBudget.fullDetailBudget = 0;
+	overBudget.refineShallowContacts = true;
+
+	double fullHeight = getDiscRestingHeight(fullDetail);
+	ASSERT_TOLERANT(fullHeight == 0.25, 0.01);
+	// the hull of the disc sticks out of it, so the disc rests a little higher on its hull
+	ASSERT_TRUE(getDiscRestingHeight(coarse) > fullHeight + 0.001);
+	ASSERT_TOLERANT(getDiscRestingHeight(refined) == fullHeight, 0.01);
+	// colissions over the budget use the hulls, even when refining
+	ASSERT_TRUE(getDiscRestingHeight(overBudget) > fullHeight + 0.001);
+}
+
+TEST_CASE(loadedPolyhedraShareShapeClasses) {
+	WorldPrototype world(DELTA_T);
+	Part* crate = new Part(polyhedronShape(Library::createBox(1.0f, 1.0f, 1.0f)), GlobalCFrame(0.0, 1.0, 0.0), basicProperties);
+	Part* longCrate = new Part(polyhedronShape(Library::createBox(3.0f, 1.0f, 1.0f)), GlobalCFrame(0.0, 3.0, 0.0), basicProperties);
+	world.addPart(crate);
+	world.addPart(longCrate);
+	ASSERT_TRUE(crate->hitbox.baseShape == longCrate->hitbox.baseShape);
+
+	std::stringstream file;
+	SerializationSessionPrototype serializer;
+	serializer.serializeWorld(world, file);
+
+	WorldPrototype loadedWorld(DELTA_T);
+	DeSerializationSessionPrototype deserializer;
+	deserializer.deserializeWorld(loadedWorld, file);
+
+	// loaded polyhedra are interned as well, so they share the shape class of the parts they were saved from
+	ASSERT_STRICT(loadedWorld.getPartCount() == 2);
+	for(const Part& p : loadedWorld.iterParts()) {
+		ASSERT_TRUE(p.hitbox.baseShape == crate->hitbox.baseShape);
+	}
+}
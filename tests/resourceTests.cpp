@@ -0,0 +1,190 @@
+#include "testsMain.h"
+
+#include "../util/resource/resource.h"
+#include "../util/resource/resourceManager.h"
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+class TestResource;
+
+std::thread::id mainThread;
+std::atomic<int> decodeCount(0);
+std::atomic<bool> decodedOffMainThread(false);
+std::atomic<bool> finishedOffMainThread(false);
+
+struct TestData : public ResourceData {
+	std::string contents;
+};
+
+class TestAllocator : public ResourceAllocator<TestResource> {
+public:
+	virtual TestResource* load(const std::string& name, const std::string& path) override;
+	virtual std::unique_ptr<ResourceData> decode(const std::string& path) override;
+	virtual TestResource* finish(const std::string& name, const std::string& path, std::unique_ptr<ResourceData> data) override;
+};
+
+class TestResource : public Resource {
+public:
+	DEFINE_RESOURCE(OBJ, "default");
+
+	std::string contents;
+
+	TestResource(const std::string& name, const std::string& path, const std::string& contents) : Resource(name, path), contents(contents) {}
+
+	virtual void close() override {}
+
+	static TestAllocator getAllocator() {
+		return TestAllocator();
+	}
+};
+
+// paths starting with "missing" can't be loaded
+TestResource* TestAllocator::load(const std::string& name, const std::string& path) {
+	if (path.rfind("missing", 0) == 0)
+		return nullptr;
+
+	return new TestResource(name, path, "contents of " + path);
+}
+
+std::unique_ptr<ResourceData> TestAllocator::decode(const std::string& path) {
+	decodeCount++;
+	if (std::this_thread::get_id() != mainThread)
+		decodedOffMainThread = true;
+
+	std::unique_ptr<TestData> data = std::make_unique<TestData>();
+	if (path.rfind("missing", 0) != 0)
+		data->contents = "contents of " + path;
+
+	return data;
+}
+
+TestResource* TestAllocator::finish(const std::string& name, const std::string& path, std::unique_ptr<ResourceData> data) {
+	if (std::this_thread::get_id() != mainThread)
+		finishedOffMainThread = true;
+
+	TestData* testData = static_cast<TestData*>(data.get());
+	if (testData->contents.empty())
+		return nullptr;
+
+	return new TestResource(name, path, testData->contents);
+}
+
+void resetCounters() {
+	mainThread = std::this_thread::get_id();
+	decodeCount = 0;
+	decodedOffMainThread = false;
+	finishedOffMainThread = false;
+}
+
+};
+
+TEST_CASE(asyncResourceLoad) {
+	resetCounters();
+	ResourceManager::setLoaderThreadCount(2);
+
+	ResourceHandle<TestResource> handle = ResourceManager::addAsync<TestResource>("a", "a.txt");
+
+	// waiting decodes queued resources on the waiting thread, polling leaves them to the loading threads
+	for (int i = 0; i < 5000 && !handle.isReady() && !handle.hasFailed(); i++) {
+		ResourceManager::update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	ASSERT_TRUE(handle.isReady());
+	ASSERT_TRUE(handle.get()->contents == "contents of a.txt");
+	ASSERT_TRUE(ResourceManager::get<TestResource>("a") == handle.get());
+	ASSERT_TRUE(ResourceManager::getPendingCount() == 0);
+	ASSERT_TRUE(decodedOffMainThread.load());
+	ASSERT_FALSE(finishedOffMainThread.load());
+
+	ResourceManager::close();
+}
+
+TEST_CASE(waitForAllResources) {
+	resetCounters();
+	ResourceManager::setLoaderThreadCount(2);
+
+	ResourceHandle<TestResource> first = ResourceManager::addAsync<TestResource>("d", "d.txt");
+	ResourceHandle<TestResource> second = ResourceManager::addAsync<TestResource>("e", "e.txt");
+	ResourceManager::waitForAll();
+
+	ASSERT_TRUE(first.isReady());
+	ASSERT_TRUE(second.isReady());
+	ASSERT_TRUE(ResourceManager::getPendingCount() == 0);
+	ASSERT_FALSE(finishedOffMainThread.load());
+
+	ResourceManager::close();
+}
+
+TEST_CASE(asyncResourceLoadSharesPendingLoads) {
+	resetCounters();
+	ResourceManager::setLoaderThreadCount(2);
+
+	ResourceHandle<TestResource> first = ResourceManager::addAsync<TestResource>("shared", "shared.txt");
+	ResourceHandle<TestResource> second = ResourceManager::addAsync<TestResource>("shared", "shared.txt");
+	TestResource* resource = first.wait();
+
+	ASSERT_TRUE(resource != nullptr);
+	ASSERT_TRUE(second.isReady());
+	ASSERT_TRUE(second.get() == resource);
+
+	ResourceHandle<TestResource> third = ResourceManager::addAsync<TestResource>("shared", "shared.txt");
+	ASSERT_TRUE(third.isReady());
+	ASSERT_TRUE(third.get() == resource);
+	ASSERT_TRUE(decodeCount.load() == 1);
+
+	ResourceManager::close();
+}
+
+TEST_CASE(asyncResourceLoadFailure) {
+	resetCounters();
+	ResourceManager::setLoaderThreadCount(2);
+
+	ResourceHandle<TestResource> handle = ResourceManager::addAsync<TestResource>("broken", "missing.txt");
+	ASSERT_TRUE(handle.wait() == nullptr);
+	ASSERT_TRUE(handle.hasFailed());
+	ASSERT_FALSE(ResourceManager::exists("broken"));
+
+	// failed resources fall back to the default resource
+	ASSERT_TRUE(handle.get() != nullptr);
+	ASSERT_TRUE(handle.get()->getPath() == "default");
+
+	ResourceManager::close();
+}
+
+TEST_CASE(syncAddWaitsForPendingLoad) {
+	resetCounters();
+	ResourceManager::setLoaderThreadCount(2);
+
+	ResourceHandle<TestResource> handle = ResourceManager::addAsync<TestResource>("b", "b.txt");
+	TestResource* resource = ResourceManager::add<TestResource>("b", "b.txt");
+
+	ASSERT_TRUE(handle.isReady());
+	ASSERT_TRUE(handle.get() == resource);
+	ASSERT_TRUE(decodeCount.load() == 1);
+
+	ResourceManager::close();
+}
+
+TEST_CASE(asyncResourceLoadWithoutLoaderThreads) {
+	resetCounters();
+	ResourceManager::setLoaderThreadCount(0);
+
+	ResourceHandle<TestResource> handle = ResourceManager::addAsync<TestResource>("c", "c.txt");
+	ASSERT_FALSE(handle.isReady());
+	ASSERT_TRUE(ResourceManager::getPendingCount() == 1);
+
+	ResourceManager::update();
+
+	ASSERT_TRUE(handle.isReady());
+	ASSERT_FALSE(decodedOffMainThread.load());
+	ASSERT_TRUE(ResourceManager::getPendingCount() == 0);
+
+	ResourceManager::close();
+	ResourceManager::setLoaderThreadCount(2);
+}
@@ -0,0 +1,129 @@
+#include "blockCompression.h"
+
+#include "serializeBasicTypes.h"
+
+#include <cstring>
+#include <cstdint>
+
+namespace Util {
+
+// the constants of the LZ4 block format
+static constexpr std::size_t MIN_MATCH = 4;
+static constexpr std::size_t LAST_LITERALS = 5;
+static constexpr std::size_t MATCH_FIND_LIMIT = 12;
+static constexpr std::size_t MAX_OFFSET = 65535;
+static constexpr int HASH_BITS = 14;
+
+static std::uint32_t read32(const char* ptr) {
+	std::uint32_t result;
+	std::memcpy(&result, ptr, sizeof(result));
+	return result;
+}
+
+static std::uint32_t hashSequence(std::uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void writeLength(std::vector<char>& output, std::size_t length) {
+	while(length >= 255) {
+		output.push_back(static_cast<char>(255));
+		length -= 255;
+	}
+	output.push_back(static_cast<char>(length));
+}
+
+static void writeSequence(std::vector<char>& output, const char* literals, std::size_t literalLength, std::size_t offset, std::size_t matchLength) {
+	std::size_t tokenLiteral = literalLength < 15 ? literalLength : 15;
+	std::size_t tokenMatch = 0;
+	if(matchLength != 0) {
+		tokenMatch = matchLength - MIN_MATCH < 15 ? matchLength - MIN_MATCH : 15;
+	}
+	output.push_back(static_cast<char>((tokenLiteral << 4) | tokenMatch));
+	if(literalLength >= 15) writeLength(output, literalLength - 15);
+	output.insert(output.end(), literals, literals + literalLength);
+	if(matchLength != 0) {
+		output.push_back(static_cast<char>(offset & 0xFF));
+		output.push_back(static_cast<char>(offset >> 8));
+		if(matchLength - MIN_MATCH >= 15) writeLength(output, matchLength - MIN_MATCH - 15);
+	}
+}
+
+std::vector<char> compressBlock(const char* data, std::size_t size) {
+	std::vector<char> output;
+	output.reserve(size / 2 + 16);
+
+	std::size_t anchor = 0;
+	if(size > MATCH_FIND_LIMIT) {
+		// positions of the last occurrence of each hashed 4 byte sequence
+		std::vector<std::uint32_t> hashTable(std::size_t(1) << HASH_BITS, 0);
+		std::size_t matchLimit = size - LAST_LITERALS;
+		std::size_t searchLimit = size - MATCH_FIND_LIMIT;
+		std::size_t cur = 0;
+		while(cur < searchLimit) {
+			std::uint32_t sequence = read32(data + cur);
+			std::uint32_t hash = hashSequence(sequence);
+			std::size_t candidate = hashTable[hash];
+			hashTable[hash] = static_cast<std::uint32_t>(cur);
+			if(candidate < cur && cur - candidate <= MAX_OFFSET && read32(data + candidate) == sequence) {
+				std::size_t matchLength = MIN_MATCH;
+				while(cur + matchLength < matchLimit && data[candidate + matchLength] == data[cur + matchLength]) {
+					matchLength++;
+				}
+				writeSequence(output, data + anchor, cur - anchor, cur - candidate, matchLength);
+				cur += matchLength;
+				anchor = cur;
+			} else {
+				cur++;
+			}
+		}
+	}
+	// the block always ends in a sequence of only literals
+	writeSequence(output, data + anchor, size - anchor, 0, 0);
+	return output;
+}
+
+static std::size_t readLength(const char*& cur, const char* end) {
+	std::size_t length = 0;
+	unsigned char byte;
+	do {
+		if(cur >= end) throw SerializationException("Compressed block is truncated");
+		byte = static_cast<unsigned char>(*cur++);
+		length += byte;
+	} while(byte == 255);
+	return length;
+}
+
+void decompressBlock(const char* compressedData, std::size_t compressedSize, char* outputBuf, std::size_t uncompressedSize) {
+	const char* cur = compressedData;
+	const char* end = compressedData + compressedSize;
+	std::size_t written = 0;
+	while(true) {
+		if(cur >= end) throw SerializationException("Compressed block is truncated");
+		unsigned char token = static_cast<unsigned char>(*cur++);
+
+		std::size_t literalLength = token >> 4;
+		if(literalLength == 15) literalLength += readLength(cur, end);
+		if(literalLength > static_cast<std::size_t>(end - cur) || literalLength > uncompressedSize - written) throw SerializationException("Compressed block literals are out of range");
+		std::memcpy(outputBuf + written, cur, literalLength);
+		cur += literalLength;
+		written += literalLength;
+
+		if(cur == end) break;
+
+		if(end - cur < 2) throw SerializationException("Compressed block is truncated");
+		std::size_t offset = static_cast<unsigned char>(cur[0]) | (static_cast<std::size_t>(static_cast<unsigned char>(cur[1])) << 8);
+		cur += 2;
+		std::size_t matchLength = (token & 0xF) + MIN_MATCH;
+		if((token & 0xF) == 15) matchLength += readLength(cur, end);
+		if(offset == 0 || offset > written || matchLength > uncompressedSize - written) throw SerializationException("Compressed block match is out of range");
+		// matches may overlap the data they produce, so they are copied forward byte by byte
+		const char* matchSource = outputBuf + written - offset;
+		for(std::size_t i = 0; i < matchLength; i++) {
+			outputBuf[written + i] = matchSource[i];
+		}
+		written += matchLength;
+	}
+	if(written != uncompressedSize) throw SerializationException("Compressed block has the wrong size");
+}
+
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace Util {
+
+/*
+	Fast LZ77 compression of a single block of memory, using the LZ4 block format
+	Meant for data that is written once and read back quickly, such as world files, not for the best compression ratio
+
+	The size of the uncompressed data is not stored in the block, it must be stored alongside it
+*/
+std::vector<char> compressBlock(const char* data, std::size_t size);
+
+// decompresses a block made by compressBlock into exactly uncompressedSize bytes, throws a SerializationException if the block is malformed
+void decompressBlock(const char* compressedData, std::size_t compressedSize, char* outputBuf, std::size_t uncompressedSize);
+
+};
@@ -0,0 +1,44 @@
+#include "contentHash.h"
+
+#include <cstring>
+
+namespace Util {
+
+// MurmurHash64A, which hashes 8 bytes per step
+std::uint64_t contentHash(const void* data, std::size_t size, std::uint64_t seed) {
+	const std::uint64_t multiplier = 0xc6a4a7935bd1e995ULL;
+	const int shift = 47;
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	std::uint64_t hash = seed ^ (static_cast<std::uint64_t>(size) * multiplier);
+
+	std::size_t wordCount = size / sizeof(std::uint64_t);
+	for(std::size_t i = 0; i < wordCount; i++) {
+		std::uint64_t word;
+		std::memcpy(&word, bytes + i * sizeof(std::uint64_t), sizeof(std::uint64_t));
+
+		word *= multiplier;
+		word ^= word >> shift;
+		word *= multiplier;
+
+		hash ^= word;
+		hash *= multiplier;
+	}
+
+	const unsigned char* tail = bytes + wordCount * sizeof(std::uint64_t);
+	std::size_t tailSize = size % sizeof(std::uint64_t);
+	if(tailSize != 0) {
+		for(std::size_t i = 0; i < tailSize; i++) {
+			hash ^= static_cast<std::uint64_t>(tail[i]) << (8 * i);
+		}
+		hash *= multiplier;
+	}
+
+	hash ^= hash >> shift;
+	hash *= multiplier;
+	hash ^= hash >> shift;
+
+	return hash;
+}
+
+};
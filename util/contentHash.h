@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Util {
+
+/*
+	Fast 64 bit hash of a block of memory, for recognizing files whose contents were seen before, such as the sources of cached meshes
+	Not a cryptographic hash, and it reads the data as little endian words, so hashes are only comparable between machines of the same endianness
+
+	Different seeds give unrelated hashes, so data processed in different ways can be told apart by hashing it with a different seed
+*/
+std::uint64_t contentHash(const void* data, std::size_t size, std::uint64_t seed = 0);
+
+};
@@ -42,7 +42,9 @@ public:
 		for(const std::pair<std::type_index, const DynamicSerializer*>& item : initList) {
 			const DynamicSerializer* ds = item.second;
 			serializeRegistry.emplace(item.first, ds);
-			if(deserializeRegistry.find(ds->serializerID) != deserializeRegistry.end()) throw std::logic_error("Duplicate serializerID?");
+			// several types may share a serializer, such as subclasses that only differ in implementation
+			auto existing = deserializeRegistry.find(ds->serializerID);
+			if(existing != deserializeRegistry.end() && existing->second != ds) throw std::logic_error("Duplicate serializerID?");
 			deserializeRegistry.emplace(ds->serializerID, ds);
 		}
 	}
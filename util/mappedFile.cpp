@@ -0,0 +1,135 @@
+#include "mappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace Util {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE) return;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(mapping == NULL) {
+		CloseHandle(file);
+		return;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(view == NULL) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return;
+	}
+
+	this->fileHandle = file;
+	this->mappingHandle = mapping;
+	this->data = static_cast<const char*>(view);
+	this->size = static_cast<std::size_t>(fileSize.QuadPart);
+}
+
+void MappedFile::close() {
+	if(data != nullptr) {
+		UnmapViewOfFile(data);
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+	}
+	data = nullptr;
+	size = 0;
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+	data(other.data),
+	size(other.size),
+	fileHandle(other.fileHandle),
+	mappingHandle(other.mappingHandle) {
+
+	other.data = nullptr;
+	other.size = 0;
+	other.fileHandle = nullptr;
+	other.mappingHandle = nullptr;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	std::swap(this->data, other.data);
+	std::swap(this->size, other.size);
+	std::swap(this->fileHandle, other.fileHandle);
+	std::swap(this->mappingHandle, other.mappingHandle);
+	return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd == -1) return;
+
+	struct stat fileInfo;
+	if(fstat(fd, &fileInfo) == -1 || fileInfo.st_size == 0) {
+		::close(fd);
+		return;
+	}
+
+	void* view = mmap(nullptr, static_cast<std::size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	if(view == MAP_FAILED) {
+		::close(fd);
+		return;
+	}
+
+	this->fileDescriptor = fd;
+	this->data = static_cast<const char*>(view);
+	this->size = static_cast<std::size_t>(fileInfo.st_size);
+}
+
+void MappedFile::close() {
+	if(data != nullptr) {
+		munmap(const_cast<char*>(data), size);
+		::close(fileDescriptor);
+	}
+	data = nullptr;
+	size = 0;
+	fileDescriptor = -1;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+	data(other.data),
+	size(other.size),
+	fileDescriptor(other.fileDescriptor) {
+
+	other.data = nullptr;
+	other.size = 0;
+	other.fileDescriptor = -1;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	std::swap(this->data, other.data);
+	std::swap(this->size, other.size);
+	std::swap(this->fileDescriptor, other.fileDescriptor);
+	return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+};
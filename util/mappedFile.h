@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Util {
+
+/*
+	Read only memory mapping of an entire file
+	The file's contents can be used as a plain array of bytes for as long as the MappedFile exists
+*/
+class MappedFile {
+	const char* data = nullptr;
+	std::size_t size = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+
+	void close();
+
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// empty files can't be mapped, and are reported as not opened
+	bool isOpen() const { return data != nullptr; }
+	const char* getData() const { return data; }
+	std::size_t getSize() const { return size; }
+};
+
+};
@@ -1,11 +1,19 @@
 #pragma once
 
 #include <string>
+#include <memory>
 
 class ResourceManager;
 
 #pragma region ResourceAllocator
 
+//! ResourceData
+// The contents of a resource file, read and decoded on a loading thread, waiting to be turned into the resource
+class ResourceData {
+public:
+	virtual ~ResourceData() = default;
+};
+
 //! ResourceAllocator
 template<typename T>
 class ResourceAllocator {
@@ -16,6 +24,15 @@ protected:
 
 public:
 	virtual T* load(const std::string& name, const std::string& path) = 0;
+
+	/*
+		Asynchronous loading happens in two steps. decode runs on a loading thread, and may only read and decode the file,
+		finish runs on the main thread and creates the resource from the decoded data, uploading it to the gpu if needed
+
+		Allocators which can't decode their resources off the main thread keep these defaults, which load the whole resource in finish
+	*/
+	virtual std::unique_ptr<ResourceData> decode(const std::string& path) { return nullptr; }
+	virtual T* finish(const std::string& name, const std::string& path, std::unique_ptr<ResourceData> data) { return load(name, path); }
 };
 
 #pragma endregion
@@ -43,6 +60,8 @@ protected:
 	Resource(const std::string& name, const std::string& path);
 
 public:
+	virtual ~Resource() = default;
+
 	virtual ResourceType getType() const = 0;
 	virtual std::string getTypeName() const = 0;
 	virtual void close() = 0;
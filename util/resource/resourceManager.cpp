@@ -1,7 +1,187 @@
 #include "resourceManager.h"
 
+#include <deque>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+
+std::recursive_mutex ResourceManager::mutex;
 std::unordered_map<ResourceType, Resource*> ResourceManager::defaultResources = {};
 std::unordered_map<std::string, ResourceManager::CountedResource> ResourceManager::resources = {};
+std::unordered_map<std::string, std::shared_ptr<PendingResource>> ResourceManager::pendingResources = {};
+
+#pragma region ResourceLoadQueue
+
+//! ResourceLoadQueue
+// The resources waiting to be decoded, and the threads decoding them. The threads are started when the first resource is queued
+class ResourceLoadQueue {
+private:
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable workDecoded;
+
+	std::deque<std::shared_ptr<PendingResource>> decodeQueue;
+	std::vector<std::shared_ptr<PendingResource>> decodedQueue;
+
+	std::vector<std::thread> threads;
+	std::size_t threadCount;
+	bool stopped = false;
+
+	static void decode(PendingResource& pending) {
+		try {
+			pending.data = pending.decode(pending.path);
+		} catch (const std::exception& exception) {
+			Log::error("Could not decode resource (%s): %s", pending.path.c_str(), exception.what());
+			pending.decodeFailed = true;
+		} catch (...) {
+			Log::error("Could not decode resource (%s)", pending.path.c_str());
+			pending.decodeFailed = true;
+		}
+	}
+
+	void work() {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+			workAvailable.wait(lock, [this] () { return stopped || !decodeQueue.empty(); });
+			if (stopped)
+				return;
+
+			std::shared_ptr<PendingResource> pending = std::move(decodeQueue.front());
+			decodeQueue.pop_front();
+			pending->state.store(ResourceLoadState::Decoding, std::memory_order_release);
+
+			lock.unlock();
+			decode(*pending);
+			lock.lock();
+
+			pending->state.store(ResourceLoadState::Decoded, std::memory_order_release);
+			decodedQueue.push_back(std::move(pending));
+			workDecoded.notify_all();
+		}
+	}
+
+	void stopThreads() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
+		}
+		workAvailable.notify_all();
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		threads.clear();
+		stopped = false;
+	}
+
+public:
+	ResourceLoadQueue() {
+		std::size_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = std::max<std::size_t>(1, std::min<std::size_t>(4, hardwareThreads > 1 ? hardwareThreads - 1 : 1));
+	}
+
+	~ResourceLoadQueue() {
+		stopThreads();
+	}
+
+	void push(std::shared_ptr<PendingResource> pending) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			decodeQueue.push_back(std::move(pending));
+
+			while (threads.size() < threadCount)
+				threads.emplace_back([this] () { work(); });
+		}
+		workAvailable.notify_one();
+	}
+
+	// Decodes the resources which are still queued on the calling thread, used when there are no loading threads
+	void decodeQueued() {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!decodeQueue.empty()) {
+			std::shared_ptr<PendingResource> pending = std::move(decodeQueue.front());
+			decodeQueue.pop_front();
+			pending->state.store(ResourceLoadState::Decoding, std::memory_order_release);
+
+			lock.unlock();
+			decode(*pending);
+			lock.lock();
+
+			pending->state.store(ResourceLoadState::Decoded, std::memory_order_release);
+			decodedQueue.push_back(std::move(pending));
+		}
+	}
+
+	std::vector<std::shared_ptr<PendingResource>> takeDecoded() {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::vector<std::shared_ptr<PendingResource>> decoded;
+		decoded.swap(decodedQueue);
+
+		return decoded;
+	}
+
+	// Blocks until the given resource is decoded, a resource which is still queued is decoded on the calling thread
+	void waitUntilDecoded(const std::shared_ptr<PendingResource>& pending) {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		auto iterator = std::find(decodeQueue.begin(), decodeQueue.end(), pending);
+		if (iterator != decodeQueue.end()) {
+			decodeQueue.erase(iterator);
+			pending->state.store(ResourceLoadState::Decoding, std::memory_order_release);
+
+			lock.unlock();
+			decode(*pending);
+			lock.lock();
+
+			pending->state.store(ResourceLoadState::Decoded, std::memory_order_release);
+			decodedQueue.push_back(pending);
+			return;
+		}
+
+		workDecoded.wait(lock, [&pending] () { return pending->state.load(std::memory_order_acquire) != ResourceLoadState::Decoding; });
+	}
+
+	// Stops the loading threads, and drops all resources which haven't been finished yet
+	void clear() {
+		stopThreads();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		for (std::shared_ptr<PendingResource>& pending : decodeQueue)
+			pending->state.store(ResourceLoadState::Failed, std::memory_order_release);
+		for (std::shared_ptr<PendingResource>& pending : decodedQueue) {
+			pending->data.reset();
+			pending->state.store(ResourceLoadState::Failed, std::memory_order_release);
+		}
+
+		decodeQueue.clear();
+		decodedQueue.clear();
+	}
+
+	void setThreadCount(std::size_t threadCount) {
+		stopThreads();
+		this->threadCount = threadCount;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!decodeQueue.empty()) {
+			while (threads.size() < threadCount)
+				threads.emplace_back([this] () { work(); });
+		}
+	}
+
+	std::size_t getThreadCount() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return threadCount;
+	}
+};
+
+static ResourceLoadQueue loadQueue;
+
+#pragma endregion
+
+#pragma region ResourceManager
 
 ResourceManager::ResourceManager() {
 
@@ -9,4 +189,112 @@ ResourceManager::ResourceManager() {
 
 ResourceManager::~ResourceManager() {
 	ResourceManager::close();
-}
\ No newline at end of file
+}
+
+void ResourceManager::enqueueLoad(const std::shared_ptr<PendingResource>& pending) {
+	loadQueue.push(pending);
+}
+
+void ResourceManager::waitUntilLoaded(const std::shared_ptr<PendingResource>& pending) {
+	ResourceLoadState state = pending->state.load(std::memory_order_acquire);
+	if (state == ResourceLoadState::Ready || state == ResourceLoadState::Failed)
+		return;
+
+	loadQueue.waitUntilDecoded(pending);
+	finishLoad(pending);
+}
+
+void ResourceManager::finishLoad(const std::shared_ptr<PendingResource>& pending) {
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	// A resource waited for by add or waitFor has already been finished
+	if (pending->state.load(std::memory_order_acquire) != ResourceLoadState::Decoded)
+		return;
+
+	auto pendingIterator = ResourceManager::pendingResources.find(pending->name);
+	if (pendingIterator != ResourceManager::pendingResources.end() && pendingIterator->second == pending)
+		ResourceManager::pendingResources.erase(pendingIterator);
+
+	Resource* resource = nullptr;
+	if (!pending->decodeFailed)
+		resource = pending->finish(pending->name, pending->path, std::move(pending->data));
+
+	if (resource == nullptr) {
+		Log::warn("Resource not loaded: (%s, %s)", pending->name.c_str(), pending->path.c_str());
+		pending->state.store(ResourceLoadState::Failed, std::memory_order_release);
+		return;
+	}
+
+	auto iterator = ResourceManager::resources.find(pending->name);
+	if (iterator != ResourceManager::resources.end()) {
+		// The resource has been added by someone else in the meantime
+		iterator->second.count += pending->count;
+		resource->close();
+		delete resource;
+		resource = iterator->second.value;
+	} else {
+		CountedResource countedResource = { resource, pending->count };
+		ResourceManager::resources.emplace(pending->name, countedResource);
+	}
+
+	pending->resource = resource;
+	pending->state.store(ResourceLoadState::Ready, std::memory_order_release);
+}
+
+void ResourceManager::update() {
+	if (loadQueue.getThreadCount() == 0)
+		loadQueue.decodeQueued();
+
+	for (const std::shared_ptr<PendingResource>& pending : loadQueue.takeDecoded())
+		finishLoad(pending);
+}
+
+void ResourceManager::waitForAll() {
+	std::vector<std::shared_ptr<PendingResource>> pending;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		pending.reserve(ResourceManager::pendingResources.size());
+		for (auto& iterator : ResourceManager::pendingResources)
+			pending.push_back(iterator.second);
+	}
+
+	for (const std::shared_ptr<PendingResource>& resource : pending)
+		waitUntilLoaded(resource);
+
+	// the waited for resources are still in the decoded queue
+	update();
+}
+
+std::size_t ResourceManager::getPendingCount() {
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	return ResourceManager::pendingResources.size();
+}
+
+void ResourceManager::setLoaderThreadCount(std::size_t threadCount) {
+	loadQueue.setThreadCount(threadCount);
+}
+
+std::size_t ResourceManager::getLoaderThreadCount() {
+	return loadQueue.getThreadCount();
+}
+
+void ResourceManager::close() {
+	loadQueue.clear();
+
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	for (auto& iterator : pendingResources)
+		iterator.second->state.store(ResourceLoadState::Failed, std::memory_order_release);
+	pendingResources.clear();
+
+	for (auto iterator : resources) {
+		iterator.second.value->close();
+	}
+
+	resources.clear();
+	defaultResources.clear();
+}
+
+#pragma endregion
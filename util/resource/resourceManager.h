@@ -6,12 +6,52 @@
 #include <unordered_map>
 #include <map>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
 
 #include "resource.h"
 
+//! ResourceLoadState
+enum class ResourceLoadState {
+	Queued,
+	Decoding,
+	Decoded,
+	Ready,
+	Failed
+};
+
+//! PendingResource
+// A resource which is being loaded asynchronously, shared by the loading threads, the main thread and the handles to it
+struct PendingResource {
+	std::string name;
+	std::string path;
+	std::atomic<ResourceLoadState> state { ResourceLoadState::Queued };
+
+	// runs on a loading thread
+	std::function<std::unique_ptr<ResourceData>(const std::string&)> decode;
+	// runs on the main thread
+	std::function<Resource*(const std::string&, const std::string&, std::unique_ptr<ResourceData>)> finish;
+
+	std::unique_ptr<ResourceData> data;
+	bool decodeFailed = false;
+
+	// set before the state becomes Ready
+	Resource* resource = nullptr;
+	// the number of times the resource was added while it was loading
+	int count = 1;
+};
+
+template<typename T>
+class ResourceHandle;
+
 class ResourceManager {
 	friend Resource;
 
+	template<typename T>
+	friend class ResourceHandle;
+
 private:
 
 	struct CountedResource {
@@ -19,10 +59,16 @@ private:
 		int count;
 	};
 
+	// guards all maps below, recursive because loading a resource may add its default resource
+	static std::recursive_mutex mutex;
+
 	static std::unordered_map<ResourceType, Resource*> defaultResources;
 	static std::unordered_map<std::string, CountedResource> resources;
+	static std::unordered_map<std::string, std::shared_ptr<PendingResource>> pendingResources;
 
 	static void onResourceNameChange(Resource* changedResource, const std::string& newName) {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		auto iterator = ResourceManager::resources.find(changedResource->getName());
 
 		if (iterator == ResourceManager::resources.end()) {
@@ -42,6 +88,8 @@ private:
 	}
 
 	static void onResourcePathChange(Resource* changedResource, const std::string& newPath) {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		auto iterator = ResourceManager::resources.find(changedResource->getName());
 
 		if (iterator == ResourceManager::resources.end()) {
@@ -62,6 +110,8 @@ private:
 
 	template<typename T>
 	static T* getDefaultResource() {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		//Log::subject("DEFAULT");
 		//Log::debug("Getting default resource: (%s)", T::getStaticTypeName().c_str());
 		auto iterator = ResourceManager::defaultResources.find(T::getStaticType());
@@ -84,12 +134,20 @@ private:
 		}
 	}
 
+	// hands the resource to the loading threads
+	static void enqueueLoad(const std::shared_ptr<PendingResource>& pending);
+	// blocks until the loading threads are done with the resource, and finishes it
+	static void waitUntilLoaded(const std::shared_ptr<PendingResource>& pending);
+	static void finishLoad(const std::shared_ptr<PendingResource>& pending);
+
 	ResourceManager();
 	~ResourceManager();
 
 public:
 	template<typename T, typename = std::enable_if<std::is_base_of<Resource, T>::value>>
 	static T* get(const std::string& name) {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		//Log::subject s("GET");
 		//Log::debug("Getting resource: (%s)", name.c_str());
 
@@ -109,6 +167,8 @@ public:
 		if (resource == nullptr)
 			return;
 
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		auto iterator = ResourceManager::resources.find(resource->name);
 
 		if (iterator != ResourceManager::resources.end()) {
@@ -122,9 +182,18 @@ public:
 
 	template<typename T, typename = std::enable_if_t<std::is_base_of<Resource, T>::value>>
 	static T* add(const std::string& name, const std::string& path) {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		Log::subject s("ADD");
 		//Log::debug("Adding resource: (%s, %s)", name.c_str(), path.c_str());
 
+		// A resource which is still loading is finished first
+		auto pendingIterator = ResourceManager::pendingResources.find(name);
+		if (pendingIterator != ResourceManager::pendingResources.end()) {
+			std::shared_ptr<PendingResource> pending = pendingIterator->second;
+			waitUntilLoaded(pending);
+		}
+
 		auto iterator = ResourceManager::resources.find(name);
 
 		if (iterator != ResourceManager::resources.end()) {
@@ -156,22 +225,84 @@ public:
 		return add<T>(path, path);
 	}
 
-	static void close() {
-		for (auto iterator : resources) {
-			iterator.second.value->close();
+	/*
+		Starts loading a resource in the background, and returns a handle to it right away
+		The file is read and decoded on a loading thread, after which update() creates the resource on the main thread
+		Until then, get() returns the default resource of the type, both on the handle and on the ResourceManager
+	*/
+	template<typename T, typename = std::enable_if_t<std::is_base_of<Resource, T>::value>>
+	static ResourceHandle<T> addAsync(const std::string& name, const std::string& path) {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		auto iterator = ResourceManager::resources.find(name);
+		if (iterator != ResourceManager::resources.end()) {
+			iterator->second.count++;
+
+			std::shared_ptr<PendingResource> loaded = std::make_shared<PendingResource>();
+			loaded->name = name;
+			loaded->path = path;
+			loaded->resource = iterator->second.value;
+			loaded->state.store(ResourceLoadState::Ready, std::memory_order_release);
+
+			return ResourceHandle<T>(std::move(loaded));
 		}
 
-		resources.clear();
-		defaultResources.clear();
+		auto pendingIterator = ResourceManager::pendingResources.find(name);
+		if (pendingIterator != ResourceManager::pendingResources.end()) {
+			pendingIterator->second->count++;
+
+			return ResourceHandle<T>(pendingIterator->second);
+		}
+
+		std::shared_ptr<PendingResource> pending = std::make_shared<PendingResource>();
+		pending->name = name;
+		pending->path = path;
+
+		auto allocator = T::getAllocator();
+		pending->decode = [allocator] (const std::string& path) mutable {
+			return allocator.decode(path);
+		};
+		pending->finish = [allocator] (const std::string& name, const std::string& path, std::unique_ptr<ResourceData> data) mutable -> Resource* {
+			return allocator.finish(name, path, std::move(data));
+		};
+
+		ResourceManager::pendingResources.emplace(name, pending);
+		enqueueLoad(pending);
+
+		return ResourceHandle<T>(std::move(pending));
+	}
+
+	template<typename T, typename = std::enable_if_t<std::is_base_of<Resource, T>::value>>
+	static ResourceHandle<T> addAsync(const std::string& path) {
+		return addAsync<T>(path, path);
 	}
 
+	// Creates the resources whose loading threads are done, must be called regularly on the main thread
+	static void update();
+
+	// Blocks until all resources added with addAsync have loaded, must be called on the main thread
+	static void waitForAll();
+
+	// The number of resources added with addAsync which haven't been created yet
+	static std::size_t getPendingCount();
+
+	// The number of threads that decode resources, 0 decodes them on the main thread in update(). May not be called while resources are loading
+	static void setLoaderThreadCount(std::size_t threadCount);
+	static std::size_t getLoaderThreadCount();
+
+	static void close();
+
 	static bool exists(const std::string& name) {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		auto iterator = ResourceManager::resources.find(name);
 		return iterator != ResourceManager::resources.end();
 	}
 
 	template<typename T, typename = std::enable_if<std::is_base_of<Resource, T>::value>>
 	static std::vector<T*> getResourcesOfClass() {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		std::vector<T*> list;
 
 		for (auto iterator : ResourceManager::resources) {
@@ -183,6 +314,8 @@ public:
 	}
 
 	static std::vector<Resource*> getResourcesOfType(ResourceType type) {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		std::vector<Resource*> list;
 		
 		for (auto iterator : ResourceManager::resources) {
@@ -194,6 +327,8 @@ public:
 	}
 
 	static std::vector<Resource*> getResources() {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		std::vector<Resource*> list;
 
 		for (auto iterator : ResourceManager::resources) {
@@ -204,6 +339,8 @@ public:
 	}
 
 	static std::map<std::string, std::vector<Resource*>> getResourceMap() {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
 		std::map<std::string, std::vector<Resource*>> map;
 
 		for (auto iterator : ResourceManager::resources) {
@@ -217,4 +354,46 @@ public:
 
 		return map;
 	}
-};
\ No newline at end of file
+};
+
+//! ResourceHandle
+// A resource added with ResourceManager::addAsync, which may still be loading
+template<typename T>
+class ResourceHandle {
+	std::shared_ptr<PendingResource> pending;
+
+public:
+	ResourceHandle() = default;
+	explicit ResourceHandle(std::shared_ptr<PendingResource> pending) : pending(std::move(pending)) {}
+
+	ResourceLoadState getState() const {
+		return pending == nullptr ? ResourceLoadState::Failed : pending->state.load(std::memory_order_acquire);
+	}
+
+	bool isReady() const {
+		return getState() == ResourceLoadState::Ready;
+	}
+
+	bool hasFailed() const {
+		return getState() == ResourceLoadState::Failed;
+	}
+
+	// The resource once it has loaded, the default resource of its type until then or if it could not be loaded
+	T* get() const {
+		if (isReady())
+			return static_cast<T*>(pending->resource);
+
+		return ResourceManager::getDefaultResource<T>();
+	}
+
+	// Blocks until the resource has loaded, must be called on the main thread. Returns nullptr if it could not be loaded
+	T* wait() const {
+		if (pending == nullptr)
+			return nullptr;
+
+		if (!isReady() && !hasFailed())
+			ResourceManager::waitUntilLoaded(pending);
+
+		return isReady() ? static_cast<T*>(pending->resource) : nullptr;
+	}
+};
@@ -1,13 +1,67 @@
 #include "serializeBasicTypes.h"
 
-#include <sstream>
+#include <cstring>
+#include <climits>
 
 void serialize(const char* data, size_t size, std::ostream& ostream) {
-	ostream.write(data, size);
+	std::streamsize written = ostream.rdbuf()->sputn(data, static_cast<std::streamsize>(size));
+	if(written != static_cast<std::streamsize>(size)) {
+		ostream.setstate(std::ios::badbit);
+	}
 }
 
 void deserialize(char* buf, size_t size, std::istream& istream) {
-	istream.read(buf, size);
+	std::streamsize read = istream.rdbuf()->sgetn(buf, static_cast<std::streamsize>(size));
+	if(read != static_cast<std::streamsize>(size)) {
+		istream.setstate(std::ios::failbit | std::ios::eofbit);
+	}
+}
+
+OutputBuffer::OutputBuffer(size_t initialCapacity) : buffer(initialCapacity) {
+	this->setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+void OutputBuffer::reserveExtra(size_t extraSize) {
+	size_t usedSize = this->size();
+	if(buffer.size() - usedSize >= extraSize) return;
+	size_t newCapacity = buffer.size() * 2;
+	if(newCapacity < usedSize + extraSize) newCapacity = usedSize + extraSize;
+	buffer.resize(newCapacity);
+	this->setp(buffer.data(), buffer.data() + buffer.size());
+	// pbump only takes an int
+	while(usedSize > INT_MAX) {
+		this->pbump(INT_MAX);
+		usedSize -= INT_MAX;
+	}
+	this->pbump(static_cast<int>(usedSize));
+}
+
+OutputBuffer::int_type OutputBuffer::overflow(int_type c) {
+	if(traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+	reserveExtra(1);
+	*this->pptr() = traits_type::to_char_type(c);
+	this->pbump(1);
+	return c;
+}
+
+std::streamsize OutputBuffer::xsputn(const char* data, std::streamsize count) {
+	reserveExtra(static_cast<size_t>(count));
+	std::memcpy(this->pptr(), data, static_cast<size_t>(count));
+	size_t remaining = static_cast<size_t>(count);
+	while(remaining > INT_MAX) {
+		this->pbump(INT_MAX);
+		remaining -= INT_MAX;
+	}
+	this->pbump(static_cast<int>(remaining));
+	return count;
+}
+
+std::vector<char> OutputBuffer::release() {
+	buffer.resize(this->size());
+	std::vector<char> result = std::move(buffer);
+	buffer = std::vector<char>();
+	this->setp(nullptr, nullptr);
+	return result;
 }
 
 template<>
@@ -34,11 +88,16 @@ void serializeString(const std::string& str, std::ostream& ostream) {
 }
 
 std::string deserializeString(std::istream& istream) {
-	std::stringstream sstream;
-
-	while(char c = istream.get()) {
-		sstream << c;
+	std::string result;
+	std::streambuf* buf = istream.rdbuf();
+	while(true) {
+		std::streambuf::int_type c = buf->sbumpc();
+		if(std::streambuf::traits_type::eq_int_type(c, std::streambuf::traits_type::eof())) {
+			istream.setstate(std::ios::failbit | std::ios::eofbit);
+			break;
+		}
+		if(c == 0) break;
+		result.push_back(std::streambuf::traits_type::to_char_type(c));
 	}
-
-	return sstream.str();
+	return result;
 }
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <exception>
 #include <string>
+#include <vector>
 #include <type_traits>
 
 class SerializationException : public std::exception {
@@ -16,9 +17,46 @@ public:
 	}
 };
 
+// these write and read the stream's buffer directly, bypassing the formatting layer of the stream, a short read sets failbit and eofbit
 void serialize(const char* data, size_t size, std::ostream& ostream);
 void deserialize(char* buf, size_t size, std::istream& istream);
 
+/*
+	Stream buffer reading directly from a range of memory, such as a memory mapped file, without copying it
+	The memory must outlive the buffer
+*/
+class MemoryInputBuffer : public std::streambuf {
+public:
+	MemoryInputBuffer(const char* begin, const char* end) {
+		setRange(begin, end);
+	}
+
+	void setRange(const char* begin, const char* end) {
+		char* b = const_cast<char*>(begin);
+		this->setg(b, b, const_cast<char*>(end));
+	}
+};
+
+/*
+	Growable stream buffer writing into memory
+	Writes are a bounds check and a memcpy, so many small writes through ::serialize don't each go through the stream's own buffering
+*/
+class OutputBuffer : public std::streambuf {
+	std::vector<char> buffer;
+
+	void reserveExtra(size_t extraSize);
+protected:
+	virtual int_type overflow(int_type c) override;
+	virtual std::streamsize xsputn(const char* data, std::streamsize count) override;
+public:
+	OutputBuffer(size_t initialCapacity = 4096);
+
+	const char* data() const { return this->pbase(); }
+	size_t size() const { return static_cast<size_t>(this->pptr() - this->pbase()); }
+	// returns the written data, and leaves this buffer empty
+	std::vector<char> release();
+};
+
 /*
 	Trivial value serialization
 	Included are: char, int, float, double, long, Fix, Vector, Matrix, SymmetricMatrix, DiagonalMatrix, CFrame, Transform, GlobalCFrame, GlobalTransform, Bounds, GlobalBounds
@@ -55,17 +93,26 @@ bool deserialize<bool>(std::istream& istream);
 void serializeString(const std::string& str, std::ostream& ostream);
 std::string deserializeString(std::istream& istream);
 
+// arrays of trivially copyable types are written in a single block
 template<typename T>
 void serializeArray(const T* data, size_t size, std::ostream& ostream) {
-	for(size_t i = 0; i < size; i++) {
-		serialize<T>(data[i], ostream);
+	if constexpr(std::is_trivially_copyable<T>::value) {
+		serialize(reinterpret_cast<const char*>(data), size * sizeof(T), ostream);
+	} else {
+		for(size_t i = 0; i < size; i++) {
+			serialize<T>(data[i], ostream);
+		}
 	}
 }
 
 template<typename T>
 void deserializeArray(T* buf, size_t size, std::istream& istream) {
-	for(size_t i = 0; i < size; i++) {
-		buf[i] = deserialize<T>(istream);
+	if constexpr(std::is_trivially_copyable<T>::value) {
+		deserialize(reinterpret_cast<char*>(buf), size * sizeof(T), istream);
+	} else {
+		for(size_t i = 0; i < size; i++) {
+			buf[i] = deserialize<T>(istream);
+		}
 	}
 }
 
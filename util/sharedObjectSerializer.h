@@ -48,11 +48,15 @@ public:
 		itemsYetToSerialize.clear();
 	}
 
-	void serializeIDFor(const T& obj, std::ostream& ostream) const {
+	SerializeID getIDFor(const T& obj) const {
 		auto found = objectToIDMap.find(obj);
 		if(found == objectToIDMap.end()) throw SerializationException("The given object was not registered!");
 
-		::serialize<SerializeID>((*found).second, ostream);
+		return (*found).second;
+	}
+
+	void serializeIDFor(const T& obj, std::ostream& ostream) const {
+		::serialize<SerializeID>(getIDFor(obj), ostream);
 	}
 };
 
@@ -88,14 +92,16 @@ public:
 		}
 	}
 
-	T deserializeObject(std::istream& istream) const {
-		SerializeID id = ::deserialize<SerializeID>(istream);
-
+	T getObject(SerializeID id) const {
 		auto found = IDToObjectMap.find(id);
 		if(found == IDToObjectMap.end()) throw SerializationException("There is no associated object for the id " + std::to_string(id));
 
 		return (*found).second;
 	}
+
+	T deserializeObject(std::istream& istream) const {
+		return getObject(::deserialize<SerializeID>(istream));
+	}
 };
 
 